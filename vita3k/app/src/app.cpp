@@ -20,6 +20,7 @@
 #include <camera/camera.h>
 #include <config/functions.h>
 #include <config/state.h>
+#include <display/state.h>
 #include <emuenv/state.h>
 #include <io/functions.h>
 #include <io/state.h>
@@ -28,6 +29,7 @@
 #include <renderer/functions.h>
 #include <renderer/shaders.h>
 #include <renderer/state.h>
+#include <renderer/texture_cache.h>
 #include <util/fs.h>
 #include <util/log.h>
 #include <util/net_utils.h>
@@ -71,6 +73,20 @@ void reset_perf_metrics(EmuEnvState &emuenv) {
     renderer.perf_overlay.fps_values.fill(0.0f);
     renderer.perf_overlay.fps_values_count = 0;
     renderer.perf_overlay.current_fps_offset = 0;
+    renderer.perf_overlay.commands_per_frame = 0;
+    renderer.perf_overlay.command_bytes_per_frame = 0;
+    renderer.perf_overlay.texture_bytes_hashed_per_frame = 0;
+    renderer.perf_overlay.texture_bytes_uploaded_per_frame = 0;
+    renderer.perf_overlay.vblank_interval_mean = 0;
+    renderer.perf_overlay.vblank_interval_variance = 0;
+    renderer.perf_overlay.vblank_interval_max = 0;
+    renderer.perf_overlay.vblanks_dropped = 0;
+    renderer.command_count = 0;
+    renderer.command_bytes = 0;
+    if (auto *texture_cache = renderer.get_texture_cache()) {
+        texture_cache->bytes_hashed = 0;
+        texture_cache->bytes_uploaded = 0;
+    }
 }
 
 void sync_perf_overlay_config(EmuEnvState &emuenv) {
@@ -338,6 +354,17 @@ bool update_runtime_metrics(EmuEnvState &emuenv, LaunchRuntimeMetrics &metrics)
     std::copy(std::begin(emuenv.fps_values), std::end(emuenv.fps_values), renderer.perf_overlay.fps_values.begin());
     renderer.perf_overlay.fps_values_count = perf_frames_size;
     renderer.perf_overlay.current_fps_offset = emuenv.current_fps_offset;
+    renderer.perf_overlay.commands_per_frame = static_cast<uint32_t>(renderer.command_count.exchange(0) / frame_count);
+    renderer.perf_overlay.command_bytes_per_frame = static_cast<uint32_t>(renderer.command_bytes.exchange(0) / frame_count);
+    if (auto *texture_cache = renderer.get_texture_cache()) {
+        renderer.perf_overlay.texture_bytes_hashed_per_frame = static_cast<uint32_t>(texture_cache->bytes_hashed.exchange(0) / frame_count);
+        renderer.perf_overlay.texture_bytes_uploaded_per_frame = static_cast<uint32_t>(texture_cache->bytes_uploaded.exchange(0) / frame_count);
+    }
+    const FrameTimeStats vblank_stats = emuenv.display.vblank_pacer.take_stats();
+    renderer.perf_overlay.vblank_interval_mean = static_cast<float>(vblank_stats.mean_ms);
+    renderer.perf_overlay.vblank_interval_variance = static_cast<float>(vblank_stats.variance_ms2);
+    renderer.perf_overlay.vblank_interval_max = static_cast<float>(vblank_stats.max_ms);
+    renderer.perf_overlay.vblanks_dropped = vblank_stats.dropped;
 
     return true;
 }
@@ -562,11 +562,12 @@ bool late_init(EmuEnvState &state) {
         return false;
     }
 
+    state.audio.wav_path = state.log_path / "audio.wav";
     if (!state.audio.init(state.cfg.current_config.audio_backend)) {
         LOG_WARN("Failed to initialize audio! Audio will not work.");
     }
 
-    if (!ngs::init(state.ngs, state.mem)) {
+    if (!ngs::init(state.ngs, state.mem, std::max(state.cfg.ngs_worker_threads, 0))) {
         LOG_ERROR("Failed to initialize ngs.");
         return false;
     }
@@ -587,6 +588,7 @@ void apply_renderer_config(EmuEnvState &emuenv) {
     r.stretch_hd_pixel_perfect(cc.fullscreen_hd_res_pixel_perfect);
     r.set_async_compilation(cc.async_pipeline_compilation);
     r.get_texture_cache()->set_replacement_state(cc.import_textures, cc.export_textures, cc.export_as_png);
+    r.get_texture_cache()->async_decoding = emuenv.cfg.async_texture_decoding;
 #ifdef __ANDROID__
     if (r.support_custom_drivers())
         r.set_turbo_mode(emuenv.cfg.turbo_mode);
@@ -680,6 +682,7 @@ void apply_runtime_settings(EmuEnvState &emuenv) {
     r.stretch_hd_pixel_perfect(cc.fullscreen_hd_res_pixel_perfect);
     r.set_async_compilation(cc.async_pipeline_compilation);
     r.get_texture_cache()->set_replacement_state(cc.import_textures, cc.export_textures, cc.export_as_png);
+    r.get_texture_cache()->async_decoding = emuenv.cfg.async_texture_decoding;
 #ifdef __ANDROID__
     if (r.support_custom_drivers())
         r.set_turbo_mode(emuenv.cfg.turbo_mode);
@@ -19,42 +19,17 @@
 
 #include "../state.h"
 
-#include <condition_variable>
-
 #include <cubeb/cubeb.h>
 
-struct AudioBuffer {
-    std::vector<uint8_t> buffer;
-    int buffer_position;
-};
-
-struct CubebAudioOutPort : AudioOutPort {
-    cubeb_stream *out_stream = nullptr;
-    cubeb_stream_params spec;
-    // sync variables used to wait for the buffer to be ready
-    std::mutex mutex;
-    std::condition_variable cond_var;
-    // buffer filled with audio data to pass to cubeb
-    std::vector<AudioBuffer> audio_buffers;
-    // position of the next audio buffer to put audio
-    int next_audio_buffer = 0;
-    int nb_buffers_ready = 0;
-
-    // use the destructor to destroy the cubeb stream
-    ~CubebAudioOutPort();
-};
-
 class CubebAudioAdapter : public AudioAdapter {
     cubeb *cubeb_ctx = nullptr;
+    // all the ports are mixed in this stream
+    cubeb_stream *out_stream = nullptr;
 
 public:
     CubebAudioAdapter(AudioState &audio_state);
     ~CubebAudioAdapter() override;
 
     bool init() override;
-    AudioOutPortPtr open_port(int nb_channels, int freq, int nb_sample) override;
-    void audio_output(AudioOutPort &out_port, const void *buffer) override;
-    void set_volume(AudioOutPort &out_port, float volume) override;
     void switch_state(const bool pause) override;
-    void wake_all_ports() override;
 };
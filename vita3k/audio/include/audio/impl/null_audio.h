@@ -0,0 +1,67 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "../state.h"
+
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+// Adapter without any device, for headless runs: a thread pulls the mixed stream in real time and drops it
+class NullAudioAdapter : public AudioAdapter {
+public:
+    explicit NullAudioAdapter(AudioState &audio_state);
+    ~NullAudioAdapter() override;
+
+    bool init() override;
+    void switch_state(const bool pause) override;
+
+protected:
+    // Called from the adapter thread with each mixed period
+    virtual void consume(const float *samples, uint32_t frame_count) {}
+    // Joins the adapter thread, must be called by the destructor of a subclass overriding consume
+    void stop();
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool quit = false;
+    bool paused = false;
+};
+
+// Writes the mixed stream to a 16-bit stereo WAV file, to compare the audio of two runs
+class WavAudioAdapter : public NullAudioAdapter {
+public:
+    WavAudioAdapter(AudioState &audio_state, const fs::path &path);
+    ~WavAudioAdapter() override;
+
+    bool init() override;
+
+protected:
+    void consume(const float *samples, uint32_t frame_count) override;
+
+private:
+    fs::path path;
+    fs::ofstream file;
+    std::vector<int16_t> converted;
+    uint32_t data_size = 0;
+};
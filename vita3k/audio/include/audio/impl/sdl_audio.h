@@ -19,15 +19,16 @@
 
 #include "../state.h"
 #include <SDL3/SDL_audio.h>
-#include <condition_variable>
+
+#include <vector>
 
 class SDLAudioAdapter : public AudioAdapter {
 private:
-    SDL_AudioDeviceID device_id = 0;
-    int device_buffer_samples = 0;
-    SDL_AudioSpec dst_spec;
+    SDL_AudioStream *stream = nullptr;
+    // mixed samples given to the stream
+    std::vector<float> mix_buffer;
 
-    static void SDLCALL thread_wakeup_callback(void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount);
+    static void SDLCALL stream_callback(void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount);
 
 public:
     explicit SDLAudioAdapter(AudioState &audio_state);
@@ -35,22 +36,4 @@ public:
 
     bool init() override;
     void switch_state(const bool pause) override;
-    AudioOutPortPtr open_port(int nb_channels, int freq, int nb_sample) override;
-    void audio_output(AudioOutPort &out_port, const void *buffer) override;
-    void set_volume(AudioOutPort &out_port, float volume) override;
-    int get_rest_sample(AudioOutPort &out_port) override;
-    void wake_all_ports() override;
-};
-
-using AudioStreamPtr = std::shared_ptr<SDL_AudioStream>;
-
-struct SDLAudioOutPort : public AudioOutPort {
-    int channels = 2;
-    AudioStreamPtr stream;
-    SDLAudioAdapter &adapter;
-    std::mutex mutex;
-    std::condition_variable cond_var;
-    SDLAudioOutPort(AudioStreamPtr stream, AudioAdapter &adapter)
-        : stream(std::move(stream))
-        , adapter(dynamic_cast<SDLAudioAdapter &>(adapter)) {}
 };
@@ -0,0 +1,123 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct AudioOutPort;
+
+// Sample rate of the mixed stream, the one of the PS Vita
+constexpr int MIXER_SAMPLE_RATE = 48000;
+// The mixed stream is interleaved stereo
+constexpr int MIXER_CHANNELS = 2;
+
+/**
+ * @brief Single-producer single-consumer ring of 16-bit samples
+ *
+ * The guest thread outputting to a port is the producer and the mixer is the consumer,
+ * neither of them ever takes a lock.
+ */
+class SampleRing {
+public:
+    // the capacity is rounded up to a power of two
+    explicit SampleRing(size_t min_capacity);
+    SampleRing(const SampleRing &) = delete;
+    SampleRing &operator=(const SampleRing &) = delete;
+
+    size_t capacity() const {
+        return buffer.size();
+    }
+
+    // Can be called from both sides, the result is only a snapshot
+    size_t size() const {
+        return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire);
+    }
+
+    // Producer only. Returns false without writing anything if there is no room for count samples.
+    bool push(const int16_t *samples, size_t count);
+
+    // Consumer only. Sample offset samples after the oldest one, offset must be lower than size().
+    int16_t at(size_t offset) const {
+        return buffer[(read_pos.load(std::memory_order_relaxed) + offset) & mask];
+    }
+
+    // Consumer only. Returns the samples starting offset samples after the oldest one,
+    // count is lowered to the number of them which follow each other in memory.
+    const int16_t *contiguous(size_t offset, size_t &count) const;
+
+    // Consumer only
+    void pop(size_t count) {
+        read_pos.store(read_pos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    std::vector<int16_t> buffer;
+    size_t mask;
+
+    // the producer and the consumer each write one of them, keep them on different cache lines
+    alignas(64) std::atomic<size_t> write_pos{ 0 };
+    alignas(64) std::atomic<size_t> read_pos{ 0 };
+};
+
+/**
+ * @brief Mixes all the output ports into a single stereo stream at MIXER_SAMPLE_RATE
+ *
+ * The audio adapter pulls the mixed stream from the callback of its only device stream, this callback is the
+ * only clock: an output to a port returns as soon as the port has room for it, and otherwise waits
+ * for the mixer to consume what was queued before.
+ */
+class AudioMixer {
+public:
+    // called by the constructor and destructor of the ports
+    void add_port(AudioOutPort &port);
+    void remove_port(AudioOutPort &port);
+
+    // Queues port.len frames, blocks while the port already has enough frames queued
+    void output(AudioOutPort &port, const void *buffer);
+    // Frames queued in the port and not mixed yet
+    int get_rest_sample(const AudioOutPort &port) const;
+    // volume is the average of the two channels, the port channel volumes give their balance
+    void set_volume(AudioOutPort &port, float volume);
+    // Makes the pending outputs check again if they can return
+    void wake_all_ports();
+    // While paused, the device does not pull anything so the outputs do not wait
+    void set_paused(bool pause);
+
+    // Called by the adapter, writes frame_count interleaved stereo frames of all the ports mixed together
+    void mix(float *out, uint32_t frame_count);
+
+private:
+    using PortList = std::vector<AudioOutPort *>;
+
+    // Opening or releasing a port publishes a new list under ports_mutex, the mixer reads the current one
+    // in an RCU read-side section without locking. The old list is released once no mix can still see it.
+    void publish_ports(std::unique_ptr<const PortList> next);
+
+    std::mutex ports_mutex;
+    std::unique_ptr<const PortList> ports = std::make_unique<const PortList>();
+    std::atomic<const PortList *> current_ports{ ports.get() };
+
+    // largest number of frames pulled at once by the device
+    std::atomic<uint32_t> device_period{ 512 };
+    std::atomic<bool> paused{ false };
+};
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <audio/mixer.h>
+#include <util/fs.h>
 #include <util/types.h>
 
 #include <atomic>
@@ -30,7 +32,13 @@
 #define SCE_AUDIO_VOLUME_0DB SCE_AUDIO_OUT_MAX_VOL //!< Maximum output port volume
 
 struct AudioOutPort {
-    virtual ~AudioOutPort() = default;
+    // the port is mixed by mixer until it is destroyed
+    AudioOutPort(AudioMixer &mixer, int nb_channels, int freq, int nb_sample);
+    ~AudioOutPort();
+    AudioOutPort(const AudioOutPort &) = delete;
+    AudioOutPort &operator=(const AudioOutPort &) = delete;
+
+    AudioMixer &mixer;
 
     // shutdown flag
     std::atomic<bool> stopping{ false };
@@ -39,18 +47,25 @@ struct AudioOutPort {
     int right_channel_volume = SCE_AUDIO_VOLUME_0DB;
     // Volume range from 0 to 1
     float volume = 1.0f;
-    // length of the buffer for each call
-    int len_bytes = 0;
-    // number of microseconds a buffer lasts for
-    uint64_t len_microseconds = 0;
-    // last time sceAudioOutOutput was called with this port (timestamp in microseconds)
-    uint64_t last_output = 0;
 
     // current config
     int type = 0;
     int len = 0;
     int freq = 0;
     int mode = 0;
+
+    // Mixer state
+    int channels = 2;
+    // samples output by the guest and not mixed yet
+    SampleRing ring;
+    // port frames per mixed frame, and position between the two port frames being interpolated, in 1/65536 of a frame
+    uint32_t resample_step = 1 << 16;
+    uint32_t resample_phase = 0;
+    // gain of each channel, the conversion of the samples to float included
+    std::atomic<float> gain_left;
+    std::atomic<float> gain_right;
+    // bumped by the mixer after it consumed samples and to wake the output waiting for it
+    std::atomic<uint32_t> wake_sequence{ 0 };
 };
 
 typedef std::shared_ptr<AudioOutPort> AudioOutPortPtr;
@@ -66,6 +81,7 @@ struct ThreadState;
 struct AudioState;
 
 // abstract class that need to be overloaded with an audio implementation
+// the adapter only opens a single stream, its callback pulls the ports mixed together from state.mixer
 class AudioAdapter {
 public:
     AudioState &state;
@@ -75,17 +91,13 @@ public:
     virtual ~AudioAdapter() = default;
 
     virtual bool init() = 0;
-    virtual AudioOutPortPtr open_port(int nb_channels, int freq, int nb_sample) { return nullptr; }
-    virtual void audio_output(AudioOutPort &out_port, const void *buffer) {}
-    virtual void set_volume(AudioOutPort &out_port, float volume) {}
     virtual void switch_state(const bool pause) {}
-    virtual int get_rest_sample(AudioOutPort &out_port) { return 0; };
-    virtual void wake_all_ports() {}
     friend struct AudioState;
 };
 
 struct AudioState {
-    //  the adapter must be before out_ports for the destructors to work correctly
+    // the mixer is used by the adapter callback and the ports, it must be before both of them
+    AudioMixer mixer;
     std::unique_ptr<AudioAdapter> adapter;
     std::mutex mutex;
     int next_port_id = 1;
@@ -93,6 +105,8 @@ struct AudioState {
     AudioInPort in_port;
     std::string audio_backend;
     float global_volume = 1;
+    // file written by the WAV backend
+    fs::path wav_path = "audio.wav";
 
     bool init(const std::string &adapter_name);
     void deinit();
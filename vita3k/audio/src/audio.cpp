@@ -18,6 +18,7 @@
 #include <audio/state.h>
 
 #include <audio/impl/cubeb_audio.h>
+#include <audio/impl/null_audio.h>
 #include <audio/impl/sdl_audio.h>
 
 #include <util/log.h>
@@ -40,8 +41,7 @@ void AudioState::stop_all_ports() {
             port->stopping = true;
         }
     }
-    if (adapter)
-        adapter->wake_all_ports();
+    mixer.wake_all_ports();
 }
 
 void AudioState::deinit() {
@@ -72,6 +72,10 @@ void AudioState::set_backend(const std::string &adapter_name) {
         adapter = std::make_unique<SDLAudioAdapter>(*this);
     } else if (adapter_name == "Cubeb") {
         adapter = std::make_unique<CubebAudioAdapter>(*this);
+    } else if (adapter_name == "Null") {
+        adapter = std::make_unique<NullAudioAdapter>(*this);
+    } else if (adapter_name == "WAV") {
+        adapter = std::make_unique<WavAudioAdapter>(*this, wav_path);
     } else {
         LOG_ERROR("Unknown audio adapter {}", adapter_name);
         return;
@@ -86,7 +90,10 @@ void AudioState::set_backend(const std::string &adapter_name) {
 }
 
 AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample) {
-    AudioOutPortPtr port = adapter->open_port(nb_channels, freq, nb_sample);
+    if (!adapter)
+        return nullptr;
+
+    AudioOutPortPtr port = std::make_shared<AudioOutPort>(mixer, nb_channels, freq, nb_sample);
     set_volume(*port, port->volume);
     return port;
 }
@@ -95,31 +102,13 @@ void AudioState::audio_output(AudioOutPort &out_port, const void *buffer) {
     if (out_port.stopping)
         return;
 
-    adapter->audio_output(out_port, buffer);
-
-    if (out_port.stopping)
-        return;
-
-    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    uint64_t diff = now - out_port.last_output;
-    uint64_t to_wait = out_port.len_microseconds - diff;
-    if (diff < out_port.len_microseconds && to_wait > 1000) {
-        // This is what we should be waiting to be perfectly accurate
-        // However, doing so would cause the host audio buffer to often lack samples to output
-        // This is because the PS Vita and the host audio parameters do not match exactly
-        // So instead only wait 50% of the time
-        // also don't sleep for less than 0.5 ms
-        to_wait /= 2;
-        std::this_thread::sleep_for(std::chrono::microseconds(to_wait));
-        out_port.last_output = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    } else {
-        out_port.last_output = now;
-    }
+    // the mixer waits for the device to pull the previous buffers, no need to sleep here
+    mixer.output(out_port, buffer);
 }
 
 void AudioState::set_volume(AudioOutPort &out_port, float volume) {
     out_port.volume = volume;
-    adapter->set_volume(out_port, volume * global_volume);
+    mixer.set_volume(out_port, volume * global_volume);
 }
 
 void AudioState::set_global_volume(float volume) {
@@ -127,16 +116,18 @@ void AudioState::set_global_volume(float volume) {
     //  Update adapter volume for each port.
     const std::lock_guard lock(mutex);
     for (const auto &[_, port] : out_ports) {
-        adapter->set_volume(*port, port->volume * volume);
+        mixer.set_volume(*port, port->volume * volume);
     }
 }
 
 void AudioState::switch_state(const bool pause) {
-    adapter->switch_state(pause);
+    mixer.set_paused(pause);
+    if (adapter)
+        adapter->switch_state(pause);
 }
 
 int AudioState::get_rest_sample(AudioOutPort &out_port) {
-    return adapter->get_rest_sample(out_port);
+    return mixer.get_rest_sample(out_port);
 }
 
 void AudioState::wake_all_ports() {
@@ -144,6 +135,5 @@ void AudioState::wake_all_ports() {
     for (auto &[_, port] : out_ports) {
         port->stopping = true;
     }
-    if (adapter)
-        adapter->wake_all_ports();
+    mixer.wake_all_ports();
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "audio/impl/null_audio.h"
+#include "util/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// frames pulled at once, a usual period for a real device
+static constexpr uint32_t NULL_DEVICE_PERIOD = 512;
+
+using MixerFrames = std::chrono::duration<int64_t, std::ratio<1, MIXER_SAMPLE_RATE>>;
+
+NullAudioAdapter::NullAudioAdapter(AudioState &audio_state)
+    : AudioAdapter(audio_state) {}
+
+NullAudioAdapter::~NullAudioAdapter() {
+    stop();
+}
+
+bool NullAudioAdapter::init() {
+    thread = std::thread(&NullAudioAdapter::run, this);
+    return true;
+}
+
+void NullAudioAdapter::switch_state(const bool pause) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        paused = pause;
+    }
+    cond.notify_all();
+}
+
+void NullAudioAdapter::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cond.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void NullAudioAdapter::run() {
+    std::vector<float> buffer(NULL_DEVICE_PERIOD * MIXER_CHANNELS);
+    auto start = std::chrono::steady_clock::now();
+    int64_t frames_pulled = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!quit) {
+        if (paused) {
+            cond.wait(lock, [&] { return quit || !paused; });
+            start = std::chrono::steady_clock::now();
+            frames_pulled = 0;
+            continue;
+        }
+
+        // pull a period when the previous one is over, like a device would
+        const auto next = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(MixerFrames(frames_pulled));
+        if (cond.wait_until(lock, next, [&] { return quit || paused; }))
+            continue;
+
+        lock.unlock();
+        state.mixer.mix(buffer.data(), NULL_DEVICE_PERIOD);
+        consume(buffer.data(), NULL_DEVICE_PERIOD);
+        lock.lock();
+        frames_pulled += NULL_DEVICE_PERIOD;
+    }
+}
+
+// the header is written again with the final sizes when the file is closed
+static void write_wav_header(fs::ofstream &file, uint32_t data_size) {
+    uint8_t header[44];
+    const auto put = [&](size_t offset, uint32_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++)
+            header[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    };
+    std::copy_n("RIFF", 4, header);
+    put(4, 36 + data_size, 4);
+    std::copy_n("WAVEfmt ", 8, header + 8);
+    put(16, 16, 4);
+    // integer PCM
+    put(20, 1, 2);
+    put(22, MIXER_CHANNELS, 2);
+    put(24, MIXER_SAMPLE_RATE, 4);
+    put(28, MIXER_SAMPLE_RATE * MIXER_CHANNELS * sizeof(int16_t), 4);
+    put(32, MIXER_CHANNELS * sizeof(int16_t), 2);
+    put(34, 16, 2);
+    std::copy_n("data", 4, header + 36);
+    put(40, data_size, 4);
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+}
+
+WavAudioAdapter::WavAudioAdapter(AudioState &audio_state, const fs::path &path)
+    : NullAudioAdapter(audio_state)
+    , path(path) {}
+
+WavAudioAdapter::~WavAudioAdapter() {
+    // no more samples can be consumed after this
+    stop();
+    if (file.is_open()) {
+        write_wav_header(file, data_size);
+        LOG_INFO("Wrote {:.1f} seconds of audio to {}", data_size / (MIXER_SAMPLE_RATE * MIXER_CHANNELS * sizeof(int16_t) * 1.0), path);
+    }
+}
+
+bool WavAudioAdapter::init() {
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Could not open {} to write audio", path);
+        return false;
+    }
+
+    write_wav_header(file, 0);
+    return NullAudioAdapter::init();
+}
+
+void WavAudioAdapter::consume(const float *samples, uint32_t frame_count) {
+    const size_t count = static_cast<size_t>(frame_count) * MIXER_CHANNELS;
+    converted.resize(count);
+    // the samples are already clamped by the mixer
+    for (size_t i = 0; i < count; i++)
+        converted[i] = static_cast<int16_t>(std::lrint(samples[i] * 32767.0f));
+
+    // WAV files are little endian
+    for (int16_t &sample : converted) {
+        const uint16_t value = static_cast<uint16_t>(sample);
+        const uint8_t bytes[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+        std::memcpy(&sample, bytes, sizeof(bytes));
+    }
+
+    file.write(reinterpret_cast<const char *>(converted.data()), count * sizeof(int16_t));
+    data_size += static_cast<uint32_t>(count * sizeof(int16_t));
+}
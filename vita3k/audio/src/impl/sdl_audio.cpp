@@ -28,31 +28,31 @@
         }                                                     \
     } while (0)
 
-#define SDL_CHECK(f_call) SDL_CHECK_EXT(f_call, {})
 #define SDL_CHECK_VOID(f_call) SDL_CHECK_EXT(f_call, )
-#define SDL_CHECK_NEG(f_call) SDL_CHECK_EXT((f_call) >= 0, {})
 
-static int get_threshold_samples(const int device_buffer_samples) {
-    return 4 * device_buffer_samples;
-}
-
-void SDLCALL SDLAudioAdapter::thread_wakeup_callback(void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount) {
+void SDLCALL SDLAudioAdapter::stream_callback(void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount) {
     assert(userdata != nullptr);
     assert(stream != nullptr);
-    SDLAudioOutPort *port = static_cast<SDLAudioOutPort *>(userdata);
-    const int samples_available = port->adapter.get_rest_sample(*port);
-    if (samples_available < get_threshold_samples(port->adapter.device_buffer_samples) || additional_amount > 0) {
-        port->cond_var.notify_one();
-    }
+    SDLAudioAdapter *adapter = static_cast<SDLAudioAdapter *>(userdata);
+    const int frame_count = additional_amount / (MIXER_CHANNELS * sizeof(float));
+    if (frame_count <= 0)
+        return;
+
+    // the buffer is sized for the device period in init, this only happens if the device asks for more at once
+    if (adapter->mix_buffer.size() < static_cast<size_t>(frame_count) * MIXER_CHANNELS)
+        adapter->mix_buffer.resize(static_cast<size_t>(frame_count) * MIXER_CHANNELS);
+
+    adapter->state.mixer.mix(adapter->mix_buffer.data(), frame_count);
+    SDL_CHECK_VOID(SDL_PutAudioStreamData(stream, adapter->mix_buffer.data(), frame_count * MIXER_CHANNELS * sizeof(float)));
 }
 
 SDLAudioAdapter::SDLAudioAdapter(AudioState &audio_state)
     : AudioAdapter(audio_state) {}
 
 SDLAudioAdapter::~SDLAudioAdapter() {
-    if (device_id > 0) {
-        SDL_CloseAudioDevice(device_id);
-    }
+    // also closes the device
+    if (stream)
+        SDL_DestroyAudioStream(stream);
 }
 
 bool SDLAudioAdapter::init() {
@@ -60,73 +60,29 @@ bool SDLAudioAdapter::init() {
     // Request smaller device buffer for lower latency callbacks.
     // 512 sample frames = 2048 bytes for stereo 16-bit, matching cubeb's callback size.
     SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES, "512");
-    device_id = SDL_OpenAudioDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, nullptr);
-    SDL_CHECK_EXT(device_id > 0, false);
-    return true;
-}
-
-void SDLAudioAdapter::switch_state(const bool pause) {
-    if (pause)
-        SDL_CHECK_VOID(SDL_PauseAudioDevice(device_id));
-    else
-        SDL_CHECK_VOID(SDL_ResumeAudioDevice(device_id));
-}
 
-AudioOutPortPtr SDLAudioAdapter::open_port(int nb_channels, int freq, int nb_sample) {
-    SDL_AudioSpec src_spec = {
-        .format = SDL_AUDIO_S16LE,
-        .channels = nb_channels,
-        .freq = freq
+    // all the ports are mixed in a single stream, SDL converts it to the device format
+    const SDL_AudioSpec spec = {
+        .format = SDL_AUDIO_F32,
+        .channels = MIXER_CHANNELS,
+        .freq = MIXER_SAMPLE_RATE
     };
-    SDL_CHECK(SDL_GetAudioDeviceFormat(device_id, &dst_spec, &device_buffer_samples));
-    const AudioStreamPtr stream(SDL_CreateAudioStream(&src_spec, &dst_spec), SDL_DestroyAudioStream);
-    SDL_CHECK(stream);
-    SDL_CHECK(SDL_BindAudioStream(device_id, stream.get()));
-    auto port = std::make_shared<SDLAudioOutPort>(stream, *this);
-    SDL_CHECK(SDL_SetAudioStreamGetCallback(stream.get(), SDLAudioAdapter::thread_wakeup_callback, port.get()));
-    port->channels = nb_channels;
-    port->len_microseconds = (nb_sample * 1'000'000ULL) / freq;
-    port->len_bytes = nb_sample * nb_channels * sizeof(int16_t);
-    switch_state(false);
-    return port;
-}
-
-void SDLAudioAdapter::audio_output(AudioOutPort &out_port, const void *buffer) {
-    if (out_port.stopping)
-        return;
+    stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, SDLAudioAdapter::stream_callback, this);
+    SDL_CHECK_EXT(stream, false);
 
-    //  Put audio to the port's stream and see how much is left to play.
-    SDLAudioOutPort &port = static_cast<SDLAudioOutPort &>(out_port);
-    // If there's lots of audio left to play, stop this thread.
-    // The audio callback will wake it up later when it's running out of data.
-    const int samples_available = get_rest_sample(port);
-    if (samples_available > get_threshold_samples(device_buffer_samples)) {
-        std::unique_lock<std::mutex> lock(port.mutex);
-        port.cond_var.wait_for(lock, std::chrono::microseconds(port.len_microseconds * 2));
-        if (out_port.stopping)
-            return;
-    }
-    SDL_CHECK_VOID(SDL_PutAudioStreamData(port.stream.get(), buffer, out_port.len_bytes));
-}
+    int device_buffer_samples = 0;
+    SDL_AudioSpec device_spec;
+    if (SDL_GetAudioDeviceFormat(SDL_GetAudioStreamDevice(stream), &device_spec, &device_buffer_samples))
+        mix_buffer.resize(static_cast<size_t>(std::max(device_buffer_samples, 512)) * MIXER_CHANNELS);
 
-void SDLAudioAdapter::set_volume(AudioOutPort &out_port, float volume) {
-    SDL_CHECK_VOID(SDL_SetAudioStreamGain(static_cast<SDLAudioOutPort &>(out_port).stream.get(), volume));
-}
-
-int SDLAudioAdapter::get_rest_sample(AudioOutPort &out_port) {
-    auto &port = static_cast<SDLAudioOutPort &>(out_port);
-    const int bytes_available = SDL_GetAudioStreamAvailable(port.stream.get());
-    SDL_CHECK_NEG(bytes_available);
-    // we have the number of bytes left, we can convert it back to the number of samples left
-    return bytes_available / SDL_AUDIO_FRAMESIZE(dst_spec);
+    // the device stream starts paused
+    SDL_CHECK_EXT(SDL_ResumeAudioStreamDevice(stream), false);
+    return true;
 }
 
-void SDLAudioAdapter::wake_all_ports() {
-    for (auto &[_, port_ptr] : state.out_ports) {
-        auto &port = static_cast<SDLAudioOutPort &>(*port_ptr);
-        {
-            std::lock_guard<std::mutex> lock(port.mutex);
-        }
-        port.cond_var.notify_all();
-    }
+void SDLAudioAdapter::switch_state(const bool pause) {
+    if (pause)
+        SDL_CHECK_VOID(SDL_PauseAudioStreamDevice(stream));
+    else
+        SDL_CHECK_VOID(SDL_ResumeAudioStreamDevice(stream));
 }
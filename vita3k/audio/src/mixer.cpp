@@ -0,0 +1,298 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <audio/mixer.h>
+#include <audio/state.h>
+#include <util/object_table.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MIXER_NEON
+#elif defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIXER_SSE2
+#endif
+
+// largest device period taken into account when sizing the rings and waiting, in mixed frames
+static constexpr uint32_t MAX_DEVICE_PERIOD = 8192;
+
+SampleRing::SampleRing(size_t min_capacity)
+    : buffer(std::bit_ceil(std::max<size_t>(min_capacity, 2)))
+    , mask(buffer.size() - 1) {}
+
+bool SampleRing::push(const int16_t *samples, size_t count) {
+    const size_t write = write_pos.load(std::memory_order_relaxed);
+    if (count > capacity() - (write - read_pos.load(std::memory_order_acquire)))
+        return false;
+
+    const size_t start = write & mask;
+    const size_t first_part = std::min(count, capacity() - start);
+    std::copy_n(samples, first_part, &buffer[start]);
+    std::copy_n(samples + first_part, count - first_part, buffer.data());
+    write_pos.store(write + count, std::memory_order_release);
+    return true;
+}
+
+const int16_t *SampleRing::contiguous(size_t offset, size_t &count) const {
+    const size_t start = (read_pos.load(std::memory_order_relaxed) + offset) & mask;
+    count = std::min(count, capacity() - start);
+    return &buffer[start];
+}
+
+AudioOutPort::AudioOutPort(AudioMixer &mixer, int nb_channels, int freq, int nb_sample)
+    : mixer(mixer)
+    , len(nb_sample)
+    , freq(freq)
+    , channels(nb_channels)
+    // room for the buffer being written, the one before it and what the device pulls at once
+    , ring((2 * static_cast<size_t>(nb_sample) + 2 * MAX_DEVICE_PERIOD) * nb_channels)
+    , resample_step(static_cast<uint32_t>((static_cast<uint64_t>(freq) << 16) / MIXER_SAMPLE_RATE))
+    , gain_left(1.0f / 32768.0f)
+    , gain_right(1.0f / 32768.0f) {
+    mixer.add_port(*this);
+}
+
+AudioOutPort::~AudioOutPort() {
+    mixer.remove_port(*this);
+}
+
+namespace {
+
+// out[2 * i] += src[2 * i] * gain_left and out[2 * i + 1] += src[2 * i + 1] * gain_right
+void mix_stereo(float *out, const int16_t *src, size_t frame_count, float gain_left, float gain_right) {
+    size_t i = 0;
+#if defined(MIXER_SSE2)
+    const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+    for (; i + 4 <= frame_count; i += 4) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        // sign extend the 16-bit samples by putting them in the upper half of 32-bit lanes
+        const __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        const __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(low, gains)));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), _mm_mul_ps(high, gains)));
+    }
+#elif defined(MIXER_NEON)
+    const float32x4_t gains = { gain_left, gain_right, gain_left, gain_right };
+    for (; i + 4 <= frame_count; i += 4) {
+        const int16x8_t samples = vld1q_s16(src + 2 * i);
+        const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(out + 2 * i, vmlaq_f32(vld1q_f32(out + 2 * i), low, gains));
+        vst1q_f32(out + 2 * i + 4, vmlaq_f32(vld1q_f32(out + 2 * i + 4), high, gains));
+    }
+#endif
+    for (; i < frame_count; i++) {
+        out[2 * i] += src[2 * i] * gain_left;
+        out[2 * i + 1] += src[2 * i + 1] * gain_right;
+    }
+}
+
+// out[2 * i] += src[i] * gain_left and out[2 * i + 1] += src[i] * gain_right
+void mix_mono(float *out, const int16_t *src, size_t frame_count, float gain_left, float gain_right) {
+    size_t i = 0;
+#if defined(MIXER_SSE2)
+    const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+    for (; i + 4 <= frame_count; i += 4) {
+        const __m128i samples = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        const __m128 values = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        // duplicate each sample for both channels
+        const __m128 low = _mm_unpacklo_ps(values, values);
+        const __m128 high = _mm_unpackhi_ps(values, values);
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(low, gains)));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), _mm_mul_ps(high, gains)));
+    }
+#elif defined(MIXER_NEON)
+    const float32x4_t gains = { gain_left, gain_right, gain_left, gain_right };
+    for (; i + 4 <= frame_count; i += 4) {
+        const float32x4_t values = vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i)));
+        const float32x4x2_t both = vzipq_f32(values, values);
+        vst1q_f32(out + 2 * i, vmlaq_f32(vld1q_f32(out + 2 * i), both.val[0], gains));
+        vst1q_f32(out + 2 * i + 4, vmlaq_f32(vld1q_f32(out + 2 * i + 4), both.val[1], gains));
+    }
+#endif
+    for (; i < frame_count; i++) {
+        out[2 * i] += src[i] * gain_left;
+        out[2 * i + 1] += src[i] * gain_right;
+    }
+}
+
+void clamp_samples(float *samples, size_t count) {
+    size_t i = 0;
+#if defined(MIXER_SSE2)
+    const __m128 min = _mm_set1_ps(-1.0f);
+    const __m128 max = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), min), max));
+#elif defined(MIXER_NEON)
+    const float32x4_t min = vdupq_n_f32(-1.0f);
+    const float32x4_t max = vdupq_n_f32(1.0f);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(samples + i, vminq_f32(vmaxq_f32(vld1q_f32(samples + i), min), max));
+#endif
+    for (; i < count; i++)
+        samples[i] = std::clamp(samples[i], -1.0f, 1.0f);
+}
+
+// add the port to out, a port lacking samples is only mixed for what it has
+void mix_port(AudioOutPort &port, float *out, uint32_t frame_count) {
+    const float gain_left = port.gain_left.load(std::memory_order_relaxed);
+    const float gain_right = port.gain_right.load(std::memory_order_relaxed);
+    const size_t channels = port.channels;
+    SampleRing &ring = port.ring;
+    const size_t available = ring.size() / channels;
+
+    if (port.resample_step == 1 << 16) {
+        const size_t frames = std::min<size_t>(frame_count, available);
+        for (size_t done = 0; done < frames;) {
+            // the capacity is a power of two, a stereo frame is never split by the end of the ring
+            size_t count = (frames - done) * channels;
+            const int16_t *samples = ring.contiguous(done * channels, count);
+            const size_t chunk = count / channels;
+            if (channels == 2)
+                mix_stereo(out + 2 * done, samples, chunk, gain_left, gain_right);
+            else
+                mix_mono(out + 2 * done, samples, chunk, gain_left, gain_right);
+            done += chunk;
+        }
+        ring.pop(frames * channels);
+        return;
+    }
+
+    // linear interpolation between the two port frames around each mixed frame
+    uint32_t phase = port.resample_phase;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const size_t index = phase >> 16;
+        if (index + 1 >= available)
+            break;
+
+        const float fraction = static_cast<float>(phase & 0xFFFF) / 65536.0f;
+        const auto sample = [&](size_t channel) {
+            const float first = ring.at(index * channels + channel);
+            const float second = ring.at((index + 1) * channels + channel);
+            return first + (second - first) * fraction;
+        };
+        const float left = sample(0);
+        const float right = (channels == 2) ? sample(1) : left;
+        out[2 * i] += left * gain_left;
+        out[2 * i + 1] += right * gain_right;
+        phase += port.resample_step;
+    }
+
+    const size_t consumed = phase >> 16;
+    ring.pop(consumed * channels);
+    port.resample_phase = phase & 0xFFFF;
+}
+
+} // namespace
+
+void AudioMixer::publish_ports(std::unique_ptr<const PortList> next) {
+    current_ports.store(next.get(), std::memory_order_release);
+    // once no mix can still be reading the previous list, the ports missing from the new one are not used anymore
+    rcu::synchronize();
+    ports = std::move(next);
+}
+
+void AudioMixer::add_port(AudioOutPort &port) {
+    const std::lock_guard<std::mutex> lock(ports_mutex);
+    auto next = std::make_unique<PortList>(*ports);
+    next->push_back(&port);
+    publish_ports(std::move(next));
+}
+
+void AudioMixer::remove_port(AudioOutPort &port) {
+    const std::lock_guard<std::mutex> lock(ports_mutex);
+    auto next = std::make_unique<PortList>(*ports);
+    std::erase(*next, &port);
+    publish_ports(std::move(next));
+}
+
+void AudioMixer::output(AudioOutPort &port, const void *buffer) {
+    const size_t frames = port.len;
+    const size_t channels = port.channels;
+    const size_t capacity_frames = port.ring.capacity() / channels;
+
+    while (!port.stopping.load(std::memory_order_relaxed) && !paused.load(std::memory_order_relaxed)) {
+        const uint32_t sequence = port.wake_sequence.load(std::memory_order_acquire);
+
+        // keep one buffer ahead of what the device pulls at once, converted to port frames
+        const uint32_t period = std::min(device_period.load(std::memory_order_relaxed), MAX_DEVICE_PERIOD);
+        const size_t period_frames = ((static_cast<uint64_t>(period) * port.resample_step) >> 16) + 1;
+        const size_t limit = std::min(frames + std::max(frames, 2 * period_frames), capacity_frames);
+        if (port.ring.size() / channels + frames <= limit)
+            break;
+
+        port.wake_sequence.wait(sequence, std::memory_order_acquire);
+    }
+
+    if (port.stopping)
+        return;
+
+    // can only fail while paused, the buffer is then dropped
+    port.ring.push(static_cast<const int16_t *>(buffer), frames * channels);
+}
+
+int AudioMixer::get_rest_sample(const AudioOutPort &port) const {
+    return static_cast<int>(port.ring.size() / port.channels);
+}
+
+void AudioMixer::set_volume(AudioOutPort &port, float volume) {
+    float left = volume;
+    float right = volume;
+    const int sum = port.left_channel_volume + port.right_channel_volume;
+    if (sum > 0) {
+        left = volume * 2.0f * port.left_channel_volume / sum;
+        right = volume * 2.0f * port.right_channel_volume / sum;
+    }
+
+    port.gain_left.store(left / 32768.0f, std::memory_order_relaxed);
+    port.gain_right.store(right / 32768.0f, std::memory_order_relaxed);
+}
+
+void AudioMixer::wake_all_ports() {
+    const rcu::ReadGuard guard;
+    for (AudioOutPort *port : *current_ports.load(std::memory_order_acquire)) {
+        port->wake_sequence.fetch_add(1, std::memory_order_release);
+        port->wake_sequence.notify_all();
+    }
+}
+
+void AudioMixer::set_paused(bool pause) {
+    paused = pause;
+    if (pause)
+        wake_all_ports();
+}
+
+void AudioMixer::mix(float *out, uint32_t frame_count) {
+    std::fill_n(out, static_cast<size_t>(frame_count) * MIXER_CHANNELS, 0.0f);
+    if (frame_count > device_period.load(std::memory_order_relaxed))
+        device_period.store(frame_count, std::memory_order_relaxed);
+
+    {
+        const rcu::ReadGuard guard;
+        for (AudioOutPort *port : *current_ports.load(std::memory_order_acquire)) {
+            mix_port(*port, out, frame_count);
+            port->wake_sequence.fetch_add(1, std::memory_order_release);
+            port->wake_sequence.notify_all();
+        }
+    }
+
+    clamp_samples(out, static_cast<size_t>(frame_count) * MIXER_CHANNELS);
+}
@@ -0,0 +1,67 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <audio/mixer.h>
+#include <audio/state.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+// Mixes state.range(0) ports of 256 frames into one device period, like a game playing that many voices
+static void run_mix(benchmark::State &state, int channels, int freq) {
+    constexpr int frame_count = 256;
+    AudioMixer mixer;
+    std::vector<std::unique_ptr<AudioOutPort>> ports;
+    for (int i = 0; i < state.range(0); i++)
+        ports.push_back(std::make_unique<AudioOutPort>(mixer, channels, freq, frame_count));
+
+    const std::vector<int16_t> samples(frame_count * channels, 1000);
+    std::vector<float> out(frame_count * MIXER_CHANNELS);
+    for (auto _ : state) {
+        state.PauseTiming();
+        // a resampled port consumes less than a buffer per mix, nothing would make room for more
+        for (auto &port : ports) {
+            if (mixer.get_rest_sample(*port) < frame_count)
+                mixer.output(*port, samples.data());
+        }
+        state.ResumeTiming();
+        mixer.mix(out.data(), frame_count);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * frame_count);
+}
+
+static void BM_MixStereo(benchmark::State &state) {
+    run_mix(state, 2, MIXER_SAMPLE_RATE);
+}
+
+static void BM_MixMono(benchmark::State &state) {
+    run_mix(state, 1, MIXER_SAMPLE_RATE);
+}
+
+static void BM_MixResampled(benchmark::State &state) {
+    run_mix(state, 2, 44100);
+}
+
+BENCHMARK(BM_MixStereo)->Arg(1)->Arg(8);
+BENCHMARK(BM_MixMono)->Arg(1)->Arg(8);
+BENCHMARK(BM_MixResampled)->Arg(1)->Arg(8);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,171 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <audio/mixer.h>
+#include <audio/state.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST(sample_ring, capacity_is_power_of_two) {
+    SampleRing ring(100);
+    ASSERT_EQ(ring.capacity(), 128);
+    ASSERT_EQ(ring.size(), 0);
+}
+
+TEST(sample_ring, push_pop_wraps_around) {
+    SampleRing ring(8);
+    std::vector<int16_t> samples(6);
+    std::iota(samples.begin(), samples.end(), 1);
+
+    ASSERT_TRUE(ring.push(samples.data(), 6));
+    ASSERT_FALSE(ring.push(samples.data(), 6));
+    ring.pop(4);
+
+    // 2 samples left at the end of the ring, the next ones start at its beginning
+    ASSERT_TRUE(ring.push(samples.data(), 6));
+    ASSERT_EQ(ring.size(), 8);
+    ASSERT_EQ(ring.at(0), 5);
+    ASSERT_EQ(ring.at(1), 6);
+    for (int i = 0; i < 6; i++)
+        ASSERT_EQ(ring.at(2 + i), i + 1);
+
+    size_t count = 8;
+    const int16_t *first = ring.contiguous(0, count);
+    ASSERT_EQ(count, 4);
+    ASSERT_EQ(first[3], 2);
+    count = 4;
+    const int16_t *second = ring.contiguous(4, count);
+    ASSERT_EQ(count, 4);
+    ASSERT_EQ(second[0], 3);
+}
+
+TEST(audio_mixer, mixes_stereo_and_mono_ports) {
+    AudioMixer mixer;
+    AudioOutPort stereo(mixer, 2, MIXER_SAMPLE_RATE, 16);
+    AudioOutPort mono(mixer, 1, MIXER_SAMPLE_RATE, 16);
+    mixer.set_volume(mono, 0.5f);
+
+    std::vector<int16_t> stereo_samples(32);
+    for (int i = 0; i < 16; i++) {
+        stereo_samples[2 * i] = 8192;
+        stereo_samples[2 * i + 1] = -8192;
+    }
+    const std::vector<int16_t> mono_samples(16, 16384);
+    mixer.output(stereo, stereo_samples.data());
+    mixer.output(mono, mono_samples.data());
+    ASSERT_EQ(mixer.get_rest_sample(stereo), 16);
+
+    std::vector<float> out(2 * 16);
+    mixer.mix(out.data(), 16);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_FLOAT_EQ(out[2 * i], 0.25f + 0.25f);
+        ASSERT_FLOAT_EQ(out[2 * i + 1], -0.25f + 0.25f);
+    }
+    ASSERT_EQ(mixer.get_rest_sample(stereo), 0);
+    ASSERT_EQ(mixer.get_rest_sample(mono), 0);
+}
+
+TEST(audio_mixer, channel_volumes_balance_the_gains) {
+    AudioMixer mixer;
+    AudioOutPort port(mixer, 2, MIXER_SAMPLE_RATE, 8);
+    port.left_channel_volume = SCE_AUDIO_VOLUME_0DB;
+    port.right_channel_volume = 0;
+    mixer.set_volume(port, 0.5f);
+
+    const std::vector<int16_t> samples(16, 16384);
+    mixer.output(port, samples.data());
+    std::vector<float> out(2 * 8);
+    mixer.mix(out.data(), 8);
+    ASSERT_FLOAT_EQ(out[0], 0.5f);
+    ASSERT_FLOAT_EQ(out[1], 0.0f);
+}
+
+TEST(audio_mixer, clamps_the_sum) {
+    AudioMixer mixer;
+    AudioOutPort first(mixer, 1, MIXER_SAMPLE_RATE, 8);
+    AudioOutPort second(mixer, 1, MIXER_SAMPLE_RATE, 8);
+
+    const std::vector<int16_t> samples(8, 32767);
+    mixer.output(first, samples.data());
+    mixer.output(second, samples.data());
+    std::vector<float> out(2 * 8);
+    mixer.mix(out.data(), 8);
+    for (float sample : out)
+        ASSERT_FLOAT_EQ(sample, 1.0f);
+}
+
+TEST(audio_mixer, resamples_lower_rates) {
+    AudioMixer mixer;
+    AudioOutPort port(mixer, 1, MIXER_SAMPLE_RATE / 2, 64);
+
+    // a ramp stays a ramp with half its slope after linear interpolation
+    std::vector<int16_t> samples(64);
+    for (int i = 0; i < 64; i++)
+        samples[i] = static_cast<int16_t>(i * 256);
+    mixer.output(port, samples.data());
+
+    std::vector<float> out(2 * 100);
+    mixer.mix(out.data(), 100);
+    for (int i = 0; i < 100; i++)
+        ASSERT_NEAR(out[2 * i] * 32768.0f, i * 128.0f, 0.5f);
+    ASSERT_EQ(mixer.get_rest_sample(port), 64 - 50);
+}
+
+TEST(audio_mixer, output_waits_for_the_mix) {
+    AudioMixer mixer;
+    AudioOutPort port(mixer, 2, MIXER_SAMPLE_RATE, 1024);
+    const std::vector<int16_t> samples(2 * 1024);
+
+    // the first buffers fit without waiting for the device
+    mixer.output(port, samples.data());
+    mixer.output(port, samples.data());
+
+    std::atomic<bool> done = false;
+    std::thread guest([&] {
+        mixer.output(port, samples.data());
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(done);
+
+    std::vector<float> out(2 * 1024);
+    mixer.mix(out.data(), 1024);
+    guest.join();
+    ASSERT_TRUE(done);
+    ASSERT_EQ(mixer.get_rest_sample(port), 2 * 1024);
+}
+
+TEST(audio_mixer, output_returns_when_stopping) {
+    AudioMixer mixer;
+    AudioOutPort port(mixer, 2, MIXER_SAMPLE_RATE, 1024);
+    const std::vector<int16_t> samples(2 * 1024);
+    mixer.output(port, samples.data());
+    mixer.output(port, samples.data());
+
+    std::thread guest([&] { mixer.output(port, samples.data()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    port.stopping = true;
+    mixer.wake_all_ports();
+    guest.join();
+    ASSERT_EQ(mixer.get_rest_sample(port), 2 * 1024);
+}
@@ -153,6 +153,7 @@ using PhysicalKeyCode = input::PhysicalKeyCode;
     code(int, "anisotropic-filtering", 1, anisotropic_filtering)                                        \
     code(bool, "texture-cache", true, texture_cache)                                                    \
     code(bool, "async-pipeline-compilation", true, async_pipeline_compilation)                          \
+    code(bool, "async-texture-decoding", true, async_texture_decoding)                                  \
     code(bool, "show-compile-shaders", true, show_compile_shaders)                                      \
     code(bool, "hashless-texture-cache", false, hashless_texture_cache)                                 \
     code(bool, "import-textures", false, import_textures)                                               \
@@ -164,6 +165,7 @@ using PhysicalKeyCode = input::PhysicalKeyCode;
     code(std::string, "audio-backend", "SDL", audio_backend)                                            \
     code(int, "audio-volume", 100, audio_volume)                                                        \
     code(bool, "ngs-enable", true, ngs_enable)                                                          \
+    code(int, "ngs-worker-threads", 2, ngs_worker_threads)                                              \
     code(int, "sys-button", static_cast<int>(SCE_SYSTEM_PARAM_ENTER_BUTTON_CROSS), sys_button)          \
     code(int, "sys-lang", static_cast<int>(SCE_SYSTEM_PARAM_LANG_ENGLISH_US), sys_lang)                 \
     code(int, "sys-date-format", (int)SCE_SYSTEM_PARAM_DATE_FORMAT_MMDDYYYY, sys_date_format)           \
@@ -175,6 +177,10 @@ using PhysicalKeyCode = input::PhysicalKeyCode;
     code(float, "background-alpha", .300f, background_alpha)                                            \
     code(int, "log-level", 0 /*SPDLOG_LEVEL_TRACE*/, log_level)                                         \
     code(bool, "cpu-opt", true, cpu_opt)                                                                \
+    code(bool, "fast-import-dispatch", false, fast_import_dispatch)                                     \
+    code(bool, "fast-lwmutex", false, fast_lwmutex)                                                     \
+    code(bool, "shared-jit-cache", false, shared_jit_cache)                                             \
+    code(bool, "persistent-jit-cache", false, persistent_jit_cache)                                     \
     code(std::string, "pref-path", std::string{}, vita_fs_path)                                         \
     code(bool, "discord-rich-presence", true, discord_rich_presence)                                    \
     code(bool, "wait-for-debugger", false, wait_for_debugger)                                           \
@@ -197,6 +203,8 @@ using PhysicalKeyCode = input::PhysicalKeyCode;
     code(bool, "shader-cache", true, shader_cache)                                                      \
     code(bool, "spirv-shader", false, spirv_shader)                                                     \
     code(bool, "fps-hack", false, fps_hack)                                                             \
+    code(int, "vblank-rate", 60, vblank_rate)                                                           \
+    code(bool, "vblank-unlocked", false, vblank_unlocked)                                               \
     code(uint64_t, "current-ime-lang", 4, current_ime_lang)                                             \
     code(int, "psn-signed-in", false, psn_signed_in)                                                    \
     code(bool, "http-enable", true, http_enable)                                                        \
@@ -31,9 +31,11 @@
 struct CPUState;
 struct CPUContext;
 struct CPUInterface;
+struct CPUPool;
 
 typedef std::unique_ptr<CPUState, std::function<void(CPUState *)>> CPUStatePtr;
 typedef std::unique_ptr<CPUInterface> CPUInterfacePtr;
+typedef std::shared_ptr<CPUPool> CPUPoolPtr;
 
 inline constexpr std::size_t MAX_CORE_COUNT = 150;
 
@@ -97,6 +99,28 @@ struct CPUContext {
     }
 };
 
+struct JitStats {
+    // Number of Dynarmic instances currently alive
+    std::size_t jit_count = 0;
+    // Host memory reserved for the generated code of the instances alive
+    uint64_t code_cache_size = 0;
+    // Number of blocks translated since startup
+    uint64_t translated_blocks = 0;
+    // Time spent translating the blocks of the jit cache ahead of time, and number of them.
+    // Blocks translated while running cannot be timed apart from their execution.
+    uint64_t pretranslation_ns = 0;
+    uint64_t pretranslated_blocks = 0;
+};
+
+// Location a block was translated from. Dynarmic also keys its blocks on the FPSCR mode bits.
+struct JitEntryPoint {
+    Address pc = 0;
+    uint32_t fpscr = 0;
+    bool thumb = false;
+
+    auto operator<=>(const JitEntryPoint &) const = default;
+};
+
 union DoubleReg {
     double d;
     float f[2];
@@ -23,10 +23,12 @@
 #include <cpu/common.h>
 
 #include <cstdint>
+#include <vector>
 
 struct MemState;
 
-CPUStatePtr init_cpu(bool cpu_opt, SceUID thread_id, std::size_t processor_id, MemState &mem);
+CPUPoolPtr init_cpu_pool(bool cpu_opt, std::size_t initial_size, MemState &mem);
+CPUStatePtr init_cpu(bool cpu_opt, SceUID thread_id, std::size_t processor_id, MemState &mem, const CPUPoolPtr &pool = nullptr);
 int run(CPUState &state);
 int step(CPUState &state);
 void stop(CPUState &state);
@@ -49,6 +51,12 @@ CPUContext save_context(CPUState &state);
 void load_context(CPUState &state, const CPUContext &ctx);
 std::size_t get_processor_id(CPUState &state);
 void invalidate_jit_cache(CPUState &state, Address start, size_t length);
+void invalidate_jit_cache(CPUPool &pool, Address start, size_t length);
+JitStats get_jit_stats();
+// Translate the blocks at the given entry points without running them
+void pretranslate(CPUState &state, const std::vector<JitEntryPoint> &entries);
+// Stops a pretranslation waiting for a jit of the pool held by a thread, the pool cannot pretranslate anymore
+void cancel_pretranslation(CPUPool &pool);
 
 uint32_t read_fpscr(CPUState &state);
 void write_fpscr(CPUState &state, uint32_t value);
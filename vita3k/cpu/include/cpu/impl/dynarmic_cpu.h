@@ -22,19 +22,78 @@
 #include <cpu/functions.h>
 #include <cpu/impl/interface.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class ArmDynarmicCallback;
 class ArmDynarmicCP15;
 
+// A Dynarmic instance with everything its generated code refers to
+struct DynarmicJit {
+    std::unique_ptr<ArmDynarmicCallback> cb;
+    std::shared_ptr<ArmDynarmicCP15> cp15;
+    std::unique_ptr<Dynarmic::A32::Jit> jit;
+
+    std::size_t processor_id = 0;
+    // Host memory reserved for the generated code
+    std::size_t code_cache_size = 0;
+    bool log_code = false;
+    bool log_mem = false;
+
+    DynarmicJit(MemState &mem, bool cpu_opt, std::size_t processor_id, bool log_code, bool log_mem);
+    ~DynarmicJit();
+};
+
+// Dynarmic instances (and their translation caches) shared by all the guest threads.
+// A thread only holds one of them while it is running.
+struct CPUPool {
+    MemState &mem;
+    bool cpu_opt;
+
+    std::mutex mutex;
+    std::condition_variable jit_released;
+    std::vector<std::unique_ptr<DynarmicJit>> jits;
+    std::vector<DynarmicJit *> free_jits;
+    bool pretranslation_canceled = false;
+
+    CPUPool(MemState &mem, bool cpu_opt, std::size_t initial_size);
+
+    // Takes a free jit, a new one is created if there is none
+    DynarmicJit *acquire(bool log_code, bool log_mem);
+    // Wait for the index-th jit to be free and take it, returns null if there is no such jit
+    // or if cancel_pretranslation was called
+    DynarmicJit *acquire_at(std::size_t index);
+    // Makes the pending and future acquire_at calls return null
+    void cancel_pretranslation();
+    void release(DynarmicJit *jit);
+    void invalidate_jit_cache(Address start, size_t length);
+};
+
 class DynarmicCPU : public CPUInterface {
     friend class ArmDynarmicCallback;
 
     CPUState *parent;
 
-    std::unique_ptr<Dynarmic::A32::Jit> jit;
-    std::unique_ptr<ArmDynarmicCallback> cb;
-    std::shared_ptr<ArmDynarmicCP15> cp15;
+    // Set if the jit is taken from a pool when running, otherwise this cpu owns its jit
+    CPUPoolPtr pool;
+    std::unique_ptr<DynarmicJit> own_jit;
+    // Jit this cpu is attached to, null when it is detached from the pool
+    DynarmicJit *current = nullptr;
+    Dynarmic::A32::Jit *jit = nullptr;
+
+    // stop() can be called from another thread while this cpu attaches or detaches,
+    // halt_mutex makes sure it never halts a jit after it went back to the pool
+    std::mutex halt_mutex;
+    Dynarmic::A32::Jit *running_jit = nullptr;
+    // Set by stop() until the run it was meant for returns
+    bool halt_requested = false;
+
+    // Thread context while detached from the pool
+    CPUContext context;
+    uint32_t tpidruro = 0;
 
     std::size_t core_id = 0;
 
@@ -45,10 +104,13 @@ class DynarmicCPU : public CPUInterface {
     bool log_code = false;
     bool cpu_opt;
 
-    std::unique_ptr<Dynarmic::A32::Jit> make_jit();
+    void make_own_jit();
+    void attach();
+    void detach();
+    void translate(const std::vector<JitEntryPoint> &entries);
 
 public:
-    DynarmicCPU(CPUState *state, std::size_t processor_id, bool cpu_opt);
+    DynarmicCPU(CPUState *state, std::size_t processor_id, bool cpu_opt, const CPUPoolPtr &pool);
     ~DynarmicCPU() override;
     int run() override;
     void stop() override;
@@ -93,6 +155,7 @@ public:
     void clear_exclusive() override;
     std::size_t processor_id() const override;
     void invalidate_jit_cache(Address start, size_t length) override;
+    void pretranslate(const std::vector<JitEntryPoint> &entries) override;
 
     static Dynarmic::ExclusiveMonitor shared_monitor;
 };
@@ -20,6 +20,7 @@
 #include <cpu/common.h>
 
 #include <cstdint>
+#include <vector>
 
 /*! \brief Base class for all CPU backend implementation */
 struct CPUInterface {
@@ -55,6 +56,7 @@ struct CPUInterface {
     virtual CPUContext save_context() = 0;
     virtual void load_context(const CPUContext &ctx) = 0;
     virtual void invalidate_jit_cache(Address start, size_t length) = 0;
+    virtual void pretranslate(const std::vector<JitEntryPoint> &entries) = 0;
 
     virtual bool is_thumb_mode() = 0;
     virtual int step() = 0;
@@ -23,6 +23,7 @@
 #include <util/types.h>
 
 #include <atomic>
+#include <functional>
 
 struct CPUState {
     CPUState() = default;
@@ -35,6 +36,13 @@ struct CPUState {
     bool svc_called;
     uint32_t svc;
 
+    // Optional handler called from inside the JIT when a SVC is executed.
+    // Returns true if the call was handled and the JIT does not need to halt for it.
+    std::function<bool(CPUState &)> svc_handler;
+
+    // Optional hook called by the JIT every time it translates a new block for this cpu
+    std::function<void(CPUState &, const JitEntryPoint &)> translation_hook;
+
     // Exception handler support (kubridge abort handlers)
     // These are set by the page fault callback (signal-safe atomics)
     // and consumed by run_loop after HaltExecution returns.
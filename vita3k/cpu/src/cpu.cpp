@@ -38,7 +38,11 @@ SceUID get_thread_id(CPUState &state) {
     return state.thread_id;
 }
 
-CPUStatePtr init_cpu(bool cpu_opt, SceUID thread_id, std::size_t processor_id, MemState &mem) {
+CPUPoolPtr init_cpu_pool(bool cpu_opt, std::size_t initial_size, MemState &mem) {
+    return std::make_shared<CPUPool>(mem, cpu_opt, initial_size);
+}
+
+CPUStatePtr init_cpu(bool cpu_opt, SceUID thread_id, std::size_t processor_id, MemState &mem, const CPUPoolPtr &pool) {
     CPUStatePtr state(new CPUState(), delete_cpu_state);
     state->mem = &mem;
     state->thread_id = thread_id;
@@ -47,7 +51,7 @@ CPUStatePtr init_cpu(bool cpu_opt, SceUID thread_id, std::size_t processor_id, M
         return CPUStatePtr();
     }
 
-    state->cpu = std::make_unique<DynarmicCPU>(state.get(), processor_id, cpu_opt);
+    state->cpu = std::make_unique<DynarmicCPU>(state.get(), processor_id, cpu_opt, pool);
 
     return state;
 }
@@ -168,6 +172,18 @@ void invalidate_jit_cache(CPUState &state, Address start, size_t length) {
     state.cpu->invalidate_jit_cache(start, length);
 }
 
+void invalidate_jit_cache(CPUPool &pool, Address start, size_t length) {
+    pool.invalidate_jit_cache(start, length);
+}
+
+void pretranslate(CPUState &state, const std::vector<JitEntryPoint> &entries) {
+    state.cpu->pretranslate(entries);
+}
+
+void cancel_pretranslation(CPUPool &pool) {
+    pool.cancel_pretranslation();
+}
+
 std::string disassemble(CPUState &state, uint64_t at, bool thumb, uint16_t *insn_size) {
     MemState &mem = *state.mem;
     const uint8_t *const code = Ptr<const uint8_t>(static_cast<Address>(at)).get(mem);
@@ -26,7 +26,9 @@
 #include <dynarmic/interface/A32/coprocessor.h>
 #include <dynarmic/interface/exclusive_monitor.h>
 
+#include <algorithm>
 #include <bit>
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <string>
@@ -122,19 +124,28 @@ public:
     }
 };
 
+static std::atomic<std::size_t> jit_count = 0;
+static std::atomic<uint64_t> total_code_cache_size = 0;
+static std::atomic<uint64_t> translated_blocks = 0;
+static std::atomic<uint64_t> pretranslation_ns = 0;
+static std::atomic<uint64_t> pretranslated_blocks = 0;
+
 class ArmDynarmicCallback : public Dynarmic::A32::UserCallbacks {
     friend class DynarmicCPU;
 
-    CPUState *parent;
-    DynarmicCPU *cpu;
+    CPUState *parent = nullptr;
+    DynarmicCPU *cpu = nullptr;
 
 public:
-    explicit ArmDynarmicCallback(CPUState &parent, DynarmicCPU &cpu)
-        : parent(&parent)
-        , cpu(&cpu) {}
-
+    ArmDynarmicCallback() = default;
     ~ArmDynarmicCallback() override = default;
 
+    // Pooled jits are attached to the cpu of the thread running them
+    void attach(CPUState &parent, DynarmicCPU &cpu) {
+        this->parent = &parent;
+        this->cpu = &cpu;
+    }
+
     std::optional<std::uint32_t> MemoryReadCode(Dynarmic::A32::VAddr addr) override {
         if (cpu->log_mem)
             LOG_TRACE("Instruction fetch at address 0x{:X}", addr);
@@ -154,6 +165,9 @@ public:
     }
 
     void PreCodeTranslationHook(bool is_thumb, Dynarmic::A32::VAddr pc, Dynarmic::A32::IREmitter &ir) override {
+        translated_blocks.fetch_add(1, std::memory_order_relaxed);
+        if (parent->translation_hook)
+            parent->translation_hook(*parent, { pc, cpu->get_fpscr(), is_thumb });
         if (cpu->log_code) {
             ir.CallHostFunction(&TraceInstruction, ir.Imm64((uint64_t)this), ir.Imm64(pc), ir.Imm64(is_thumb));
         }
@@ -318,8 +332,11 @@ public:
     }
 
     void CallSVC(uint32_t svc) override {
-        parent->svc_called = true;
         parent->svc = svc;
+        if (parent->svc_handler && parent->svc_handler(*parent))
+            return;
+
+        parent->svc_called = true;
         cpu->jit->HaltExecution(Dynarmic::HaltReason::UserDefined8);
     }
 
@@ -332,52 +349,198 @@ public:
 
 Dynarmic::ExclusiveMonitor DynarmicCPU::shared_monitor(MAX_CORE_COUNT);
 
-std::unique_ptr<Dynarmic::A32::Jit> DynarmicCPU::make_jit() {
+DynarmicJit::DynarmicJit(MemState &mem, bool cpu_opt, std::size_t processor_id, bool log_code, bool log_mem)
+    : cb(std::make_unique<ArmDynarmicCallback>())
+    , cp15(std::make_shared<ArmDynarmicCP15>())
+    , processor_id(processor_id)
+    , log_code(log_code)
+    , log_mem(log_mem) {
     Dynarmic::A32::UserConfig config{};
     config.arch_version = Dynarmic::A32::ArchVersion::v7;
     config.callbacks = cb.get();
-    if (parent->mem->use_page_table) {
-        config.page_table = (log_mem || !cpu_opt) ? nullptr : reinterpret_cast<decltype(config.page_table)>(parent->mem->page_table.get());
+    if (mem.use_page_table) {
+        config.page_table = (log_mem || !cpu_opt) ? nullptr : reinterpret_cast<decltype(config.page_table)>(mem.page_table.get());
         config.absolute_offset_page_table = true;
     } else if (!log_mem && cpu_opt) {
-        config.fastmem_pointer = std::bit_cast<uintptr_t>(parent->mem->memory.get());
+        config.fastmem_pointer = std::bit_cast<uintptr_t>(mem.memory.get());
     }
     config.hook_hint_instructions = true;
-    config.global_monitor = &shared_monitor;
+    config.global_monitor = &DynarmicCPU::shared_monitor;
     config.coprocessors[15] = cp15;
-    config.processor_id = core_id;
+    config.processor_id = processor_id;
     config.optimizations = cpu_opt ? Dynarmic::all_safe_optimizations : Dynarmic::no_optimizations;
     config.enable_cycle_counting = false;
 
-    return std::make_unique<Dynarmic::A32::Jit>(config);
+    jit = std::make_unique<Dynarmic::A32::Jit>(config);
+    code_cache_size = config.code_cache_size;
+    jit_count++;
+    total_code_cache_size += code_cache_size;
+}
+
+DynarmicJit::~DynarmicJit() {
+    jit_count--;
+    total_code_cache_size -= code_cache_size;
+}
+
+CPUPool::CPUPool(MemState &mem, bool cpu_opt, std::size_t initial_size)
+    : mem(mem)
+    , cpu_opt(cpu_opt) {
+    initial_size = std::min(initial_size, MAX_CORE_COUNT);
+    for (std::size_t i = 0; i < initial_size; i++) {
+        jits.push_back(std::make_unique<DynarmicJit>(mem, cpu_opt, i, false, false));
+        free_jits.push_back(jits.back().get());
+    }
+}
+
+DynarmicJit *CPUPool::acquire(bool log_code, bool log_mem) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    // take the most recently released jit first, it is the most likely to have the code we need
+    for (auto it = free_jits.rbegin(); it != free_jits.rend(); ++it) {
+        DynarmicJit *jit = *it;
+        if (jit->log_code == log_code && jit->log_mem == log_mem) {
+            free_jits.erase(std::next(it).base());
+            return jit;
+        }
+    }
+
+    // Threads blocked in an import called from the jit keep theirs, waiting for one to be released
+    // could wait forever. The exclusive monitor is limited to MAX_CORE_COUNT processors, past that
+    // jits share a processor id: a reservation of one can be cleared by the other, which only makes
+    // a store exclusive fail and be retried.
+    if (jits.size() == MAX_CORE_COUNT)
+        LOG_WARN("All the {} pooled jits are in use, jits now share exclusive monitor slots", MAX_CORE_COUNT);
+    jits.push_back(std::make_unique<DynarmicJit>(mem, cpu_opt, jits.size() % MAX_CORE_COUNT, log_code, log_mem));
+    return jits.back().get();
+}
+
+DynarmicJit *CPUPool::acquire_at(std::size_t index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (index >= jits.size())
+        return nullptr;
+
+    DynarmicJit *jit = jits[index].get();
+    auto it = free_jits.end();
+    jit_released.wait(lock, [&] {
+        it = std::find(free_jits.begin(), free_jits.end(), jit);
+        return pretranslation_canceled || it != free_jits.end();
+    });
+    if (pretranslation_canceled)
+        return nullptr;
+
+    free_jits.erase(it);
+    return jit;
+}
+
+void CPUPool::cancel_pretranslation() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        pretranslation_canceled = true;
+    }
+    jit_released.notify_all();
+}
+
+void CPUPool::release(DynarmicJit *jit) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        free_jits.push_back(jit);
+    }
+    // acquire_at() waits for one jit in particular
+    jit_released.notify_all();
+}
+
+void CPUPool::invalidate_jit_cache(Address start, size_t length) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &jit : jits)
+        jit->jit->InvalidateCacheRange(start, length);
 }
 
-DynarmicCPU::DynarmicCPU(CPUState *state, std::size_t processor_id, bool cpu_opt)
+JitStats get_jit_stats() {
+    return { jit_count.load(), total_code_cache_size.load(), translated_blocks.load(), pretranslation_ns.load(), pretranslated_blocks.load() };
+}
+
+void DynarmicCPU::make_own_jit() {
+    own_jit = std::make_unique<DynarmicJit>(*parent->mem, cpu_opt, core_id, log_code, log_mem);
+    own_jit->cb->attach(*parent, *this);
+    current = own_jit.get();
+    jit = own_jit->jit.get();
+    running_jit = jit;
+}
+
+DynarmicCPU::DynarmicCPU(CPUState *state, std::size_t processor_id, bool cpu_opt, const CPUPoolPtr &pool)
     : parent(state)
-    , cb(std::make_unique<ArmDynarmicCallback>(*state, *this))
-    , cp15(std::make_shared<ArmDynarmicCP15>())
+    , pool(pool)
     , core_id(processor_id)
     , cpu_opt(cpu_opt) {
-    jit = make_jit();
+    if (!pool)
+        make_own_jit();
 }
 
 DynarmicCPU::~DynarmicCPU() = default;
 
+void DynarmicCPU::attach() {
+    current = pool->acquire(log_code, log_mem);
+    current->cb->attach(*parent, *this);
+    current->cp15->set_tpidruro(tpidruro);
+    jit = current->jit.get();
+    load_context(context);
+
+    const std::lock_guard<std::mutex> lock(halt_mutex);
+    running_jit = jit;
+    // stop() was called before we had a jit
+    if (halt_requested)
+        jit->HaltExecution();
+}
+
+void DynarmicCPU::detach() {
+    {
+        const std::lock_guard<std::mutex> lock(halt_mutex);
+        running_jit = nullptr;
+        // the run the halt was meant for is over, a halt which arrived after Run() returned
+        // must not stop the next thread using this jit
+        if (halt_requested) {
+            jit->ClearHalt();
+            halt_requested = false;
+        }
+    }
+
+    context = save_context();
+    tpidruro = current->cp15->get_tpidruro();
+    jit = nullptr;
+
+    // the next thread using this jit must not see our exclusive reservation
+    shared_monitor.ClearProcessor(current->processor_id);
+    pool->release(current);
+    current = nullptr;
+}
+
 int DynarmicCPU::run() {
     halted = false;
     break_ = false;
     parent->svc_called = false;
+    if (pool)
+        attach();
+
     Dynarmic::HaltReason halt_reason;
     do {
         halt_reason = jit->Run();
     } while ((halt_reason == Dynarmic::HaltReason::Step) || (halt_reason == Dynarmic::HaltReason::CacheInvalidation));
 
+    if (pool)
+        detach();
+
     return halted;
 }
 
 int DynarmicCPU::step() {
     parent->svc_called = false;
+    if (pool)
+        attach();
+
     jit->Step();
+
+    if (pool)
+        detach();
+
     return 0;
 }
 
@@ -395,7 +558,14 @@ void DynarmicCPU::set_log_code(bool log) {
         return;
 
     log_code = log;
-    jit = make_jit();
+    // a pooled cpu picks a jit with the right settings the next time it runs
+    if (!pool) {
+        const CPUContext ctx = save_context();
+        const uint32_t tpidruro = get_tpidruro();
+        make_own_jit();
+        load_context(ctx);
+        set_tpidruro(tpidruro);
+    }
 }
 
 void DynarmicCPU::set_log_mem(bool log) {
@@ -403,7 +573,13 @@ void DynarmicCPU::set_log_mem(bool log) {
         return;
 
     log_mem = log;
-    jit = make_jit();
+    if (!pool) {
+        const CPUContext ctx = save_context();
+        const uint32_t tpidruro = get_tpidruro();
+        make_own_jit();
+        load_context(ctx);
+        set_tpidruro(tpidruro);
+    }
 }
 
 bool DynarmicCPU::get_log_code() {
@@ -415,35 +591,58 @@ bool DynarmicCPU::get_log_mem() {
 }
 
 void DynarmicCPU::stop() {
-    jit->HaltExecution();
+    if (!pool) {
+        jit->HaltExecution();
+        return;
+    }
+
+    // if the cpu is not attached yet, the halt is done when it attaches.
+    // The page fault handler stops the cpu of the faulting thread, which is running guest code and so never holds the lock.
+    const std::lock_guard<std::mutex> lock(halt_mutex);
+    halt_requested = true;
+    if (running_jit)
+        running_jit->HaltExecution();
 }
 
 uint32_t DynarmicCPU::get_reg(uint8_t idx) {
+    if (!jit)
+        return context.cpu_registers[idx];
     return jit->Regs()[idx];
 }
 
 uint32_t DynarmicCPU::get_sp() {
-    return jit->Regs()[13];
+    return get_reg(13);
 }
 
 uint32_t DynarmicCPU::get_pc() {
-    return jit->Regs()[15];
+    return get_reg(15);
 }
 
 void DynarmicCPU::set_reg(uint8_t idx, uint32_t val) {
-    jit->Regs()[idx] = val;
+    if (!jit)
+        context.cpu_registers[idx] = val;
+    else
+        jit->Regs()[idx] = val;
 }
 
 void DynarmicCPU::set_cpsr(uint32_t val) {
-    jit->SetCpsr(val);
+    if (!jit)
+        context.cpsr = val;
+    else
+        jit->SetCpsr(val);
 }
 
 uint32_t DynarmicCPU::get_tpidruro() {
-    return cp15->get_tpidruro();
+    if (!current)
+        return tpidruro;
+    return current->cp15->get_tpidruro();
 }
 
 void DynarmicCPU::set_tpidruro(uint32_t val) {
-    cp15->set_tpidruro(val);
+    if (!current)
+        tpidruro = val;
+    else
+        current->cp15->set_tpidruro(val);
 }
 
 void DynarmicCPU::set_pc(uint32_t val) {
@@ -454,30 +653,40 @@ void DynarmicCPU::set_pc(uint32_t val) {
         set_cpsr(get_cpsr() & 0xFFFFFFDF);
         val = val & 0xFFFFFFFC;
     }
-    jit->Regs()[15] = val;
+    set_reg(15, val);
 }
 
 void DynarmicCPU::set_lr(uint32_t val) {
-    jit->Regs()[14] = val;
+    set_reg(14, val);
 }
 
 void DynarmicCPU::set_sp(uint32_t val) {
-    jit->Regs()[13] = val;
+    set_reg(13, val);
 }
 
 uint32_t DynarmicCPU::get_cpsr() {
+    if (!jit)
+        return context.cpsr;
     return jit->Cpsr();
 }
 
 uint32_t DynarmicCPU::get_fpscr() {
+    if (!jit)
+        return context.fpscr;
     return jit->Fpscr();
 }
 
 void DynarmicCPU::set_fpscr(uint32_t val) {
-    jit->SetFpscr(val);
+    if (!jit)
+        context.fpscr = val;
+    else
+        jit->SetFpscr(val);
 }
 
 CPUContext DynarmicCPU::save_context() {
+    if (!jit)
+        return context;
+
     CPUContext ctx;
     ctx.cpu_registers = jit->Regs();
     static_assert(sizeof(ctx.fpu_registers) == sizeof(jit->ExtRegs()));
@@ -489,6 +698,11 @@ CPUContext DynarmicCPU::save_context() {
 }
 
 void DynarmicCPU::load_context(const CPUContext &ctx) {
+    if (!jit) {
+        context = ctx;
+        return;
+    }
+
     jit->Regs() = ctx.cpu_registers;
     static_assert(sizeof(ctx.fpu_registers) == sizeof(jit->ExtRegs()));
     memcpy(jit->ExtRegs().data(), ctx.fpu_registers.data(), sizeof(ctx.fpu_registers));
@@ -497,19 +711,24 @@ void DynarmicCPU::load_context(const CPUContext &ctx) {
 }
 
 uint32_t DynarmicCPU::get_lr() {
-    return jit->Regs()[14];
+    return get_reg(14);
 }
 
 float DynarmicCPU::get_float_reg(uint8_t idx) {
+    if (!jit)
+        return context.fpu_registers[idx];
     return std::bit_cast<float>(jit->ExtRegs()[idx]);
 }
 
 void DynarmicCPU::set_float_reg(uint8_t idx, float val) {
-    jit->ExtRegs()[idx] = std::bit_cast<uint32_t>(val);
+    if (!jit)
+        context.fpu_registers[idx] = val;
+    else
+        jit->ExtRegs()[idx] = std::bit_cast<uint32_t>(val);
 }
 
 bool DynarmicCPU::is_thumb_mode() {
-    return jit->Cpsr() & 0x20;
+    return get_cpsr() & 0x20;
 }
 
 std::size_t DynarmicCPU::processor_id() const {
@@ -517,9 +736,57 @@ std::size_t DynarmicCPU::processor_id() const {
 }
 
 void DynarmicCPU::invalidate_jit_cache(Address start, size_t length) {
-    jit->InvalidateCacheRange(start, length);
+    if (pool)
+        pool->invalidate_jit_cache(start, length);
+    else
+        jit->InvalidateCacheRange(start, length);
+}
+
+void DynarmicCPU::translate(const std::vector<JitEntryPoint> &entries) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t blocks_before = translated_blocks.load(std::memory_order_relaxed);
+    for (const auto &entry : entries) {
+        if (!Ptr<uint32_t>(entry.pc).valid(*parent->mem))
+            continue;
+
+        jit->Regs()[15] = entry.pc;
+        jit->SetCpsr(entry.thumb ? 0x20 : 0);
+        jit->SetFpscr(entry.fpscr);
+        // Run() looks the block up (translating it if needed) before checking for a pending halt,
+        // so this translates the block at pc without executing any of it
+        jit->HaltExecution();
+        jit->Run();
+    }
+
+    // other threads can translate at the same time, the count is only an estimate
+    pretranslated_blocks += translated_blocks.load(std::memory_order_relaxed) - blocks_before;
+    pretranslation_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DynarmicCPU::pretranslate(const std::vector<JitEntryPoint> &entries) {
+    if (!pool) {
+        const CPUContext ctx = save_context();
+        translate(entries);
+        load_context(ctx);
+        return;
+    }
+
+    for (std::size_t i = 0;; i++) {
+        current = pool->acquire_at(i);
+        if (!current)
+            break;
+
+        current->cb->attach(*parent, *this);
+        jit = current->jit.get();
+        translate(entries);
+        jit = nullptr;
+        pool->release(current);
+        current = nullptr;
+    }
 }
 
 void DynarmicCPU::clear_exclusive() {
-    shared_monitor.ClearProcessor(core_id);
+    // a detached cpu had its reservation cleared when it released its jit
+    if (current)
+        shared_monitor.ClearProcessor(current->processor_id);
 }
@@ -0,0 +1,102 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// Intervals between the ticks of a FramePacer since the stats were last taken
+struct FrameTimeStats {
+    uint32_t frame_count = 0;
+    double mean_ms = 0;
+    double variance_ms2 = 0;
+    double max_ms = 0;
+    // periods skipped because the ticks were too late to catch up
+    uint32_t dropped = 0;
+};
+
+/**
+ * @brief Ticks at a fixed rate against absolute deadlines
+ *
+ * The deadline of tick n is origin + n * period, so sleeping late never delays the following ticks.
+ * Each wait sleeps until shortly before the deadline then spins for the rest, the time left for the spin
+ * follows how late the host wakes the thread up. A tick late by a few periods is caught up immediately,
+ * a longer stall moves the origin instead of bursting all the missed ticks.
+ * In unlocked mode, a tick also happens as soon as notify() is called.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Time source of the pacer, the steady clock by default. The tests replace it with a simulated one.
+    // The unlocked mode still waits for the notifications on the steady clock.
+    struct Timing {
+        std::function<Clock::time_point()> now;
+        // returns at time or later
+        std::function<void(Clock::time_point)> sleep_until;
+    };
+
+    FramePacer();
+    explicit FramePacer(Timing timing);
+
+    // rate is in Hz, the deadlines start again from now
+    void set_rate(double rate);
+    void set_unlocked(bool unlocked);
+    bool is_unlocked() const;
+
+    // Waits for the next tick, only called by the pacing thread
+    void wait_next();
+    // Makes the current wait of an unlocked pacer return now, can be called from any thread
+    void notify();
+
+    // Can be called from any thread, the stats start again from zero
+    FrameTimeStats take_stats();
+
+private:
+    Clock::time_point deadline(uint64_t tick) const;
+    void sleep_until(Clock::time_point time);
+    void restart(Clock::time_point now);
+    void record_tick(Clock::time_point now, uint32_t dropped);
+
+    Timing timing;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool notified = false;
+    std::atomic<bool> unlocked{ false };
+
+    // in nanoseconds, a double so the deadlines do not drift from the rounding of the period
+    double period_ns;
+    Clock::time_point origin;
+    uint64_t next_tick = 1;
+    // time left to spin after sleeping, and average delay of the host waking the thread up
+    Clock::duration spin_margin;
+    Clock::duration average_oversleep{};
+
+    Clock::time_point last_tick;
+    // sums of the intervals between ticks and of their squares, in ms
+    uint32_t stats_count = 0;
+    double stats_sum = 0;
+    double stats_sum_squares = 0;
+    double stats_max = 0;
+    uint32_t stats_dropped = 0;
+};
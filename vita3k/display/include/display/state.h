@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <display/pacer.h>
 #include <kernel/callback.h>
 #include <mem/ptr.h>
 #include <util/types.h>
@@ -72,9 +73,12 @@ struct DisplayState {
     std::atomic<bool> imgui_render{ true };
     std::atomic<bool> fullscreen{ false };
     std::atomic<std::uint64_t> vblank_count{ 0 };
+    // min-heap on target_vcount, the waiter to wake first is at the front
     std::vector<DisplayStateVBlankWaitInfo> vblank_wait_infos;
     std::atomic<uint64_t> last_setframe_vblank_count = 0;
     std::map<SceUID, CallbackPtr> vblank_callbacks{};
+    // paces the vblank thread, in unlocked mode a vblank also happens each time the renderer presents a frame
+    FramePacer vblank_pacer;
 
     // if set to true, make sceDisplayWaitVblankStartMulti/sceDisplayWaitSetFrameBufMulti behave as sceDisplayWaitVblankStart/sceDisplayWaitSetFrameBuf
     // this allows some game running at 30fps to run at 60fps without any issue
@@ -17,24 +17,28 @@
 
 #include <display/functions.h>
 
+#include <config/state.h>
 #include <dialog/state.h>
 #include <display/state.h>
 #include <emuenv/state.h>
 #include <kernel/state.h>
 #include <renderer/state.h>
 
-#include <chrono>
+#include <algorithm>
 #include <motion/functions.h>
 #include <touch/functions.h>
 
 // Code heavily influenced by PPSSSPP's SceDisplay.cpp
 
-static constexpr int TARGET_FPS = 60;
-static constexpr int64_t TARGET_MICRO_PER_FRAME = 1000000LL / TARGET_FPS;
 // how many cycles do we need to see before we start predicting the next frame
 static constexpr int predict_threshold = 3;
 static constexpr int max_expected_swapchain_size = 6;
 
+// comparison of the vblank_wait_infos heap, the lowest target_vcount is at the front
+static bool wakes_later(const DisplayStateVBlankWaitInfo &lhs, const DisplayStateVBlankWaitInfo &rhs) {
+    return lhs.target_vcount > rhs.target_vcount;
+}
+
 static void vblank_sync_thread(EmuEnvState &emuenv) {
     DisplayState &display = emuenv.display;
 
@@ -63,25 +67,22 @@ static void vblank_sync_thread(EmuEnvState &emuenv) {
             for (auto &[_, cb] : display.vblank_callbacks)
                 cb->event_notify(cb->get_notifier_id());
 
-            for (std::size_t i = 0; i < display.vblank_wait_infos.size();) {
-                auto &vblank_wait_info = display.vblank_wait_infos[i];
-                if (vblank_wait_info.target_vcount <= display.vblank_count) {
-                    ThreadStatePtr target_wait = vblank_wait_info.target_thread;
-
-                    target_wait->update_status(ThreadStatus::run);
-                    display.vblank_wait_infos.erase(display.vblank_wait_infos.begin() + i);
-                } else {
-                    i++;
-                }
+            auto &wait_infos = display.vblank_wait_infos;
+            while (!wait_infos.empty() && wait_infos.front().target_vcount <= display.vblank_count) {
+                std::pop_heap(wait_infos.begin(), wait_infos.end(), wakes_later);
+                wait_infos.back().target_thread->update_status(ThreadStatus::run);
+                wait_infos.pop_back();
             }
         }
-        const auto time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        const auto time_left = TARGET_MICRO_PER_FRAME - (time_ms % TARGET_MICRO_PER_FRAME);
-        std::this_thread::sleep_for(std::chrono::microseconds(time_left));
+
+        display.vblank_pacer.wait_next();
     }
 }
 
 void start_sync_thread(EmuEnvState &emuenv) {
+    // the first vblank is counted as soon as the thread starts, the next ones one period apart
+    emuenv.display.vblank_pacer.set_unlocked(emuenv.cfg.vblank_unlocked);
+    emuenv.display.vblank_pacer.set_rate(emuenv.cfg.vblank_rate);
     emuenv.display.vblank_thread = std::make_unique<std::thread>(vblank_sync_thread, std::ref(emuenv));
 }
 
@@ -101,6 +102,7 @@ void wait_vblank(DisplayState &display, KernelState &kernel, const ThreadStatePt
 
             wait_thread->update_status(ThreadStatus::wait);
             display.vblank_wait_infos.push_back({ wait_thread, target_vcount });
+            std::push_heap(display.vblank_wait_infos.begin(), display.vblank_wait_infos.end(), wakes_later);
         }
 
         wait_thread->status_cond.wait(thread_lock, [&]() {
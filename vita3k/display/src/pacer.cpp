@@ -0,0 +1,153 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <display/pacer.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+// a tick later than this many periods moves the origin instead of being caught up
+static constexpr uint64_t MAX_CATCH_UP_PERIODS = 4;
+static constexpr FramePacer::Clock::duration MIN_SPIN_MARGIN = 100us;
+static constexpr FramePacer::Clock::duration MAX_SPIN_MARGIN = 2ms;
+
+FramePacer::FramePacer()
+    : FramePacer(Timing{ Clock::now, [](Clock::time_point time) { std::this_thread::sleep_until(time); } }) {
+}
+
+FramePacer::FramePacer(Timing timing)
+    : timing(std::move(timing))
+    , spin_margin(1ms) {
+    set_rate(60.0);
+}
+
+void FramePacer::set_rate(double rate) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    period_ns = 1e9 / std::max(rate, 1.0);
+    restart(timing.now());
+}
+
+void FramePacer::set_unlocked(bool unlocked) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    this->unlocked = unlocked;
+}
+
+bool FramePacer::is_unlocked() const {
+    return unlocked;
+}
+
+FramePacer::Clock::time_point FramePacer::deadline(uint64_t tick) const {
+    return origin + std::chrono::nanoseconds(static_cast<int64_t>(tick * period_ns));
+}
+
+void FramePacer::restart(Clock::time_point now) {
+    origin = now;
+    next_tick = 1;
+    last_tick = now;
+}
+
+void FramePacer::sleep_until(Clock::time_point time) {
+    const auto wake_time = time - spin_margin;
+    if (timing.now() < wake_time) {
+        timing.sleep_until(wake_time);
+
+        // the margin follows twice the average delay of the wake up, the spin then rarely ends late
+        const auto oversleep = std::max(timing.now() - wake_time, Clock::duration::zero());
+        average_oversleep += (oversleep - average_oversleep) / 8;
+        spin_margin = std::clamp(2 * average_oversleep, Clock::duration(MIN_SPIN_MARGIN), Clock::duration(MAX_SPIN_MARGIN));
+    }
+
+    while (timing.now() < time)
+        std::this_thread::yield();
+}
+
+void FramePacer::wait_next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto next = deadline(next_tick);
+
+    if (unlocked) {
+        // the period is only the longest wait, the tick follows the notifications
+        if (cond.wait_until(lock, next, [&] { return notified; })) {
+            notified = false;
+            const auto now = timing.now();
+            record_tick(now, 0);
+            restart(now);
+            return;
+        }
+    } else {
+        lock.unlock();
+        sleep_until(next);
+        lock.lock();
+    }
+
+    const auto now = timing.now();
+    uint32_t dropped = 0;
+    if (now - next > std::chrono::nanoseconds(static_cast<int64_t>(MAX_CATCH_UP_PERIODS * period_ns))) {
+        // stalled, catching up would make the ticks burst
+        dropped = static_cast<uint32_t>((now - next) / std::chrono::nanoseconds(static_cast<int64_t>(period_ns)));
+        record_tick(now, dropped);
+        origin = now;
+        next_tick = 1;
+        return;
+    }
+
+    record_tick(now, 0);
+    next_tick++;
+}
+
+void FramePacer::notify() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (!unlocked)
+            return;
+        notified = true;
+    }
+    cond.notify_one();
+}
+
+void FramePacer::record_tick(Clock::time_point now, uint32_t dropped) {
+    const double interval = std::chrono::duration<double, std::milli>(now - last_tick).count();
+    last_tick = now;
+
+    stats_count++;
+    stats_sum += interval;
+    stats_sum_squares += interval * interval;
+    stats_max = std::max(stats_max, interval);
+    stats_dropped += dropped;
+}
+
+FrameTimeStats FramePacer::take_stats() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    FrameTimeStats stats;
+    stats.frame_count = stats_count;
+    stats.dropped = stats_dropped;
+    stats.max_ms = stats_max;
+    if (stats_count > 0) {
+        stats.mean_ms = stats_sum / stats_count;
+        stats.variance_ms2 = std::max(stats_sum_squares / stats_count - stats.mean_ms * stats.mean_ms, 0.0);
+    }
+
+    stats_count = 0;
+    stats_sum = 0;
+    stats_sum_squares = 0;
+    stats_max = 0;
+    stats_dropped = 0;
+    return stats;
+}
@@ -0,0 +1,146 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <display/pacer.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+using Clock = FramePacer::Clock;
+
+// Clock of the pacer in the tests, every read moves it forward by a microsecond like a real clock
+// would and a sleep jumps to the wake up time, late by oversleep
+struct SimulatedClock {
+    Clock::time_point time{};
+    Clock::duration oversleep{};
+
+    FramePacer::Timing timing() {
+        return {
+            [this] {
+                const auto now = time;
+                time += 1us;
+                return now;
+            },
+            [this](Clock::time_point wake_time) { time = std::max(time, wake_time + oversleep); }
+        };
+    }
+};
+
+TEST(frame_pacer, ticks_on_the_deadlines) {
+    SimulatedClock clock;
+    FramePacer pacer(clock.timing());
+    const Clock::time_point origin = clock.time;
+    pacer.set_rate(200.0);
+    pacer.take_stats();
+
+    for (int tick = 1; tick <= 20; tick++) {
+        pacer.wait_next();
+        const auto deadline = origin + tick * 5ms;
+        EXPECT_GE(clock.time, deadline);
+        EXPECT_LT(clock.time, deadline + 20us);
+    }
+
+    const FrameTimeStats stats = pacer.take_stats();
+    EXPECT_EQ(stats.frame_count, 20);
+    EXPECT_NEAR(stats.mean_ms, 5.0, 0.01);
+    EXPECT_LT(stats.variance_ms2, 0.001);
+    EXPECT_NEAR(stats.max_ms, 5.0, 0.02);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(pacer.take_stats().frame_count, 0);
+}
+
+TEST(frame_pacer, late_wake_ups_do_not_delay_the_next_deadlines) {
+    SimulatedClock clock;
+    clock.oversleep = 3ms;
+    FramePacer pacer(clock.timing());
+    const Clock::time_point origin = clock.time;
+    pacer.set_rate(200.0);
+
+    // every tick is late but the lateness does not add up, once the spin margin grew to its 2 ms maximum
+    // the ticks are late by the 1 ms left
+    for (int tick = 1; tick <= 50; tick++) {
+        pacer.wait_next();
+        const auto deadline = origin + tick * 5ms;
+        EXPECT_GE(clock.time, deadline);
+        EXPECT_LT(clock.time, deadline + (tick < 10 ? 3ms : 1ms) + 20us);
+    }
+    EXPECT_EQ(pacer.take_stats().dropped, 0);
+}
+
+TEST(frame_pacer, catches_up_a_short_delay) {
+    SimulatedClock clock;
+    FramePacer pacer(clock.timing());
+    const Clock::time_point origin = clock.time;
+    pacer.set_rate(100.0);
+    pacer.wait_next();
+
+    // late by less than the catch up limit, the next tick is due right away and the one after keeps its deadline
+    clock.time += 15ms;
+    const auto before = clock.time;
+    pacer.wait_next();
+    EXPECT_LT(clock.time, before + 20us);
+    pacer.wait_next();
+    EXPECT_GE(clock.time, origin + 30ms);
+    EXPECT_LT(clock.time, origin + 30ms + 20us);
+    EXPECT_EQ(pacer.take_stats().dropped, 0);
+}
+
+TEST(frame_pacer, drops_the_periods_of_a_stall) {
+    SimulatedClock clock;
+    FramePacer pacer(clock.timing());
+    pacer.set_rate(100.0);
+    pacer.wait_next();
+    pacer.take_stats();
+
+    clock.time += 100ms;
+    pacer.wait_next();
+    const auto stall_end = clock.time;
+    EXPECT_EQ(pacer.take_stats().dropped, 9);
+
+    // the deadlines start again from the end of the stall instead of bursting to catch up
+    pacer.wait_next();
+    EXPECT_GE(clock.time, stall_end + 10ms);
+    EXPECT_LT(clock.time, stall_end + 10ms + 20us);
+}
+
+TEST(frame_pacer, unlocked_follows_notifications) {
+    FramePacer pacer;
+    pacer.set_rate(1.0);
+    pacer.set_unlocked(true);
+
+    std::thread notifier([&] {
+        std::this_thread::sleep_for(10ms);
+        pacer.notify();
+    });
+    const auto before = FramePacer::Clock::now();
+    pacer.wait_next();
+    EXPECT_LT(FramePacer::Clock::now() - before, 500ms);
+    notifier.join();
+
+    // a locked pacer ignores them
+    pacer.set_unlocked(false);
+    pacer.notify();
+    pacer.set_rate(50.0);
+    const auto locked_before = FramePacer::Clock::now();
+    pacer.wait_next();
+    EXPECT_GE(FramePacer::Clock::now() - locked_before, 19ms);
+}
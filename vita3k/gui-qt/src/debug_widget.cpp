@@ -20,6 +20,7 @@
 #include <cpu/functions.h>
 #include <emuenv/state.h>
 #include <kernel/state.h>
+#include <kernel/sync_primitives.h>
 #include <kernel/thread/thread_state.h>
 #include <mem/functions.h>
 #include <mem/state.h>
@@ -82,7 +83,7 @@ void DebugWidget::setup_ui() {
     m_mutexes_tree->setColumnWidth(1, 220);
     m_tabs->addTab(m_mutexes_tree, tr("Mutexes"));
 
-    m_lw_mutexes_tree = create_tree({ tr("ID"), tr("Name"), tr("Lock Count"), tr("Attributes"), tr("Waiting Threads"), tr("Owner") });
+    m_lw_mutexes_tree = create_tree({ tr("ID"), tr("Name"), tr("Lock Count"), tr("Attributes"), tr("Waiting Threads"), tr("Owner"), tr("Contended Locks"), tr("Wait Time (us)") });
     m_lw_mutexes_tree->setColumnWidth(0, 100);
     m_lw_mutexes_tree->setColumnWidth(1, 220);
     m_tabs->addTab(m_lw_mutexes_tree, tr("LW Mutexes"));
@@ -262,13 +263,20 @@ void DebugWidget::refresh_lw_mutexes() {
     const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
 
     for (const auto &[id, mutex] : emuenv.kernel.lwmutexes) {
+        SceUID owner_id;
+        int lock_count;
+        lwmutex_get_owner(emuenv.kernel, emuenv.mem, *mutex, owner_id, lock_count);
+        const auto owner = emuenv.kernel.threads.find(owner_id);
+
         auto *item = new QTreeWidgetItem(m_lw_mutexes_tree);
         item->setText(0, QStringLiteral("0x%1").arg(id, 8, 16, QLatin1Char('0')).toUpper());
         item->setText(1, QString::fromUtf8(mutex->name));
-        item->setText(2, QString::number(mutex->lock_count));
+        item->setText(2, QString::number(lock_count));
         item->setText(3, QString::number(mutex->attr));
         item->setText(4, QString::number(mutex->waiting_threads ? mutex->waiting_threads->size() : 0));
-        item->setText(5, mutex->owner ? QString::fromStdString(mutex->owner->name) : tr("not owned"));
+        item->setText(5, owner != emuenv.kernel.threads.end() ? QString::fromStdString(owner->second->name) : tr("not owned"));
+        item->setText(6, QString::number(mutex->stats.contended_locks.load()));
+        item->setText(7, QString::number(mutex->stats.total_wait_us.load()));
     }
 }
 
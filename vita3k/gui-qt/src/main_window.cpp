@@ -1894,15 +1894,16 @@ void MainWindow::setup_status_bar() {
     });
     connect(m_audio_backend_button, &QPushButton::customContextMenuRequested, this, [this](const QPoint &pos) {
         QMenu menu(this);
-        auto *sdl_action = menu.addAction(QStringLiteral("SDL"));
-        auto *cubeb_action = menu.addAction(QStringLiteral("Cubeb"));
+        // the label may be changed by the style (e.g. an added shortcut ampersand), keep the config value in the data
+        for (const QString &backend : { QStringLiteral("SDL"), QStringLiteral("Cubeb"), QStringLiteral("Null"), QStringLiteral("WAV") })
+            menu.addAction(backend)->setData(backend);
         QAction *chosen = menu.exec(m_audio_backend_button->mapToGlobal(pos));
         if (!chosen)
             return;
         Config desired;
         copy_config_for_edit(desired, emuenv.cfg);
         auto &cc = desired.current_config;
-        cc.audio_backend = (chosen == cubeb_action) ? "Cubeb" : "SDL";
+        cc.audio_backend = chosen->data().toString().toStdString();
         save_config(desired);
         update_audio_backend_button();
     });
@@ -2040,11 +2041,7 @@ void MainWindow::update_screen_filter_button() {
 
 void MainWindow::update_audio_backend_button() {
     const auto &backend = emuenv.cfg.current_config.audio_backend;
-    if (backend == "SDL") {
-        m_audio_backend_button->setText(QStringLiteral("SDL"));
-    } else {
-        m_audio_backend_button->setText(QStringLiteral("CUBEB"));
-    }
+    m_audio_backend_button->setText(QString::fromStdString(backend).toUpper());
     update_status_button_accent(m_audio_backend_button, QStringLiteral("audio"));
 }
 
@@ -381,8 +381,8 @@ void SettingsDialog::load_config() {
     m_ui->fps_hack->setChecked(m_config.fps_hack);
 
     m_ui->audio_backend_box->clear();
-    m_ui->audio_backend_box->addItems({ QStringLiteral("SDL"), QStringLiteral("Cubeb") });
-    m_ui->audio_backend_box->setCurrentIndex(m_config.audio_backend == "Cubeb" ? 1 : 0);
+    m_ui->audio_backend_box->addItems({ QStringLiteral("SDL"), QStringLiteral("Cubeb"), QStringLiteral("Null"), QStringLiteral("WAV") });
+    m_ui->audio_backend_box->setCurrentIndex(std::max(m_ui->audio_backend_box->findText(QString::fromStdString(m_config.audio_backend)), 0));
 
     m_ui->audio_volume->setValue(m_config.audio_volume);
     m_ui->audio_volume_label->setText(tr("Current volume: %1%").arg(m_config.audio_volume));
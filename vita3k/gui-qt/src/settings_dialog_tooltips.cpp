@@ -122,7 +122,7 @@ SettingsDialogTooltips::SettingsDialogTooltips(QObject *parent)
     , spirv_shader(tr("Pass generated Spir-V shader directly to driver.\nNote that some beneficial extensions will be disabled, and not all GPUs are compatible with this."))
     , fps_hack(tr("Game hack. May double the framerate from 30 FPS to 60 FPS in some games, but can cause some games to run twice as fast."))
     , memory_mapping(tr("Memory mapping improved performance, reduces memory usage and fixes many graphical issues. However, it may be unstable on some GPUs."))
-    , audio_backend(tr("Select the audio backend. Cubeb is recommended for most systems."))
+    , audio_backend(tr("Select the audio backend. Cubeb is recommended for most systems. Null plays nothing and WAV writes the audio to audio.wav in the log folder, both are meant for headless runs."))
     , audio_volume(tr("Set the in-game audio volume."))
     , theme_music_enable(tr("Enable background music for generated Vita themes when the selected theme provides an ATRAC9 BGM file."))
     , theme_music_volume(tr("Set the playback volume for Vita theme background music. This only affects interface theme music."))
@@ -19,7 +19,9 @@
 
 #include <gxm/types.h>
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <bitset>
 #include <string>
 
@@ -50,10 +52,89 @@ bool is_paletted_format(SceGxmTextureBaseFormat base_format);
 bool is_yuv_format(SceGxmTextureBaseFormat base_format);
 uint32_t attribute_format_size(SceGxmAttributeFormat format);
 bool is_stream_instancing(SceGxmIndexSource source);
+
+// Indices
+struct IndexRange {
+    uint32_t min = 0;
+    uint32_t max = 0;
+};
+
+// Smallest and largest index of an index buffer, returns { 0, 0 } if count is 0
+IndexRange get_index_range(const void *indices, uint32_t count, SceGxmIndexFormat format);
 bool convert_color_format_to_texture_format(SceGxmColorFormat format, SceGxmTextureFormat &dest_format);
 
 // Transfer
 uint32_t get_bits_per_pixel(SceGxmTransferFormat Format);
+// Fill width x height texels with the first bytes_per_texel bytes of color (zero after the 4th byte), stride is in bytes
+void fill_image(void *dest, uint32_t width, uint32_t height, int32_t stride, uint32_t bytes_per_texel, uint32_t color);
+// Average each 2x2 block of src into a texel of dest, width and height are the dimensions of dest and strides are in bytes
+// Returns false if the format is not a color format (raw and yuv formats)
+bool downscale_image(void *dest, const void *src, uint32_t width, uint32_t height, int32_t dest_stride, int32_t src_stride, SceGxmTransferFormat format);
+
+// Tiled and swizzled layouts
+// Copy a tiled (32x32 texel tiles) or swizzled (Morton order) image of width x height texels to a linear image.
+// Texels of 1, 2, 3, 4, 6, 8, 12 and 16 bytes are handled, returns false for any other size.
+bool tiled_to_linear(void *dest, const void *src, uint32_t width, uint32_t height, uint32_t bytes_per_texel);
+bool swizzled_to_linear(void *dest, const void *src, uint32_t width, uint32_t height, uint32_t bytes_per_texel);
+
+// Inserts a zero bit above every bit of the lower 16 bits
+constexpr uint32_t spread_bits(uint32_t x) {
+    x &= 0x0000ffff;
+    x = (x ^ (x << 8)) & 0x00ff00ff;
+    x = (x ^ (x << 4)) & 0x0f0f0f0f;
+    x = (x ^ (x << 2)) & 0x33333333;
+    x = (x ^ (x << 1)) & 0x55555555;
+    return x;
+}
+
+/**
+ * \brief Texel addressing of a transfer image
+ *
+ * The offset of the texel (x, y) is row_offset(y) + column_offset(x) for the three layouts,
+ * so a copy can compute the offsets of the columns once and reuse them for every row.
+ */
+template <SceGxmTransferType type>
+class TransferLayout {
+public:
+    // stride is in texels, width and height are only used by the swizzled layout and must be powers of two
+    TransferLayout(const uint32_t width, const uint32_t height, const uint32_t stride)
+        : stride(stride)
+        , min(std::min(width, height))
+        , k(std::bit_width(min) - 1) {}
+
+    uint32_t row_offset(const uint32_t y) const {
+        if constexpr (type == SCE_GXM_TRANSFER_LINEAR)
+            return y * stride;
+        else if constexpr (type == SCE_GXM_TRANSFER_TILED)
+            return (y / 32) * (stride / 32) * 1024 + (y % 32) * 32;
+        else
+            return ((y >> k) << (2 * k)) | spread_bits(y & (min - 1));
+    }
+
+    uint32_t column_offset(const uint32_t x) const {
+        if constexpr (type == SCE_GXM_TRANSFER_LINEAR)
+            return x;
+        else if constexpr (type == SCE_GXM_TRANSFER_TILED)
+            return (x / 32) * 1024 + x % 32;
+        else
+            return ((x >> k) << (2 * k)) | (spread_bits(x & (min - 1)) << 1);
+    }
+
+    // Number of texels starting at column x which follow each other in memory
+    uint32_t contiguous_texels(const uint32_t x) const {
+        if constexpr (type == SCE_GXM_TRANSFER_LINEAR)
+            return UINT32_MAX;
+        else if constexpr (type == SCE_GXM_TRANSFER_TILED)
+            return 32 - x % 32;
+        else
+            return 1;
+    }
+
+private:
+    uint32_t stride;
+    uint32_t min;
+    uint32_t k;
+};
 
 void destroy_all_contexts(EmuEnvState &emuenv, bool force_backend_destroy);
 void destroy_all_render_targets(EmuEnvState &emuenv, bool force_backend_destroy);
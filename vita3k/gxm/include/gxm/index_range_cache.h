@@ -0,0 +1,69 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <gxm/functions.h>
+#include <mem/ptr.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct MemState;
+
+namespace gxm {
+
+/**
+ * @brief Remembers the index range of the index buffers drawn with
+ *
+ * The range of a buffer is kept until its memory is written to, which is detected by write-protecting it.
+ * Small buffers are always scanned, and so are buffers rewritten too often, as a write fault costs more than a scan.
+ */
+class IndexRangeCache {
+public:
+    IndexRange get(MemState &mem, Ptr<const void> indices, uint32_t count, SceGxmIndexFormat format);
+    void clear();
+
+private:
+    struct Key {
+        Address address;
+        uint32_t count;
+        SceGxmIndexFormat format;
+
+        bool operator==(const Key &other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return (static_cast<size_t>(key.address) << 32) ^ key.count ^ key.format;
+        }
+    };
+
+    struct Entry {
+        IndexRange range;
+        // cleared by the write-protection callback, which can run on any thread
+        std::atomic<bool> valid{ false };
+        uint32_t invalidation_count = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<Entry>, KeyHash> entries;
+};
+
+} // namespace gxm
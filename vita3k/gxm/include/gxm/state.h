@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <gxm/index_range_cache.h>
 #include <gxm/types.h>
 #include <mem/ptr.h>
 #include <threads/queue.h>
@@ -77,6 +78,8 @@ struct GxmState {
     std::unordered_map<SceGxmContext *, Address> deferred_contexts;
     std::unordered_map<SceGxmRenderTarget *, Address> render_targets;
 
+    gxm::IndexRangeCache index_range_cache;
+
     void deinit() {
         if (display_host_thread.joinable())
             display_host_thread.join();
@@ -96,5 +99,6 @@ struct GxmState {
         immediate_context = 0;
         deferred_contexts.clear();
         render_targets.clear();
+        index_range_cache.clear();
     }
 };
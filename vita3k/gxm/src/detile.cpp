@@ -0,0 +1,346 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+/*
+conversion of the tiled and swizzled texture layouts to linear
+tiled images are made of 32x32 texel tiles, they are copied one tile row at a time
+swizzled images are in Morton order, which is a row (or a column) of squares of the size of the smaller dimension.
+Every 16 consecutive texels are a 4x4 block which is transposed to its 4 rows at once, with NEON on aarch64,
+SSE2 on x86 (SSSE3 for 8-bit texels if the cpu supports it)
+*/
+
+#include <gxm/functions.h>
+
+#include <util/instrset_detect.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSSE3 __attribute__((__target__("ssse3")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define TARGET_SSSE3
+#include <intrin.h>
+#else
+#error "Compiler is not supported"
+#endif
+
+namespace gxm {
+
+using DetileFunc = void (*)(uint8_t *dest, const uint8_t *src, uint32_t width, uint32_t height);
+// copies the 4x4 block of 16 swizzled texels at src to its 4 rows at dest
+using UnswizzleBlockFunc = void (*)(uint8_t *dest, size_t pitch, const uint8_t *src);
+
+static constexpr uint32_t TILE_SIZE = 32;
+
+// index in the swizzled block of each texel of the 4 rows of a 4x4 block
+static constexpr uint8_t BLOCK_TEXELS[4][4] = {
+    { 0, 2, 8, 10 },
+    { 1, 3, 9, 11 },
+    { 4, 6, 12, 14 },
+    { 5, 7, 13, 15 },
+};
+
+// Based on this: http://xen.firefly.nu/up/rearrange.c.html
+// https://fgiesen.wordpress.com/2009/12/13/decoding-morton-codes/
+// Thanks daniel from GXTConvert finding this out first
+
+// inverse of spread_bits, keeps the even bits
+static uint32_t compact_bits(uint32_t x) {
+    x &= 0x55555555;
+    x = (x ^ (x >> 1)) & 0x33333333;
+    x = (x ^ (x >> 2)) & 0x0f0f0f0f;
+    x = (x ^ (x >> 4)) & 0x00ff00ff;
+    x = (x ^ (x >> 8)) & 0x0000ffff;
+    return x;
+}
+
+template <size_t N>
+static void tiled_to_linear_impl(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height) {
+    const uint32_t width_in_tiles = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t full_tiles = width / TILE_SIZE;
+    const size_t last_tile_row_size = (width % TILE_SIZE) * N;
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *src_row = src + ((y / TILE_SIZE) * width_in_tiles * TILE_SIZE * TILE_SIZE + (y % TILE_SIZE) * TILE_SIZE) * N;
+        uint8_t *dest_row = dest + static_cast<size_t>(y) * width * N;
+
+        // the size is known at compile time, the compiler turns these copies into a few vector moves
+        for (uint32_t tile = 0; tile < full_tiles; tile++)
+            memcpy(dest_row + tile * TILE_SIZE * N, src_row + tile * TILE_SIZE * TILE_SIZE * N, TILE_SIZE * N);
+
+        if (last_tile_row_size != 0)
+            memcpy(dest_row + full_tiles * TILE_SIZE * N, src_row + full_tiles * TILE_SIZE * TILE_SIZE * N, last_tile_row_size);
+    }
+}
+
+// one texel at a time, also handles the dimensions which are not a power of two the same way as before
+template <size_t N>
+static void swizzled_to_linear_basic(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height) {
+    const uint32_t min = std::min(width, height);
+    const uint32_t k = std::bit_width(min) - 1;
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        uint32_t x = compact_bits(i >> 1) & (min - 1);
+        uint32_t y = compact_bits(i) & (min - 1);
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width >= height)
+            x |= upper_bits;
+        else
+            y |= upper_bits;
+
+        memcpy(dest + (static_cast<size_t>(y) * width + x) * N, src + static_cast<size_t>(i) * N, N);
+    }
+}
+
+template <size_t N>
+static void unswizzle_block_basic(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++)
+            memcpy(dest + y * pitch + x * N, src + BLOCK_TEXELS[y][x] * N, N);
+    }
+}
+
+template <size_t N, UnswizzleBlockFunc unswizzle_block>
+static void swizzled_to_linear_blocks(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height) {
+    const uint32_t min = std::min(width, height);
+    if (min < 4 || !std::has_single_bit(width) || !std::has_single_bit(height)) {
+        swizzled_to_linear_basic<N>(dest, src, width, height);
+        return;
+    }
+
+    const size_t pitch = static_cast<size_t>(width) * N;
+    const uint32_t blocks_per_square = (min / 4) * (min / 4);
+    const uint32_t square_count = std::max(width, height) / min;
+
+    for (uint32_t square = 0; square < square_count; square++) {
+        uint8_t *square_dest = width >= height ? dest + square * min * N : dest + square * min * pitch;
+        for (uint32_t block = 0; block < blocks_per_square; block++, src += 16 * N) {
+            const uint32_t x = compact_bits(block >> 1) * 4;
+            const uint32_t y = compact_bits(block) * 4;
+            unswizzle_block(square_dest + y * pitch + x * N, pitch, src);
+        }
+    }
+}
+
+#if defined(__aarch64__)
+static void unswizzle_block_u8_neon(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    static constexpr uint8_t mask_values[16] = { 0, 2, 8, 10, 1, 3, 9, 11, 4, 6, 12, 14, 5, 7, 13, 15 };
+    const uint32x4_t rows = vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8(src), vld1q_u8(mask_values)));
+    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dest), rows, 0);
+    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dest + pitch), rows, 1);
+    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dest + 2 * pitch), rows, 2);
+    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dest + 3 * pitch), rows, 3);
+}
+
+static void unswizzle_block_u16_neon(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const uint16x8_t low = vld1q_u16(reinterpret_cast<const uint16_t *>(src));
+    const uint16x8_t high = vld1q_u16(reinterpret_cast<const uint16_t *>(src + 16));
+    // pairs (0, 2) (4, 6) (8, 10) (12, 14) and (1, 3) (5, 7) (9, 11) (13, 15)
+    const uint32x4_t even = vreinterpretq_u32_u16(vuzp1q_u16(low, high));
+    const uint32x4_t odd = vreinterpretq_u32_u16(vuzp2q_u16(low, high));
+    const uint16x8_t rows_01 = vreinterpretq_u16_u32(vuzp1q_u32(even, odd));
+    const uint16x8_t rows_23 = vreinterpretq_u16_u32(vuzp2q_u32(even, odd));
+    vst1_u16(reinterpret_cast<uint16_t *>(dest), vget_low_u16(rows_01));
+    vst1_u16(reinterpret_cast<uint16_t *>(dest + pitch), vget_high_u16(rows_01));
+    vst1_u16(reinterpret_cast<uint16_t *>(dest + 2 * pitch), vget_low_u16(rows_23));
+    vst1_u16(reinterpret_cast<uint16_t *>(dest + 3 * pitch), vget_high_u16(rows_23));
+}
+
+static void unswizzle_block_u32_neon(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const uint32_t *texels = reinterpret_cast<const uint32_t *>(src);
+    const uint32x4_t q0 = vld1q_u32(texels);
+    const uint32x4_t q1 = vld1q_u32(texels + 4);
+    const uint32x4_t q2 = vld1q_u32(texels + 8);
+    const uint32x4_t q3 = vld1q_u32(texels + 12);
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest), vuzp1q_u32(q0, q2));
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + pitch), vuzp2q_u32(q0, q2));
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + 2 * pitch), vuzp1q_u32(q1, q3));
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + 3 * pitch), vuzp2q_u32(q1, q3));
+}
+
+static void unswizzle_block_u64_neon(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const uint64_t *texels = reinterpret_cast<const uint64_t *>(src);
+    for (uint32_t half = 0; half < 2; half++) {
+        // texels (0, 1) (2, 3) (8, 9) (10, 11) then the same plus 4 for the rows 2 and 3
+        const uint64x2_t q0 = vld1q_u64(texels + half * 4);
+        const uint64x2_t q1 = vld1q_u64(texels + half * 4 + 2);
+        const uint64x2_t q2 = vld1q_u64(texels + half * 4 + 8);
+        const uint64x2_t q3 = vld1q_u64(texels + half * 4 + 10);
+        uint64_t *row = reinterpret_cast<uint64_t *>(dest + half * 2 * pitch);
+        vst1q_u64(row, vzip1q_u64(q0, q1));
+        vst1q_u64(row + 2, vzip1q_u64(q2, q3));
+        row = reinterpret_cast<uint64_t *>(dest + (half * 2 + 1) * pitch);
+        vst1q_u64(row, vzip2q_u64(q0, q1));
+        vst1q_u64(row + 2, vzip2q_u64(q2, q3));
+    }
+}
+
+static constexpr UnswizzleBlockFunc unswizzle_block_u16 = unswizzle_block_u16_neon;
+static constexpr UnswizzleBlockFunc unswizzle_block_u32 = unswizzle_block_u32_neon;
+static constexpr UnswizzleBlockFunc unswizzle_block_u64 = unswizzle_block_u64_neon;
+#else
+static void TARGET_SSSE3 unswizzle_block_u8_ssse3(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const __m128i mask = _mm_setr_epi8(0, 2, 8, 10, 1, 3, 9, 11, 4, 6, 12, 14, 5, 7, 13, 15);
+    const __m128i rows = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), mask);
+    const uint32_t row_values[4] = {
+        static_cast<uint32_t>(_mm_cvtsi128_si32(rows)),
+        static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(rows, 4))),
+        static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(rows, 8))),
+        static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(rows, 12))),
+    };
+    for (uint32_t y = 0; y < 4; y++)
+        memcpy(dest + y * pitch, &row_values[y], sizeof(uint32_t));
+}
+
+static void TARGET_SSSE3 swizzled_to_linear_u8_ssse3(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height) {
+    swizzled_to_linear_blocks<1, unswizzle_block_u8_ssse3>(dest, src, width, height);
+}
+
+static void unswizzle_block_u16_sse2(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    // pairs (0, 2) (1, 3) (4, 6) (5, 7) and (8, 10) (9, 11) (12, 14) (13, 15)
+    low = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+    high = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i rows_01 = _mm_unpacklo_epi32(low, high);
+    const __m128i rows_23 = _mm_unpackhi_epi32(low, high);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dest), rows_01);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dest + pitch), _mm_srli_si128(rows_01, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dest + 2 * pitch), rows_23);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dest + 3 * pitch), _mm_srli_si128(rows_23, 8));
+}
+
+static void unswizzle_block_u32_sse2(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const float *texels = reinterpret_cast<const float *>(src);
+    const __m128 q0 = _mm_loadu_ps(texels);
+    const __m128 q1 = _mm_loadu_ps(texels + 4);
+    const __m128 q2 = _mm_loadu_ps(texels + 8);
+    const __m128 q3 = _mm_loadu_ps(texels + 12);
+    _mm_storeu_ps(reinterpret_cast<float *>(dest), _mm_shuffle_ps(q0, q2, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + pitch), _mm_shuffle_ps(q0, q2, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + 2 * pitch), _mm_shuffle_ps(q1, q3, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + 3 * pitch), _mm_shuffle_ps(q1, q3, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static void unswizzle_block_u64_sse2(uint8_t *dest, const size_t pitch, const uint8_t *src) {
+    const __m128i *texels = reinterpret_cast<const __m128i *>(src);
+    for (uint32_t half = 0; half < 2; half++) {
+        // texels (0, 1) (2, 3) (8, 9) (10, 11) then the same plus 4 for the rows 2 and 3
+        const __m128i q0 = _mm_loadu_si128(texels + half * 2);
+        const __m128i q1 = _mm_loadu_si128(texels + half * 2 + 1);
+        const __m128i q2 = _mm_loadu_si128(texels + half * 2 + 4);
+        const __m128i q3 = _mm_loadu_si128(texels + half * 2 + 5);
+        __m128i *row = reinterpret_cast<__m128i *>(dest + half * 2 * pitch);
+        _mm_storeu_si128(row, _mm_unpacklo_epi64(q0, q1));
+        _mm_storeu_si128(row + 1, _mm_unpacklo_epi64(q2, q3));
+        row = reinterpret_cast<__m128i *>(dest + (half * 2 + 1) * pitch);
+        _mm_storeu_si128(row, _mm_unpackhi_epi64(q0, q1));
+        _mm_storeu_si128(row + 1, _mm_unpackhi_epi64(q2, q3));
+    }
+}
+
+static constexpr UnswizzleBlockFunc unswizzle_block_u16 = unswizzle_block_u16_sse2;
+static constexpr UnswizzleBlockFunc unswizzle_block_u32 = unswizzle_block_u32_sse2;
+static constexpr UnswizzleBlockFunc unswizzle_block_u64 = unswizzle_block_u64_sse2;
+#endif
+
+static DetileFunc select_swizzled_to_linear_u8() {
+#if defined(__aarch64__)
+    return swizzled_to_linear_blocks<1, unswizzle_block_u8_neon>;
+#else
+    if (util::instrset::instrset_detect() >= util::instrset::instrset_SSSE3) {
+        LOG_INFO("SSSE3 instruction set is supported. Using SSSE3 8-bit texture unswizzling");
+        return swizzled_to_linear_u8_ssse3;
+    }
+
+    LOG_INFO("SSSE3 instruction set is not supported. Using basic 8-bit texture unswizzling");
+    return swizzled_to_linear_blocks<1, unswizzle_block_basic<1>>;
+#endif
+}
+
+static DetileFunc get_tiled_to_linear_func(const uint32_t bytes_per_texel) {
+    switch (bytes_per_texel) {
+    case 1:
+        return tiled_to_linear_impl<1>;
+    case 2:
+        return tiled_to_linear_impl<2>;
+    case 3:
+        return tiled_to_linear_impl<3>;
+    case 4:
+        return tiled_to_linear_impl<4>;
+    case 6:
+        return tiled_to_linear_impl<6>;
+    case 8:
+        return tiled_to_linear_impl<8>;
+    case 12:
+        return tiled_to_linear_impl<12>;
+    case 16:
+        return tiled_to_linear_impl<16>;
+    default:
+        return nullptr;
+    }
+}
+
+static DetileFunc get_swizzled_to_linear_func(const uint32_t bytes_per_texel) {
+    static const DetileFunc swizzled_to_linear_u8 = select_swizzled_to_linear_u8();
+
+    switch (bytes_per_texel) {
+    case 1:
+        return swizzled_to_linear_u8;
+    case 2:
+        return swizzled_to_linear_blocks<2, unswizzle_block_u16>;
+    case 3:
+        return swizzled_to_linear_blocks<3, unswizzle_block_basic<3>>;
+    case 4:
+        return swizzled_to_linear_blocks<4, unswizzle_block_u32>;
+    case 6:
+        return swizzled_to_linear_blocks<6, unswizzle_block_basic<6>>;
+    case 8:
+        return swizzled_to_linear_blocks<8, unswizzle_block_u64>;
+    case 12:
+        return swizzled_to_linear_blocks<12, unswizzle_block_basic<12>>;
+    case 16:
+        return swizzled_to_linear_blocks<16, unswizzle_block_basic<16>>;
+    default:
+        return nullptr;
+    }
+}
+
+bool tiled_to_linear(void *dest, const void *src, const uint32_t width, const uint32_t height, const uint32_t bytes_per_texel) {
+    const DetileFunc func = get_tiled_to_linear_func(bytes_per_texel);
+    if (!func)
+        return false;
+
+    func(static_cast<uint8_t *>(dest), static_cast<const uint8_t *>(src), width, height);
+    return true;
+}
+
+bool swizzled_to_linear(void *dest, const void *src, const uint32_t width, const uint32_t height, const uint32_t bytes_per_texel) {
+    const DetileFunc func = get_swizzled_to_linear_func(bytes_per_texel);
+    if (!func)
+        return false;
+
+    func(static_cast<uint8_t *>(dest), static_cast<const uint8_t *>(src), width, height);
+    return true;
+}
+} // namespace gxm
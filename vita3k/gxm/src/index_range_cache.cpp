@@ -0,0 +1,70 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/index_range_cache.h>
+
+#include <mem/functions.h>
+
+namespace gxm {
+
+// below this, scanning the indices is cheaper than looking up the cache
+static constexpr uint32_t MIN_CACHED_INDEX_COUNT = 1024;
+// buffers rewritten more often than this are considered dynamic and are not protected anymore
+static constexpr uint32_t MAX_INVALIDATION_COUNT = 4;
+static constexpr size_t MAX_CACHE_ENTRIES = 4096;
+
+IndexRange IndexRangeCache::get(MemState &mem, Ptr<const void> indices, const uint32_t count, const SceGxmIndexFormat format) {
+    const void *data = indices.get(mem);
+    if (count < MIN_CACHED_INDEX_COUNT)
+        return get_index_range(data, count, format);
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    const Key key{ indices.address(), count, format };
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        // protections stay registered with their entry, they are only removed when the memory is written to
+        if (entries.size() >= MAX_CACHE_ENTRIES)
+            entries.clear();
+
+        it = entries.emplace(key, std::make_shared<Entry>()).first;
+    } else if (it->second->valid.load(std::memory_order_acquire)) {
+        return it->second->range;
+    } else if (it->second->invalidation_count >= MAX_INVALIDATION_COUNT) {
+        return get_index_range(data, count, format);
+    } else {
+        it->second->invalidation_count++;
+    }
+
+    // protect before scanning, a write happening during the scan then invalidates the entry
+    const std::shared_ptr<Entry> &entry = it->second;
+    entry->valid.store(true, std::memory_order_release);
+    const uint32_t size = count * (format == SCE_GXM_INDEX_FORMAT_U16 ? sizeof(uint16_t) : sizeof(uint32_t));
+    add_protect(mem, indices.address(), size, MemPerm::ReadOnly, [entry](Address, bool) {
+        entry->valid.store(false, std::memory_order_release);
+        return true;
+    });
+
+    entry->range = get_index_range(data, count, format);
+    return entry->range;
+}
+
+void IndexRangeCache::clear() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+} // namespace gxm
@@ -0,0 +1,211 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+/*
+min/max scan of index buffers, used to know how much vertex data a draw reads
+aarch64 always has NEON, on x86 AVX2 or SSE4.1 are used if the cpu supports them
+*/
+
+#include <gxm/functions.h>
+
+#include <util/instrset_detect.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE41 __attribute__((__target__("sse4.1")))
+#define TARGET_AVX2 __attribute__((__target__("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define TARGET_SSE41
+#define TARGET_AVX2
+#include <intrin.h>
+#else
+#error "Compiler is not supported"
+#endif
+
+namespace gxm {
+
+using IndexRangeFunc = IndexRange (*)(const void *indices, uint32_t count);
+
+template <typename T>
+static IndexRange index_range_scalar(const T *data, const uint32_t count, T min_value = std::numeric_limits<T>::max(), T max_value = 0) {
+    for (uint32_t i = 0; i < count; i++) {
+        min_value = std::min(min_value, data[i]);
+        max_value = std::max(max_value, data[i]);
+    }
+
+    return { min_value, max_value };
+}
+
+template <typename T>
+static IndexRange index_range_basic(const void *indices, const uint32_t count) {
+    return index_range_scalar(static_cast<const T *>(indices), count);
+}
+
+#if defined(__aarch64__)
+static IndexRange index_range_u16_neon(const void *indices, const uint32_t count) {
+    const uint16_t *data = static_cast<const uint16_t *>(indices);
+    uint32_t i = 0;
+    uint16x8_t min_vec = vdupq_n_u16(std::numeric_limits<uint16_t>::max());
+    uint16x8_t max_vec = vdupq_n_u16(0);
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t values = vld1q_u16(data + i);
+        min_vec = vminq_u16(min_vec, values);
+        max_vec = vmaxq_u16(max_vec, values);
+    }
+
+    return index_range_scalar<uint16_t>(data + i, count - i, vminvq_u16(min_vec), vmaxvq_u16(max_vec));
+}
+
+static IndexRange index_range_u32_neon(const void *indices, const uint32_t count) {
+    const uint32_t *data = static_cast<const uint32_t *>(indices);
+    uint32_t i = 0;
+    uint32x4_t min_vec = vdupq_n_u32(std::numeric_limits<uint32_t>::max());
+    uint32x4_t max_vec = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t values = vld1q_u32(data + i);
+        min_vec = vminq_u32(min_vec, values);
+        max_vec = vmaxq_u32(max_vec, values);
+    }
+
+    return index_range_scalar<uint32_t>(data + i, count - i, vminvq_u32(min_vec), vmaxvq_u32(max_vec));
+}
+#else
+static uint16_t TARGET_SSE41 horizontal_min_u16(const __m128i values) {
+    return static_cast<uint16_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(values)));
+}
+
+static uint16_t TARGET_SSE41 horizontal_max_u16(const __m128i values) {
+    // max(x) = ~min(~x)
+    const __m128i ones = _mm_set1_epi16(-1);
+    return static_cast<uint16_t>(~_mm_cvtsi128_si32(_mm_minpos_epu16(_mm_xor_si128(values, ones))));
+}
+
+static uint32_t TARGET_SSE41 horizontal_min_u32(__m128i values) {
+    values = _mm_min_epu32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2)));
+    values = _mm_min_epu32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(values));
+}
+
+static uint32_t TARGET_SSE41 horizontal_max_u32(__m128i values) {
+    values = _mm_max_epu32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2)));
+    values = _mm_max_epu32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(values));
+}
+
+static IndexRange TARGET_SSE41 index_range_u16_sse41(const void *indices, const uint32_t count) {
+    const uint16_t *data = static_cast<const uint16_t *>(indices);
+    uint32_t i = 0;
+    __m128i min_vec = _mm_set1_epi16(-1);
+    __m128i max_vec = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        min_vec = _mm_min_epu16(min_vec, values);
+        max_vec = _mm_max_epu16(max_vec, values);
+    }
+
+    return index_range_scalar<uint16_t>(data + i, count - i, horizontal_min_u16(min_vec), horizontal_max_u16(max_vec));
+}
+
+static IndexRange TARGET_SSE41 index_range_u32_sse41(const void *indices, const uint32_t count) {
+    const uint32_t *data = static_cast<const uint32_t *>(indices);
+    uint32_t i = 0;
+    __m128i min_vec = _mm_set1_epi32(-1);
+    __m128i max_vec = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        min_vec = _mm_min_epu32(min_vec, values);
+        max_vec = _mm_max_epu32(max_vec, values);
+    }
+
+    return index_range_scalar<uint32_t>(data + i, count - i, horizontal_min_u32(min_vec), horizontal_max_u32(max_vec));
+}
+
+static IndexRange TARGET_AVX2 index_range_u16_avx2(const void *indices, const uint32_t count) {
+    const uint16_t *data = static_cast<const uint16_t *>(indices);
+    uint32_t i = 0;
+    __m256i min_vec = _mm256_set1_epi16(-1);
+    __m256i max_vec = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        min_vec = _mm256_min_epu16(min_vec, values);
+        max_vec = _mm256_max_epu16(max_vec, values);
+    }
+
+    const __m128i min_half = _mm_min_epu16(_mm256_castsi256_si128(min_vec), _mm256_extracti128_si256(min_vec, 1));
+    const __m128i max_half = _mm_max_epu16(_mm256_castsi256_si128(max_vec), _mm256_extracti128_si256(max_vec, 1));
+    return index_range_scalar<uint16_t>(data + i, count - i, horizontal_min_u16(min_half), horizontal_max_u16(max_half));
+}
+
+static IndexRange TARGET_AVX2 index_range_u32_avx2(const void *indices, const uint32_t count) {
+    const uint32_t *data = static_cast<const uint32_t *>(indices);
+    uint32_t i = 0;
+    __m256i min_vec = _mm256_set1_epi32(-1);
+    __m256i max_vec = _mm256_setzero_si256();
+    for (; i + 8 <= count; i += 8) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        min_vec = _mm256_min_epu32(min_vec, values);
+        max_vec = _mm256_max_epu32(max_vec, values);
+    }
+
+    const __m128i min_half = _mm_min_epu32(_mm256_castsi256_si128(min_vec), _mm256_extracti128_si256(min_vec, 1));
+    const __m128i max_half = _mm_max_epu32(_mm256_castsi256_si128(max_vec), _mm256_extracti128_si256(max_vec, 1));
+    return index_range_scalar<uint32_t>(data + i, count - i, horizontal_min_u32(min_half), horizontal_max_u32(max_half));
+}
+#endif
+
+struct IndexRangeFuncs {
+    IndexRangeFunc u16;
+    IndexRangeFunc u32;
+};
+
+static IndexRangeFuncs select_index_range_funcs() {
+#if defined(__aarch64__)
+    return { index_range_u16_neon, index_range_u32_neon };
+#else
+    const int instrset = util::instrset::instrset_detect();
+    if (instrset >= util::instrset::instrset_AVX2) {
+        LOG_INFO("AVX2 instruction set is supported. Using AVX2 index range scan");
+        return { index_range_u16_avx2, index_range_u32_avx2 };
+    }
+    if (instrset >= util::instrset::instrset_SSE4_1) {
+        LOG_INFO("SSE4.1 instruction set is supported. Using SSE4.1 index range scan");
+        return { index_range_u16_sse41, index_range_u32_sse41 };
+    }
+
+    LOG_INFO("SSE4.1 instruction set is not supported. Using basic index range scan");
+    return { index_range_basic<uint16_t>, index_range_basic<uint32_t> };
+#endif
+}
+
+IndexRange get_index_range(const void *indices, const uint32_t count, const SceGxmIndexFormat format) {
+    static const IndexRangeFuncs funcs = select_index_range_funcs();
+
+    if (count == 0)
+        return {};
+
+    if (format == SCE_GXM_INDEX_FORMAT_U16)
+        return funcs.u16(indices, count);
+    else
+        return funcs.u32(indices, count);
+}
+} // namespace gxm
@@ -15,7 +15,25 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
-#include <gxm/types.h>
+/*
+CPU side of the transfer fill and downscale commands
+fills write a first row with 16-byte stores of a repeated pattern, then copy it to the other rows
+downscales average each 2x2 block, with NEON on aarch64 and SSE2 on x86
+*/
+
+#include <gxm/functions.h>
+
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#else
+#error "Compiler is not supported"
+#endif
 
 namespace gxm {
 uint32_t get_bits_per_pixel(SceGxmTransferFormat Format) {
@@ -46,4 +64,233 @@ uint32_t get_bits_per_pixel(SceGxmTransferFormat Format) {
 
     return 0;
 }
+
+void fill_image(void *dest, const uint32_t width, const uint32_t height, const int32_t stride, const uint32_t bytes_per_texel, const uint32_t color) {
+    if (width == 0 || height == 0)
+        return;
+
+    // 48 bytes is a multiple of 16 bytes and of every texel size (1, 2, 3, 4, 8 and 16 bytes)
+    uint8_t pattern[48];
+    for (uint32_t i = 0; i < sizeof(pattern); i++) {
+        const uint32_t byte = i % bytes_per_texel;
+        pattern[i] = byte < sizeof(color) ? static_cast<uint8_t>(color >> (8 * byte)) : 0;
+    }
+
+    uint8_t *first_row = static_cast<uint8_t *>(dest);
+    const size_t row_size = static_cast<size_t>(width) * bytes_per_texel;
+    size_t offset = 0;
+    for (; offset + sizeof(pattern) <= row_size; offset += sizeof(pattern))
+        memcpy(first_row + offset, pattern, sizeof(pattern));
+    memcpy(first_row + offset, pattern, row_size - offset);
+
+    for (uint32_t y = 1; y < height; y++)
+        memcpy(first_row + static_cast<ptrdiff_t>(y) * stride, first_row, row_size);
+}
+
+// rounded average of the 4 channels of a 2x2 block
+static uint32_t average(const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t d) {
+    return (a + b + c + d + 2) / 4;
+}
+
+// formats with one byte per channel, N is the number of channels
+template <uint32_t N>
+static void downscale_bytes_basic(uint8_t *dest, const uint8_t *src_row0, const uint8_t *src_row1, const uint32_t x_start, const uint32_t width) {
+    for (uint32_t x = x_start; x < width; x++) {
+        for (uint32_t c = 0; c < N; c++) {
+            const uint32_t left = 2 * x * N + c;
+            dest[x * N + c] = static_cast<uint8_t>(average(src_row0[left], src_row0[left + N], src_row1[left], src_row1[left + N]));
+        }
+    }
+}
+
+// packed formats, the fields are given from the lowest bits
+template <typename T, uint32_t... field_bits>
+static void downscale_packed_basic(T *dest, const T *src_row0, const T *src_row1, const uint32_t x_start, const uint32_t width) {
+    for (uint32_t x = x_start; x < width; x++) {
+        const T texels[4] = { src_row0[2 * x], src_row0[2 * x + 1], src_row1[2 * x], src_row1[2 * x + 1] };
+        T result = 0;
+        uint32_t shift = 0;
+        for (const uint32_t bits : { field_bits... }) {
+            const uint32_t mask = (1U << bits) - 1;
+            const uint32_t value = average((texels[0] >> shift) & mask, (texels[1] >> shift) & mask, (texels[2] >> shift) & mask, (texels[3] >> shift) & mask);
+            result |= static_cast<T>(value << shift);
+            shift += bits;
+        }
+        dest[x] = result;
+    }
+}
+
+#if defined(__aarch64__)
+// 16 bytes of each source row to 8 bytes of the destination row
+template <uint32_t N>
+static uint32_t downscale_bytes_row(uint8_t *dest, const uint8_t *src_row0, const uint8_t *src_row1, const uint32_t width) {
+    constexpr uint32_t texels_per_step = 8 / N;
+    uint32_t x = 0;
+    for (; x + texels_per_step <= width; x += texels_per_step) {
+        uint8x8_t even0, odd0, even1, odd1;
+        // split the even and odd texels of both rows
+        if constexpr (N == 1) {
+            const uint8x8x2_t row0 = vld2_u8(src_row0 + 2 * x);
+            const uint8x8x2_t row1 = vld2_u8(src_row1 + 2 * x);
+            even0 = row0.val[0], odd0 = row0.val[1], even1 = row1.val[0], odd1 = row1.val[1];
+        } else if constexpr (N == 2) {
+            const uint16x4x2_t row0 = vld2_u16(reinterpret_cast<const uint16_t *>(src_row0 + 4 * x));
+            const uint16x4x2_t row1 = vld2_u16(reinterpret_cast<const uint16_t *>(src_row1 + 4 * x));
+            even0 = vreinterpret_u8_u16(row0.val[0]), odd0 = vreinterpret_u8_u16(row0.val[1]);
+            even1 = vreinterpret_u8_u16(row1.val[0]), odd1 = vreinterpret_u8_u16(row1.val[1]);
+        } else {
+            const uint32x2x2_t row0 = vld2_u32(reinterpret_cast<const uint32_t *>(src_row0 + 8 * x));
+            const uint32x2x2_t row1 = vld2_u32(reinterpret_cast<const uint32_t *>(src_row1 + 8 * x));
+            even0 = vreinterpret_u8_u32(row0.val[0]), odd0 = vreinterpret_u8_u32(row0.val[1]);
+            even1 = vreinterpret_u8_u32(row1.val[0]), odd1 = vreinterpret_u8_u32(row1.val[1]);
+        }
+        const uint16x8_t sum = vaddq_u16(vaddl_u8(even0, odd0), vaddl_u8(even1, odd1));
+        vst1_u8(dest + x * N, vrshrn_n_u16(sum, 2));
+    }
+
+    return x;
+}
+
+static uint32_t downscale_bgr_row(uint8_t *dest, const uint8_t *src_row0, const uint8_t *src_row1, const uint32_t width) {
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const uint8x16x3_t row0 = vld3q_u8(src_row0 + 6 * x);
+        const uint8x16x3_t row1 = vld3q_u8(src_row1 + 6 * x);
+        uint8x8x3_t result;
+        for (int c = 0; c < 3; c++) {
+            // pairwise add of the adjacent texels of the same channel
+            const uint16x8_t sum = vaddq_u16(vpaddlq_u8(row0.val[c]), vpaddlq_u8(row1.val[c]));
+            result.val[c] = vrshrn_n_u16(sum, 2);
+        }
+        vst3_u8(dest + 3 * x, result);
+    }
+
+    return x;
+}
+
+static uint32_t downscale_565_row(uint16_t *dest, const uint16_t *src_row0, const uint16_t *src_row1, const uint32_t width) {
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const uint16x8x2_t row0 = vld2q_u16(src_row0 + 2 * x);
+        const uint16x8x2_t row1 = vld2q_u16(src_row1 + 2 * x);
+        const auto field_sum = [&](const int shift, const uint16_t mask) {
+            const uint16x8_t mask_vec = vdupq_n_u16(mask);
+            const uint16x8_t sum = vaddq_u16(vandq_u16(vshlq_u16(row0.val[0], vdupq_n_s16(-shift)), mask_vec), vandq_u16(vshlq_u16(row0.val[1], vdupq_n_s16(-shift)), mask_vec));
+            return vaddq_u16(sum, vaddq_u16(vandq_u16(vshlq_u16(row1.val[0], vdupq_n_s16(-shift)), mask_vec), vandq_u16(vshlq_u16(row1.val[1], vdupq_n_s16(-shift)), mask_vec)));
+        };
+        const uint16x8_t r = vrshrq_n_u16(field_sum(0, 0x1f), 2);
+        const uint16x8_t g = vrshrq_n_u16(field_sum(5, 0x3f), 2);
+        const uint16x8_t b = vrshrq_n_u16(field_sum(11, 0x1f), 2);
+        vst1q_u16(dest + x, vorrq_u16(r, vorrq_u16(vshlq_n_u16(g, 5), vshlq_n_u16(b, 11))));
+    }
+
+    return x;
+}
+#else
+// 16 bytes of each source row to 8 bytes of the destination row
+template <uint32_t N>
+static uint32_t downscale_bytes_row(uint8_t *dest, const uint8_t *src_row0, const uint8_t *src_row1, const uint32_t width) {
+    constexpr uint32_t texels_per_step = 8 / N;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(2);
+    uint32_t x = 0;
+    for (; x + texels_per_step <= width; x += texels_per_step) {
+        const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_row0 + 2 * x * N));
+        const __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_row1 + 2 * x * N));
+        // sum of the two rows on 16 bits
+        const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+        const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+
+        // then add the channels of each pair of adjacent texels
+        __m128i sum;
+        if constexpr (N == 1) {
+            const __m128i ones = _mm_set1_epi16(1);
+            sum = _mm_packs_epi32(_mm_madd_epi16(low, ones), _mm_madd_epi16(high, ones));
+        } else if constexpr (N == 2) {
+            const __m128 low_ps = _mm_castsi128_ps(low);
+            const __m128 high_ps = _mm_castsi128_ps(high);
+            sum = _mm_add_epi16(_mm_castps_si128(_mm_shuffle_ps(low_ps, high_ps, _MM_SHUFFLE(2, 0, 2, 0))),
+                _mm_castps_si128(_mm_shuffle_ps(low_ps, high_ps, _MM_SHUFFLE(3, 1, 3, 1))));
+        } else {
+            sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+        }
+
+        const __m128i result = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dest + x * N), _mm_packus_epi16(result, result));
+    }
+
+    return x;
+}
+
+static uint32_t downscale_bgr_row(uint8_t *, const uint8_t *, const uint8_t *, uint32_t) {
+    // the channels of adjacent texels are 3 bytes apart, which SSE2 has no cheap shuffle for
+    return 0;
+}
+
+static uint32_t downscale_565_row(uint16_t *dest, const uint16_t *src_row0, const uint16_t *src_row1, const uint32_t width) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i rounding = _mm_set1_epi32(2);
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_row0 + 2 * x));
+        const __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_row1 + 2 * x));
+        // sum of the 4 values of a field for each destination texel, on 32 bits
+        const auto field_sum = [&](const int shift, const int16_t mask) {
+            const __m128i mask_vec = _mm_set1_epi16(mask);
+            const __m128i sum = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(row0, shift), mask_vec), _mm_and_si128(_mm_srli_epi16(row1, shift), mask_vec));
+            return _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(sum, ones), rounding), 2);
+        };
+        __m128i result = _mm_or_si128(field_sum(0, 0x1f), _mm_or_si128(_mm_slli_epi32(field_sum(5, 0x3f), 5), _mm_slli_epi32(field_sum(11, 0x1f), 11)));
+        // keep the low 16 bits of each lane, sign extended so that the signed saturation keeps them as is
+        result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dest + x), _mm_packs_epi32(result, result));
+    }
+
+    return x;
+}
+#endif
+
+bool downscale_image(void *dest, const void *src, const uint32_t width, const uint32_t height, const int32_t dest_stride, const int32_t src_stride, const SceGxmTransferFormat format) {
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *src_row0 = static_cast<const uint8_t *>(src) + static_cast<ptrdiff_t>(2 * y) * src_stride;
+        const uint8_t *src_row1 = src_row0 + src_stride;
+        uint8_t *dest_row = static_cast<uint8_t *>(dest) + static_cast<ptrdiff_t>(y) * dest_stride;
+
+        const auto *src_row0_16 = reinterpret_cast<const uint16_t *>(src_row0);
+        const auto *src_row1_16 = reinterpret_cast<const uint16_t *>(src_row1);
+        auto *dest_row_16 = reinterpret_cast<uint16_t *>(dest_row);
+
+        switch (format) {
+        case SCE_GXM_TRANSFER_FORMAT_U8_R:
+            downscale_bytes_basic<1>(dest_row, src_row0, src_row1, downscale_bytes_row<1>(dest_row, src_row0, src_row1, width), width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U8U8_GR:
+            downscale_bytes_basic<2>(dest_row, src_row0, src_row1, downscale_bytes_row<2>(dest_row, src_row0, src_row1, width), width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U8U8U8_BGR:
+            downscale_bytes_basic<3>(dest_row, src_row0, src_row1, downscale_bgr_row(dest_row, src_row0, src_row1, width), width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR:
+            downscale_bytes_basic<4>(dest_row, src_row0, src_row1, downscale_bytes_row<4>(dest_row, src_row0, src_row1, width), width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U5U6U5_BGR:
+            downscale_packed_basic<uint16_t, 5, 6, 5>(dest_row_16, src_row0_16, src_row1_16, downscale_565_row(dest_row_16, src_row0_16, src_row1_16, width), width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U1U5U5U5_ABGR:
+            downscale_packed_basic<uint16_t, 5, 5, 5, 1>(dest_row_16, src_row0_16, src_row1_16, 0, width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U4U4U4U4_ABGR:
+            downscale_packed_basic<uint16_t, 4, 4, 4, 4>(dest_row_16, src_row0_16, src_row1_16, 0, width);
+            break;
+        case SCE_GXM_TRANSFER_FORMAT_U2U10U10U10_ABGR:
+            downscale_packed_basic<uint32_t, 10, 10, 10, 2>(reinterpret_cast<uint32_t *>(dest_row), reinterpret_cast<const uint32_t *>(src_row0),
+                reinterpret_cast<const uint32_t *>(src_row1), 0, width);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
 } // namespace gxm
@@ -0,0 +1,109 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/functions.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+static uint32_t compact_bits(uint32_t x) {
+    x &= 0x55555555;
+    x = (x ^ (x >> 1)) & 0x33333333;
+    x = (x ^ (x >> 2)) & 0x0f0f0f0f;
+    x = (x ^ (x >> 4)) & 0x00ff00ff;
+    x = (x ^ (x >> 8)) & 0x0000ffff;
+    return x;
+}
+
+// the previous implementation, one memcpy per texel
+static void swizzled_to_linear_per_texel(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height, const uint32_t bytes_per_texel) {
+    const uint32_t min = std::min(width, height);
+    const uint32_t k = std::bit_width(min) - 1;
+    for (uint32_t i = 0; i < width * height; i++) {
+        uint32_t x = compact_bits(i >> 1) & (min - 1);
+        uint32_t y = compact_bits(i) & (min - 1);
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width >= height)
+            x |= upper_bits;
+        else
+            y |= upper_bits;
+        memcpy(dest + (y * width + x) * bytes_per_texel, src + i * bytes_per_texel, bytes_per_texel);
+    }
+}
+
+static void tiled_to_linear_per_texel(uint8_t *dest, const uint8_t *src, const uint32_t width, const uint32_t height, const uint32_t bytes_per_texel) {
+    const uint32_t width_in_tiles = (width + 31) / 32;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t offset = (((x / 32) + width_in_tiles * (y / 32)) * 1024 + (y % 32) * 32 + x % 32) * bytes_per_texel;
+            memcpy(dest + (y * width + x) * bytes_per_texel, src + offset, bytes_per_texel);
+        }
+    }
+}
+
+enum class Layout {
+    Swizzled,
+    Tiled,
+};
+
+template <Layout layout, uint32_t bytes_per_texel>
+static void BM_PerTexel(benchmark::State &state) {
+    const uint32_t size = static_cast<uint32_t>(state.range(0));
+    const std::vector<uint8_t> src(size * size * bytes_per_texel, 0x5a);
+    std::vector<uint8_t> dest(src.size());
+    for (auto _ : state) {
+        if constexpr (layout == Layout::Swizzled)
+            swizzled_to_linear_per_texel(dest.data(), src.data(), size, size, bytes_per_texel);
+        else
+            tiled_to_linear_per_texel(dest.data(), src.data(), size, size, bytes_per_texel);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+template <Layout layout, uint32_t bytes_per_texel>
+static void BM_Detile(benchmark::State &state) {
+    const uint32_t size = static_cast<uint32_t>(state.range(0));
+    const std::vector<uint8_t> src(size * size * bytes_per_texel, 0x5a);
+    std::vector<uint8_t> dest(src.size());
+    for (auto _ : state) {
+        if constexpr (layout == Layout::Swizzled)
+            gxm::swizzled_to_linear(dest.data(), src.data(), size, size, bytes_per_texel);
+        else
+            gxm::tiled_to_linear(dest.data(), src.data(), size, size, bytes_per_texel);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+#define DETILE_BENCHMARKS(layout, bytes_per_texel)                                        \
+    BENCHMARK(BM_PerTexel<layout, bytes_per_texel>)->RangeMultiplier(2)->Range(64, 2048); \
+    BENCHMARK(BM_Detile<layout, bytes_per_texel>)->RangeMultiplier(2)->Range(64, 2048);
+
+// square textures from 64x64 to 2048x2048 with 8, 16, 32 and 64-bit texels
+DETILE_BENCHMARKS(Layout::Swizzled, 1)
+DETILE_BENCHMARKS(Layout::Swizzled, 2)
+DETILE_BENCHMARKS(Layout::Swizzled, 4)
+DETILE_BENCHMARKS(Layout::Swizzled, 8)
+DETILE_BENCHMARKS(Layout::Tiled, 1)
+DETILE_BENCHMARKS(Layout::Tiled, 2)
+DETILE_BENCHMARKS(Layout::Tiled, 4)
+DETILE_BENCHMARKS(Layout::Tiled, 8)
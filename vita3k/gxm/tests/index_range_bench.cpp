@@ -0,0 +1,60 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/functions.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+template <typename T>
+static std::vector<T> make_indices(const size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> dist(0, std::min<uint32_t>(count, std::numeric_limits<T>::max()));
+    std::vector<T> indices(count);
+    for (T &index : indices)
+        index = static_cast<T>(dist(rng));
+    return indices;
+}
+
+template <typename T>
+static void BM_MaxElement(benchmark::State &state) {
+    const std::vector<T> indices = make_indices<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(*std::max_element(indices.begin(), indices.end()));
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+template <typename T>
+static void BM_IndexRange(benchmark::State &state) {
+    const std::vector<T> indices = make_indices<T>(state.range(0));
+    const SceGxmIndexFormat format = sizeof(T) == sizeof(uint16_t) ? SCE_GXM_INDEX_FORMAT_U16 : SCE_GXM_INDEX_FORMAT_U32;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(gxm::get_index_range(indices.data(), static_cast<uint32_t>(indices.size()), format));
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+// from a single triangle to a full 16-bit index buffer
+BENCHMARK(BM_MaxElement<uint16_t>)->RangeMultiplier(8)->Range(3, 65536);
+BENCHMARK(BM_IndexRange<uint16_t>)->RangeMultiplier(8)->Range(3, 65536);
+BENCHMARK(BM_MaxElement<uint32_t>)->RangeMultiplier(8)->Range(3, 65536);
+BENCHMARK(BM_IndexRange<uint32_t>)->RangeMultiplier(8)->Range(3, 65536);
+
+BENCHMARK_MAIN();
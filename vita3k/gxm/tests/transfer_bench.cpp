@@ -0,0 +1,85 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/functions.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+// the size of the PS Vita screen
+static constexpr uint32_t WIDTH = 960;
+static constexpr uint32_t HEIGHT = 544;
+
+// the previous implementation, one memcpy per texel
+static void fill_per_texel(uint8_t *dest, const uint32_t stride, const uint32_t bytes_per_texel, const uint32_t color) {
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+        for (uint32_t x = 0; x < WIDTH; x++)
+            memcpy(dest + y * stride + x * bytes_per_texel, &color, bytes_per_texel);
+    }
+}
+
+template <uint32_t bytes_per_texel>
+static void BM_FillPerTexel(benchmark::State &state) {
+    std::vector<uint8_t> dest(WIDTH * HEIGHT * bytes_per_texel);
+    for (auto _ : state) {
+        fill_per_texel(dest.data(), WIDTH * bytes_per_texel, bytes_per_texel, 0x80402010);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * dest.size());
+}
+
+template <uint32_t bytes_per_texel>
+static void BM_Fill(benchmark::State &state) {
+    std::vector<uint8_t> dest(WIDTH * HEIGHT * bytes_per_texel);
+    for (auto _ : state) {
+        gxm::fill_image(dest.data(), WIDTH, HEIGHT, WIDTH * bytes_per_texel, bytes_per_texel, 0x80402010);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * dest.size());
+}
+
+template <SceGxmTransferFormat format>
+static void BM_Downscale(benchmark::State &state) {
+    const uint32_t bytes_per_texel = gxm::get_bits_per_pixel(format) / 8;
+    std::vector<uint8_t> src(WIDTH * HEIGHT * bytes_per_texel);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = static_cast<uint8_t>(i * 7);
+    std::vector<uint8_t> dest(src.size() / 4);
+    for (auto _ : state) {
+        gxm::downscale_image(dest.data(), src.data(), WIDTH / 2, HEIGHT / 2, WIDTH / 2 * bytes_per_texel, WIDTH * bytes_per_texel, format);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+BENCHMARK(BM_FillPerTexel<1>);
+BENCHMARK(BM_Fill<1>);
+BENCHMARK(BM_FillPerTexel<2>);
+BENCHMARK(BM_Fill<2>);
+BENCHMARK(BM_FillPerTexel<3>);
+BENCHMARK(BM_Fill<3>);
+BENCHMARK(BM_FillPerTexel<4>);
+BENCHMARK(BM_Fill<4>);
+
+// 960x544 to 480x272
+BENCHMARK(BM_Downscale<SCE_GXM_TRANSFER_FORMAT_U5U6U5_BGR>);
+BENCHMARK(BM_Downscale<SCE_GXM_TRANSFER_FORMAT_U8U8U8_BGR>);
+BENCHMARK(BM_Downscale<SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR>);
+BENCHMARK(BM_Downscale<SCE_GXM_TRANSFER_FORMAT_U1U5U5U5_ABGR>);
+BENCHMARK(BM_Downscale<SCE_GXM_TRANSFER_FORMAT_U8_R>);
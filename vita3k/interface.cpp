@@ -416,10 +416,16 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv, const
     emuenv.kernel.process_exit_callback = [&emuenv](int res, std::optional<AppLaunchRequest> relaunch) {
         emuenv.post_app_launch_request(relaunch.value_or(AppLaunchRequest{ .reason = AppLaunchReason::ProcessExit }));
     };
-    if (!emuenv.kernel.init(emuenv.mem, call_import, emuenv.cfg.current_config.cpu_opt)) {
+    emuenv.kernel.fast_import_dispatch = emuenv.cfg.fast_import_dispatch;
+    emuenv.kernel.fast_lwmutex = emuenv.cfg.fast_lwmutex;
+    // threads share a pool of cpu-pool-size Dynarmic instances (extended if needed) when the JIT cache is shared
+    const std::size_t cpu_pool_size = emuenv.cfg.shared_jit_cache ? std::max(emuenv.cfg.cpu_pool_size, 1) : 0;
+    if (!emuenv.kernel.init(emuenv.mem, call_import, emuenv.cfg.current_config.cpu_opt, cpu_pool_size)) {
         LOG_WARN("Failed to init kernel!");
         return KernelInitFailed;
     }
+    if (emuenv.cfg.persistent_jit_cache)
+        emuenv.kernel.jit_cache.init(emuenv.cache_path / "jit" / emuenv.io.title_id, emuenv.mem, emuenv.cfg.current_config.cpu_opt, emuenv.kernel.cpu_pool);
 
     if (emuenv.cfg.archive_log) {
         const fs::path log_directory{ emuenv.log_path / "logs" };
@@ -431,6 +437,10 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv, const
     }
 
     LOG_INFO("CPU Optimisation state: {}", emuenv.cfg.current_config.cpu_opt);
+    LOG_INFO("Fast import dispatch: {}", emuenv.cfg.fast_import_dispatch);
+    LOG_INFO("Fast lightweight mutexes: {}", emuenv.cfg.fast_lwmutex);
+    LOG_INFO("Shared JIT cache: {}", emuenv.cfg.shared_jit_cache);
+    LOG_INFO("Persistent JIT cache: {}", emuenv.cfg.persistent_jit_cache);
     LOG_INFO("ngs state: {}", emuenv.cfg.current_config.ngs_enable);
     LOG_INFO("Resolution multiplier: {}", emuenv.cfg.resolution_multiplier);
 
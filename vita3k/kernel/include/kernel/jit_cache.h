@@ -0,0 +1,87 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <cpu/common.h>
+#include <mem/util.h>
+#include <util/fs.h>
+#include <util/types.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct MemState;
+
+/**
+ * @brief Persistent list of the blocks the JIT translated for each loaded module
+ *
+ * Dynarmic cannot serialize its generated code, so what is kept on disk is the set of
+ * entry points it translated, keyed by a hash of the module code. On the next boot of the
+ * same module these entry points are translated in the background before the guest reaches them.
+ */
+class JitCache {
+public:
+    struct CodeRange {
+        Address start;
+        uint32_t size;
+    };
+
+    ~JitCache();
+
+    void init(const fs::path &path, MemState &mem, bool cpu_opt, const CPUPoolPtr &pool);
+    // Stop translating in the background and save every module
+    void deinit();
+    bool enabled() const { return !path.empty(); }
+
+    void add_module(SceUID uid, const std::vector<CodeRange> &ranges);
+    void remove_module(SceUID uid);
+
+    void record(const JitEntryPoint &entry);
+    void invalidate(Address start, size_t length);
+
+private:
+    struct Module {
+        uint64_t hash = 0;
+        std::vector<CodeRange> ranges;
+        std::set<JitEntryPoint> entries;
+        bool dirty = false;
+
+        bool contains(Address address) const;
+    };
+
+    fs::path path;
+    MemState *mem = nullptr;
+    bool cpu_opt = false;
+    CPUPoolPtr pool;
+
+    std::mutex mutex;
+    std::map<SceUID, Module> modules;
+
+    std::thread worker;
+    std::condition_variable work_cond;
+    std::deque<std::vector<JitEntryPoint>> work;
+    bool stop_worker = false;
+
+    void save(const Module &module) const;
+    void worker_loop();
+};
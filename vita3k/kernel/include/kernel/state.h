@@ -20,8 +20,10 @@
 #include <cpu/common.h>
 #include <kernel/callback.h>
 #include <kernel/debugger.h>
+#include <kernel/jit_cache.h>
 #include <kernel/object_store.h>
 #include <kernel/sync_primitives.h>
+#include <kernel/timer_wheel.h>
 #include <kernel/types.h>
 #include <mem/allocator.h>
 #include <mem/block.h>
@@ -29,6 +31,7 @@
 #include <mem/util.h>
 #include <rtc/rtc.h>
 #include <util/containers.h>
+#include <util/object_table.h>
 #include <util/types.h>
 
 #include <emuenv/app_launch_request.h>
@@ -56,7 +59,7 @@ typedef std::shared_ptr<KernelModule> SceKernelModulePtr;
 typedef std::shared_ptr<ThreadState> ThreadStatePtr;
 typedef std::map<SceUID, CodecEngineBlock> CodecEngineBlocks;
 typedef std::map<SceUID, Ptr<Ptr<void>>> SlotToAddress;
-typedef std::map<SceUID, ThreadStatePtr> ThreadStatePtrs;
+typedef ObjectTable<ThreadState> ThreadStatePtrs;
 typedef std::map<SceUID, SceKernelModulePtr> SceKernelModuleInfoPtrs;
 typedef std::map<SceUID, CallbackPtr> CallbackPtrs;
 typedef unordered_map_fast<uint32_t, Address> ExportNids;
@@ -93,6 +96,17 @@ typedef std::multimap<uint32_t, Address> FuncBindingInfos;
 
 typedef std::map<uint32_t, uint32_t> ModuleUidByNid;
 
+struct ImportCallStats {
+    // calls handled from inside the JIT without halting it
+    std::atomic<uint64_t> fast_calls{ 0 };
+    // calls which halted the JIT and went through the thread run loop
+    std::atomic<uint64_t> slow_calls{ 0 };
+    // set once the import is known to need the run loop (it runs guest code, swaps the cpu context...)
+    std::atomic<bool> halt_required{ false };
+};
+
+typedef std::map<uint32_t, ImportCallStats> ImportCallStatsMap;
+
 struct KernelState {
     KernelState();
 
@@ -136,9 +150,24 @@ struct KernelState {
     ModuleUidByNid module_uid_by_nid;
 
     bool cpu_opt;
+    // Shared by all the threads if the JIT translation cache is shared, null otherwise
+    CPUPoolPtr cpu_pool;
+    // Entry points of the translated blocks, saved across boots. Disabled unless initialized.
+    JitCache jit_cache;
     CorenumAllocator corenum_allocator;
     CallImportFunc call_import;
 
+    // Call HLE imports directly from the SVC callback instead of halting the JIT on every import call
+    bool fast_import_dispatch = false;
+    std::mutex import_stats_mutex;
+    ImportCallStatsMap import_stats;
+
+    // Lock and unlock uncontended lightweight mutexes with an atomic on their guest work area, without the kernel objects
+    bool fast_lwmutex = false;
+
+    // Owns the timeouts of the waiting threads
+    TimerWheel timer_wheel;
+
     // Shared NOP+WFI sentinel used by the Dynarmic as the halt return address
     Block halt_instruction;
     Address halt_instruction_pc;
@@ -163,7 +192,7 @@ struct KernelState {
         return next_uid++;
     }
 
-    bool init(MemState &mem, const CallImportFunc &call_import, bool cpu_opt);
+    bool init(MemState &mem, const CallImportFunc &call_import, bool cpu_opt, std::size_t cpu_pool_size = 0);
     void deinit(MemState &mem);
     void load_process_param(MemState &mem, Ptr<uint32_t> ptr);
     ThreadStatePtr create_thread(MemState &mem, const char *name, Ptr<const void> entry_point = Ptr<const void>(0));
@@ -183,6 +212,11 @@ struct KernelState {
     // The registered process_exit_callback is invoked to notify the host layer.
     void request_process_exit(int res, std::optional<AppLaunchRequest> relaunch = std::nullopt);
 
+    ImportCallStats &get_import_stats(uint32_t nid);
+    void log_import_stats();
+    void log_lwmutex_stats();
+    void log_timer_wheel_stats();
+
     void set_memory_watch(bool enabled);
     void invalidate_jit_cache(Address start, size_t length);
     SceKernelModuleInfo *find_module_by_addr(Address address);
@@ -18,59 +18,15 @@
 #pragma once
 
 #include <kernel/thread/thread_data_queue.h>
+#include <kernel/thread/thread_state.h>
 #include <kernel/types.h>
 #include <util/byte_ring_buffer.h>
+#include <util/object_table.h>
 
-struct KernelState;
-
-struct WaitingThreadData {
-    ThreadStatePtr thread;
-    int32_t priority;
-    bool *was_canceled;
-
-    // additional fields for each primitive
-    union {
-        struct { // mutex
-            int32_t lock_count;
-        };
-        struct { // rwlock
-            bool is_write;
-        };
-        struct { // semaphore
-            int32_t signal;
-        };
-        struct { // simple events
-            int32_t pattern;
-            uint32_t *result_pattern;
-            uint64_t *user_data;
-        };
-        struct { // event flags
-            int32_t wait;
-            int32_t flags;
-            uint32_t *outBits;
-        };
-        // struct { }; // condvar
-        struct { // msgpipe
-            SceSize request_size;
-        } mp;
-    };
-
-    bool operator<(const WaitingThreadData &rhs) const {
-        return priority < rhs.priority;
-    }
-
-    bool operator>(const WaitingThreadData &rhs) const {
-        return priority > rhs.priority;
-    }
+#include <array>
+#include <atomic>
 
-    bool operator==(const WaitingThreadData &rhs) const {
-        return thread == rhs.thread;
-    }
-
-    bool operator==(const ThreadStatePtr &rhs) const {
-        return thread == rhs;
-    }
-};
+struct KernelState;
 
 typedef std::unique_ptr<ThreadDataQueue<WaitingThreadData>> WaitingThreadQueuePtr;
 
@@ -94,7 +50,7 @@ struct SimpleEvent : SyncPrimitive {
 };
 
 typedef std::shared_ptr<SimpleEvent> SimpleEventPtr;
-typedef std::map<SceUID, SimpleEventPtr> SimpleEventPtrs;
+typedef ObjectTable<SimpleEvent> SimpleEventPtrs;
 
 struct Timer : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -110,7 +66,7 @@ struct Timer : SyncPrimitive {
 };
 
 typedef std::shared_ptr<Timer> TimerPtr;
-typedef std::map<SceUID, TimerPtr> TimerPtrs;
+typedef ObjectTable<Timer> TimerPtrs;
 
 struct Semaphore : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -120,18 +76,33 @@ struct Semaphore : SyncPrimitive {
 };
 
 typedef std::shared_ptr<Semaphore> SemaphorePtr;
-typedef std::map<SceUID, SemaphorePtr> SemaphorePtrs;
+typedef ObjectTable<Semaphore> SemaphorePtrs;
+
+static constexpr size_t LWMUTEX_WAIT_BUCKETS = 16;
+
+// Contention of a lightweight mutex, recorded when the fast path is enabled
+struct LwMutexStats {
+    // locks which found the mutex owned by another thread and had to go through the kernel
+    std::atomic<uint64_t> contended_locks{ 0 };
+    std::atomic<uint64_t> timeouts{ 0 };
+    std::atomic<uint64_t> total_wait_us{ 0 };
+    // wait_histogram[i] counts the contended locks which waited less than 2^i microseconds (and at least 2^(i-1)),
+    // the last bucket counts all the longer waits
+    std::array<std::atomic<uint64_t>, LWMUTEX_WAIT_BUCKETS> wait_histogram{};
+};
 
 struct Mutex : SyncPrimitive {
     int init_count;
+    // With the lightweight mutex fast path, the owner and lock count of lightweight mutexes are only kept in their work area
     int lock_count;
     ThreadStatePtr owner;
     WaitingThreadQueuePtr waiting_threads;
     Ptr<SceKernelLwMutexWork> workarea;
+    LwMutexStats stats;
 };
 
 typedef std::shared_ptr<Mutex> MutexPtr;
-typedef std::map<SceUID, MutexPtr> MutexPtrs;
+typedef ObjectTable<Mutex> MutexPtrs;
 
 enum class RWLockState {
     Unlocked,
@@ -149,7 +120,7 @@ struct RWLock : SyncPrimitive {
 };
 
 typedef std::shared_ptr<RWLock> RWLockPtr;
-typedef std::map<SceUID, RWLockPtr> RWLockPtrs;
+typedef ObjectTable<RWLock> RWLockPtrs;
 
 struct EventFlag : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -157,7 +128,7 @@ struct EventFlag : SyncPrimitive {
 };
 
 typedef std::shared_ptr<EventFlag> EventFlagPtr;
-typedef std::map<SceUID, EventFlagPtr> EventFlagPtrs;
+typedef ObjectTable<EventFlag> EventFlagPtrs;
 
 struct Condvar : SyncPrimitive {
     struct SignalTarget {
@@ -181,7 +152,7 @@ struct Condvar : SyncPrimitive {
     MutexPtr associated_mutex;
 };
 typedef std::shared_ptr<Condvar> CondvarPtr;
-typedef std::map<SceUID, CondvarPtr> CondvarPtrs;
+typedef ObjectTable<Condvar> CondvarPtrs;
 
 struct MsgPipe : SyncPrimitive {
     MsgPipe(std::size_t bufSize)
@@ -198,7 +169,7 @@ struct MsgPipe : SyncPrimitive {
 };
 
 typedef std::shared_ptr<MsgPipe> MsgPipePtr;
-typedef std::map<SceUID, MsgPipePtr> MsgPipePtrs;
+typedef ObjectTable<MsgPipe> MsgPipePtrs;
 
 enum class SyncWeight {
     Light, // lightweight
@@ -226,10 +197,16 @@ SceUID mutex_create(SceUID *uid_out, KernelState &kernel, MemState &mem, const c
 SceUID mutex_find(KernelState &kernel, const char *export_name, const char *pName);
 int mutex_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int lock_count, unsigned int *timeout, SyncWeight weight);
 int mutex_try_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int lock_count, SyncWeight weight);
-int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight);
+int mutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight);
 int mutex_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight);
 MutexPtr mutex_get(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight);
 
+// Lightweight mutex, with the fast path the uncontended cases never look the mutex up
+int lwmutex_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, Ptr<SceKernelLwMutexWork> workarea, int lock_count, unsigned int *timeout, bool only_try);
+int lwmutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, Ptr<SceKernelLwMutexWork> workarea, int unlock_count);
+// Current owner (0 if none) and lock count of a lightweight mutex
+void lwmutex_get_owner(const KernelState &kernel, const MemState &mem, const Mutex &mutex, SceUID &owner_id, int &lock_count);
+
 // RWLock
 SceUID rwlock_create(KernelState &kernel, MemState &mem, const char *export_name, const char *name, SceUID thread_id, SceUInt32 attr);
 SceInt32 rwlock_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID lock_id, uint32_t *timeout, bool is_write);
@@ -17,256 +17,247 @@
 
 #pragma once
 
-#include <kernel/thread/thread_state.h>
+#include <util/types.h>
 
-#include <algorithm>
-#include <list>
-#include <set>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+struct ThreadState;
+typedef std::shared_ptr<ThreadState> ThreadStatePtr;
 
 template <typename T>
-class ThreadDataQueueInteratorBase {
-public:
-    virtual ~ThreadDataQueueInteratorBase() = default;
-    virtual bool operator==(const ThreadDataQueueInteratorBase &rhs) const = 0;
-    virtual ThreadDataQueueInteratorBase<T> &operator++() = 0;
-    virtual ThreadDataQueueInteratorBase<T> *clone() const = 0;
-    virtual T operator*() = 0;
-};
+class ThreadDataQueue;
+template <typename T>
+class ThreadDataQueueInterator;
 
+// Links of a thread data in a queue. The queues are intrusive: a pushed thread data is linked
+// in place, not copied, so it must stay alive (it is kept in the waiting ThreadState) until removed.
 template <typename T>
-class ThreadDataQueueInterator {
+class ThreadDataQueueNode {
 public:
-    ThreadDataQueueInterator(ThreadDataQueueInteratorBase<T> *base)
-        : _base(base) {
-    }
-
-    ~ThreadDataQueueInterator() {
-        delete _base;
-    }
-
-    ThreadDataQueueInterator(const ThreadDataQueueInterator<T> &o)
-        : _base(o._base->clone()) {
-    }
-
-    ThreadDataQueueInterator<T> &operator=(const ThreadDataQueueInterator<T> &o) {
-        if (this != std::addressof(o)) {
-            delete _base;
-            _base = o._base->clone();
-        }
+    ThreadDataQueueNode() = default;
+    // copies of a thread data are never linked
+    ThreadDataQueueNode(const ThreadDataQueueNode &) {}
+    ThreadDataQueueNode &operator=(const ThreadDataQueueNode &) {
         return *this;
     }
 
-    bool operator==(const ThreadDataQueueInterator<T> &rhs) const {
-        return *_base == *rhs._base;
-    }
-
-    bool operator!=(const ThreadDataQueueInterator<T> &rhs) const {
-        return !(*this == rhs);
-    }
-
-    ThreadDataQueueInterator<T> &operator++() {
-        ++(*_base);
-        return *this;
-    }
-
-    ThreadDataQueueInterator<T> operator++(int) {
-        auto last = _base->clone();
-        _base->operator++();
-        return ThreadDataQueueInterator<T>(last);
-    }
-
-    T operator*() {
-        return **_base;
-    }
-
-    ThreadDataQueueInteratorBase<T> *base() const {
-        return _base;
+    bool is_queued() const {
+        return queue != nullptr;
     }
 
 private:
-    ThreadDataQueueInteratorBase<T> *_base;
-};
+    friend class ThreadDataQueue<T>;
+    friend class ThreadDataQueueInterator<T>;
 
-template <typename T>
-class ThreadDataQueue {
-public:
-    virtual ThreadDataQueueInterator<T> begin() = 0;
-    virtual ThreadDataQueueInterator<T> end() = 0;
-    virtual void erase(const ThreadDataQueueInterator<T> &it) = 0;
-    virtual ThreadDataQueueInterator<T> push(const T &val) = 0;
-    virtual void pop() = 0;
-    virtual bool empty() = 0;
-    virtual size_t size() = 0;
-
-    virtual ThreadDataQueueInterator<T> find(const T &val) = 0;
-    virtual ThreadDataQueueInterator<T> find(const ThreadStatePtr &val) = 0;
-    virtual ~ThreadDataQueue() = default;
+    T *prev = nullptr;
+    T *next = nullptr;
+    const ThreadDataQueue<T> *queue = nullptr;
 };
 
-template <typename T>
-class FIFOThreadDataQueueInteratorBase : public ThreadDataQueueInteratorBase<T> {
-public:
-    FIFOThreadDataQueueInteratorBase(typename std::list<T>::iterator it)
-        : it(it) {
-    }
-
-    ~FIFOThreadDataQueueInteratorBase() override = default;
-
-    bool operator==(const ThreadDataQueueInteratorBase<T> &rhs) const override {
-        auto &casted = static_cast<const FIFOThreadDataQueueInteratorBase<T> &>(rhs);
-        return it == casted.it;
-    }
-
-    ThreadDataQueueInteratorBase<T> &operator++() override {
-        ++it;
-        return *this;
-    }
-
-    ThreadDataQueueInteratorBase<T> *clone() const override {
-        return new FIFOThreadDataQueueInteratorBase<T>(it);
-    }
-
-    T operator*() override {
-        return *it;
+struct WaitingThreadData : ThreadDataQueueNode<WaitingThreadData> {
+    ThreadStatePtr thread;
+    int32_t priority;
+    bool *was_canceled;
+
+    // additional fields for each primitive
+    union {
+        struct { // mutex
+            int32_t lock_count;
+        };
+        struct { // rwlock
+            bool is_write;
+        };
+        struct { // semaphore
+            int32_t signal;
+        };
+        struct { // simple events
+            int32_t pattern;
+            uint32_t *result_pattern;
+            uint64_t *user_data;
+        };
+        struct { // event flags
+            int32_t wait;
+            int32_t flags;
+            uint32_t *outBits;
+        };
+        // struct { }; // condvar
+        struct { // msgpipe
+            SceSize request_size;
+        } mp;
+    };
+
+    bool operator<(const WaitingThreadData &rhs) const {
+        return priority < rhs.priority;
+    }
+
+    bool operator>(const WaitingThreadData &rhs) const {
+        return priority > rhs.priority;
+    }
+
+    bool operator==(const WaitingThreadData &rhs) const {
+        return thread == rhs.thread;
+    }
+
+    bool operator==(const ThreadStatePtr &rhs) const {
+        return thread == rhs;
     }
-
-    typename std::list<T>::iterator it;
 };
 
 template <typename T>
-class FIFOThreadDataQueue : public ThreadDataQueue<T> {
+class ThreadDataQueueInterator {
 public:
-    FIFOThreadDataQueue() = default;
-
-    ThreadDataQueueInterator<T> begin() override {
-        return make_iterator(c.begin());
+    explicit ThreadDataQueueInterator(T *node = nullptr)
+        : node(node) {
     }
 
-    ThreadDataQueueInterator<T> end() override {
-        return make_iterator(c.end());
-    }
+    bool operator==(const ThreadDataQueueInterator<T> &rhs) const = default;
 
-    void erase(const ThreadDataQueueInterator<T> &it) override {
-        auto base = dynamic_cast<const FIFOThreadDataQueueInteratorBase<T> *>(it.base());
-        c.erase(base->it);
-    }
-
-    ThreadDataQueueInterator<T> push(const T &val) override {
-        c.push_back(val);
-        return make_iterator(--c.end());
-    }
-
-    void pop() override {
-        c.erase(c.begin());
-    }
-
-    size_t size() override {
-        return c.size();
+    ThreadDataQueueInterator<T> &operator++() {
+        node = node->next;
+        return *this;
     }
 
-    bool empty() override {
-        return c.empty();
+    ThreadDataQueueInterator<T> operator++(int) {
+        const ThreadDataQueueInterator<T> last = *this;
+        node = node->next;
+        return last;
     }
 
-    ThreadDataQueueInterator<T> find(const T &val) override {
-        auto it = std::find(c.begin(), c.end(), val);
-        return make_iterator(it);
+    T &operator*() const {
+        return *node;
     }
 
-    ThreadDataQueueInterator<T> find(const ThreadStatePtr &val) override {
-        auto it = std::find(c.begin(), c.end(), val);
-        return make_iterator(it);
+    T *operator->() const {
+        return node;
     }
 
 private:
-    ThreadDataQueueInterator<T> make_iterator(typename std::list<T>::iterator it) {
-        auto base = new FIFOThreadDataQueueInteratorBase<T>(it);
-        return ThreadDataQueueInterator<T>(base);
-    }
+    friend class ThreadDataQueue<T>;
 
-    std::list<T> c;
+    T *node;
 };
 
+/**
+ * @brief Intrusive queue of waiting threads
+ *
+ * Nothing is allocated: the queue links the thread data pushed to it, which the waiting threads keep in their ThreadState.
+ * The derived queues only decide where a new thread data is inserted.
+ */
 template <typename T>
-class PriorityThreadDataQueueInteratorBase : public ThreadDataQueueInteratorBase<T> {
+class ThreadDataQueue {
 public:
-    PriorityThreadDataQueueInteratorBase(typename std::multiset<T, std::greater<>>::iterator it)
-        : it(it) {
-    }
+    typedef ThreadDataQueueInterator<T> Iterator;
 
-    ~PriorityThreadDataQueueInteratorBase() override = default;
+    ThreadDataQueue() = default;
+    ThreadDataQueue(const ThreadDataQueue &) = delete;
+    ThreadDataQueue &operator=(const ThreadDataQueue &) = delete;
 
-    bool operator==(const ThreadDataQueueInteratorBase<T> &rhs) const override {
-        auto &casted = static_cast<const PriorityThreadDataQueueInteratorBase<T> &>(rhs);
-        return it == casted.it;
+    virtual ~ThreadDataQueue() {
+        while (head)
+            unlink(*head);
     }
 
-    ThreadDataQueueInteratorBase<T> &operator++() override {
-        ++it;
-        return *this;
+    Iterator begin() const {
+        return Iterator(head);
     }
 
-    ThreadDataQueueInteratorBase<T> *clone() const override {
-        return new PriorityThreadDataQueueInteratorBase<T>(it);
+    Iterator end() const {
+        return Iterator();
     }
 
-    T operator*() override {
-        return *it;
+    void erase(const Iterator &it) {
+        unlink(*it.node);
     }
 
-    typename std::multiset<T>::iterator it;
-};
-
-template <typename T>
-class PriorityThreadDataQueue : public ThreadDataQueue<T> {
-public:
-    PriorityThreadDataQueue() = default;
+    virtual Iterator push(T &val) = 0;
 
-    ThreadDataQueueInterator<T> begin() override {
-        return make_iterator(c.begin());
+    void pop() {
+        unlink(*head);
     }
 
-    ThreadDataQueueInterator<T> end() override {
-        return make_iterator(c.end());
+    bool empty() const {
+        return head == nullptr;
     }
 
-    void erase(const ThreadDataQueueInterator<T> &it) override {
-        auto base = dynamic_cast<const PriorityThreadDataQueueInteratorBase<T> *>(it.base());
-        c.erase(base->it);
+    size_t size() const {
+        return count;
     }
 
-    ThreadDataQueueInterator<T> push(const T &val) override {
-        auto it = c.insert(val);
-        return make_iterator(it);
+    Iterator find(const ThreadStatePtr &val) const {
+        T *node = head;
+        while (node && !(*node == val))
+            node = node->next;
+        return Iterator(node);
     }
 
-    void pop() override {
-        c.erase(c.begin());
+protected:
+    // Links val before the first queued thread data it goes before according to Order
+    template <typename Order>
+    Iterator insert(T &val) {
+        // search from the end, most threads waiting on the same object have the same priority
+        T *position = nullptr;
+        for (T *queued = tail; queued && Order::goes_before(val, *queued); queued = queued->prev)
+            position = queued;
+        return link_before(val, position);
     }
 
-    size_t size() override {
-        return c.size();
-    }
-
-    bool empty() override {
-        return c.empty();
-    }
+private:
+    // Links val before position, at the end of the queue if position is null
+    Iterator link_before(T &val, T *position) {
+        assert(!val.queue);
+        val.queue = this;
+        val.next = position;
+        val.prev = position ? position->prev : tail;
+        (val.prev ? val.prev->next : head) = &val;
+        (position ? position->prev : tail) = &val;
+        count++;
+        return Iterator(&val);
+    }
+
+    void unlink(T &val) {
+        assert(val.queue == this);
+        (val.prev ? val.prev->next : head) = val.next;
+        (val.next ? val.next->prev : tail) = val.prev;
+        val.prev = nullptr;
+        val.next = nullptr;
+        val.queue = nullptr;
+        count--;
+
+        // the queued thread data of a thread references the thread itself, release it last
+        const ThreadStatePtr thread = std::move(val.thread);
+    }
+
+    T *head = nullptr;
+    T *tail = nullptr;
+    size_t count = 0;
+};
 
-    ThreadDataQueueInterator<T> find(const T &val) override {
-        auto it = std::find(c.begin(), c.end(), val);
-        return make_iterator(it);
+struct FIFOOrder {
+    template <typename T>
+    static bool goes_before(const T &val, const T &queued) {
+        return false;
     }
+};
 
-    ThreadDataQueueInterator<T> find(const ThreadStatePtr &val) override {
-        auto it = std::find(c.begin(), c.end(), val);
-        return make_iterator(it);
+// Lower priority values first, in FIFO order for the same priority
+struct PriorityOrder {
+    template <typename T>
+    static bool goes_before(const T &val, const T &queued) {
+        return val < queued;
     }
+};
 
-private:
-    ThreadDataQueueInterator<T> make_iterator(typename std::multiset<T, std::greater<>>::iterator it) {
-        auto base = new PriorityThreadDataQueueInteratorBase<T>(it);
-        return ThreadDataQueueInterator<T>(base);
+template <typename T, typename Order>
+class OrderedThreadDataQueue final : public ThreadDataQueue<T> {
+public:
+    typename ThreadDataQueue<T>::Iterator push(T &val) override {
+        return this->template insert<Order>(val);
     }
-
-    std::multiset<T> c;
 };
+
+template <typename T>
+using FIFOThreadDataQueue = OrderedThreadDataQueue<T, FIFOOrder>;
+template <typename T>
+using PriorityThreadDataQueue = OrderedThreadDataQueue<T, PriorityOrder>;
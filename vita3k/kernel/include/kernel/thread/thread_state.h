@@ -19,9 +19,12 @@
 
 #include <cpu/state.h>
 #include <kernel/callback.h>
+#include <kernel/thread/thread_data_queue.h>
+#include <kernel/timer_wheel.h>
 #include <kernel/types.h>
 #include <mem/block.h>
 #include <mem/ptr.h>
+#include <util/containers.h>
 
 #include <condition_variable>
 #include <mutex>
@@ -33,6 +36,7 @@ struct CPUContext;
 struct ThreadState;
 struct ThreadParams;
 struct KernelState;
+struct ImportCallStats;
 
 typedef std::unique_ptr<CPUState, std::function<void(CPUState *)>> CPUStatePtr;
 typedef std::function<void(CPUState &, uint32_t, SceUID)> CallImport;
@@ -82,6 +86,10 @@ struct ThreadState {
     std::vector<CallbackPtr> callbacks;
     std::condition_variable status_cond;
     std::vector<std::shared_ptr<ThreadState>> waiting_threads;
+    // Linked in the queue of the sync object this thread waits for
+    WaitingThreadData wait_data;
+    // Timeout of the current wait, in the timer wheel of the kernel while pending
+    TimerWheelEntry timeout;
     uint32_t returned_value = 0;
 
     ThreadState() = delete;
@@ -108,12 +116,17 @@ struct ThreadState {
 
     void suspend();
     void resume(bool step = false);
+    void invalidate_jit_cache(Address start, size_t length);
     std::string log_stack_traceback() const;
 
 private:
     void push_arguments(const std::vector<uint32_t> &args);
     void dispatch_abort(CPUState &cpu);
 
+    // Called from the SVC callback when fast import dispatch is enabled
+    bool dispatch_import_in_jit(CPUState &cpu);
+    ImportCallStats &get_import_stats(uint32_t nid);
+
     KernelState &kernel;
 
     CPUContext init_cpu_ctx;
@@ -130,6 +143,14 @@ private:
     // frame alive (run_loop()) while parked dormant; callbacks add nested frames.
     int call_level = 0;
 
+    // Set while an import is running from inside the JIT of this thread. The JIT can't be re-entered
+    // at that point, so guest callbacks are run on jit_callback_cpu instead.
+    bool in_jit_import = false;
+    bool jit_import_ran_guest_code = false;
+    CPUStatePtr jit_callback_cpu;
+    // Local cache of the kernel import stats, only accessed by this thread
+    unordered_map_fast<uint32_t, ImportCallStats *> import_stats_cache;
+
     // when calling sceKernelStartThread
     bool run_start_callback = false;
     // when calling sceKernelExitThread or sceKernelExitDeleteThread
@@ -0,0 +1,139 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class TimerWheel;
+
+// A timeout of a waiting thread, kept in its ThreadState and linked in the timer wheel while pending
+class TimerWheelEntry {
+public:
+    TimerWheelEntry() = default;
+    TimerWheelEntry(const TimerWheelEntry &) = delete;
+    TimerWheelEntry &operator=(const TimerWheelEntry &) = delete;
+
+    // Only valid with the mutex given to TimerWheel::schedule locked
+    bool expired() const {
+        return fired;
+    }
+
+private:
+    friend class TimerWheel;
+
+    enum class State {
+        Idle,
+        Pending,
+        // removed from the wheel, the waiting thread is being woken
+        Firing,
+    };
+
+    TimerWheelEntry *prev = nullptr;
+    TimerWheelEntry *next = nullptr;
+    uint64_t deadline = 0;
+    State state = State::Idle;
+    bool fired = false;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    std::mutex *mutex = nullptr;
+    std::condition_variable *cond = nullptr;
+};
+
+static constexpr size_t TIMER_WAKE_ERROR_BUCKETS = 16;
+
+struct TimerWheelStats {
+    std::atomic<uint64_t> scheduled{ 0 };
+    // timeouts canceled before their deadline, the waiting thread was woken by the primitive
+    std::atomic<uint64_t> canceled{ 0 };
+    std::atomic<uint64_t> expired{ 0 };
+    std::atomic<uint64_t> total_wake_error_us{ 0 };
+    std::atomic<uint64_t> max_wake_error_us{ 0 };
+    // wake_error_histogram[i] counts the expired timeouts whose waiting thread woke up less than 2^i microseconds
+    // (and at least 2^(i-1)) after the requested deadline, the last bucket counts all the later wake-ups
+    std::array<std::atomic<uint64_t>, TIMER_WAKE_ERROR_BUCKETS> wake_error_histogram{};
+};
+
+/**
+ * @brief Hierarchical timer wheel owning the timeouts of the waiting threads
+ *
+ * A single host thread sleeps until the earliest deadline and wakes the threads whose timeout expired,
+ * instead of every waiting thread arming its own OS timer with condition_variable::wait_for.
+ * Deadlines have a one microsecond resolution: each level has 64 slots, a slot of a level covering a whole
+ * turn of the level below it. Scheduling and canceling a timeout are O(1) and never allocate.
+ */
+class TimerWheel {
+public:
+    ~TimerWheel();
+
+    // Current time of the wheel in microseconds, on the steady clock
+    static uint64_t now();
+
+    // Sets entry.expired() and notifies cond with mutex locked once deadline is reached. mutex must be locked by the caller.
+    void schedule(TimerWheelEntry &entry, uint64_t deadline, std::mutex &mutex, std::condition_variable &cond);
+    // Removes the entry from the wheel if it is still pending, returns true and records the wake-up error if it expired.
+    // lock is the lock of the mutex given to schedule, it is released while the wheel is still waking the thread.
+    // Must be called after every schedule, before the entry and the mutex can be destroyed.
+    bool cancel(TimerWheelEntry &entry, std::unique_lock<std::mutex> &lock);
+
+    // Stops the wheel thread and expires the pending timeouts. It is started again by the next schedule.
+    void stop();
+
+    TimerWheelStats stats;
+
+private:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+    // 2^30 us, about 18 minutes. Later deadlines are put in the last slot and moved again when it is reached.
+    static constexpr uint32_t LEVELS = 5;
+
+    struct Level {
+        std::array<TimerWheelEntry *, SLOTS> slots{};
+        // bit i set if slots[i] is not empty
+        uint64_t occupied = 0;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    // notified when entries are done firing, for cancel
+    std::condition_variable fired_cond;
+    std::thread thread;
+    bool stopping = false;
+    // deadline the wheel thread sleeps until, 0 while it is awake
+    uint64_t sleeping_until = 0;
+
+    std::array<Level, LEVELS> levels;
+    // next tick (microsecond) to process, the deadlines of all the pending entries are at or after it
+    uint64_t current = 0;
+    size_t pending = 0;
+
+    void insert(TimerWheelEntry &entry);
+    void unlink(TimerWheelEntry &entry);
+    // First tick at or after current where an entry expires or a slot must be moved to a lower level
+    uint64_t next_tick() const;
+    // Processes the ticks up to time, returns the expired entries
+    TimerWheelEntry *advance(uint64_t time);
+    // Wakes the threads of the expired entries, lock is the lock of the wheel mutex
+    void fire(TimerWheelEntry *expired, std::unique_lock<std::mutex> &lock);
+    void run();
+};
@@ -673,14 +673,17 @@ struct SceKernelLMOption {
     SceSize size;
 };
 
-// We only use workarea for uid
+// We only use workarea for uid, and for the lock itself with the lightweight mutex fast path:
+// owner is then the owner thread id, with its high bit set while threads wait for the mutex
 struct SceKernelLwMutexWork {
     std::uint32_t owner;
     std::uint32_t unknown0;
     std::uint32_t lockCount;
     std::uint32_t attr;
     SceUID uid;
-    std::uint32_t unknown1[3];
+    // number of locks taken without contention with the fast path, for profiling
+    std::uint32_t fastLockCount;
+    std::uint32_t unknown1[2];
 };
 
 static_assert(sizeof(SceKernelLwMutexWork) == 32, "Incorrect size");
@@ -0,0 +1,219 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/jit_cache.h>
+
+#include <cpu/functions.h>
+#include <cpu/state.h>
+#include <mem/ptr.h>
+#include <util/log.h>
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <cstring>
+
+static constexpr uint32_t JIT_CACHE_MAGIC = 0x4354494A; // 'JITC'
+static constexpr uint32_t JIT_CACHE_VERSION = 1;
+// Entry points are translated in batches so that deinit does not have to wait for a whole module
+static constexpr size_t PRETRANSLATE_BATCH_SIZE = 256;
+
+struct JitCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+};
+
+struct JitCacheEntry {
+    uint32_t pc;
+    uint32_t fpscr;
+    uint32_t thumb;
+};
+
+static fs::path get_module_path(const fs::path &path, uint64_t hash) {
+    return path / fmt::format("{:016X}.bin", hash);
+}
+
+bool JitCache::Module::contains(Address address) const {
+    for (const auto &range : ranges) {
+        if (address >= range.start && address - range.start < range.size)
+            return true;
+    }
+    return false;
+}
+
+JitCache::~JitCache() {
+    deinit();
+}
+
+void JitCache::init(const fs::path &path, MemState &mem, bool cpu_opt, const CPUPoolPtr &pool) {
+    this->path = path;
+    this->mem = &mem;
+    this->cpu_opt = cpu_opt;
+    this->pool = pool;
+
+    fs::create_directories(path);
+
+    // translating ahead of time is only useful if the threads share the translated code
+    if (pool) {
+        stop_worker = false;
+        worker = std::thread(&JitCache::worker_loop, this);
+    }
+}
+
+void JitCache::deinit() {
+    if (!enabled())
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stop_worker = true;
+        work.clear();
+    }
+    work_cond.notify_one();
+    // the worker can be waiting for a jit kept by a thread blocked in an import
+    if (pool)
+        cancel_pretranslation(*pool);
+    if (worker.joinable())
+        worker.join();
+
+    for (const auto &[_, module] : modules) {
+        if (module.dirty)
+            save(module);
+    }
+    modules.clear();
+    pool.reset();
+    path.clear();
+}
+
+void JitCache::add_module(SceUID uid, const std::vector<CodeRange> &ranges) {
+    if (!enabled())
+        return;
+
+    Module module;
+    module.ranges = ranges;
+    // the seed also covers the load address, entries of a module relocated somewhere else are useless
+    for (const auto &range : ranges)
+        module.hash = XXH3_64bits_withSeed(Ptr<const uint8_t>(range.start).get(*mem), range.size, module.hash ^ range.start);
+
+    std::vector<uint8_t> data;
+    if (fs_utils::read_data(get_module_path(path, module.hash), data) && data.size() >= sizeof(JitCacheHeader)) {
+        JitCacheHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        if (header.magic == JIT_CACHE_MAGIC && header.version == JIT_CACHE_VERSION
+            && data.size() == sizeof(header) + header.count * sizeof(JitCacheEntry)) {
+            const auto *entries = reinterpret_cast<const JitCacheEntry *>(data.data() + sizeof(header));
+            for (uint32_t i = 0; i < header.count; i++) {
+                if (module.contains(entries[i].pc))
+                    module.entries.insert({ entries[i].pc, entries[i].fpscr, entries[i].thumb != 0 });
+            }
+        } else {
+            LOG_WARN("Ignoring invalid JIT cache file for module hash {:016X}", module.hash);
+        }
+    }
+
+    LOG_INFO("JIT cache: {} entry point(s) known for module {} (hash {:016X})", module.entries.size(), uid, module.hash);
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (worker.joinable() && !module.entries.empty()) {
+        for (auto it = module.entries.begin(); it != module.entries.end();) {
+            auto &batch = work.emplace_back();
+            for (; it != module.entries.end() && batch.size() < PRETRANSLATE_BATCH_SIZE; ++it)
+                batch.push_back(*it);
+        }
+        work_cond.notify_one();
+    }
+    modules[uid] = std::move(module);
+}
+
+void JitCache::remove_module(SceUID uid) {
+    if (!enabled())
+        return;
+
+    Module module;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        const auto it = modules.find(uid);
+        if (it == modules.end())
+            return;
+        module = std::move(it->second);
+        modules.erase(it);
+    }
+
+    if (module.dirty)
+        save(module);
+}
+
+void JitCache::record(const JitEntryPoint &entry) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (auto &[_, module] : modules) {
+        if (module.contains(entry.pc)) {
+            if (module.entries.insert(entry).second)
+                module.dirty = true;
+            return;
+        }
+    }
+}
+
+void JitCache::invalidate(Address start, size_t length) {
+    if (!enabled())
+        return;
+
+    // the code there changed, a block translated from the original code may not even be valid anymore
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (auto &[_, module] : modules) {
+        const auto first = module.entries.lower_bound({ start, 0, false });
+        auto last = first;
+        while (last != module.entries.end() && last->pc - start < length)
+            ++last;
+        if (first != last) {
+            module.entries.erase(first, last);
+            module.dirty = true;
+        }
+    }
+}
+
+void JitCache::save(const Module &module) const {
+    std::vector<uint8_t> data(sizeof(JitCacheHeader) + module.entries.size() * sizeof(JitCacheEntry));
+    const JitCacheHeader header{ JIT_CACHE_MAGIC, JIT_CACHE_VERSION, static_cast<uint32_t>(module.entries.size()) };
+    memcpy(data.data(), &header, sizeof(header));
+
+    auto *entries = reinterpret_cast<JitCacheEntry *>(data.data() + sizeof(header));
+    for (const auto &entry : module.entries)
+        *entries++ = { entry.pc, entry.fpscr, entry.thumb };
+
+    fs_utils::dump_data(get_module_path(path, module.hash), data.data(), data.size());
+}
+
+void JitCache::worker_loop() {
+    // this cpu never runs guest code, it is only used to drive the translation in every jit of the pool
+    const CPUStatePtr cpu = init_cpu(cpu_opt, 0, 0, *mem, pool);
+
+    while (true) {
+        std::vector<JitEntryPoint> entries;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_cond.wait(lock, [this] { return stop_worker || !work.empty(); });
+            if (stop_worker)
+                return;
+            entries = std::move(work.front());
+            work.pop_front();
+        }
+
+        pretranslate(*cpu, entries);
+    }
+}
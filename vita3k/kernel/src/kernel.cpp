@@ -27,12 +27,16 @@
 
 #include <cpu/functions.h>
 #include <mem/ptr.h>
+#include <nids/functions.h>
 #include <util/lock_and_find.h>
 #include <util/log.h>
 
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_thread.h>
 
+#include <algorithm>
+#include <string_view>
+
 int CorenumAllocator::new_corenum() {
     const std::lock_guard<std::mutex> guard(lock);
 
@@ -88,12 +92,14 @@ KernelState::KernelState()
     : debugger(*this) {
 }
 
-bool KernelState::init(MemState &mem, const CallImportFunc &call_import, bool cpu_opt) {
+bool KernelState::init(MemState &mem, const CallImportFunc &call_import, bool cpu_opt, std::size_t cpu_pool_size) {
     corenum_allocator.set_max_core_count(MAX_CORE_COUNT);
     start_tick = rtc_get_ticks(rtc_base_ticks());
     base_tick = { rtc_base_ticks() };
     this->call_import = call_import;
     this->cpu_opt = cpu_opt;
+    if (cpu_pool_size > 0)
+        cpu_pool = init_cpu_pool(cpu_opt, cpu_pool_size, mem);
 
     // Generate halt instruction (NOP + WFI)
     halt_instruction = alloc_block(mem, 4, "halt_instruction");
@@ -131,10 +137,87 @@ void KernelState::set_memory_watch(bool enabled) {
     }
 }
 
+ImportCallStats &KernelState::get_import_stats(uint32_t nid) {
+    const std::lock_guard<std::mutex> lock(import_stats_mutex);
+    const auto [it, inserted] = import_stats.try_emplace(nid);
+    if (inserted) {
+        // fiber functions swap the whole context of the calling cpu, let the run loop reload it
+        if (std::string_view(import_name(nid)).starts_with("sceFiber"))
+            it->second.halt_required = true;
+    }
+    return it->second;
+}
+
+void KernelState::log_import_stats() {
+    const std::lock_guard<std::mutex> lock(import_stats_mutex);
+    if (import_stats.empty())
+        return;
+
+    std::vector<std::pair<uint32_t, uint64_t>> nids_by_calls;
+    uint64_t total_fast = 0;
+    uint64_t total_slow = 0;
+    for (const auto &[nid, stats] : import_stats) {
+        total_fast += stats.fast_calls;
+        total_slow += stats.slow_calls;
+        nids_by_calls.emplace_back(nid, stats.fast_calls + stats.slow_calls);
+    }
+    std::sort(nids_by_calls.begin(), nids_by_calls.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    constexpr size_t MAX_LOGGED_IMPORTS = 32;
+    LOG_INFO("Import calls: {} in-JIT, {} through the run loop", total_fast, total_slow);
+    for (size_t i = 0; i < std::min(nids_by_calls.size(), MAX_LOGGED_IMPORTS); i++) {
+        const uint32_t nid = nids_by_calls[i].first;
+        const ImportCallStats &stats = import_stats.at(nid);
+        LOG_INFO("{} {}: {} in-JIT, {} through the run loop{}", log_hex(nid), import_name(nid), stats.fast_calls.load(), stats.slow_calls.load(), stats.halt_required ? " (halt required)" : "");
+    }
+}
+
+void KernelState::log_lwmutex_stats() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::vector<MutexPtr> contended;
+    for (const auto &[_, lwmutex] : lwmutexes) {
+        if (lwmutex->stats.contended_locks > 0)
+            contended.push_back(lwmutex);
+    }
+    if (contended.empty())
+        return;
+    std::sort(contended.begin(), contended.end(), [](const auto &a, const auto &b) { return a->stats.total_wait_us > b->stats.total_wait_us; });
+
+    constexpr size_t MAX_LOGGED_LWMUTEXES = 16;
+    LOG_INFO("{} contended lightweight mutex(es)", contended.size());
+    for (size_t i = 0; i < std::min(contended.size(), MAX_LOGGED_LWMUTEXES); i++) {
+        const LwMutexStats &stats = contended[i]->stats;
+        std::string histogram;
+        for (const auto &bucket : stats.wait_histogram)
+            histogram += fmt::format(" {}", bucket.load());
+        LOG_INFO("{} \"{}\": {} contended lock(s), {} timeout(s), {} us waited, wait histogram (log2 us):{}",
+            contended[i]->uid, contended[i]->name, stats.contended_locks.load(), stats.timeouts.load(), stats.total_wait_us.load(), histogram);
+    }
+}
+
+void KernelState::log_timer_wheel_stats() {
+    const TimerWheelStats &stats = timer_wheel.stats;
+    if (stats.scheduled == 0)
+        return;
+
+    std::string histogram;
+    for (const auto &bucket : stats.wake_error_histogram)
+        histogram += fmt::format(" {}", bucket.load());
+    const uint64_t expired = stats.expired;
+    LOG_INFO("Timer wheel: {} timeout(s), {} canceled early, {} expired, {} us average and {} us max wake-up delay, wake-up delay histogram (log2 us):{}",
+        stats.scheduled.load(), stats.canceled.load(), expired, expired ? stats.total_wake_error_us / expired : 0, stats.max_wake_error_us.load(), histogram);
+}
+
 void KernelState::invalidate_jit_cache(Address start, size_t length) {
+    jit_cache.invalidate(start, length);
+    if (cpu_pool) {
+        ::invalidate_jit_cache(*cpu_pool, start, length);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex);
     for (const auto &[_, thread] : threads) {
-        ::invalidate_jit_cache(*thread->cpu, start, length);
+        thread->invalidate_jit_cache(start, length);
     }
 }
 
@@ -220,6 +303,30 @@ void KernelState::deinit(MemState &mem) {
     process_exit();
     threads.clear();
 
+    if (fast_import_dispatch)
+        log_import_stats();
+    if (fast_lwmutex)
+        log_lwmutex_stats();
+    // the threads still in a timed wait time out now
+    timer_wheel.stop();
+    log_timer_wheel_stats();
+    const JitStats jit_stats = get_jit_stats();
+    LOG_INFO("JIT: {} Dynarmic instance(s) alive reserving {} MiB of code cache, {} blocks translated",
+        jit_stats.jit_count, jit_stats.code_cache_size / (1024 * 1024), jit_stats.translated_blocks);
+    if (jit_stats.pretranslated_blocks > 0) {
+        // running blocks are translated the same way, their translation time is estimated from the ahead of time one
+        const double ms_per_block = jit_stats.pretranslation_ns / 1e6 / jit_stats.pretranslated_blocks;
+        LOG_INFO("JIT: {} blocks translated ahead of time in {:.1f} ms, all the translations took about {:.1f} ms",
+            jit_stats.pretranslated_blocks, jit_stats.pretranslation_ns / 1e6, ms_per_block * jit_stats.translated_blocks);
+    }
+    // the cache translates in the background with the pool, it must be stopped first
+    jit_cache.deinit();
+    cpu_pool.reset();
+    {
+        const std::lock_guard<std::mutex> lock(import_stats_mutex);
+        import_stats.clear();
+    }
+
     simple_events.clear();
     timers.clear();
     semaphores.clear();
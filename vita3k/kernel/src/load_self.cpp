@@ -772,6 +772,14 @@ SceUID load_self(KernelState &kernel, MemState &mem, const void *self, const std
         const std::lock_guard<std::mutex> lock(kernel.mutex);
         kernel.loaded_modules[uid] = kernelModuleInfo;
     }
+    if (kernel.jit_cache.enabled()) {
+        std::vector<JitCache::CodeRange> code_ranges;
+        for (const auto &[seg_index, segment] : segment_reloc_info) {
+            if (segments[seg_index].p_flags & PF_X)
+                code_ranges.push_back({ segment.addr, segments[seg_index].p_filesz });
+        }
+        kernel.jit_cache.add_module(uid, code_ranges);
+    }
     {
         const std::lock_guard<std::mutex> guard(kernel.export_nids_mutex);
         kernel.module_uid_by_nid[module_info->module_nid] = uid;
@@ -802,6 +810,9 @@ int unload_self(KernelState &kernel, MemState &mem, KernelModule &module) {
 
     SceUID mod_nid = module_info->module_nid;
 
+    // save the entry points before the invalidation below drops them
+    kernel.jit_cache.remove_module(module.info.modid);
+
     // last step: free the memory
     for (int i = 0; i < MODULE_INFO_NUM_SEGMENTS; i++) {
         const auto &segment = module.info.segments[i];
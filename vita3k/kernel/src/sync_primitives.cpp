@@ -23,6 +23,8 @@
 #include <util/lock_and_find.h>
 #include <util/log.h>
 
+#include <bit>
+
 static constexpr bool LOG_SYNC_PRIMITIVES = false;
 
 // ***********
@@ -82,12 +84,15 @@ inline static int handle_timeout(KernelState &kernel, const ThreadStatePtr &thre
     const ThreadDataQueueInterator<WaitingThreadData> &data_it, const char *export_name,
     SceUInt *const timeout) {
     if (timeout) {
-        bool status = false;
         auto start = std::chrono::steady_clock::now();
         if (*timeout > 0) {
-            status = thread->status_cond.wait_for(primitive_lock, std::chrono::microseconds{ *timeout }, [&] { return thread->status == ThreadStatus::run; });
+            kernel.timer_wheel.schedule(thread->timeout, TimerWheel::now() + *timeout, *primitive_lock.mutex(), thread->status_cond);
+            thread->status_cond.wait(primitive_lock, [&] { return thread->status == ThreadStatus::run || thread->timeout.expired(); });
+            kernel.timer_wheel.cancel(thread->timeout, primitive_lock);
         }
 
+        // the thread may have been woken while its timeout expired, it is then no longer waiting
+        const bool status = thread->status == ThreadStatus::run;
         if (!status) {
             *timeout = 0; // Time run out, so remaining time is 0
 
@@ -111,9 +116,26 @@ inline static int handle_timeout(KernelState &kernel, const ThreadStatePtr &thre
         thread->status_cond.wait(primitive_lock, [&] { return thread->status == ThreadStatus::run; });
     }
 
+    // The threads handing the primitive over unlink the thread data before waking the thread. exit_delete()
+    // wakes it without the primitive lock (taken before the thread lock), the thread then unlinks itself.
+    if (data_it->is_queued()) {
+        queue->erase(data_it);
+        return RET_ERROR(SCE_KERNEL_ERROR_WAIT_CANCEL);
+    }
+
     return SCE_KERNEL_OK;
 }
 
+// Set in the owner word of a lightweight mutex work area while threads wait for it,
+// so that the owner goes through the kernel to hand the mutex over when unlocking it
+static constexpr uint32_t LWMUTEX_CONTENDED = 0x80000000;
+
+// The owner word of the guest work area is the lock itself with the lightweight mutex fast path
+inline static std::atomic<uint32_t> &lwmutex_owner(SceKernelLwMutexWork *workarea) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free);
+    return *reinterpret_cast<std::atomic<uint32_t> *>(&workarea->owner);
+}
+
 // *****************
 // * Simple events *
 // *****************
@@ -185,7 +207,7 @@ SceInt32 simple_event_waitorpoll(KernelState &kernel, const char *export_name, S
         std::unique_lock<std::mutex> thread_lock(thread->mutex);
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.result_pattern = result_pattern;
         data.user_data = user_data;
@@ -452,7 +474,7 @@ SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID t
     } else if (is_wait) {
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.result_pattern = result_pattern;
         data.user_data = user_data;
@@ -460,21 +482,23 @@ SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID t
 
         const auto data_it = timer->waiting_threads->push(data);
 
-        bool got_event = false;
-        while (!got_event) {
-            uint64_t wait_time = timer->next_event - current_time;
-            // wait before we got an event and we are the first thread in the waiting list
-            timer->condvar.wait_for(lock, std::chrono::microseconds(wait_time), [&] {
-                return thread->status == ThreadStatus::run
-                    || (*timer->waiting_threads->begin()).thread->id == thread_id;
-            });
+        while (true) {
+            // only the first thread in the waiting list waits for the next event, the others wait for their turn
+            if (timer->waiting_threads->begin() == data_it) {
+                current_time = get_current_time();
+                if (timer->event_set || current_time >= timer->next_event)
+                    break;
+                if (timer->next_event != std::numeric_limits<uint64_t>::max())
+                    kernel.timer_wheel.schedule(thread->timeout, TimerWheel::now() + (timer->next_event - current_time), timer->mutex, timer->condvar);
+            }
+            timer->condvar.wait(lock);
+            // timer_set or timer_start may have moved the next event, it is scheduled again
+            kernel.timer_wheel.cancel(thread->timeout, lock);
             if (thread->status == ThreadStatus::run) {
                 timer->waiting_threads->erase(data_it);
                 timer->condvar.notify_all();
                 return SCE_KERNEL_ERROR_WAIT_CANCEL;
             }
-            current_time = get_current_time();
-            got_event = timer->event_set || current_time > timer->next_event;
         }
 
         timer->waiting_threads->pop();
@@ -579,7 +603,10 @@ SceUID mutex_create(SceUID *uid_out, KernelState &kernel, MemState &mem, const c
         workarea_mem->lockCount = init_count;
         if (workarea_mem->lockCount)
             workarea_mem->owner = thread_id;
+        else if (kernel.fast_lwmutex)
+            workarea_mem->owner = 0;
         workarea_mem->attr = attr;
+        workarea_mem->fastLockCount = 0;
     }
 
     const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
@@ -617,7 +644,132 @@ SceUID mutex_find(KernelState &kernel, const char *export_name, const char *pNam
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
 
+// Lightweight mutex fast path: the owner word of the work area is taken with a CAS, the kernel object is only used
+// to sleep when another thread owns it
+static int lwmutex_lock_fast(KernelState &kernel, const char *export_name, SceUID thread_id, int lock_count, SceKernelLwMutexWork *workarea, const MutexPtr &mutex, SceUInt *timeout, bool only_try) {
+    std::atomic<uint32_t> &owner = lwmutex_owner(workarea);
+
+    uint32_t current = 0;
+    if (owner.compare_exchange_strong(current, thread_id, std::memory_order_acquire)) {
+        workarea->lockCount = lock_count;
+        workarea->fastLockCount++;
+        return SCE_KERNEL_OK;
+    }
+
+    // Owned by ourselves
+    if ((current & ~LWMUTEX_CONTENDED) == static_cast<uint32_t>(thread_id)) {
+        if (workarea->attr & SCE_KERNEL_MUTEX_ATTR_RECURSIVE) {
+            workarea->lockCount += lock_count;
+            return SCE_KERNEL_OK;
+        }
+        return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_RECURSIVE);
+    }
+
+    // Don't sleep if only_try is set
+    if (only_try)
+        return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_FAILED_TO_OWN);
+
+    MutexPtr found_mutex = mutex;
+    if (!found_mutex) {
+        if (auto error = find_mutex(found_mutex, nullptr, kernel, export_name, workarea->uid, SyncWeight::Light))
+            return error;
+    }
+
+    const ThreadStatePtr thread = kernel.get_thread(thread_id);
+    std::unique_lock<std::mutex> mutex_lock(found_mutex->mutex);
+
+    // Flag the mutex as contended, unless it was released in the meantime
+    current = owner.load(std::memory_order_relaxed);
+    while (!(current & LWMUTEX_CONTENDED)) {
+        if (current == 0) {
+            if (owner.compare_exchange_weak(current, thread_id, std::memory_order_acquire)) {
+                workarea->lockCount = lock_count;
+                return SCE_KERNEL_OK;
+            }
+        } else if (owner.compare_exchange_weak(current, current | LWMUTEX_CONTENDED, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    LwMutexStats &stats = found_mutex->stats;
+    stats.contended_locks++;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Sleep thread! The owner gives us the mutex when unlocking it
+    std::unique_lock<std::mutex> thread_lock(thread->mutex);
+    thread->update_status(ThreadStatus::wait, ThreadStatus::run);
+
+    WaitingThreadData &data = thread->wait_data;
+    data.thread = thread;
+    data.lock_count = lock_count;
+    data.priority = thread->priority;
+
+    const auto data_it = found_mutex->waiting_threads->push(data);
+    thread_lock.unlock();
+
+    const int res = handle_timeout(kernel, thread, thread_lock, mutex_lock, found_mutex->waiting_threads, data_it, export_name, timeout);
+    if (res != SCE_KERNEL_OK) {
+        stats.timeouts++;
+        // we were the last waiter, let the owner unlock without the kernel again
+        if (found_mutex->waiting_threads->empty())
+            owner.fetch_and(~LWMUTEX_CONTENDED, std::memory_order_relaxed);
+    }
+
+    const uint64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    stats.total_wait_us += wait_us;
+    stats.wait_histogram[std::min<size_t>(std::bit_width(wait_us), LWMUTEX_WAIT_BUCKETS - 1)]++;
+
+    return res;
+}
+
+static int lwmutex_unlock_fast(KernelState &kernel, const char *export_name, SceUID thread_id, int unlock_count, SceKernelLwMutexWork *workarea, const MutexPtr &mutex) {
+    std::atomic<uint32_t> &owner = lwmutex_owner(workarea);
+
+    if ((owner.load(std::memory_order_relaxed) & ~LWMUTEX_CONTENDED) != static_cast<uint32_t>(thread_id))
+        return SCE_KERNEL_OK;
+
+    if (unlock_count > static_cast<int>(workarea->lockCount))
+        return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_UNLOCK_UDF);
+
+    workarea->lockCount -= unlock_count;
+    if (workarea->lockCount > 0)
+        return SCE_KERNEL_OK;
+
+    uint32_t current = thread_id;
+    if (owner.compare_exchange_strong(current, 0, std::memory_order_release))
+        return SCE_KERNEL_OK;
+
+    // Contended, hand the mutex over to the first waiting thread
+    MutexPtr found_mutex = mutex;
+    if (!found_mutex) {
+        if (auto error = find_mutex(found_mutex, nullptr, kernel, export_name, workarea->uid, SyncWeight::Light))
+            return error;
+    }
+
+    const std::lock_guard<std::mutex> mutex_lock(found_mutex->mutex);
+
+    // the last waiter may have timed out in the meantime
+    if (found_mutex->waiting_threads->empty()) {
+        owner.store(0, std::memory_order_release);
+        return SCE_KERNEL_OK;
+    }
+
+    const auto waiting_thread_data = *found_mutex->waiting_threads->begin();
+    const auto waiting_thread = waiting_thread_data.thread;
+
+    const std::lock_guard<std::mutex> waiting_thread_lock(waiting_thread->mutex);
+    found_mutex->waiting_threads->pop();
+    workarea->lockCount = waiting_thread_data.lock_count;
+    owner.store(waiting_thread->id | (found_mutex->waiting_threads->empty() ? 0 : LWMUTEX_CONTENDED), std::memory_order_release);
+    waiting_thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+
+    return SCE_KERNEL_OK;
+}
+
 inline static int mutex_lock_impl(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, int lock_count, MutexPtr &mutex, SyncWeight weight, SceUInt *timeout, bool only_try) {
+    if (weight == SyncWeight::Light && kernel.fast_lwmutex)
+        return lwmutex_lock_fast(kernel, export_name, thread_id, lock_count, mutex->workarea.get(mem), mutex, timeout, only_try);
+
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} lock_count: {} timeout: {} waiting_threads: {}",
             export_name, mutex->uid, thread_id, mutex->name, mutex->attr, mutex->lock_count, timeout ? *timeout : 0,
@@ -660,7 +812,7 @@ inline static int mutex_lock_impl(KernelState &kernel, MemState &mem, const char
         std::unique_lock<std::mutex> thread_lock(thread->mutex);
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.lock_count = lock_count;
         data.priority = thread->priority;
@@ -715,7 +867,10 @@ int mutex_try_lock(KernelState &kernel, MemState &mem, const char *export_name,
     return mutex_lock_impl(kernel, mem, export_name, thread_id, lock_count, mutex, weight, nullptr, true);
 }
 
-inline static int mutex_unlock_impl(KernelState &kernel, const char *export_name, SceUID thread_id, int unlock_count, MutexPtr &mutex) {
+inline static int mutex_unlock_impl(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, int unlock_count, MutexPtr &mutex, SyncWeight weight) {
+    if (weight == SyncWeight::Light && kernel.fast_lwmutex)
+        return lwmutex_unlock_fast(kernel, export_name, thread_id, unlock_count, mutex->workarea.get(mem), mutex);
+
     const ThreadStatePtr current_thread = kernel.get_thread(thread_id);
 
     const std::lock_guard<std::mutex> mutex_lock(mutex->mutex);
@@ -748,7 +903,7 @@ inline static int mutex_unlock_impl(KernelState &kernel, const char *export_name
     return SCE_KERNEL_OK;
 }
 
-int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight) {
+int mutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight) {
     assert(mutexid >= 0);
 
     MutexPtr mutex;
@@ -761,7 +916,48 @@ int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id,
             mutex->waiting_threads->size());
     }
 
-    return mutex_unlock_impl(kernel, export_name, thread_id, unlock_count, mutex);
+    return mutex_unlock_impl(kernel, mem, export_name, thread_id, unlock_count, mutex, weight);
+}
+
+int lwmutex_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, Ptr<SceKernelLwMutexWork> workarea, int lock_count, unsigned int *timeout, bool only_try) {
+    if (kernel.fast_lwmutex) {
+        if (LOG_SYNC_PRIMITIVES) {
+            LOG_DEBUG("{}: uid: {} thread_id: {} owner: {} lock_count: {} timeout: {}",
+                export_name, workarea.get(mem)->uid, thread_id, workarea.get(mem)->owner, lock_count, timeout ? *timeout : 0);
+        }
+
+        return lwmutex_lock_fast(kernel, export_name, thread_id, lock_count, workarea.get(mem), nullptr, timeout, only_try);
+    }
+
+    const SceUID lwmutexid = workarea.get(mem)->uid;
+    if (only_try)
+        return mutex_try_lock(kernel, mem, export_name, thread_id, lwmutexid, lock_count, SyncWeight::Light);
+    return mutex_lock(kernel, mem, export_name, thread_id, lwmutexid, lock_count, timeout, SyncWeight::Light);
+}
+
+int lwmutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, Ptr<SceKernelLwMutexWork> workarea, int unlock_count) {
+    if (kernel.fast_lwmutex) {
+        if (LOG_SYNC_PRIMITIVES) {
+            LOG_DEBUG("{}: uid: {} thread_id: {} owner: {} unlock_count: {}",
+                export_name, workarea.get(mem)->uid, thread_id, workarea.get(mem)->owner, unlock_count);
+        }
+
+        return lwmutex_unlock_fast(kernel, export_name, thread_id, unlock_count, workarea.get(mem), nullptr);
+    }
+
+    return mutex_unlock(kernel, mem, export_name, thread_id, workarea.get(mem)->uid, unlock_count, SyncWeight::Light);
+}
+
+void lwmutex_get_owner(const KernelState &kernel, const MemState &mem, const Mutex &mutex, SceUID &owner_id, int &lock_count) {
+    if (kernel.fast_lwmutex) {
+        SceKernelLwMutexWork *workarea = mutex.workarea.get(mem);
+        owner_id = lwmutex_owner(workarea).load(std::memory_order_relaxed) & ~LWMUTEX_CONTENDED;
+        lock_count = owner_id ? workarea->lockCount : 0;
+        return;
+    }
+
+    owner_id = mutex.owner ? mutex.owner->id : 0;
+    lock_count = mutex.lock_count;
 }
 
 int mutex_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight) {
@@ -879,7 +1075,7 @@ SceInt32 rwlock_lock(KernelState &kernel, MemState &mem, const char *export_name
         std::unique_lock<std::mutex> thread_lock(thread->mutex);
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.is_write = is_write;
         data.priority = thread->priority;
@@ -1054,7 +1250,7 @@ SceInt32 semaphore_wait(KernelState &kernel, const char *export_name, SceUID thr
         std::unique_lock<std::mutex> thread_lock(thread->mutex);
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.priority = thread->priority;
         data.signal = needCount;
@@ -1246,13 +1442,13 @@ int condvar_wait(KernelState &kernel, MemState &mem, const char *export_name, Sc
 
     std::unique_lock<std::mutex> condition_variable_lock(condvar->mutex);
 
-    if (auto error = mutex_unlock_impl(kernel, export_name, thread_id, 1, condvar->associated_mutex))
+    if (auto error = mutex_unlock_impl(kernel, mem, export_name, thread_id, 1, condvar->associated_mutex, weight))
         return error;
 
     std::unique_lock<std::mutex> thread_lock(thread->mutex);
     thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-    WaitingThreadData data;
+    WaitingThreadData &data = thread->wait_data;
     data.thread = thread;
     data.priority = thread->priority;
 
@@ -1457,7 +1653,7 @@ static int eventflag_waitorpoll(KernelState &kernel, const char *export_name, Sc
         std::unique_lock<std::mutex> thread_lock(thread->mutex);
         thread->update_status(ThreadStatus::wait, ThreadStatus::run);
 
-        WaitingThreadData data;
+        WaitingThreadData &data = thread->wait_data;
         data.thread = thread;
         data.wait = wait;
         data.flags = flags;
@@ -1729,12 +1925,12 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
     } else if (waitMode & SCE_KERNEL_MSG_PIPE_MODE_DONT_WAIT) {
         return 0;
     } else { // sleep until we can insert
-        WaitingThreadData wait_data;
+        WaitingThreadData &wait_data = thread->wait_data;
         wait_data.thread = thread;
         wait_data.priority = thread->priority;
         wait_data.mp.request_size = (ASAP) ? 1 : recvSize; // If ASAP, we can read as low as 1 byte
 
-        msgpipe->receivers->push(wait_data);
+        const auto data_it = msgpipe->receivers->push(wait_data);
 
         std::unique_lock thread_lock(thread->mutex); // Lock thread - needed for condition variable
         thread->update_status(ThreadStatus::wait, ThreadStatus::run); // Mark ourselves as sleeping
@@ -1760,15 +1956,22 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
                     return SCE_KERNEL_ERROR_WAIT_DELETE;
                 }
                 msgpipe_lock.lock(); // Lock message pipe again
+                if (wait_data.is_queued()) { // woken by exit_delete, not by a sender
+                    msgpipe->receivers->erase(data_it);
+                    return RET_ERROR(SCE_KERNEL_ERROR_WAIT_CANCEL);
+                }
                 availableSize = msgpipe->data_buffer.Used();
             } while (!((availableSize >= recvSize) || (ASAP && (availableSize > 0))));
 
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] {
-                return thread->status == ThreadStatus::run;
+            kernel.timer_wheel.schedule(thread->timeout, TimerWheel::now() + *pTimeout, thread->mutex, thread->status_cond);
+            thread->status_cond.wait(thread_lock, [&] {
+                return thread->status == ThreadStatus::run || thread->timeout.expired();
             });
+            kernel.timer_wheel.cancel(thread->timeout, thread_lock);
+            const bool status = thread->status == ThreadStatus::run;
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, static_cast<size_t>(-1));
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -1776,9 +1979,17 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
 
             if (!status) { // Timed out and buffer hasn't been touched
                 thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+                thread_lock.unlock();
+                msgpipe_lock.lock();
+                if (wait_data.is_queued())
+                    msgpipe->receivers->erase(data_it);
                 return RET_ERROR(SCE_KERNEL_ERROR_WAIT_TIMEOUT);
             }
             msgpipe_lock.lock(); // Lock message pipe again
+            if (wait_data.is_queued()) { // woken by exit_delete, not by a sender
+                msgpipe->receivers->erase(data_it);
+                return RET_ERROR(SCE_KERNEL_ERROR_WAIT_CANCEL);
+            }
             return finish();
         }
     }
@@ -1836,12 +2047,12 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
     } else if (waitMode & SCE_KERNEL_MSG_PIPE_MODE_DONT_WAIT) {
         return 0;
     } else { // Go to sleep until there's more space
-        WaitingThreadData wait_data;
+        WaitingThreadData &wait_data = thread->wait_data;
         wait_data.thread = thread;
         wait_data.priority = thread->priority;
         wait_data.mp.request_size = (ASAP) ? 1 : sendSize; // If ASAP, we can insert as low as 1 byte
 
-        msgpipe->senders->push(wait_data);
+        const auto data_it = msgpipe->senders->push(wait_data);
 
         std::unique_lock thread_lock(thread->mutex); // Lock thread - needed for condition variable
         thread->update_status(ThreadStatus::wait, ThreadStatus::run); // Mark ourselves as sleeping
@@ -1867,6 +2078,10 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
                     return SCE_KERNEL_ERROR_WAIT_DELETE;
                 }
                 msgpipe_lock.lock(); // Lock message pipe before read from data_buffer
+                if (wait_data.is_queued()) { // woken by exit_delete, not by a receiver
+                    msgpipe->senders->erase(data_it);
+                    return RET_ERROR(SCE_KERNEL_ERROR_WAIT_CANCEL);
+                }
                 freeSize = msgpipe->data_buffer.Free();
             } while (!((freeSize >= sendSize) || (ASAP && (freeSize >= 1))));
 
@@ -1874,9 +2089,12 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] {
-                return thread->status == ThreadStatus::run;
+            kernel.timer_wheel.schedule(thread->timeout, TimerWheel::now() + *pTimeout, thread->mutex, thread->status_cond);
+            thread->status_cond.wait(thread_lock, [&] {
+                return thread->status == ThreadStatus::run || thread->timeout.expired();
             });
+            kernel.timer_wheel.cancel(thread->timeout, thread_lock);
+            const bool status = thread->status == ThreadStatus::run;
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, static_cast<size_t>(-1));
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -1884,9 +2102,17 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
 
             if (!status) { // Timed out and buffer hasn't been touched
                 thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+                thread_lock.unlock();
+                msgpipe_lock.lock();
+                if (wait_data.is_queued())
+                    msgpipe->senders->erase(data_it);
                 return RET_ERROR(SCE_KERNEL_ERROR_WAIT_TIMEOUT);
             }
             msgpipe_lock.lock(); // Lock message pipe before read from data_buffer in finish()
+            if (wait_data.is_queued()) { // woken by exit_delete, not by a receiver
+                msgpipe->senders->erase(data_it);
+                return RET_ERROR(SCE_KERNEL_ERROR_WAIT_CANCEL);
+            }
             return finish();
         }
     }
@@ -1912,11 +2138,12 @@ SceInt32 msgpipe_delete(KernelState &kernel, const char *export_name, SceUID thr
         std::atomic_thread_fence(std::memory_order_release);
 
         // Wake up every thread
-        for (auto it : *msgpipe->senders) {
-            it.thread->update_status(ThreadStatus::run, ThreadStatus::wait);
-        }
-        for (auto it : *msgpipe->receivers) {
-            it.thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+        for (auto *queue : { msgpipe->senders.get(), msgpipe->receivers.get() }) {
+            while (!queue->empty()) {
+                const ThreadStatePtr waiting_thread = queue->begin()->thread;
+                queue->pop();
+                waiting_thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+            }
         }
         while (std::atomic_load(&msgpipe->remainingThreads) != 0) // FIXME busy loop bad
             std::this_thread::yield();
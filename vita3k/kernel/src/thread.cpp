@@ -71,7 +71,7 @@ int ThreadState::init(const char *name, Ptr<const void> entry_point, int init_pr
     start_tick = rtc_get_ticks(kernel.base_tick.tick);
     last_vblank_waited = 0;
 
-    cpu = init_cpu(kernel.cpu_opt, id, static_cast<std::size_t>(core_num), mem);
+    cpu = init_cpu(kernel.cpu_opt, id, static_cast<std::size_t>(core_num), mem, kernel.cpu_pool);
     if (!cpu) {
         return SCE_KERNEL_ERROR_ERROR;
     }
@@ -81,6 +81,12 @@ int ThreadState::init(const char *name, Ptr<const void> entry_point, int init_pr
     if (kernel.debugger.watch_memory) {
         set_log_mem(*cpu, true);
     }
+    if (kernel.fast_import_dispatch) {
+        cpu->svc_handler = [this](CPUState &cpu) { return dispatch_import_in_jit(cpu); };
+    }
+    if (kernel.jit_cache.enabled()) {
+        cpu->translation_hook = [this](CPUState &cpu, const JitEntryPoint &entry) { kernel.jit_cache.record(entry); };
+    }
 
     std::string alloc_name = fmt::format("Stack for thread {} (#{})", name, id);
     stack = alloc_block(mem, stack_size, alloc_name.c_str());
@@ -176,7 +182,8 @@ void ThreadState::exit_delete(bool exit) {
     if (status == ThreadStatus::run) {
         stop(*cpu);
     } else if (status == ThreadStatus::wait) {
-        // wake threads blocked in a sync primitive so they can observe delete_requested
+        // wake threads blocked in a sync primitive so they can observe delete_requested. The primitive lock is
+        // taken before the thread lock, so the woken thread unlinks its wait data from the primitive's queue itself.
         update_status(ThreadStatus::run);
     } else {
         // dormant or suspend: wake run_loop() so it can observe delete_requested
@@ -274,6 +281,8 @@ void ThreadState::run_loop() {
             // handle svc call if this was what stopped the cpu
             if (cpu->svc_called) {
                 const uint32_t nid = *Ptr<uint32_t>(read_pc(*cpu) + 4).get(mem);
+                if (kernel.fast_import_dispatch)
+                    get_import_stats(nid).slow_calls.fetch_add(1, std::memory_order_relaxed);
                 kernel.call_import(*cpu, nid, id);
                 clear_exclusive(*cpu);
             }
@@ -327,6 +336,20 @@ uint32_t ThreadState::run_callback(Address callback_address, const std::vector<u
         return 0;
     }
 
+    // Dynarmic can't be re-entered from one of its callbacks, so if this import was called from
+    // inside the JIT, run the guest callback on a secondary cpu which takes over the current context
+    const bool from_jit_import = in_jit_import;
+    if (from_jit_import) {
+        // no svc handler on this one: imports called by the callback always go through the run loop
+        if (!jit_callback_cpu)
+            jit_callback_cpu = init_cpu(kernel.cpu_opt, id, get_processor_id(*cpu), mem, kernel.cpu_pool);
+        load_context(*jit_callback_cpu, save_context(*cpu));
+        write_tpidruro(*jit_callback_cpu, read_tpidruro(*cpu));
+        std::swap(cpu, jit_callback_cpu);
+        in_jit_import = false;
+        jit_import_ran_guest_code = true;
+    }
+
     // save the current context before overwriting PC/LR for the callback
     const CPUContext previous_ctx = save_context(*cpu);
     const uint32_t previous_tpidruro = read_tpidruro(*cpu);
@@ -350,9 +373,59 @@ uint32_t ThreadState::run_callback(Address callback_address, const std::vector<u
     load_context(*cpu, previous_ctx);
     write_tpidruro(*cpu, previous_tpidruro);
 
+    if (from_jit_import) {
+        std::swap(cpu, jit_callback_cpu);
+        in_jit_import = true;
+        set_current_cpu_state(cpu.get());
+    }
+
     return returned_value;
 }
 
+ImportCallStats &ThreadState::get_import_stats(uint32_t nid) {
+    const auto it = import_stats_cache.find(nid);
+    if (it != import_stats_cache.end())
+        return *it->second;
+
+    ImportCallStats &stats = kernel.get_import_stats(nid);
+    import_stats_cache.emplace(nid, &stats);
+    return stats;
+}
+
+bool ThreadState::dispatch_import_in_jit(CPUState &cpu) {
+    // PC already points after the svc, the nid follows the return instruction
+    const uint32_t nid = *Ptr<uint32_t>(read_pc(cpu) + 4).get(mem);
+    ImportCallStats &stats = get_import_stats(nid);
+    if (stats.halt_required.load(std::memory_order_relaxed))
+        return false;
+
+    in_jit_import = true;
+    jit_import_ran_guest_code = false;
+    kernel.call_import(cpu, nid, id);
+    clear_exclusive(cpu);
+    in_jit_import = false;
+
+    // the import needed a secondary cpu to run guest code, send it through the run loop from now on
+    if (jit_import_ran_guest_code)
+        stats.halt_required = true;
+
+    bool needs_run_loop;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        needs_run_loop = exit_requested || delete_requested || suspend_requested || single_stepping || status != ThreadStatus::run;
+    }
+    needs_run_loop = needs_run_loop || cpu.abort_pending || hit_breakpoint(cpu);
+
+    if (needs_run_loop) {
+        stats.slow_calls.fetch_add(1, std::memory_order_relaxed);
+        stop(cpu);
+    } else {
+        stats.fast_calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
 void ThreadState::dispatch_abort(CPUState &cpu) {
     const uint32_t fault_addr = cpu.abort_fault_addr.load();
     // DABT = type 0
@@ -444,6 +517,12 @@ void ThreadState::resume(bool step) {
     }
 }
 
+void ThreadState::invalidate_jit_cache(Address start, size_t length) {
+    ::invalidate_jit_cache(*cpu, start, length);
+    if (jit_callback_cpu)
+        ::invalidate_jit_cache(*jit_callback_cpu, start, length);
+}
+
 std::string ThreadState::log_stack_traceback() const {
     constexpr Address START_OFFSET = 0;
     constexpr Address END_OFFSET = 1024;
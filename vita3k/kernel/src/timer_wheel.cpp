@@ -0,0 +1,275 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/timer_wheel.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <limits>
+
+// The wheel thread wakes up this early and yields until the deadline, condition variables are not more precise
+static constexpr uint64_t TIMER_SLACK_US = 50;
+static constexpr uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+uint64_t TimerWheel::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TimerWheel::schedule(TimerWheelEntry &entry, uint64_t deadline, std::mutex &mutex, std::condition_variable &cond) {
+    assert(entry.state == TimerWheelEntry::State::Idle);
+    entry.fired = false;
+    entry.deadline = deadline;
+    entry.mutex = &mutex;
+    entry.cond = &cond;
+
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    if (!thread.joinable()) {
+        stopping = false;
+        thread = std::thread(&TimerWheel::run, this);
+    }
+
+    // nothing is linked, the wheel can be moved to the current time
+    if (pending == 0)
+        current = std::max(current, now());
+
+    entry.state = TimerWheelEntry::State::Pending;
+    pending++;
+    insert(entry);
+    stats.scheduled++;
+
+    if (deadline < sleeping_until)
+        this->cond.notify_one();
+}
+
+bool TimerWheel::cancel(TimerWheelEntry &entry, std::unique_lock<std::mutex> &lock) {
+    const uint64_t wake_time = now();
+    {
+        std::unique_lock<std::mutex> wheel_lock(mutex);
+        if (entry.state == TimerWheelEntry::State::Pending) {
+            unlink(entry);
+            pending--;
+            entry.state = TimerWheelEntry::State::Idle;
+            stats.canceled++;
+            return false;
+        }
+
+        if (entry.state == TimerWheelEntry::State::Firing) {
+            // the wheel thread needs the lock to wake us
+            lock.unlock();
+            fired_cond.wait(wheel_lock, [&] { return entry.state != TimerWheelEntry::State::Firing; });
+            wheel_lock.unlock();
+            lock.lock();
+        }
+    }
+
+    if (!entry.fired)
+        return false;
+    entry.fired = false;
+
+    const uint64_t error = wake_time > entry.deadline ? wake_time - entry.deadline : 0;
+    stats.expired++;
+    stats.total_wake_error_us += error;
+    uint64_t max_error = stats.max_wake_error_us;
+    while (error > max_error && !stats.max_wake_error_us.compare_exchange_weak(max_error, error)) {
+    }
+    stats.wake_error_histogram[std::min<size_t>(std::bit_width(error), TIMER_WAKE_ERROR_BUCKETS - 1)]++;
+
+    return true;
+}
+
+void TimerWheel::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_one();
+    if (thread.joinable())
+        thread.join();
+
+    // threads can still be in a timed wait at shutdown, their timeouts expire now instead of never
+    std::unique_lock<std::mutex> lock(mutex);
+    TimerWheelEntry *expired = nullptr;
+    for (Level &level : levels) {
+        for (TimerWheelEntry *&slot : level.slots) {
+            while (slot) {
+                TimerWheelEntry *entry = slot;
+                slot = entry->next;
+                entry->state = TimerWheelEntry::State::Firing;
+                entry->prev = nullptr;
+                entry->next = expired;
+                expired = entry;
+            }
+        }
+        level.occupied = 0;
+    }
+    pending = 0;
+
+    if (expired)
+        fire(expired, lock);
+}
+
+void TimerWheel::insert(TimerWheelEntry &entry) {
+    const uint64_t deadline = std::max(entry.deadline, current);
+    // the lowest level where the slot of the deadline is not reached yet and does not wrap around
+    uint32_t level = 0;
+    uint64_t group = deadline;
+    for (; level < LEVELS; level++) {
+        const uint32_t shift = level * SLOT_BITS;
+        const uint64_t first = (current + (uint64_t(1) << shift) - 1) >> shift;
+        group = deadline >> shift;
+        if (group - first < SLOTS)
+            break;
+        if (level == LEVELS - 1) {
+            // too far away, moved again when this slot is reached
+            group = first + SLOTS - 1;
+            break;
+        }
+    }
+
+    const uint32_t slot = group & (SLOTS - 1);
+    entry.level = level;
+    entry.slot = slot;
+    entry.prev = nullptr;
+    entry.next = levels[level].slots[slot];
+    if (entry.next)
+        entry.next->prev = &entry;
+    levels[level].slots[slot] = &entry;
+    levels[level].occupied |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(TimerWheelEntry &entry) {
+    Level &level = levels[entry.level];
+    (entry.prev ? entry.prev->next : level.slots[entry.slot]) = entry.next;
+    if (entry.next)
+        entry.next->prev = entry.prev;
+    if (!level.slots[entry.slot])
+        level.occupied &= ~(uint64_t(1) << entry.slot);
+    entry.prev = nullptr;
+    entry.next = nullptr;
+}
+
+uint64_t TimerWheel::next_tick() const {
+    uint64_t tick = NO_TICK;
+    for (uint32_t level = 0; level < LEVELS; level++) {
+        if (!levels[level].occupied)
+            continue;
+
+        // the slots of a level cover the SLOTS groups following the first one not reached yet
+        const uint32_t shift = level * SLOT_BITS;
+        const uint64_t first = (current + (uint64_t(1) << shift) - 1) >> shift;
+        const uint64_t group = first + std::countr_zero(std::rotr(levels[level].occupied, first & (SLOTS - 1)));
+        tick = std::min(tick, group << shift);
+    }
+    return tick;
+}
+
+TimerWheelEntry *TimerWheel::advance(uint64_t time) {
+    TimerWheelEntry *expired = nullptr;
+    while (pending > 0) {
+        const uint64_t tick = next_tick();
+        if (tick > time)
+            break;
+        current = tick;
+
+        // move the slots starting at this tick to the lower levels, from the highest one
+        for (uint32_t level = LEVELS - 1; level > 0; level--) {
+            const uint32_t shift = level * SLOT_BITS;
+            if (tick & ((uint64_t(1) << shift) - 1))
+                continue;
+            const uint32_t slot = (tick >> shift) & (SLOTS - 1);
+            TimerWheelEntry *entry = levels[level].slots[slot];
+            levels[level].slots[slot] = nullptr;
+            levels[level].occupied &= ~(uint64_t(1) << slot);
+            while (entry) {
+                TimerWheelEntry *next = entry->next;
+                insert(*entry);
+                entry = next;
+            }
+        }
+
+        const uint32_t slot = tick & (SLOTS - 1);
+        TimerWheelEntry *entry = levels[0].slots[slot];
+        levels[0].slots[slot] = nullptr;
+        levels[0].occupied &= ~(uint64_t(1) << slot);
+        while (entry) {
+            TimerWheelEntry *next = entry->next;
+            entry->state = TimerWheelEntry::State::Firing;
+            entry->prev = nullptr;
+            entry->next = expired;
+            expired = entry;
+            pending--;
+            entry = next;
+        }
+
+        current = tick + 1;
+    }
+
+    // no entry expires until then
+    current = std::max(current, time + 1);
+    return expired;
+}
+
+void TimerWheel::fire(TimerWheelEntry *expired, std::unique_lock<std::mutex> &lock) {
+    // the waiting threads check their timeout with their own mutex locked
+    lock.unlock();
+    for (TimerWheelEntry *entry = expired; entry; entry = entry->next) {
+        const std::lock_guard<std::mutex> entry_lock(*entry->mutex);
+        entry->fired = true;
+        entry->cond->notify_all();
+    }
+    lock.lock();
+
+    while (expired) {
+        TimerWheelEntry *next = expired->next;
+        expired->next = nullptr;
+        expired->state = TimerWheelEntry::State::Idle;
+        expired = next;
+    }
+    fired_cond.notify_all();
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        const uint64_t time = now();
+        TimerWheelEntry *expired = advance(time);
+        if (expired) {
+            fire(expired, lock);
+            continue;
+        }
+
+        const uint64_t tick = next_tick();
+        if (tick > time + TIMER_SLACK_US) {
+            sleeping_until = tick;
+            if (tick == NO_TICK)
+                cond.wait(lock);
+            else
+                cond.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::microseconds(tick - TIMER_SLACK_US)));
+            sleeping_until = 0;
+        } else {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,203 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/state.h>
+#include <kernel/sync_primitives.h>
+#include <kernel/thread/thread_state.h>
+#include <mem/state.h>
+#include <util/lock_and_find.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static constexpr int BENCH_THREADS = 8;
+
+// A kernel with one guest thread and one semaphore per benchmark thread
+struct SyncBenchState {
+    MemState mem;
+    KernelState kernel;
+    std::vector<SceUID> thread_ids;
+    std::vector<SceUID> semaphore_ids;
+    // the same threads in a map behind the kernel mutex, as the kernel objects were stored before the object tables
+    std::map<SceUID, ThreadStatePtr> thread_map;
+
+    SyncBenchState() {
+        for (int i = 0; i < BENCH_THREADS; i++) {
+            const ThreadStatePtr thread = std::make_shared<ThreadState>(kernel.get_next_uid(), kernel, mem);
+            thread->status = ThreadStatus::run;
+            kernel.threads.emplace(thread->id, thread);
+            thread_map.emplace(thread->id, thread);
+            thread_ids.push_back(thread->id);
+            semaphore_ids.push_back(semaphore_create(kernel, "bench", "bench", thread->id, SCE_KERNEL_ATTR_TH_FIFO, 0, 1));
+        }
+    }
+};
+
+static SyncBenchState &get_bench_state() {
+    // shared by the benchmark threads, created by the first one
+    static SyncBenchState state;
+    return state;
+}
+
+static void BM_ThreadLookupLockedMap(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const SceUID thread_id = bench.thread_ids[state.thread_index()];
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lock_and_find(thread_id, bench.thread_map, bench.kernel.mutex));
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ThreadLookupObjectTable(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const SceUID thread_id = bench.thread_ids[state.thread_index()];
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bench.kernel.get_thread(thread_id));
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Every thread signals and waits its own semaphore: they only contend on the kernel object lookups
+static void BM_SemaphoreSignalWait(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const SceUID thread_id = bench.thread_ids[state.thread_index()];
+    const SceUID semaphore_id = bench.semaphore_ids[state.thread_index()];
+    for (auto _ : state) {
+        semaphore_signal(bench.kernel, "bench", thread_id, semaphore_id, 1);
+        semaphore_wait(bench.kernel, "bench", thread_id, semaphore_id, 1, nullptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Pairs of threads passing a token back and forth through two semaphores, the waits block
+static void BM_SemaphorePingPong(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const int index = state.thread_index();
+    const SceUID thread_id = bench.thread_ids[index];
+    const SceUID ping = bench.semaphore_ids[index & ~1];
+    const SceUID pong = bench.semaphore_ids[index | 1];
+    const bool first = (index & 1) == 0;
+    for (auto _ : state) {
+        if (first) {
+            semaphore_signal(bench.kernel, "bench", thread_id, ping, 1);
+            semaphore_wait(bench.kernel, "bench", thread_id, pong, 1, nullptr);
+        } else {
+            semaphore_wait(bench.kernel, "bench", thread_id, ping, 1, nullptr);
+            semaphore_signal(bench.kernel, "bench", thread_id, pong, 1);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Threads of different priorities queued and woken in turn, with the thread data kept in the waiting threads
+template <typename Queue>
+static void BM_WaitQueuePushPop(benchmark::State &state) {
+    std::vector<WaitingThreadData> waiting(state.range(0));
+    for (size_t i = 0; i < waiting.size(); i++)
+        waiting[i].priority = 64 + i % 4;
+
+    Queue queue;
+    for (auto _ : state) {
+        for (auto &data : waiting)
+            queue.push(data);
+        while (!queue.empty())
+            queue.pop();
+    }
+    state.SetItemsProcessed(state.iterations() * waiting.size());
+}
+
+// Time from semaphore_signal to the return of semaphore_wait in the woken thread
+static void BM_SemaphoreWakeLatency(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const SceUID signaler_id = bench.thread_ids[0];
+    const ThreadStatePtr waiter = std::make_shared<ThreadState>(bench.kernel.get_next_uid(), bench.kernel, bench.mem);
+    waiter->status = ThreadStatus::run;
+    {
+        const std::lock_guard<std::mutex> lock(bench.kernel.mutex);
+        bench.kernel.threads.emplace(waiter->id, waiter);
+    }
+    const SceUID semaphore_id = semaphore_create(bench.kernel, "bench", "bench", signaler_id, SCE_KERNEL_ATTR_TH_PRIO, 0, 1);
+    const SemaphorePtr semaphore = bench.kernel.semaphores.get(semaphore_id);
+    const auto waiter_asleep = [&] {
+        const std::lock_guard<std::mutex> lock(semaphore->mutex);
+        return !semaphore->waiting_threads->empty();
+    };
+
+    std::atomic<bool> stop = false;
+    std::atomic<int64_t> woken_at = 0;
+    std::thread waiter_thread([&] {
+        while (semaphore_wait(bench.kernel, "bench", waiter->id, semaphore_id, 1, nullptr) == SCE_KERNEL_OK && !stop)
+            woken_at = std::chrono::steady_clock::now().time_since_epoch().count();
+    });
+
+    for (auto _ : state) {
+        // let the waiter go to sleep first
+        while (!waiter_asleep())
+            std::this_thread::yield();
+
+        woken_at = 0;
+        const auto start = std::chrono::steady_clock::now();
+        semaphore_signal(bench.kernel, "bench", signaler_id, semaphore_id, 1);
+        while (woken_at == 0)
+            std::this_thread::yield();
+        const std::chrono::steady_clock::duration latency(woken_at - start.time_since_epoch().count());
+        state.SetIterationTime(std::chrono::duration<double>(latency).count());
+    }
+
+    stop = true;
+    semaphore_signal(bench.kernel, "bench", signaler_id, semaphore_id, 1);
+    waiter_thread.join();
+    semaphore_delete(bench.kernel, "bench", signaler_id, semaphore_id);
+    const std::lock_guard<std::mutex> lock(bench.kernel.mutex);
+    bench.kernel.threads.erase(waiter->id);
+}
+
+// Waits which time out, the timer wheel wakes the thread: reports how late after the requested timeout it returned
+static void BM_SemaphoreWaitTimeout(benchmark::State &state) {
+    SyncBenchState &bench = get_bench_state();
+    const SceUID thread_id = bench.thread_ids[state.thread_index()];
+    const SceUID semaphore_id = bench.semaphore_ids[state.thread_index()];
+    const SceUInt32 timeout = state.range(0);
+    uint64_t total_error_us = 0;
+    uint64_t max_error_us = 0;
+    for (auto _ : state) {
+        SceUInt32 remaining = timeout;
+        const auto start = std::chrono::steady_clock::now();
+        semaphore_wait(bench.kernel, "bench", thread_id, semaphore_id, 1, &remaining);
+        const uint64_t waited_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        const uint64_t error_us = waited_us > timeout ? waited_us - timeout : 0;
+        total_error_us += error_us;
+        max_error_us = std::max(max_error_us, error_us);
+    }
+    state.counters["avg_late_us"] = benchmark::Counter(static_cast<double>(total_error_us) / state.iterations());
+    state.counters["max_late_us"] = benchmark::Counter(static_cast<double>(max_error_us));
+}
+
+BENCHMARK(BM_ThreadLookupLockedMap)->ThreadRange(1, BENCH_THREADS)->UseRealTime();
+BENCHMARK(BM_ThreadLookupObjectTable)->ThreadRange(1, BENCH_THREADS)->UseRealTime();
+BENCHMARK(BM_SemaphoreSignalWait)->ThreadRange(1, BENCH_THREADS)->UseRealTime();
+BENCHMARK(BM_SemaphorePingPong)->Threads(2)->Threads(BENCH_THREADS)->UseRealTime();
+
+BENCHMARK(BM_WaitQueuePushPop<FIFOThreadDataQueue<WaitingThreadData>>)->Arg(1)->Arg(16);
+BENCHMARK(BM_WaitQueuePushPop<PriorityThreadDataQueue<WaitingThreadData>>)->Arg(1)->Arg(16);
+BENCHMARK(BM_SemaphoreWakeLatency)->UseManualTime();
+BENCHMARK(BM_SemaphoreWaitTimeout)->Arg(100)->Arg(1000)->Threads(1)->Threads(BENCH_THREADS)->UseRealTime();
+
+BENCHMARK_MAIN();
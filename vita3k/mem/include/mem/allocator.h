@@ -20,12 +20,26 @@
 #include <cstdint>
 #include <vector>
 
+// A set bit is a free slot, the most significant bit of a word being the lowest offset
 struct BitmapAllocator {
     std::vector<std::uint32_t> words;
     std::size_t max_offset;
 
 protected:
+    // Two summary levels above words, so the search skips full words without looking at them.
+    // Bit i of word_summary is set when words[i] may have a free slot (it is only cleared when
+    // the allocator fills the word), bit i of group_summary when word_summary[i] is not 0.
+    std::vector<std::uint64_t> word_summary;
+    std::vector<std::uint64_t> group_summary;
+
     int force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode = false);
+    void rebuild_summary();
+    void update_summary(const std::size_t first_word, const std::size_t last_word);
+    // First word at or after index which may have a free slot, words.size() if there is none
+    std::size_t next_free_word(const std::size_t index) const;
+
+    int find_first_fit(const std::size_t start_word, const std::uint32_t size) const;
+    int find_best_fit(const std::size_t start_word, const std::uint32_t size) const;
 
 public:
     BitmapAllocator() = default;
@@ -59,6 +59,10 @@ void close_access_parent_protect_segment(MemState &state, Address addr);
 void add_external_mapping(MemState &mem, Address addr, uint32_t size, uint8_t *addr_ptr);
 void remove_external_mapping(MemState &mem, uint8_t *addr_ptr, uint32_t size);
 bool is_protecting(MemState &state, Address addr, MemPerm *perm = nullptr);
+// Write tracking without callbacks: a write to a watched page only records a new write generation for it.
+// Returns the generation to give to pages_written_since, the range is watched again by calling this again.
+uint32_t watch_pages(MemState &state, Address addr, uint32_t size);
+bool pages_written_since(const MemState &state, Address addr, uint32_t size, uint32_t generation);
 bool is_valid_addr(const MemState &state, Address addr);
 bool is_valid_addr_range(const MemState &state, Address start, Address end);
 bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcept;
@@ -0,0 +1,120 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <mem/util.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct MemState;
+
+struct GuestHeapStats {
+    uint32_t system_size = 0; // bytes taken from the page allocator
+    uint32_t max_system_size = 0;
+    uint32_t in_use_size = 0; // bytes handed out to the guest, rounded up to the size class
+    uint32_t max_in_use_size = 0;
+};
+
+/**
+ * @brief Guest heap backing the HLE malloc family
+ *
+ * Blocks up to MAX_SMALL_SIZE bytes are carved from slabs holding a single size class, the slabs are
+ * carved from regions taken from the page allocator, so most calls never reach alloc/free nor zero a page.
+ * Bigger blocks get their own pages like before. The bookkeeping lives on the host, a guest
+ * overflowing a block can not corrupt it.
+ */
+class GuestHeap {
+public:
+    static constexpr uint32_t MIN_ALIGNMENT = 16;
+    static constexpr uint32_t MAX_SMALL_SIZE = 3072;
+    static constexpr uint32_t SLAB_SIZE = KiB(16);
+    static constexpr uint32_t REGION_SIZE = KiB(256);
+
+    GuestHeap();
+    GuestHeap(const GuestHeap &) = delete;
+    GuestHeap &operator=(const GuestHeap &) = delete;
+
+    // All of these return 0 on failure, the content of a new block is undefined unless calloc is used
+    Address malloc(MemState &mem, uint32_t size);
+    Address calloc(MemState &mem, uint32_t count, uint32_t size);
+    // Blocks unknown to the heap are left alone and 0 is returned
+    Address realloc(MemState &mem, Address address, uint32_t size);
+    Address reallocalign(MemState &mem, Address address, uint32_t alignment, uint32_t size);
+    Address memalign(MemState &mem, uint32_t alignment, uint32_t size);
+    // Addresses unknown to the heap are given back to the page allocator
+    void free(MemState &mem, Address address);
+
+    // Number of usable bytes of the block, 0 if address is not a block of this heap
+    uint32_t usable_size(Address address);
+    GuestHeapStats stats();
+
+private:
+    struct Region;
+
+    struct Slab {
+        Region *region = nullptr;
+        Address base = 0;
+        uint16_t size_class = 0;
+        uint16_t free_count = 0;
+        uint16_t capacity = 0;
+        bool active = false; // false while the slab sits in the free slab pool
+        // bit set = slot free
+        std::array<uint64_t, SLAB_SIZE / MIN_ALIGNMENT / 64> free_slots{};
+    };
+
+    struct Region {
+        Address base = 0;
+        uint32_t active_slabs = 0;
+        std::array<Slab, REGION_SIZE / SLAB_SIZE> slabs;
+    };
+
+    struct SizeClass {
+        uint32_t size = 0;
+        // slabs with at least one free slot, the last one is allocated from first
+        std::vector<Slab *> partial;
+    };
+
+    // Everything below must be called with the mutex held
+    Address allocate(MemState &mem, uint32_t size, uint32_t alignment);
+    // Returns false if address is not a block of this heap
+    bool deallocate(MemState &mem, Address address);
+    uint32_t block_size(Address address);
+
+    Slab *find_slab(Address address);
+    Slab *take_slab(MemState &mem, uint32_t size_class);
+    void release_slab(MemState &mem, Slab &slab);
+    Address alloc_small(MemState &mem, uint32_t size_class);
+    void free_small(MemState &mem, Slab &slab, Address address);
+    Address alloc_large(MemState &mem, uint32_t size, uint32_t alignment);
+    void add_system(int64_t delta);
+    void add_in_use(int64_t delta);
+
+    std::mutex mutex;
+    std::vector<SizeClass> size_classes;
+    // smallest size class for a size, indexed by size / MIN_ALIGNMENT rounded up
+    std::array<uint8_t, MAX_SMALL_SIZE / MIN_ALIGNMENT + 1> class_of_size{};
+    std::map<Address, std::unique_ptr<Region>> regions;
+    std::vector<Slab *> free_slabs;
+    std::map<Address, uint32_t> large_blocks; // address -> size in bytes, rounded up to pages
+    GuestHeapStats heap_stats;
+};
@@ -21,6 +21,7 @@
 #include <mem/functions.h>
 #include <mem/util.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -74,7 +75,18 @@ struct MemState {
 
     PageNameMap page_name_map;
 
+    // Rely on the OS zeroing decommitted and never touched pages instead of zeroing every allocation,
+    // the pages are then only backed by host memory once the guest touches them
+    bool lazy_zero_fill = true;
+
     bool use_page_table = false;
     PageTable page_table;
     std::map<uint64_t, MemExternalMapping, std::greater<>> external_mapping;
+
+    // Write tracking, see watch_pages
+    // one bit per 4 KiB page, set while the page is write-protected and waiting for a write
+    std::unique_ptr<std::atomic<uint64_t>[]> watched_pages;
+    // generation of the last write to each page
+    std::unique_ptr<std::atomic<uint32_t>[]> page_write_generation;
+    std::atomic<uint32_t> write_generation{ 0 };
 };
@@ -17,9 +17,14 @@
 
 #include <mem/allocator.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
 BitmapAllocator::BitmapAllocator(const std::size_t total_bits)
     : words((total_bits >> 5) + ((total_bits % 32 != 0) ? 1 : 0), 0xFFFFFFFF)
     , max_offset(total_bits) {
+    rebuild_summary();
 }
 
 void BitmapAllocator::set_maximum(const std::size_t total_bits) {
@@ -35,13 +40,71 @@ void BitmapAllocator::set_maximum(const std::size_t total_bits) {
     }
 
     max_offset = total_bits;
+    rebuild_summary();
 }
 
 void BitmapAllocator::reset() {
     words.clear();
+    rebuild_summary();
+}
+
+void BitmapAllocator::rebuild_summary() {
+    word_summary.assign((words.size() + 63) / 64, 0);
+    group_summary.assign((word_summary.size() + 63) / 64, 0);
+    if (!words.empty())
+        update_summary(0, words.size() - 1);
+}
+
+void BitmapAllocator::update_summary(const std::size_t first_word, const std::size_t last_word) {
+    for (std::size_t group = first_word / 64; group <= last_word / 64; group++) {
+        const std::size_t begin = std::max(first_word, group * 64);
+        const std::size_t end = std::min(last_word + 1, (group + 1) * 64);
+
+        std::uint64_t summary = word_summary[group];
+        for (std::size_t i = begin; i < end; i++) {
+            const std::uint64_t bit = std::uint64_t(1) << (i % 64);
+            summary = (words[i] != 0) ? (summary | bit) : (summary & ~bit);
+        }
+        word_summary[group] = summary;
+
+        const std::uint64_t group_bit = std::uint64_t(1) << (group % 64);
+        if (summary != 0)
+            group_summary[group / 64] |= group_bit;
+        else
+            group_summary[group / 64] &= ~group_bit;
+    }
+}
+
+std::size_t BitmapAllocator::next_free_word(const std::size_t index) const {
+    std::size_t group = index / 64;
+    if (group >= word_summary.size())
+        return words.size();
+
+    // the rest of the group of index
+    const std::uint64_t in_group = word_summary[group] & (~std::uint64_t(0) << (index % 64));
+    if (in_group != 0)
+        return group * 64 + std::countr_zero(in_group);
+
+    // then the next group with a free word
+    group++;
+    std::size_t top = group / 64;
+    if (top >= group_summary.size())
+        return words.size();
+    std::uint64_t groups = group_summary[top] & (~std::uint64_t(0) << (group % 64));
+    while (groups == 0) {
+        if (++top >= group_summary.size())
+            return words.size();
+        groups = group_summary[top];
+    }
+
+    group = top * 64 + std::countr_zero(groups);
+    return group * 64 + std::countr_zero(word_summary[group]);
 }
 
 int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode) {
+    const std::size_t first_word = offset >> 5;
+    const std::size_t last_word = std::min<std::size_t>((static_cast<std::size_t>(offset) + std::max<std::uint32_t>(size, 1) - 1) >> 5, words.size() - 1);
+
     std::uint32_t *word = &words[0] + (offset >> 5);
     const std::uint32_t set_bit = offset & 31;
     std::uint32_t end_bit = set_bit + size;
@@ -58,6 +121,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
             *word = wval & (~mask);
         }
 
+        update_summary(first_word, first_word);
         return std::min<int>(size, (words.size() << 5) - set_bit);
     }
 
@@ -86,6 +150,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
         }
     }
 
+    update_summary(first_word, last_word);
     return std::min<int>(size, (words.size() << 5) - set_bit);
 }
 
@@ -97,86 +162,151 @@ void BitmapAllocator::free(const std::uint32_t offset, const std::uint32_t size)
     force_fill(offset, size, true);
 }
 
-int BitmapAllocator::allocate_from(const std::uint32_t start_offset, std::uint32_t &size, const bool best_fit) {
-    if (words.empty()) {
-        return -1;
+// Bits b of the result are set when the size bits from b down to b - size + 1 are all set in w, 1 <= size <= 32
+static std::uint32_t run_starts(std::uint32_t w, std::uint32_t size) {
+    // each step doubles the length of the runs checked, until size is covered
+    std::uint32_t covered = 1;
+    while (covered < size) {
+        const std::uint32_t step = std::min(covered, size - covered);
+        w &= w << step;
+        covered += step;
     }
+    return w;
+}
 
-    std::uint32_t *word = &words[0] + (start_offset >> 5);
-
-    // We have arrived at le word that still have free position (bit 1)
-    std::uint32_t *word_end = &words[words.size() - 1];
-
-    int bflmin = 0xFFFFFF;
-    int bofmin = -1;
-    std::uint32_t *wordmin = nullptr;
-
-    // Keep finding
-    while (word <= word_end) {
-        std::uint32_t wv = *word;
-
-        if (wv != 0) {
-            // Still have free stuff
-            int bflen = 0;
-            int boff = 0;
-            std::uint32_t *bword = nullptr;
-
-            int cursor = 31;
-
-            while (cursor >= 0) {
-                if (((wv >> cursor) & 1) == 1) {
-                    boff = cursor;
-                    bflen = 0;
-                    bword = word;
-
-                    while (cursor >= 0 && (((wv >> cursor) & 1) == 1)) {
-                        bflen++;
-                        cursor--;
-
-                        if (cursor < 0 && (word + 1 <= word_end)) {
-                            cursor = 31;
-                            word++;
-                            wv = *word;
-                        }
-                    }
-
-                    if (bflen >= size) {
-                        if (!best_fit) {
-                            // Force allocate and then return
-                            const int offset = static_cast<int>(31 - boff + ((bword - &words[0]) << 5));
-                            if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-                                size = force_fill(static_cast<const std::uint32_t>(offset), size, false);
-                                return offset;
-                            }
-                        } else {
-                            if (bflen < bflmin) {
-                                bflmin = bflen;
-                                bofmin = boff;
-                                wordmin = bword;
-                            }
-                        }
-                    }
-                }
-
-                cursor--;
-            }
+int BitmapAllocator::find_first_fit(const std::size_t start_word, const std::uint32_t size) const {
+    // free run ending at the end of the previous word, it may go on in the next one
+    std::size_t carry_start = 0;
+    std::uint32_t carry_length = 0;
+    std::size_t previous = words.size();
+
+    for (std::size_t index = next_free_word(start_word); index < words.size(); index = next_free_word(index + 1)) {
+        if (index != previous + 1)
+            carry_length = 0;
+        previous = index;
+
+        const std::uint32_t w = words[index];
+        const std::size_t word_offset = index << 5;
+        const std::uint32_t leading = std::countl_one(w);
+        const std::size_t prefix_start = (carry_length > 0) ? carry_start : word_offset;
+
+        std::size_t found = SIZE_MAX;
+        if (carry_length + leading >= size) {
+            found = prefix_start;
+        } else if (size <= 32) {
+            const std::uint32_t starts = run_starts(w, size);
+            if (starts != 0)
+                found = word_offset + std::countl_zero(starts);
         }
 
-        word++;
-    }
+        if (found != SIZE_MAX) {
+            // any other run is after this one
+            return (found + size <= max_offset) ? static_cast<int>(found) : -1;
+        }
 
-    if (best_fit && bofmin != -1) {
-        // Force allocate and then return
-        const int offset = static_cast<int>(31 - bofmin + ((wordmin - &words[0]) << 5));
-        if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-            size = force_fill(static_cast<std::uint32_t>(offset), size, false);
-            return offset;
+        if (w == 0xFFFFFFFFU) {
+            carry_start = prefix_start;
+            carry_length += 32;
+        } else {
+            const std::uint32_t trailing = std::countr_one(w);
+            carry_start = word_offset + 32 - trailing;
+            carry_length = trailing;
         }
     }
 
     return -1;
 }
 
+int BitmapAllocator::find_best_fit(const std::size_t start_word, const std::uint32_t size) const {
+    std::size_t best_start = 0;
+    std::size_t best_length = SIZE_MAX;
+
+    // returns true when the run fits exactly, no other run can be better
+    const auto check_run = [&](std::size_t start, std::size_t length) {
+        if (start >= max_offset)
+            return false;
+        length = std::min(length, max_offset - start);
+        if (length >= size && length < best_length) {
+            best_start = start;
+            best_length = length;
+        }
+        return length == size;
+    };
+
+    std::size_t carry_start = 0;
+    std::size_t carry_length = 0;
+    std::size_t previous = words.size();
+
+    for (std::size_t index = next_free_word(start_word); index < words.size(); index = next_free_word(index + 1)) {
+        if (index != previous + 1 && carry_length > 0) {
+            if (check_run(carry_start, carry_length))
+                return static_cast<int>(best_start);
+            carry_length = 0;
+        }
+        previous = index;
+
+        const std::uint32_t w = words[index];
+        const std::size_t word_offset = index << 5;
+        if (w == 0xFFFFFFFFU) {
+            if (carry_length == 0)
+                carry_start = word_offset;
+            carry_length += 32;
+            continue;
+        }
+
+        // the run at the start of the word ends the one carried from the previous words
+        const std::uint32_t leading = std::countl_one(w);
+        if (carry_length + leading > 0) {
+            if (check_run((carry_length > 0) ? carry_start : word_offset, carry_length + leading))
+                return static_cast<int>(best_start);
+        }
+        carry_length = 0;
+
+        std::uint32_t rest = w & (0xFFFFFFFFU >> leading);
+        // the runs inside the word are only looked at one by one when one of them is long enough,
+        // the one at its end is always kept as it may go on in the next word
+        const std::uint32_t trailing = std::countr_one(w);
+        const std::uint32_t trailing_mask = (trailing == 0) ? 0 : (0xFFFFFFFFU >> (32 - trailing));
+        if (size > 32 || run_starts(rest & ~trailing_mask, size) == 0)
+            rest &= trailing_mask;
+
+        while (rest != 0) {
+            const std::uint32_t start = std::countl_zero(rest);
+            const std::uint32_t length = std::countl_one(rest << start);
+            if (start + length == 32) {
+                // it may go on in the next word
+                carry_start = word_offset + start;
+                carry_length = length;
+                break;
+            }
+
+            if (check_run(word_offset + start, length))
+                return static_cast<int>(best_start);
+            rest &= 0xFFFFFFFFU >> (start + length);
+        }
+    }
+
+    if (carry_length > 0)
+        check_run(carry_start, carry_length);
+
+    return (best_length != SIZE_MAX) ? static_cast<int>(best_start) : -1;
+}
+
+int BitmapAllocator::allocate_from(const std::uint32_t start_offset, std::uint32_t &size, const bool best_fit) {
+    if (words.empty()) {
+        return -1;
+    }
+
+    // the search starts at the beginning of the word of start_offset
+    const std::size_t start_word = start_offset >> 5;
+    const int offset = best_fit ? find_best_fit(start_word, size) : find_first_fit(start_word, size);
+    if (offset < 0)
+        return -1;
+
+    size = force_fill(static_cast<std::uint32_t>(offset), size, false);
+    return offset;
+}
+
 int BitmapAllocator::allocate_at(const std::uint32_t start_offset, std::uint32_t size) {
     if (free_slot_count(start_offset, start_offset + size) != size) {
         return -1;
@@ -186,18 +316,9 @@ int BitmapAllocator::allocate_at(const std::uint32_t start_offset, std::uint32_t
     return 0;
 }
 
-#ifdef __cpp_lib_bitops
-#include <bit>
 static int number_of_set_bits(std::uint32_t i) {
     return std::popcount(i);
 }
-#else
-static int number_of_set_bits(std::uint32_t i) {
-    i = i - ((i >> 1) & 0x55555555);
-    i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
-    return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
-}
-#endif
 
 int BitmapAllocator::free_slot_count(const std::uint32_t offset, const std::uint32_t offset_end) const {
     if (offset >= offset_end) {
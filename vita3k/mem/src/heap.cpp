@@ -0,0 +1,316 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/heap.h>
+#include <mem/state.h>
+
+#include <util/align.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+static constexpr uint32_t PAGE_SIZE = KiB(4);
+
+// Spaced so that rounding a size up never wastes more than 25% of the block
+static constexpr uint16_t SIZE_CLASSES[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+    2560, 3072
+};
+
+static_assert(SIZE_CLASSES[std::size(SIZE_CLASSES) - 1] == GuestHeap::MAX_SMALL_SIZE);
+
+GuestHeap::GuestHeap()
+    : size_classes(std::size(SIZE_CLASSES)) {
+    uint8_t size_class = 0;
+    for (uint32_t i = 0; i < class_of_size.size(); i++) {
+        while (SIZE_CLASSES[size_class] < i * MIN_ALIGNMENT)
+            size_class++;
+        class_of_size[i] = size_class;
+    }
+    for (uint32_t i = 0; i < size_classes.size(); i++)
+        size_classes[i].size = SIZE_CLASSES[i];
+}
+
+Address GuestHeap::malloc(MemState &mem, uint32_t size) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return allocate(mem, size, MIN_ALIGNMENT);
+}
+
+Address GuestHeap::calloc(MemState &mem, uint32_t count, uint32_t size) {
+    const uint64_t total = static_cast<uint64_t>(count) * size;
+    if (total > UINT32_MAX)
+        return 0;
+
+    Address address;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        address = allocate(mem, static_cast<uint32_t>(total), MIN_ALIGNMENT);
+    }
+    if (address)
+        memset(&mem.memory[address], 0, total);
+    return address;
+}
+
+Address GuestHeap::realloc(MemState &mem, Address address, uint32_t size) {
+    return reallocalign(mem, address, MIN_ALIGNMENT, size);
+}
+
+Address GuestHeap::reallocalign(MemState &mem, Address address, uint32_t alignment, uint32_t size) {
+    if (!address)
+        return memalign(mem, alignment, size);
+    if (!std::has_single_bit(alignment))
+        return 0;
+    alignment = std::max(alignment, MIN_ALIGNMENT);
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t old_size = block_size(address);
+    if (old_size == 0) {
+        LOG_ERROR("realloc of unknown block {}", log_hex(address));
+        return 0;
+    }
+
+    // keep the block when it does not shrink by more than half, moving it would not save much
+    if (address % alignment == 0 && size <= old_size && size >= old_size / 2)
+        return address;
+
+    const Address new_address = allocate(mem, size, alignment);
+    if (!new_address)
+        return 0;
+
+    memcpy(&mem.memory[new_address], &mem.memory[address], std::min(size, old_size));
+    deallocate(mem, address);
+    return new_address;
+}
+
+Address GuestHeap::memalign(MemState &mem, uint32_t alignment, uint32_t size) {
+    if (!std::has_single_bit(alignment))
+        return 0;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    return allocate(mem, size, std::max(alignment, MIN_ALIGNMENT));
+}
+
+void GuestHeap::free(MemState &mem, Address address) {
+    if (!address)
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (deallocate(mem, address))
+            return;
+    }
+
+    // not one of ours, it may come from a plain alloc
+    ::free(mem, address);
+}
+
+uint32_t GuestHeap::usable_size(Address address) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return block_size(address);
+}
+
+GuestHeapStats GuestHeap::stats() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return heap_stats;
+}
+
+Address GuestHeap::allocate(MemState &mem, uint32_t size, uint32_t alignment) {
+    if (size <= MAX_SMALL_SIZE) {
+        // regions, and so slabs, are only page aligned: a slot is aligned if its size is a multiple of the alignment,
+        // which is then at most 2 KiB and divides the page size
+        for (uint32_t size_class = class_of_size[align(size, MIN_ALIGNMENT) / MIN_ALIGNMENT]; size_class < size_classes.size(); size_class++) {
+            if (size_classes[size_class].size % alignment == 0)
+                return alloc_small(mem, size_class);
+        }
+    }
+
+    return alloc_large(mem, size, alignment);
+}
+
+bool GuestHeap::deallocate(MemState &mem, Address address) {
+    Slab *slab = find_slab(address);
+    if (slab) {
+        free_small(mem, *slab, address);
+        return true;
+    }
+
+    const auto block = large_blocks.find(address);
+    if (block == large_blocks.end())
+        return false;
+
+    add_system(-static_cast<int64_t>(block->second));
+    add_in_use(-static_cast<int64_t>(block->second));
+    large_blocks.erase(block);
+    ::free(mem, address);
+    return true;
+}
+
+uint32_t GuestHeap::block_size(Address address) {
+    if (const Slab *slab = find_slab(address))
+        return size_classes[slab->size_class].size;
+
+    const auto block = large_blocks.find(address);
+    return block == large_blocks.end() ? 0 : block->second;
+}
+
+GuestHeap::Slab *GuestHeap::find_slab(Address address) {
+    auto region = regions.upper_bound(address);
+    if (region == regions.begin())
+        return nullptr;
+    --region;
+
+    const Address offset = address - region->first;
+    if (offset >= REGION_SIZE)
+        return nullptr;
+
+    Slab &slab = region->second->slabs[offset / SLAB_SIZE];
+    return slab.active ? &slab : nullptr;
+}
+
+GuestHeap::Slab *GuestHeap::take_slab(MemState &mem, uint32_t size_class) {
+    if (free_slabs.empty()) {
+        const Address base = alloc(mem, REGION_SIZE, "Guest heap");
+        if (!base)
+            return nullptr;
+
+        auto region = std::make_unique<Region>();
+        region->base = base;
+        // hand out the lowest slabs first
+        for (uint32_t i = static_cast<uint32_t>(region->slabs.size()); i-- > 0;) {
+            region->slabs[i].region = region.get();
+            region->slabs[i].base = base + i * SLAB_SIZE;
+            free_slabs.push_back(&region->slabs[i]);
+        }
+        regions.emplace(base, std::move(region));
+        add_system(REGION_SIZE);
+    }
+
+    Slab &slab = *free_slabs.back();
+    free_slabs.pop_back();
+
+    slab.size_class = static_cast<uint16_t>(size_class);
+    slab.capacity = static_cast<uint16_t>(SLAB_SIZE / size_classes[size_class].size);
+    slab.free_count = slab.capacity;
+    slab.free_slots.fill(0);
+    for (uint32_t i = 0; i < slab.capacity / 64; i++)
+        slab.free_slots[i] = ~0ull;
+    if (slab.capacity % 64)
+        slab.free_slots[slab.capacity / 64] = (1ull << (slab.capacity % 64)) - 1;
+    slab.active = true;
+    slab.region->active_slabs++;
+
+    return &slab;
+}
+
+void GuestHeap::release_slab(MemState &mem, Slab &slab) {
+    slab.active = false;
+    Region &region = *slab.region;
+    region.active_slabs--;
+
+    // keep the last region around, a program freeing all its blocks is likely to allocate again
+    if (region.active_slabs == 0 && regions.size() > 1) {
+        std::erase_if(free_slabs, [&](const Slab *free_slab) { return free_slab->region == &region; });
+        const Address base = region.base;
+        regions.erase(base);
+        add_system(-static_cast<int64_t>(REGION_SIZE));
+        ::free(mem, base);
+        return;
+    }
+
+    free_slabs.push_back(&slab);
+}
+
+Address GuestHeap::alloc_small(MemState &mem, uint32_t size_class) {
+    SizeClass &sc = size_classes[size_class];
+    if (sc.partial.empty()) {
+        Slab *slab = take_slab(mem, size_class);
+        if (!slab)
+            return 0;
+        sc.partial.push_back(slab);
+    }
+
+    Slab &slab = *sc.partial.back();
+    uint32_t word = 0;
+    while (slab.free_slots[word] == 0)
+        word++;
+
+    const uint32_t bit = std::countr_zero(slab.free_slots[word]);
+    slab.free_slots[word] &= ~(1ull << bit);
+    if (--slab.free_count == 0)
+        sc.partial.pop_back();
+
+    add_in_use(sc.size);
+    return slab.base + (word * 64 + bit) * sc.size;
+}
+
+void GuestHeap::free_small(MemState &mem, Slab &slab, Address address) {
+    SizeClass &sc = size_classes[slab.size_class];
+    const uint32_t offset = address - slab.base;
+    const uint32_t slot = offset / sc.size;
+    if (offset % sc.size != 0 || slot >= slab.capacity) {
+        LOG_ERROR("Freeing {} which is not the start of a block", log_hex(address));
+        return;
+    }
+
+    uint64_t &word = slab.free_slots[slot / 64];
+    const uint64_t mask = 1ull << (slot % 64);
+    if (word & mask) {
+        LOG_ERROR("Freeing {} twice", log_hex(address));
+        return;
+    }
+
+    word |= mask;
+    add_in_use(-static_cast<int64_t>(sc.size));
+    if (slab.free_count++ == 0)
+        sc.partial.push_back(&slab);
+
+    // an empty slab can go to another size class, unless it is the only one left for this one
+    if (slab.free_count == slab.capacity && sc.partial.size() > 1) {
+        std::erase(sc.partial, &slab);
+        release_slab(mem, slab);
+    }
+}
+
+Address GuestHeap::alloc_large(MemState &mem, uint32_t size, uint32_t alignment) {
+    if (size > UINT32_MAX - PAGE_SIZE)
+        return 0;
+
+    const uint32_t page_size = align(std::max(size, 1u), PAGE_SIZE);
+    const Address address = alignment > PAGE_SIZE ? alloc_aligned(mem, page_size, "Guest heap", alignment) : alloc(mem, page_size, "Guest heap");
+    if (!address)
+        return 0;
+
+    large_blocks.emplace(address, page_size);
+    add_system(page_size);
+    add_in_use(page_size);
+    return address;
+}
+
+void GuestHeap::add_system(int64_t delta) {
+    heap_stats.system_size = static_cast<uint32_t>(heap_stats.system_size + delta);
+    heap_stats.max_system_size = std::max(heap_stats.max_system_size, heap_stats.system_size);
+}
+
+void GuestHeap::add_in_use(int64_t delta) {
+    heap_stats.in_use_size = static_cast<uint32_t>(heap_stats.in_use_size + delta);
+    heap_stats.max_in_use_size = std::max(heap_stats.max_in_use_size, heap_stats.in_use_size);
+}
@@ -22,6 +22,7 @@
 #include <util/log.h>
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstring>
 #include <mutex>
@@ -51,6 +52,7 @@ static void register_access_violation_handler(const AccessViolationHandler &hand
 
 static Address alloc_inner(MemState &state, uint32_t start_page, uint32_t page_count, const char *name, const bool force);
 static void delete_memory(uint8_t *memory);
+static bool release_watched_pages(MemState &state, Address addr, uint32_t size);
 
 #ifdef _WIN32
 static std::string get_error_msg() {
@@ -104,6 +106,10 @@ bool init(MemState &state, const bool use_page_table) {
     state.alloc_table = AllocPageTable(new AllocMemPage[table_length]);
     memset(state.alloc_table.get(), 0, sizeof(AllocMemPage) * table_length);
 
+    state.watched_pages = std::make_unique<std::atomic<uint64_t>[]>(table_length / 64);
+    state.page_write_generation = std::make_unique<std::atomic<uint32_t>[]>(table_length);
+    state.write_generation = 0;
+
     state.allocator.set_maximum(table_length);
 
     const auto handler = [&state](uint8_t *addr, bool write) noexcept {
@@ -154,6 +160,31 @@ bool is_valid_addr_range(const MemState &state, Address start, Address end) {
     return state.allocator.free_slot_count(start_page, end_page) == 0;
 }
 
+// Number of free guest pages in the host page starting at host_page
+static uint32_t free_pages_in_host_page(const MemState &state, Address host_page) {
+    const uint32_t first_guest = host_page / STANDARD_PAGE_SIZE;
+    const uint32_t last_guest = (host_page + state.host_page_size) / STANDARD_PAGE_SIZE;
+    return state.allocator.free_slot_count(first_guest, last_guest);
+}
+
+// A host page with all its guest pages free is either untouched since init or was decommitted by free,
+// the OS gives it back zeroed on the next touch. Only the host pages at both ends of an allocation
+// can be shared with other allocations and hold stale data, those are the only ones zeroed here.
+static void zero_shared_host_pages(MemState &state, Address addr, uint32_t size) {
+    const Address end = addr + size;
+    const uint32_t pages_per_host_page = state.host_page_size / STANDARD_PAGE_SIZE;
+    for (const Address host_page : { align_down(addr, state.host_page_size), align_down(end - 1, state.host_page_size) }) {
+        const Address start = std::max(host_page, addr);
+        const Address stop = std::min(host_page + state.host_page_size, end);
+        // the pages of the allocation were free before it
+        const uint32_t free_pages = free_pages_in_host_page(state, host_page) + (stop - start) / STANDARD_PAGE_SIZE;
+        if (free_pages != pages_per_host_page)
+            std::memset(&state.memory[start], 0, stop - start);
+        if (host_page + state.host_page_size >= end)
+            break;
+    }
+}
+
 static Address alloc_inner(MemState &state, uint32_t start_page, uint32_t page_count, const char *name, const bool force) {
     int page_num;
     if (force) {
@@ -183,7 +214,10 @@ static Address alloc_inner(MemState &state, uint32_t start_page, uint32_t page_c
     const int ret = mprotect(commit_ptr, commit_size, PROT_READ | PROT_WRITE);
     LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
 #endif
-    std::memset(&state.memory[addr], 0, size);
+    if (state.lazy_zero_fill)
+        zero_shared_host_pages(state, addr, size);
+    else
+        std::memset(&state.memory[addr], 0, size);
 
     AllocMemPage &page = state.alloc_table[page_num];
     assert(!page.allocated);
@@ -298,21 +332,21 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
         fmt::print("Access: {}\n", log_hex(vaddr));
     }
 
+    // the whole host page loses its protection, so every watched page in it counts as written
+    const Address host_page = align_down(vaddr, state.host_page_size);
+    const bool was_watched = write && release_watched_pages(state, host_page, state.host_page_size);
+
     auto it = state.protect_tree.lower_bound(vaddr);
-    if (it == state.protect_tree.end()) {
-        // HACK: keep going
-        unprotect_inner(state, align_down(vaddr, state.host_page_size), state.host_page_size);
-        LOG_CRITICAL("Unhandled write protected region was valid. Address=0x{:X}", vaddr);
+    if (it == state.protect_tree.end() || vaddr < it->first || vaddr >= it->first + it->second.size) {
+        unprotect_inner(state, host_page, state.host_page_size);
+        if (!was_watched) {
+            // HACK: keep going
+            LOG_CRITICAL("Unhandled write protected region was valid. Address=0x{:X}", vaddr);
+        }
         return true;
     }
 
     ProtectSegmentInfo &info = it->second;
-    if (vaddr < it->first || vaddr >= it->first + info.size) {
-        // HACK: keep going
-        unprotect_inner(state, align_down(vaddr, state.host_page_size), state.host_page_size);
-        LOG_CRITICAL("Unhandled write protected region was valid. Address=0x{:X}", vaddr);
-        return true;
-    }
 
     Address previous_beg = it->first;
     for (auto &[block_addr, block] : info.blocks) {
@@ -320,11 +354,85 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     }
 
     unprotect_inner(state, it->first, info.size);
+    release_watched_pages(state, it->first, info.size);
     state.protect_tree.erase(it);
 
     return true;
 }
 
+// Records a write to the watched pages of the range and stops watching them, returns false if none was watched
+static bool release_watched_pages(MemState &state, Address addr, uint32_t size) {
+    const uint32_t first_page = addr / STANDARD_PAGE_SIZE;
+    const uint32_t end_page = static_cast<uint32_t>((static_cast<uint64_t>(addr) + size + STANDARD_PAGE_SIZE - 1) / STANDARD_PAGE_SIZE);
+
+    uint32_t generation = 0;
+    for (uint32_t page = first_page; page < end_page;) {
+        const uint32_t word_end = std::min(end_page, (page | 63) + 1);
+        uint64_t mask = ~0ULL << (page % 64);
+        if (word_end % 64 != 0)
+            mask &= ~(~0ULL << (word_end % 64));
+
+        uint64_t released = state.watched_pages[page / 64].fetch_and(~mask, std::memory_order_acq_rel) & mask;
+        while (released != 0) {
+            if (generation == 0)
+                generation = state.write_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+            const uint32_t bit = std::countr_zero(released);
+            state.page_write_generation[(page & ~63u) + bit].store(generation, std::memory_order_release);
+            released &= released - 1;
+        }
+        page = word_end;
+    }
+
+    return generation != 0;
+}
+
+uint32_t watch_pages(MemState &state, Address addr, uint32_t size) {
+    // read it before protecting, a write happening in between is then seen as newer
+    const uint32_t generation = state.write_generation.load(std::memory_order_acquire);
+    if (size == 0)
+        return generation;
+
+    const std::lock_guard<std::mutex> lock(state.protect_mutex);
+    align_to_page(state, addr, size);
+
+    const uint32_t first_page = addr / STANDARD_PAGE_SIZE;
+    const uint32_t end_page = first_page + size / STANDARD_PAGE_SIZE;
+    for (uint32_t page = first_page; page < end_page;) {
+        const uint32_t word_end = std::min(end_page, (page | 63) + 1);
+        uint64_t mask = ~0ULL << (page % 64);
+        if (word_end % 64 != 0)
+            mask &= ~(~0ULL << (word_end % 64));
+
+        state.watched_pages[page / 64].fetch_or(mask, std::memory_order_acq_rel);
+        page = word_end;
+    }
+
+    protect_inner(state, addr, size, MemPerm::ReadOnly);
+
+    // do not lift a more restrictive protection
+    auto it = state.protect_tree.lower_bound(addr + size - 1);
+    while (it != state.protect_tree.end() && it->first + it->second.size > addr) {
+        if (it->second.perm == MemPerm::None)
+            protect_inner(state, it->first, it->second.size, MemPerm::None);
+        ++it;
+    }
+
+    return generation;
+}
+
+bool pages_written_since(const MemState &state, Address addr, uint32_t size, uint32_t generation) {
+    const uint32_t first_page = addr / STANDARD_PAGE_SIZE;
+    const uint32_t end_page = static_cast<uint32_t>((static_cast<uint64_t>(addr) + size + STANDARD_PAGE_SIZE - 1) / STANDARD_PAGE_SIZE);
+    for (uint32_t page = first_page; page < end_page; page++) {
+        // the difference handles the wrap-around of the generation
+        const uint32_t page_generation = state.page_write_generation[page].load(std::memory_order_acquire);
+        if (static_cast<int32_t>(page_generation - generation) > 0)
+            return true;
+    }
+
+    return false;
+}
+
 bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
     const std::lock_guard<std::mutex> lock(state.protect_mutex);
     ProtectSegmentInfo protect(size, perm);
@@ -420,6 +528,7 @@ void remove_external_mapping(MemState &mem, uint8_t *addr_ptr, uint32_t size) {
 
     // remove all protections on this range
     unprotect_inner(mem, mapping.address, mapping.size);
+    release_watched_pages(mem, mapping.address, mapping.size);
     {
         const std::unique_lock<std::mutex> lock(mem.protect_mutex);
         auto prot_it = mem.protect_tree.lower_bound(mapping.address);
@@ -498,51 +607,40 @@ void free(MemState &state, Address address) {
         state.page_name_map.erase(page_num);
     }
 
+    // the memory is going to be decommitted, whoever watches it must see it changed
+    release_watched_pages(state, page_num * STANDARD_PAGE_SIZE, page.size * STANDARD_PAGE_SIZE);
+
     assert(!state.use_page_table || state.page_table[address / KiB(4)] == state.memory.get());
     const Address region_start = page_num * STANDARD_PAGE_SIZE;
     const Address region_end = region_start + page.size * STANDARD_PAGE_SIZE;
 
-    Address host_page = align_down(region_start, state.host_page_size);
-    Address batch_start = 0;
-    uint32_t batch_size = 0;
-
-    while (host_page < region_end) {
-        Address host_page_end = host_page + state.host_page_size;
-        uint32_t first_guest = host_page / STANDARD_PAGE_SIZE;
-        uint32_t last_guest = host_page_end / STANDARD_PAGE_SIZE;
-
-        if (state.allocator.free_slot_count(first_guest, last_guest) == (last_guest - first_guest)) {
-            if (batch_size == 0)
-                batch_start = host_page;
-            batch_size += state.host_page_size;
-        } else if (batch_size > 0) {
-            uint8_t *memory = &state.memory[batch_start];
-#ifdef _WIN32
-            const BOOL ret = VirtualFree(memory, batch_size, MEM_DECOMMIT);
-            LOG_CRITICAL_IF(!ret, "VirtualFree failed: {}", get_error_msg());
-#else
-            int ret = mprotect(memory, batch_size, PROT_NONE);
-            LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
-            ret = madvise(memory, batch_size, MADV_DONTNEED);
-            LOG_CRITICAL_IF(ret == -1, "madvise failed: {}", get_error_msg());
-#endif
-            batch_size = 0;
-        }
-        host_page = host_page_end;
-    }
+    // the host pages in between only hold the freed pages, only both ends can still be in use
+    const uint32_t pages_per_host_page = state.host_page_size / STANDARD_PAGE_SIZE;
+    Address decommit_start = align_down(region_start, state.host_page_size);
+    Address decommit_end = align(region_end, state.host_page_size);
+    if (free_pages_in_host_page(state, decommit_start) != pages_per_host_page)
+        decommit_start += state.host_page_size;
+    if (decommit_end > decommit_start && free_pages_in_host_page(state, decommit_end - state.host_page_size) != pages_per_host_page)
+        decommit_end -= state.host_page_size;
+    if (decommit_end <= decommit_start)
+        return;
 
-    if (batch_size > 0) {
-        uint8_t *memory = &state.memory[batch_start];
+    uint8_t *memory = &state.memory[decommit_start];
+    const uint32_t decommit_size = decommit_end - decommit_start;
 #ifdef _WIN32
-        const BOOL ret = VirtualFree(memory, batch_size, MEM_DECOMMIT);
-        LOG_CRITICAL_IF(!ret, "VirtualFree failed: {}", get_error_msg());
+    const BOOL ret = VirtualFree(memory, decommit_size, MEM_DECOMMIT);
+    LOG_CRITICAL_IF(!ret, "VirtualFree failed: {}", get_error_msg());
+#elif defined(__APPLE__)
+    // MADV_DONTNEED does not guarantee the pages are zeroed on macOS, lazy_zero_fill relies on it.
+    // Mapping new anonymous pages over them does, and releases the old ones as well.
+    const void *const ret = mmap(memory, decommit_size, PROT_NONE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    LOG_CRITICAL_IF(ret == MAP_FAILED, "mmap failed: {}", get_error_msg());
 #else
-        int ret = mprotect(memory, batch_size, PROT_NONE);
-        LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
-        ret = madvise(memory, batch_size, MADV_DONTNEED);
-        LOG_CRITICAL_IF(ret == -1, "madvise failed: {}", get_error_msg());
+    int ret = mprotect(memory, decommit_size, PROT_NONE);
+    LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
+    ret = madvise(memory, decommit_size, MADV_DONTNEED);
+    LOG_CRITICAL_IF(ret == -1, "madvise failed: {}", get_error_msg());
 #endif
-    }
 }
 
 uint32_t mem_available(MemState &state) {
@@ -566,6 +664,8 @@ void deinit_mem(MemState &state) {
 
     state.memory.reset();
     state.alloc_table.reset();
+    state.watched_pages.reset();
+    state.page_write_generation.reset();
     state.allocator.reset();
     state.page_name_map.clear();
     state.page_table.reset();
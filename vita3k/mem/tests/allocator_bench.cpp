@@ -0,0 +1,93 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/allocator.h>
+
+#include <benchmark/benchmark.h>
+
+// Same number of pages as the guest address space of MemState
+static constexpr std::uint32_t PAGE_COUNT = 1 << 20;
+
+// Allocates state.range(0) pages at a time until the allocator is full, then frees everything
+static void BM_Sequential(benchmark::State &state) {
+    const std::uint32_t block_size = static_cast<std::uint32_t>(state.range(0));
+    BitmapAllocator allocator(PAGE_COUNT);
+    std::int64_t allocations = 0;
+
+    for (auto _ : state) {
+        std::uint32_t size = block_size;
+        const int offset = allocator.allocate_from(0, size);
+        if (offset < 0) {
+            state.PauseTiming();
+            allocator.free(0, PAGE_COUNT);
+            state.ResumeTiming();
+            continue;
+        }
+
+        benchmark::DoNotOptimize(offset);
+        allocations++;
+    }
+
+    state.SetItemsProcessed(allocations);
+}
+
+// The whole space is made of 3 used pages followed by a free one, except for the last 1 MiB pages
+static void make_fragmented(BitmapAllocator &allocator) {
+    std::uint32_t size = PAGE_COUNT - 256;
+    allocator.allocate_from(0, size);
+    for (std::uint32_t page = 3; page < PAGE_COUNT - 256; page += 4)
+        allocator.free(page, 1);
+}
+
+// Allocates and frees a block which does not fit in any of the holes
+static void BM_Fragmented(benchmark::State &state) {
+    BitmapAllocator allocator(PAGE_COUNT);
+    make_fragmented(allocator);
+    const bool best_fit = state.range(0) != 0;
+
+    for (auto _ : state) {
+        std::uint32_t size = 4;
+        const int offset = allocator.allocate_from(0, size, best_fit);
+        benchmark::DoNotOptimize(offset);
+        allocator.free(offset, size);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Allocates and frees a block at the end of an allocator where everything else is used
+static void BM_NearlyFull(benchmark::State &state) {
+    BitmapAllocator allocator(PAGE_COUNT);
+    std::uint32_t size = PAGE_COUNT - 256;
+    allocator.allocate_from(0, size);
+    const bool best_fit = state.range(0) != 0;
+
+    for (auto _ : state) {
+        std::uint32_t size = 4;
+        const int offset = allocator.allocate_from(0, size, best_fit);
+        benchmark::DoNotOptimize(offset);
+        allocator.free(offset, size);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Sequential)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(BM_Fragmented)->ArgName("best_fit")->Arg(0)->Arg(1);
+BENCHMARK(BM_NearlyFull)->ArgName("best_fit")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,209 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/heap.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+class guest_heap : public testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+    }
+
+    void TearDown() override {
+        deinit_mem(mem);
+    }
+
+    uint8_t *ptr(Address address) {
+        return &mem.memory[address];
+    }
+
+    MemState mem;
+};
+
+TEST_F(guest_heap, small_blocks_are_aligned_and_do_not_overlap) {
+    GuestHeap heap;
+    std::vector<std::pair<Address, uint32_t>> blocks;
+    for (uint32_t size = 0; size <= 600; size += 7) {
+        const Address address = heap.malloc(mem, size);
+        ASSERT_NE(address, 0);
+        EXPECT_EQ(address % GuestHeap::MIN_ALIGNMENT, 0);
+        EXPECT_GE(heap.usable_size(address), size);
+        blocks.emplace_back(address, heap.usable_size(address));
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    for (size_t i = 1; i < blocks.size(); i++)
+        EXPECT_LE(blocks[i - 1].first + blocks[i - 1].second, blocks[i].first);
+
+    for (const auto &[address, size] : blocks)
+        heap.free(mem, address);
+    EXPECT_EQ(heap.stats().in_use_size, 0);
+}
+
+TEST_F(guest_heap, calloc_zeroes_reused_block) {
+    GuestHeap heap;
+    const Address first = heap.malloc(mem, 64);
+    ASSERT_NE(first, 0);
+    memset(ptr(first), 0xcc, 64);
+    heap.free(mem, first);
+
+    const Address second = heap.calloc(mem, 16, 4);
+    ASSERT_EQ(second, first);
+    EXPECT_TRUE(std::all_of(ptr(second), ptr(second) + 64, [](uint8_t byte) { return byte == 0; }));
+
+    EXPECT_EQ(heap.calloc(mem, 0x10000, 0x10000), 0);
+}
+
+TEST_F(guest_heap, realloc_keeps_content) {
+    GuestHeap heap;
+    Address address = heap.malloc(mem, 24);
+    ASSERT_NE(address, 0);
+    for (uint8_t i = 0; i < 24; i++)
+        ptr(address)[i] = i;
+
+    // small -> small -> large -> small
+    for (const uint32_t size : { 200u, 20000u, 30u }) {
+        address = heap.realloc(mem, address, size);
+        ASSERT_NE(address, 0);
+        EXPECT_GE(heap.usable_size(address), size);
+        for (uint8_t i = 0; i < 24; i++)
+            ASSERT_EQ(ptr(address)[i], i);
+    }
+
+    // shrinking a little keeps the block
+    EXPECT_EQ(heap.realloc(mem, address, 20), address);
+    heap.free(mem, address);
+}
+
+TEST_F(guest_heap, reallocalign_moves_misaligned_blocks_and_leaves_unknown_ones) {
+    GuestHeap heap;
+    Address address = heap.malloc(mem, 48);
+    ASSERT_NE(address, 0);
+    for (uint8_t i = 0; i < 48; i++)
+        ptr(address)[i] = i;
+
+    address = heap.reallocalign(mem, address, 1024, 40);
+    ASSERT_NE(address, 0);
+    EXPECT_EQ(address % 1024, 0);
+    for (uint8_t i = 0; i < 40; i++)
+        ASSERT_EQ(ptr(address)[i], i);
+    heap.free(mem, address);
+
+    const Address foreign = alloc(mem, 32, "foreign");
+    EXPECT_EQ(heap.reallocalign(mem, foreign, 64, 100), 0);
+    EXPECT_EQ(heap.realloc(mem, foreign, 100), 0);
+    // still allocated
+    EXPECT_TRUE(is_valid_addr(mem, foreign));
+    free(mem, foreign);
+}
+
+TEST_F(guest_heap, memalign_respects_alignment) {
+    GuestHeap heap;
+    for (const uint32_t alignment : { 4u, 32u, 64u, 256u, 1024u, 4096u, 65536u }) {
+        const Address address = heap.memalign(mem, alignment, 100);
+        ASSERT_NE(address, 0);
+        EXPECT_EQ(address % alignment, 0);
+        heap.free(mem, address);
+    }
+    EXPECT_EQ(heap.memalign(mem, 24, 100), 0);
+}
+
+TEST_F(guest_heap, large_blocks_and_foreign_blocks_are_returned) {
+    GuestHeap heap;
+    const uint32_t available = mem_available(mem);
+
+    const Address large = heap.malloc(mem, KiB(100));
+    ASSERT_NE(large, 0);
+    EXPECT_EQ(heap.usable_size(large), KiB(100));
+    heap.free(mem, large);
+
+    // blocks allocated before the heap existed are freed through the page allocator
+    const Address foreign = alloc(mem, 32, "foreign");
+    EXPECT_EQ(heap.usable_size(foreign), 0);
+    heap.free(mem, foreign);
+
+    EXPECT_EQ(mem_available(mem), available);
+}
+
+TEST_F(guest_heap, empty_regions_are_released) {
+    GuestHeap heap;
+    std::vector<Address> blocks;
+    // enough 1 KiB blocks for several regions
+    for (uint32_t i = 0; i < 1024; i++)
+        blocks.push_back(heap.malloc(mem, 1000));
+    EXPECT_GE(heap.stats().system_size, 4 * GuestHeap::REGION_SIZE);
+
+    for (const Address address : blocks)
+        heap.free(mem, address);
+    EXPECT_EQ(heap.stats().system_size, GuestHeap::REGION_SIZE);
+    EXPECT_GE(heap.stats().max_system_size, 4 * GuestHeap::REGION_SIZE);
+}
+
+// Same random sequence of small malloc/free with and without the heap, the heap must take far fewer pages
+TEST_F(guest_heap, stress_peak_memory_against_page_allocation) {
+    const auto run = [&](const std::function<Address(uint32_t)> &allocate, const std::function<void(Address)> &release, uint32_t kept) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> size_dist(1, 256);
+        const uint32_t available = mem_available(mem);
+        uint32_t peak = 0;
+        std::vector<Address> live;
+        for (int i = 0; i < 20000; i++) {
+            if (live.size() < 2000 && (live.empty() || rng() % 3 != 0)) {
+                const uint32_t size = size_dist(rng);
+                const Address address = allocate(size);
+                EXPECT_NE(address, 0);
+                memset(ptr(address), 0xaa, size);
+                live.push_back(address);
+                if (i % 16 == 0)
+                    peak = std::max(peak, available - mem_available(mem));
+            } else {
+                const size_t index = rng() % live.size();
+                release(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+        for (const Address address : live)
+            release(address);
+        EXPECT_EQ(available - mem_available(mem), kept);
+        return peak;
+    };
+
+    const uint32_t page_peak = run([&](uint32_t size) { return alloc(mem, size, "stress"); }, [&](Address address) { free(mem, address); }, 0);
+
+    uint32_t heap_peak;
+    {
+        GuestHeap heap;
+        heap_peak = run([&](uint32_t size) { return heap.malloc(mem, size); }, [&](Address address) { heap.free(mem, address); }, GuestHeap::REGION_SIZE);
+        EXPECT_EQ(heap.stats().in_use_size, 0);
+        EXPECT_GE(heap.stats().max_system_size, heap_peak);
+    }
+
+    // close to 2000 live blocks of up to 256 bytes: a page each without the heap, two regions with it
+    EXPECT_GE(page_peak, 1900 * KiB(4));
+    EXPECT_LE(heap_peak, 2 * GuestHeap::REGION_SIZE);
+    EXPECT_LT(heap_peak * 10, page_peak);
+}
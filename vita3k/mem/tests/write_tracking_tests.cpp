@@ -0,0 +1,83 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+class write_tracking : public testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+        addr = alloc(mem, KiB(64), "write_tracking");
+        ASSERT_NE(addr, 0);
+    }
+
+    void TearDown() override {
+        deinit_mem(mem);
+    }
+
+    uint8_t *ptr(Address address) {
+        return &mem.memory[address];
+    }
+
+    MemState mem;
+    Address addr = 0;
+};
+
+TEST_F(write_tracking, write_is_recorded) {
+    const uint32_t generation = watch_pages(mem, addr, KiB(16));
+    EXPECT_EQ(ptr(addr)[0], 0);
+    EXPECT_FALSE(pages_written_since(mem, addr, KiB(16), generation));
+
+    ptr(addr + KiB(8))[1] = 1;
+    EXPECT_TRUE(pages_written_since(mem, addr, KiB(16), generation));
+    EXPECT_TRUE(pages_written_since(mem, addr + KiB(8), 4, generation));
+}
+
+TEST_F(write_tracking, write_outside_of_range_is_ignored) {
+    const uint32_t generation = watch_pages(mem, addr + KiB(32), KiB(4));
+    ptr(addr)[0] = 1;
+    ptr(addr + KiB(40))[0] = 1;
+    EXPECT_FALSE(pages_written_since(mem, addr + KiB(32), KiB(4), generation));
+}
+
+TEST_F(write_tracking, watch_again_after_write) {
+    uint32_t generation = watch_pages(mem, addr, KiB(4));
+    ptr(addr)[0] = 1;
+    ASSERT_TRUE(pages_written_since(mem, addr, KiB(4), generation));
+
+    generation = watch_pages(mem, addr, KiB(4));
+    EXPECT_FALSE(pages_written_since(mem, addr, KiB(4), generation));
+    ptr(addr)[0] = 2;
+    EXPECT_TRUE(pages_written_since(mem, addr, KiB(4), generation));
+}
+
+TEST_F(write_tracking, overlapping_watchers_see_the_same_write) {
+    const uint32_t first = watch_pages(mem, addr, KiB(16));
+    const uint32_t second = watch_pages(mem, addr + KiB(8), KiB(16));
+    ptr(addr + KiB(12))[0] = 1;
+    EXPECT_TRUE(pages_written_since(mem, addr, KiB(16), first));
+    EXPECT_TRUE(pages_written_since(mem, addr + KiB(8), KiB(16), second));
+}
+
+TEST_F(write_tracking, free_counts_as_write) {
+    const uint32_t generation = watch_pages(mem, addr, KiB(4));
+    free(mem, addr);
+    EXPECT_TRUE(pages_written_since(mem, addr, KiB(4), generation));
+}
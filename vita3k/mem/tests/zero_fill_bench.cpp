@@ -0,0 +1,65 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/state.h>
+
+#include <benchmark/benchmark.h>
+
+#ifdef __linux__
+#include <fstream>
+#include <unistd.h>
+#endif
+
+// Resident memory of the process in bytes, 0 where it is not known
+static uint64_t resident_size() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// What a game does at boot: allocates a big block (like sceKernelAllocMemBlock) and only touches part of it
+static void BM_BootAllocation(benchmark::State &state) {
+    MemState mem;
+    if (!init(mem, false)) {
+        state.SkipWithError("init failed");
+        return;
+    }
+    mem.lazy_zero_fill = state.range(0) != 0;
+    const uint32_t size = MiB(256);
+    uint64_t resident = 0;
+
+    for (auto _ : state) {
+        const uint64_t resident_before = resident_size();
+        const Address addr = alloc(mem, size, "boot");
+        // one byte every 64 KiB
+        for (uint32_t offset = 0; offset < size; offset += KiB(64))
+            mem.memory[addr + offset] = 1;
+        resident = resident_size() - resident_before;
+        free(mem, addr);
+    }
+
+    state.counters["resident_MiB"] = static_cast<double>(resident) / MiB(1);
+    deinit_mem(mem);
+}
+
+BENCHMARK(BM_BootAllocation)->ArgName("lazy")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
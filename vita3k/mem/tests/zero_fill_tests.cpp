@@ -0,0 +1,90 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+class zero_fill : public testing::TestWithParam<uint32_t> {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+        // pretend the host has bigger pages, guest pages then share host pages
+        mem.host_page_size = std::max(mem.host_page_size, GetParam());
+    }
+
+    void TearDown() override {
+        deinit_mem(mem);
+    }
+
+    bool is_zero(Address address, uint32_t size) {
+        return std::all_of(&mem.memory[address], &mem.memory[address + size], [](uint8_t byte) { return byte == 0; });
+    }
+
+    MemState mem;
+};
+
+TEST_P(zero_fill, fresh_allocation_is_zero) {
+    const Address addr = alloc(mem, MiB(1), "fresh");
+    ASSERT_NE(addr, 0);
+    EXPECT_TRUE(is_zero(addr, MiB(1)));
+}
+
+TEST_P(zero_fill, reused_pages_are_zero) {
+    const Address first = alloc(mem, KiB(64), "first");
+    ASSERT_NE(first, 0);
+    memset(&mem.memory[first], 0xff, KiB(64));
+    free(mem, first);
+
+    const Address second = alloc(mem, KiB(64), "second");
+    ASSERT_EQ(second, first);
+    EXPECT_TRUE(is_zero(second, KiB(64)));
+}
+
+TEST_P(zero_fill, pages_sharing_a_host_page_are_zero) {
+    // neighbours keep the host pages of the freed blocks committed
+    std::vector<Address> blocks;
+    for (int i = 0; i < 16; i++) {
+        blocks.push_back(alloc(mem, KiB(4), "block"));
+        ASSERT_NE(blocks.back(), 0);
+        memset(&mem.memory[blocks.back()], 0xff, KiB(4));
+    }
+    for (size_t i = 0; i < blocks.size(); i += 2)
+        free(mem, blocks[i]);
+
+    for (size_t i = 0; i < blocks.size(); i += 2) {
+        const Address addr = alloc(mem, KiB(4), "again");
+        ASSERT_NE(addr, 0);
+        EXPECT_TRUE(is_zero(addr, KiB(4)));
+    }
+}
+
+TEST_P(zero_fill, eager_mode_is_zero_too) {
+    mem.lazy_zero_fill = false;
+    const Address first = alloc(mem, KiB(16), "first");
+    memset(&mem.memory[first], 0xff, KiB(16));
+    free(mem, first);
+    const Address second = alloc(mem, KiB(16), "second");
+    EXPECT_TRUE(is_zero(second, KiB(16)));
+}
+
+INSTANTIATE_TEST_SUITE_P(host_page_sizes, zero_fill, testing::Values(KiB(4), KiB(16), KiB(64)));
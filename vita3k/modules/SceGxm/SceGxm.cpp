@@ -999,15 +999,6 @@ struct SceGxmContext {
     Ptr<uint8_t> alloc_space{};
     Ptr<uint8_t> alloc_space_end{};
 
-    // for immediate context only
-    // we use the fact that everything is done in an ordered manner
-    // (i.e if command a is allocated before b, then it is freed before b)
-    // the real positions are these ones modulo command_allocator_size
-    size_t command_next_free_pos;
-    // this one is atomic as it is read from one thread and written to by another
-    std::atomic<size_t> command_last_free_pos;
-    uint32_t command_allocator_size = 0;
-
     bool last_precomputed = false;
 
     // this is used for deferred contexts
@@ -1038,11 +1029,9 @@ struct SceGxmContext {
         renderer::Command *cmd = command_list->list->first;
         while (cmd != command_list->list->last) {
             renderer::Command *next = cmd->next;
-            renderer::destroy_command_payload(*cmd);
             free(cmd);
             cmd = next;
         }
-        renderer::destroy_command_payload(*cmd);
         free(cmd);
         free(command_list->list);
 
@@ -1111,11 +1100,7 @@ struct SceGxmContext {
             alloc_space = state.vdm_buffer.cast<uint8_t>();
             actual_size = state.vdm_buffer_size;
 
-            if (state.type == SCE_GXM_CONTEXT_TYPE_IMMEDIATE) {
-                command_allocator_size = state.vdm_buffer_size / sizeof(renderer::Command);
-                command_next_free_pos = 0;
-                command_last_free_pos = command_allocator_size - 1;
-            } else {
+            if (state.type != SCE_GXM_CONTEXT_TYPE_IMMEDIATE) {
                 // setting the vdm buffer size to 0 means we are using it
                 state.vdm_buffer_size = 0;
             }
@@ -1164,38 +1149,20 @@ struct SceGxmContext {
         return reinterpret_cast<T *>(linearly_allocate(kern, mem, thread_id, sizeof(T)));
     }
 
-    renderer::Command *allocate_new_command(KernelState &kern, const MemState &mem, SceUID current_thread_id) {
-        renderer::Command *new_command = nullptr;
+    renderer::Command *allocate_new_command(KernelState &kern, const MemState &mem, SceUID current_thread_id, std::size_t payload_size) {
+        if (state.type == SCE_GXM_CONTEXT_TYPE_IMMEDIATE)
+            return renderer->command_arena.allocate(payload_size);
 
-        if (state.type == SCE_GXM_CONTEXT_TYPE_IMMEDIATE) {
-            if (command_allocator_size > 0 && command_next_free_pos <= command_last_free_pos.load(std::memory_order_acquire)) {
-                size_t offset = command_next_free_pos % command_allocator_size;
-                command_next_free_pos++;
-                new_command = alloc_space.cast<renderer::Command>().get(mem) + offset;
-                new (new_command) renderer::Command;
-            } else {
-                new_command = new renderer::Command;
-                new_command->flags |= renderer::Command::FLAG_FROM_HOST;
-            }
-        } else {
-            new_command = linearly_allocate<renderer::Command>(kern, mem, current_thread_id);
+        // deferred commands stay alive as long as their command list, they are freed in free_command_list
+        uint8_t *memory = linearly_allocate(kern, mem, current_thread_id, sizeof(renderer::Command) + payload_size);
+        if (!memory)
+            return nullptr;
 
-            new (new_command) renderer::Command;
-            new_command->flags |= renderer::Command::FLAG_NO_FREE;
-        }
+        renderer::Command *new_command = new (memory) renderer::Command;
+        new_command->flags |= renderer::Command::FLAG_NO_FREE;
 
         return new_command;
     }
-
-    void free_new_command(renderer::Command *cmd) {
-        if (!(cmd->flags & renderer::Command::FLAG_NO_FREE)) {
-            if (cmd->flags & renderer::Command::FLAG_FROM_HOST) {
-                delete cmd;
-            } else {
-                command_last_free_pos.fetch_add(1, std::memory_order_release);
-            }
-        }
-    }
 };
 
 // the size of the context on a PS Vita is 2048 bytes
@@ -1203,13 +1170,9 @@ struct SceGxmContext {
 static_assert(sizeof(SceGxmContext) + 4 <= 2048);
 
 static void destroy_pending_immediate_commands(SceGxmContext *context) {
-    renderer::Command *cmd = context->renderer->command_list.first;
-    while (cmd) {
-        renderer::Command *next = cmd->next;
-        renderer::destroy_command_payload(*cmd);
-        context->free_new_command(cmd);
-        cmd = next;
-    }
+    renderer::CommandList &command_list = context->renderer->command_list;
+    if (command_list.first)
+        renderer::CommandArena::release(command_list.first, command_list.last);
 
     renderer::reset_command_list(context->renderer->command_list);
 }
@@ -1218,7 +1181,6 @@ static void destroy_pending_deferred_command_chain(renderer::CommandList &comman
     renderer::Command *cmd = command_list.first;
     while (cmd) {
         renderer::Command *next = cmd->next;
-        renderer::destroy_command_payload(*cmd);
         free(cmd);
         cmd = next;
     }
@@ -1654,11 +1616,11 @@ EXPORT(int, sceGxmBeginCommandList, SceGxmContext *deferredContext) {
     KernelState *kernel = &emuenv.kernel;
     MemState *mem = &emuenv.mem;
 
-    deferredContext->renderer->alloc_func = [deferredContext, kernel, mem, thread_id]() {
-        return deferredContext->allocate_new_command(*kernel, *mem, thread_id);
+    deferredContext->renderer->alloc_func = [deferredContext, kernel, mem, thread_id](std::size_t payload_size) {
+        return deferredContext->allocate_new_command(*kernel, *mem, thread_id, payload_size);
     };
 
-    deferredContext->renderer->free_func = [](renderer::Command *cmd) {
+    deferredContext->renderer->free_func = [](renderer::Command *first, renderer::Command *last) {
         // do not delete here, commands will be deleted when they are overwritten
     };
 
@@ -1713,21 +1675,7 @@ EXPORT(int, sceGxmBeginScene, SceGxmContext *context, uint32_t flags, const SceG
     context->is_vert_texture_dirty.set();
     context->is_frag_texture_dirty.set();
 
-    SceGxmColorSurface *color_surface_copy = nullptr;
-    SceGxmDepthStencilSurface *depth_stencil_surface_copy = nullptr;
-
-    if (colorSurface) {
-        color_surface_copy = new SceGxmColorSurface;
-        *color_surface_copy = *colorSurface;
-    }
-
-    if (depthStencil) {
-        depth_stencil_surface_copy = new SceGxmDepthStencilSurface;
-        *depth_stencil_surface_copy = *depthStencil;
-    }
-
-    renderer::set_context(*emuenv.renderer, context->renderer.get(), renderTarget->renderer.get(), color_surface_copy,
-        depth_stencil_surface_copy);
+    renderer::set_context(*emuenv.renderer, context->renderer.get(), renderTarget->renderer.get(), colorSurface, depthStencil);
 
     const std::uint32_t xmax = (validRegion ? validRegion->xMax : renderTarget->width - 1);
     const std::uint32_t ymax = (validRegion ? validRegion->yMax : renderTarget->height - 1);
@@ -2005,13 +1953,11 @@ EXPORT(int, sceGxmCreateContext, const SceGxmContextParams *params, Ptr<SceGxmCo
     KernelState *kernel = &emuenv.kernel;
     MemState *mem = &emuenv.mem;
 
-    ctx->renderer->alloc_func = [ctx, kernel, mem, thread_id]() {
-        return ctx->allocate_new_command(*kernel, *mem, thread_id);
+    ctx->renderer->alloc_func = [ctx, kernel, mem, thread_id](std::size_t payload_size) {
+        return ctx->allocate_new_command(*kernel, *mem, thread_id, payload_size);
     };
 
-    ctx->renderer->free_func = [ctx](renderer::Command *cmd) {
-        return ctx->free_new_command(cmd);
-    };
+    ctx->renderer->free_func = renderer::CommandArena::release;
 
     emuenv.gxm.immediate_context = context->address();
     return 0;
@@ -2335,8 +2281,6 @@ static int gxmDrawElementGeneral(EmuEnvState &emuenv, const char *export_name, c
     const SceGxmProgram &vertex_program_gxp = *gxm_vertex_program.program.get(emuenv.mem);
     const SceGxmProgram &fragment_program_gxp = *gxm_fragment_program.program.get(emuenv.mem);
 
-    const void *indices_ptr = indexData.get(emuenv.mem);
-
     gxmSetUniformBuffers(*emuenv.renderer, emuenv.gxm, context, vertex_program_gxp, context->state.vertex_uniform_buffers, gxm_vertex_program.renderer_data->uniform_buffer_sizes,
         emuenv.mem);
     gxmSetUniformBuffers(*emuenv.renderer, emuenv.gxm, context, fragment_program_gxp, context->state.fragment_uniform_buffers, gxm_fragment_program.renderer_data->uniform_buffer_sizes,
@@ -2372,13 +2316,7 @@ static int gxmDrawElementGeneral(EmuEnvState &emuenv, const char *export_name, c
     size_t max_index = 0;
     if (!emuenv.renderer->features.enable_memory_mapping) {
         // we don't need to get the vertex buffer size with memory mapping
-        if (indexType == SCE_GXM_INDEX_FORMAT_U16) {
-            const uint16_t *const data = static_cast<const uint16_t *>(indices_ptr);
-            max_index = *std::max_element(&data[0], &data[indexCount]);
-        } else {
-            const uint32_t *const data = static_cast<const uint32_t *>(indices_ptr);
-            max_index = *std::max_element(&data[0], &data[indexCount]);
-        }
+        max_index = emuenv.gxm.index_range_cache.get(emuenv.mem, indexData, indexCount, indexType).max;
     }
 
     size_t max_data_length[SCE_GXM_MAX_VERTEX_STREAMS] = {};
@@ -2494,13 +2432,7 @@ EXPORT(int, sceGxmDrawPrecomputed, SceGxmContext *context, SceGxmPrecomputedDraw
     uint32_t max_index = 0;
     if (!emuenv.renderer->features.enable_memory_mapping) {
         // we don't need to get the vertex buffer size with memory mapping
-        if (draw->index_format == SCE_GXM_INDEX_FORMAT_U16) {
-            const uint16_t *const data = draw->index_data.cast<const uint16_t>().get(emuenv.mem);
-            max_index = *std::max_element(&data[0], &data[draw->vertex_count]);
-        } else {
-            const uint32_t *const data = draw->index_data.cast<const uint32_t>().get(emuenv.mem);
-            max_index = *std::max_element(&data[0], &data[draw->vertex_count]);
-        }
+        max_index = emuenv.gxm.index_range_cache.get(emuenv.mem, draw->index_data, draw->vertex_count, draw->index_format).max;
     }
 
     // set all textures that are used and mark them as dirty
@@ -19,6 +19,7 @@
 
 #include <io/functions.h>
 #include <kernel/state.h>
+#include <mem/heap.h>
 #include <util/lock_and_find.h>
 #include <util/log.h>
 #include <util/tracy.h>
@@ -28,6 +29,19 @@
 
 TRACY_MODULE_NAME(SceLibc);
 
+// Layout of the malloc_stats output, only the first four fields are written
+struct SceLibcMallocManagedSize {
+    SceSize maxSystemSize;
+    SceSize currentSystemSize;
+    SceSize maxInuseSize;
+    SceSize currentInuseSize;
+    SceSize reserved[4];
+};
+
+LIBRARY_INIT(SceLibc) {
+    emuenv.kernel.obj_store.create<GuestHeap>();
+}
+
 EXPORT(int, _Assert) {
     TRACY_FUNC(_Assert);
     return UNIMPLEMENTED();
@@ -332,9 +346,9 @@ EXPORT(int, c32rtomb) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, calloc) {
-    TRACY_FUNC(calloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, calloc, uint32_t count, uint32_t size) {
+    TRACY_FUNC(calloc, count, size);
+    return Ptr<void>(emuenv.kernel.obj_store.get<GuestHeap>()->calloc(emuenv.mem, count, size));
 }
 
 EXPORT(int, clearerr) {
@@ -475,7 +489,7 @@ EXPORT(int, fread) {
 
 EXPORT(void, free, Address mem) {
     TRACY_FUNC(free, mem);
-    free(emuenv.mem, mem);
+    emuenv.kernel.obj_store.get<GuestHeap>()->free(emuenv.mem, mem);
 }
 
 EXPORT(int, freopen) {
@@ -764,24 +778,37 @@ EXPORT(int, longjmp) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, malloc, SceSize size) {
+EXPORT(Ptr<void>, malloc, SceSize size) {
     TRACY_FUNC(malloc, size);
-    return alloc(emuenv.mem, size, __FUNCTION__);
+    return Ptr<void>(emuenv.kernel.obj_store.get<GuestHeap>()->malloc(emuenv.mem, size));
 }
 
-EXPORT(int, malloc_stats) {
-    TRACY_FUNC(malloc_stats);
-    return UNIMPLEMENTED();
+static int write_malloc_stats(EmuEnvState &emuenv, Ptr<SceLibcMallocManagedSize> mmsize) {
+    if (!mmsize)
+        return -1;
+
+    const GuestHeapStats stats = emuenv.kernel.obj_store.get<GuestHeap>()->stats();
+    SceLibcMallocManagedSize *out = mmsize.get(emuenv.mem);
+    out->maxSystemSize = stats.max_system_size;
+    out->currentSystemSize = stats.system_size;
+    out->maxInuseSize = stats.max_in_use_size;
+    out->currentInuseSize = stats.in_use_size;
+    return 0;
 }
 
-EXPORT(int, malloc_stats_fast) {
-    TRACY_FUNC(malloc_stats_fast);
-    return UNIMPLEMENTED();
+EXPORT(int, malloc_stats, Ptr<SceLibcMallocManagedSize> mmsize) {
+    TRACY_FUNC(malloc_stats, mmsize);
+    return write_malloc_stats(emuenv, mmsize);
 }
 
-EXPORT(int, malloc_usable_size) {
-    TRACY_FUNC(malloc_usable_size);
-    return UNIMPLEMENTED();
+EXPORT(int, malloc_stats_fast, Ptr<SceLibcMallocManagedSize> mmsize) {
+    TRACY_FUNC(malloc_stats_fast, mmsize);
+    return write_malloc_stats(emuenv, mmsize);
+}
+
+EXPORT(uint32_t, malloc_usable_size, Address ptr) {
+    TRACY_FUNC(malloc_usable_size, ptr);
+    return emuenv.kernel.obj_store.get<GuestHeap>()->usable_size(ptr);
 }
 
 EXPORT(int, mblen) {
@@ -841,9 +868,7 @@ EXPORT(int, mbtowc) {
 
 EXPORT(Ptr<void>, memalign, uint32_t alignment, uint32_t size) {
     TRACY_FUNC(memalign, alignment, size);
-    Address address = alloc_aligned(emuenv.mem, size, "memalign", alignment);
-
-    return Ptr<void>(address);
+    return Ptr<void>(emuenv.kernel.obj_store.get<GuestHeap>()->memalign(emuenv.mem, alignment, size));
 }
 
 EXPORT(int, memchr) {
@@ -886,14 +911,20 @@ EXPORT(int, mktime) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_calloc) {
-    TRACY_FUNC(mspace_calloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_calloc, Ptr<void> space, uint32_t elements, uint32_t size) {
+    TRACY_FUNC(mspace_calloc, space, elements, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_calloc(space.get(emuenv.mem), elements, size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
-EXPORT(int, mspace_create) {
-    TRACY_FUNC(mspace_create);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_create, Ptr<void> base, uint32_t capacity) {
+    TRACY_FUNC(mspace_create, base, capacity);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    mspace space = create_mspace_with_base(base.get(emuenv.mem), capacity, 0);
+    return Ptr<void>(space, emuenv.mem);
 }
 
 EXPORT(int, mspace_create_internal) {
@@ -906,14 +937,18 @@ EXPORT(int, mspace_create_with_flag) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_destroy) {
-    TRACY_FUNC(mspace_destroy);
-    return UNIMPLEMENTED();
+EXPORT(uint32_t, mspace_destroy, Ptr<void> space) {
+    TRACY_FUNC(mspace_destroy, space);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    return static_cast<uint32_t>(destroy_mspace(space.get(emuenv.mem)));
 }
 
-EXPORT(int, mspace_free) {
-    TRACY_FUNC(mspace_free);
-    return UNIMPLEMENTED();
+EXPORT(void, mspace_free, Ptr<void> space, Ptr<void> address) {
+    TRACY_FUNC(mspace_free, space, address);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    mspace_free(space.get(emuenv.mem), address.get(emuenv.mem));
 }
 
 EXPORT(int, mspace_is_heap_empty) {
@@ -921,9 +956,12 @@ EXPORT(int, mspace_is_heap_empty) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_malloc) {
-    TRACY_FUNC(mspace_malloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_malloc, Ptr<void> space, uint32_t size) {
+    TRACY_FUNC(mspace_malloc, space, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_malloc(space.get(emuenv.mem), size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
 EXPORT(int, mspace_malloc_stats) {
@@ -936,19 +974,27 @@ EXPORT(int, mspace_malloc_stats_fast) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_malloc_usable_size) {
-    TRACY_FUNC(mspace_malloc_usable_size);
-    return UNIMPLEMENTED();
+EXPORT(uint32_t, mspace_malloc_usable_size, Ptr<void> address) {
+    TRACY_FUNC(mspace_malloc_usable_size, address);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    return static_cast<uint32_t>(mspace_usable_size(address.get(emuenv.mem)));
 }
 
-EXPORT(int, mspace_memalign) {
-    TRACY_FUNC(mspace_memalign);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_memalign, Ptr<void> space, uint32_t alignment, uint32_t size) {
+    TRACY_FUNC(mspace_memalign, space, alignment, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_memalign(space.get(emuenv.mem), alignment, size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
-EXPORT(int, mspace_realloc) {
-    TRACY_FUNC(mspace_realloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_realloc, Ptr<void> space, Ptr<void> address, uint32_t size) {
+    TRACY_FUNC(mspace_realloc, space, address, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *new_address = mspace_realloc(space.get(emuenv.mem), address.get(emuenv.mem), size);
+    return Ptr<void>(new_address, emuenv.mem);
 }
 
 EXPORT(int, mspace_reallocalign) {
@@ -1038,14 +1084,14 @@ EXPORT(int, rand_r) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, realloc) {
-    TRACY_FUNC(realloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, realloc, Address ptr, uint32_t size) {
+    TRACY_FUNC(realloc, ptr, size);
+    return Ptr<void>(emuenv.kernel.obj_store.get<GuestHeap>()->realloc(emuenv.mem, ptr, size));
 }
 
-EXPORT(int, reallocalign) {
-    TRACY_FUNC(reallocalign);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, reallocalign, Address ptr, uint32_t size, uint32_t alignment) {
+    TRACY_FUNC(reallocalign, ptr, size, alignment);
+    return Ptr<void>(emuenv.kernel.obj_store.get<GuestHeap>()->reallocalign(emuenv.mem, ptr, alignment, size));
 }
 
 EXPORT(int, remove) {
@@ -2,19 +2,49 @@
 
 #include <net/socket.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 struct EpollSocket {
     unsigned int events;
     SceNetEpollData data;
     std::weak_ptr<Socket> sock;
 };
 
+/**
+ * @brief Set of sockets waited on by sceNetEpollWait
+ *
+ * On Linux every Epoll owns an epoll instance, the sockets are registered once in add and wait only
+ * goes through the ready ones. Elsewhere, or if the epoll instance can't be created,
+ * wait builds fd_sets from every entry and calls select.
+ */
 struct Epoll {
+    std::mutex mutex;
     std::map<int, EpollSocket> eventEntries;
 
+    explicit Epoll(bool use_native = true);
+    ~Epoll();
+    Epoll(const Epoll &) = delete;
+    Epoll &operator=(const Epoll &) = delete;
+
     int add(int id, std::weak_ptr<Socket> sock, SceNetEpollEvent *ev);
     int del(int id);
     int mod(int id, SceNetEpollEvent *ev);
+    // timeout is in microseconds, a negative one waits forever
     int wait(SceNetEpollEvent *events, int maxevents, int timeout);
+
+    bool is_native() const {
+        return native_fd >= 0;
+    }
+
+private:
+    int wait_select(SceNetEpollEvent *events, int maxevents, int timeout);
+#ifdef __linux__
+    int wait_native(SceNetEpollEvent *events, int maxevents, int timeout);
+#endif
+
+    int native_fd = -1;
 };
 
 typedef std::shared_ptr<Epoll> EpollPtr;
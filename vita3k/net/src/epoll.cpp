@@ -17,25 +17,105 @@
 
 #include <net/epoll.h>
 
+#include <algorithm>
+#include <chrono>
 #include <optional>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+static std::optional<abs_socket> get_valid_posix_socket(const std::weak_ptr<Socket> &weak_sock) {
+    const auto sock = weak_sock.lock();
+    if (!sock)
+        return std::nullopt;
+
+    const auto posixSocket = std::dynamic_pointer_cast<PosixSocket>(sock);
+    if (!posixSocket)
+        return std::nullopt;
+
+    return posixSocket->sock;
+}
+
+#ifdef __linux__
+static uint32_t to_native_events(unsigned int events) {
+    uint32_t native_events = 0;
+    if (events & SCE_NET_EPOLLIN)
+        native_events |= EPOLLIN;
+    if (events & SCE_NET_EPOLLOUT)
+        native_events |= EPOLLOUT;
+    // EPOLLERR is always reported, it is filtered in wait_native
+    return native_events;
+}
+
+// Registers, updates or removes the socket of an entry in the native epoll
+static int control_native(int native_fd, int op, int id, const EpollSocket &entry) {
+    const auto sock = get_valid_posix_socket(entry.sock);
+    if (!sock)
+        return 0;
+
+    epoll_event ev{};
+    ev.events = to_native_events(entry.events);
+    ev.data.u32 = static_cast<uint32_t>(id);
+    // a closed socket was already removed by the kernel, there is nothing left to modify or delete
+    if (epoll_ctl(native_fd, op, *sock, &ev) < 0 && !(op != EPOLL_CTL_ADD && (errno == EBADF || errno == ENOENT)))
+        return PosixSocket::translate_return_value(-1);
+
+    return 0;
+}
+#endif
+
+Epoll::Epoll(bool use_native) {
+#ifdef __linux__
+    if (use_native)
+        native_fd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+Epoll::~Epoll() {
+#ifdef __linux__
+    if (native_fd >= 0)
+        ::close(native_fd);
+#endif
+}
 
 int Epoll::add(int id, std::weak_ptr<Socket> sock, SceNetEpollEvent *ev) {
-    if (!eventEntries.try_emplace(id, EpollSocket{ ev->events, ev->data, sock }).second) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const auto [it, inserted] = eventEntries.try_emplace(id, EpollSocket{ ev->events, ev->data, sock });
+    if (!inserted) {
         return SCE_NET_ERROR_EEXIST;
     }
 
+#ifdef __linux__
+    if (is_native()) {
+        const int ret = control_native(native_fd, EPOLL_CTL_ADD, id, it->second);
+        if (ret < 0)
+            eventEntries.erase(it);
+        return ret;
+    }
+#endif
     return 0;
 }
 
 int Epoll::del(int id) {
-    if (eventEntries.erase(id) == 0) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it = eventEntries.find(id);
+    if (it == eventEntries.end()) {
         return SCE_NET_ERROR_ENOENT;
     }
 
+#ifdef __linux__
+    if (is_native())
+        control_native(native_fd, EPOLL_CTL_DEL, id, it->second);
+#endif
+    eventEntries.erase(it);
     return 0;
 }
 
 int Epoll::mod(int id, SceNetEpollEvent *ev) {
+    const std::lock_guard<std::mutex> lock(mutex);
     auto it = eventEntries.find(id);
     if (it == eventEntries.end()) {
         return SCE_NET_ERROR_ENOENT;
@@ -43,6 +123,10 @@ int Epoll::mod(int id, SceNetEpollEvent *ev) {
 
     it->second.events = ev->events;
     it->second.data = ev->data;
+#ifdef __linux__
+    if (is_native())
+        return control_native(native_fd, EPOLL_CTL_MOD, id, it->second);
+#endif
     return 0;
 }
 
@@ -53,26 +137,88 @@ static void add_event_fd_set(fd_set *set, int *maxFd, abs_socket sock) {
 }
 
 int Epoll::wait(SceNetEpollEvent *events, int maxevents, int timeout_microseconds) {
+#ifdef __linux__
+    if (is_native())
+        return wait_native(events, maxevents, timeout_microseconds);
+#endif
+    return wait_select(events, maxevents, timeout_microseconds);
+}
+
+#ifdef __linux__
+int Epoll::wait_native(SceNetEpollEvent *events, int maxevents, int timeout_microseconds) {
+    if (maxevents <= 0)
+        return SCE_NET_ERROR_EINVAL;
+
+    // a negative timeout waits forever
+    const bool wait_forever = timeout_microseconds < 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(std::max(timeout_microseconds, 0));
+    // round up, a short timeout must not turn into a busy loop
+    int timeout_ms = wait_forever ? -1 : (timeout_microseconds + 999) / 1000;
+
+    std::vector<epoll_event> ready(maxevents);
+    while (true) {
+        int ret;
+        do {
+            ret = epoll_wait(native_fd, ready.data(), maxevents, timeout_ms);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0)
+            return PosixSocket::translate_return_value(ret);
+
+        int eventCount = 0;
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            for (int i = 0; i < ret; i++) {
+                // the entry may have been removed while waiting
+                const auto it = eventEntries.find(static_cast<int>(ready[i].data.u32));
+                if (it == eventEntries.end())
+                    continue;
+
+                const EpollSocket &entry = it->second;
+                unsigned int eventTypes = 0;
+                // a hung up socket is readable, like with select
+                if ((ready[i].events & (EPOLLIN | EPOLLHUP)) && (entry.events & SCE_NET_EPOLLIN))
+                    eventTypes |= SCE_NET_EPOLLIN;
+                if ((ready[i].events & EPOLLOUT) && (entry.events & SCE_NET_EPOLLOUT))
+                    eventTypes |= SCE_NET_EPOLLOUT;
+                if ((ready[i].events & EPOLLERR) && (entry.events & SCE_NET_EPOLLERR))
+                    eventTypes |= SCE_NET_EPOLLERR;
+
+                if (eventTypes != 0) {
+                    events[eventCount].events = eventTypes;
+                    events[eventCount].data = entry.data;
+                    eventCount++;
+                }
+            }
+        }
+
+        if (eventCount > 0 || ret == 0)
+            return eventCount;
+
+        // every ready event was filtered out, an error or hang up the entry did not ask for,
+        // returning 0 before the timeout would make the guest spin, so keep waiting
+        const auto now = std::chrono::steady_clock::now();
+        if (!wait_forever && now >= deadline)
+            return 0;
+        // epoll reports such an event again at once, do not spin on it either
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (!wait_forever) {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout_ms = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+        }
+    }
+}
+#endif
+
+int Epoll::wait_select(SceNetEpollEvent *events, int maxevents, int timeout_microseconds) {
     fd_set readFds, writeFds, exceptFds;
     FD_ZERO(&readFds);
     FD_ZERO(&writeFds);
     FD_ZERO(&exceptFds);
     int maxFd = 0;
 
-    const auto get_valid_posix_socket = [](const std::weak_ptr<Socket> &weak_sock, int id) -> std::optional<abs_socket> {
-        const auto sock = weak_sock.lock();
-        if (!sock)
-            return std::nullopt;
-
-        const auto posixSocket = std::dynamic_pointer_cast<PosixSocket>(sock);
-        if (!posixSocket)
-            return std::nullopt;
-
-        return posixSocket->sock;
-    };
-
+    std::unique_lock<std::mutex> lock(mutex);
     for (const auto &[id, entry] : eventEntries) {
-        const auto sock = get_valid_posix_socket(entry.sock, id);
+        const auto sock = get_valid_posix_socket(entry.sock);
         if (!sock)
             continue;
 
@@ -90,14 +236,16 @@ int Epoll::wait(SceNetEpollEvent *events, int maxevents, int timeout_microsecond
     timeval timeout;
     timeout.tv_sec = timeout_microseconds / 1000000;
     timeout.tv_usec = timeout_microseconds % 1000000;
+    lock.unlock();
     auto ret = select(maxFd + 1, &readFds, &writeFds, &exceptFds, &timeout);
     if (ret < 0)
         return PosixSocket::translate_return_value(ret);
 
+    lock.lock();
     int eventCount = 0;
     for (const auto &[id, entry] : eventEntries) {
         unsigned int eventTypes = 0;
-        const auto sock = get_valid_posix_socket(entry.sock, id);
+        const auto sock = get_valid_posix_socket(entry.sock);
         if (!sock)
             continue;
 
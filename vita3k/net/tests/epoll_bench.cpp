@@ -0,0 +1,114 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <net/epoll.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+// Receivers bound to ephemeral loopback ports and a sender, no external network is needed
+struct LoopbackSockets {
+    std::vector<std::shared_ptr<PosixSocket>> receivers;
+    std::vector<sockaddr_in> addresses;
+    abs_socket sender;
+
+    explicit LoopbackSockets(int count) {
+        for (int i = 0; i < count; i++) {
+            const abs_socket sock = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t addrlen = sizeof(addr);
+            ::bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+            getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrlen);
+            receivers.push_back(std::make_shared<PosixSocket>(sock, SCE_NET_SOCK_DGRAM));
+            addresses.push_back(addr);
+        }
+        sender = socket(AF_INET, SOCK_DGRAM, 0);
+    }
+
+    ~LoopbackSockets() {
+        for (const auto &receiver : receivers)
+            receiver->close();
+#ifdef _WIN32
+        closesocket(sender);
+#else
+        ::close(sender);
+#endif
+    }
+};
+
+// Sends a datagram to state.range(2) random sockets out of state.range(1), then waits until all of them are reported
+static void BM_EpollWait(benchmark::State &state) {
+    const bool native = state.range(0) != 0;
+    const int socket_count = static_cast<int>(state.range(1));
+    const int burst = static_cast<int>(state.range(2));
+
+    LoopbackSockets sockets(socket_count);
+    Epoll epoll(native);
+    if (native && !epoll.is_native()) {
+        state.SkipWithError("no native backend on this platform");
+        return;
+    }
+
+    for (int i = 0; i < socket_count; i++) {
+        SceNetEpollEvent ev{};
+        ev.events = SCE_NET_EPOLLIN;
+        memcpy(ev.data.data, &i, sizeof(i));
+        epoll.add(i, sockets.receivers[i], &ev);
+    }
+
+    std::mt19937 rng(0);
+    std::vector<SceNetEpollEvent> events(socket_count);
+    char buffer[64] = {};
+    int64_t packets = 0;
+
+    for (auto _ : state) {
+        for (int i = 0; i < burst; i++) {
+            const sockaddr_in &addr = sockets.addresses[rng() % socket_count];
+            sendto(sockets.sender, buffer, sizeof(buffer), 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+        }
+
+        // several datagrams can land on the same socket, drain until nothing is left
+        int pending = burst;
+        while (pending > 0) {
+            const int count = epoll.wait(events.data(), socket_count, 100000);
+            if (count <= 0) {
+                state.SkipWithError("datagrams were lost");
+                return;
+            }
+            for (int i = 0; i < count; i++) {
+                int id;
+                memcpy(&id, events[i].data.data, sizeof(id));
+                while (sockets.receivers[id]->recv_packet(buffer, sizeof(buffer), SCE_NET_MSG_DONTWAIT, nullptr, nullptr) > 0)
+                    pending--;
+            }
+        }
+        packets += burst;
+    }
+
+    state.SetItemsProcessed(packets);
+}
+
+BENCHMARK(BM_EpollWait)
+    ->ArgNames({ "native", "sockets", "burst" })
+    ->ArgsProduct({ { 0, 1 }, { 16, 256, 768 }, { 1, 32 } })
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
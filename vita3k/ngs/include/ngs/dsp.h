@@ -0,0 +1,248 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct SceNgsParamFilter;
+struct SceNgsParamCoEff;
+
+/*
+Block DSP kernels used by the effect modules.
+Voices exchange interleaved stereo float frames, every buffer below uses this layout
+and every kernel works on a whole block (the system granularity) at once.
+*/
+namespace ngs::dsp {
+
+// Returns true if the parameters differ from the cached copy, and updates it
+inline bool update_params_cache(std::vector<uint8_t> &cache, const void *params, const size_t size) {
+    if (cache.size() == size && std::memcmp(cache.data(), params, size) == 0)
+        return false;
+
+    cache.resize(size);
+    std::memcpy(cache.data(), params, size);
+    return true;
+}
+
+float millibels_to_gain(float millibels);
+
+// output = input * gain
+void scale(const float *input, float *output, float gain, uint32_t frames);
+// output += input * gain, with a different gain for each channel
+void mix(float *output, const float *input, float left_gain, float right_gain, uint32_t frames);
+// output += input * matrix, matrix[i][j] is the gain from input channel i to output channel j
+void mix_matrix(float *output, const float *input, const float (&matrix)[2][2], uint32_t frames);
+// Limits every sample to [-1, 1]
+void clamp(float *buffer, uint32_t frames);
+
+// y[0] = b0 x[0] + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+struct BiquadCoeffs {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+
+    bool is_identity() const {
+        return b0 == 1.0f && b1 == 0.0f && b2 == 0.0f && a1 == 0.0f && a2 == 0.0f;
+    }
+};
+
+struct BiquadState {
+    float z1[2] = {};
+    float z2[2] = {};
+};
+
+BiquadCoeffs make_biquad(const SceNgsParamFilter &filter, float sample_rate);
+BiquadCoeffs make_biquad(const SceNgsParamCoEff &coeffs);
+// Both channels are filtered together, input and output can be the same buffer
+void process_biquad(const BiquadCoeffs &coeffs, BiquadState &state, const float *input, float *output, uint32_t frames);
+// Same as applying count biquads one after the other, in a single pass
+void process_biquad_cascade(const BiquadCoeffs *coeffs, BiquadState *states, uint32_t count, const float *input, float *output, uint32_t frames);
+
+class DelayLine {
+public:
+    // Makes room for delays up to max_delay frames read by blocks of max_block frames, the line is cleared if it has to grow
+    void reserve(uint32_t max_delay, uint32_t max_block);
+    void clear();
+
+    void write(const float *input, uint32_t frames);
+    // output[i] is the frame written delay frames before the i-th frame following the current write position,
+    // fractional delays are linearly interpolated. Reading the frames of the next write needs delay >= frames.
+    void read(float *output, uint32_t frames, float delay) const;
+    // Same as read with a different delay for each frame
+    void read_modulated(float *output, uint32_t frames, const float *delays) const;
+
+private:
+    std::vector<float> buffer;
+    uint32_t mask = 0;
+    uint32_t position = 0;
+};
+
+struct ReverbSettings {
+    float dry_gain = 1.0f;
+    float room_gain = 0.0f;
+    float reflections_gain = 0.0f;
+    float reverb_gain = 0.0f;
+    // in frames, the late reverb delay is relative to the reflections
+    float reflections_delay = 0.0f;
+    float reverb_delay = 0.0f;
+    // in seconds
+    float decay_time = 1.0f;
+    float decay_hf_ratio = 1.0f;
+    // 0 to 1
+    float diffusion = 1.0f;
+    float density = 1.0f;
+    // applied to the signal sent to the room
+    BiquadCoeffs room_hf;
+    BiquadCoeffs room_lf;
+    // early reflection tap layout of each channel (SceNgsReverbRoom) and the scale of its delays
+    std::array<uint32_t, 2> reflection_patterns = {};
+    float reflections_scalar = 1.0f;
+};
+
+class Reverb {
+public:
+    static constexpr uint32_t COMB_COUNT = 4;
+    static constexpr uint32_t ALLPASS_COUNT = 3;
+    static constexpr uint32_t REFLECTION_TAP_COUNT = 4;
+
+    void configure(const ReverbSettings &settings, float sample_rate, uint32_t max_block);
+    void process(const float *input, float *output, uint32_t frames);
+
+private:
+    ReverbSettings settings;
+    BiquadState room_hf_state;
+    BiquadState room_lf_state;
+    DelayLine pre_delay;
+
+    // the combs of a channel are processed together, their lines are interleaved
+    std::array<std::vector<float>, 2> comb_lines;
+    uint32_t comb_mask = 0;
+    uint32_t comb_position = 0;
+    uint32_t comb_lengths[2][COMB_COUNT] = {};
+    float comb_feedback[2][COMB_COUNT] = {};
+    float comb_damping[2][COMB_COUNT] = {};
+    float comb_filter[2][COMB_COUNT] = {};
+
+    // each allpass processes both channels, interleaved
+    std::array<std::vector<float>, ALLPASS_COUNT> allpass_lines;
+    uint32_t allpass_mask = 0;
+    uint32_t allpass_position = 0;
+    uint32_t allpass_lengths[ALLPASS_COUNT][2] = {};
+    float allpass_feedback = 0.5f;
+
+    float reflection_delays[2][REFLECTION_TAP_COUNT] = {};
+    float reflection_gains[2][REFLECTION_TAP_COUNT] = {};
+
+    std::vector<float> wet;
+    std::vector<float> tap;
+};
+
+struct CompressorSettings {
+    float ratio = 1.0f;
+    // linear amplitudes
+    float threshold = 1.0f;
+    float makeup_gain = 1.0f;
+    // in milliseconds
+    float attack = 10.0f;
+    float release = 100.0f;
+    // width of the knee in dB
+    float knee = 0.0f;
+    bool peak_mode = false;
+    bool stereo_link = false;
+};
+
+class Compressor {
+public:
+    void configure(const CompressorSettings &settings, float sample_rate);
+    // input_level and output_level receive the detected level of each channel at the end of the block
+    void process(const float *input, float *output, uint32_t frames, float *input_level, float *output_level);
+
+private:
+    CompressorSettings settings;
+    float threshold_db = 0.0f;
+    float attack_coeff = 1.0f;
+    float release_coeff = 1.0f;
+    float rms_coeff = 1.0f;
+
+    float mean_square[2] = {};
+    float envelope[2] = {};
+    float gain[2] = { 1.0f, 1.0f };
+};
+
+struct DelayTapSettings {
+    // in frames
+    float delay = 0.0f;
+    float modulation_width = 0.0f;
+    // in radians
+    float modulation_phase = 0.0f;
+    float volume = 0.0f;
+    float feedback = 0.0f;
+    BiquadCoeffs filter;
+};
+
+struct DelaySettings {
+    static constexpr uint32_t MAX_TAPS = 4;
+
+    float dry_gain = 1.0f;
+    // in Hz
+    float modulation_rate = 0.0f;
+    std::array<DelayTapSettings, MAX_TAPS> taps;
+};
+
+class Delay {
+public:
+    void configure(const DelaySettings &settings, float sample_rate, uint32_t max_block);
+    void process(const float *input, float *output, uint32_t frames);
+
+private:
+    void process_chunk(const float *input, float *output, uint32_t frames);
+
+    DelaySettings settings;
+    DelayLine line;
+    BiquadState tap_filters[DelaySettings::MAX_TAPS];
+    // the modulation oscillators are rotated instead of calling sin for every frame
+    float oscillators[DelaySettings::MAX_TAPS][2] = {};
+    float rotation[2] = { 1.0f, 0.0f };
+    float min_delay = 1.0f;
+
+    std::vector<float> tap;
+    std::vector<float> feedback;
+    std::vector<float> delays;
+};
+
+class PitchShifter {
+public:
+    // ratio is the frequency multiplier
+    void process(const float *input, float *output, uint32_t frames, float ratio);
+
+private:
+    DelayLine line;
+    // position of the first read head in its window, from 0 to 1
+    float phase = 0.0f;
+
+    std::vector<float> heads[2];
+    std::vector<float> delays[2];
+};
+
+} // namespace ngs::dsp
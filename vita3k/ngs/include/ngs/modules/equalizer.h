@@ -38,10 +38,17 @@ struct SceNgsParamEqParamsCoEff {
 
 namespace ngs {
 
+struct EqualizerLogicalState : public ModuleLogicalState {
+    std::vector<uint8_t> params;
+    dsp::BiquadCoeffs coeffs[SCE_NGS_MAX_EQ_FILTERS];
+    dsp::BiquadState states[SCE_NGS_MAX_EQ_FILTERS];
+};
+
 class EqualizerModule : public Module {
 public:
     bool process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) override;
     uint32_t module_id() const override { return 0x5CEC; }
+    void on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) override;
 
     static constexpr uint32_t get_max_parameter_size() {
         return std::max(sizeof(SceNgsParamEqParams), sizeof(SceNgsParamEqParamsCoEff));
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <ngs/dsp.h>
 #include <ngs/system.h>
 #include <ngs/types.h>
 
@@ -66,10 +67,17 @@ struct SceNgsFilterParamsCoEff {
 
 namespace ngs {
 
+struct FilterLogicalState : public ModuleLogicalState {
+    std::vector<uint8_t> params;
+    dsp::BiquadCoeffs coeffs;
+    dsp::BiquadState state;
+};
+
 class FilterModule : public Module {
 public:
     bool process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) override;
     uint32_t module_id() const override { return 0x5CE4; }
+    void on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) override;
 
     static constexpr uint32_t get_max_parameter_size() {
         return std::max(sizeof(SceNgsFilterParams), sizeof(SceNgsFilterParamsCoEff));
@@ -22,6 +22,7 @@
 #include <mem/ptr.h>
 
 #include <condition_variable>
+#include <mutex>
 #include <queue>
 #include <vector>
 
@@ -29,6 +30,7 @@ struct MemState;
 struct KernelState;
 
 struct SceNgsPatchSetupInfo;
+class WorkerPool;
 
 namespace ngs {
 struct Voice;
@@ -64,7 +66,39 @@ struct VoiceScheduler {
     std::condition_variable_any condvar;
     bool is_updating = false;
 
+    // if set, the voices that do not depend on each other are processed in parallel
+    WorkerPool *workers = nullptr;
+
 protected:
+    static constexpr uint32_t MIN_VOICES_PER_JOB = 4;
+
+    struct VoiceSource {
+        Voice *voice;
+        Patch *patch;
+        uint32_t port;
+    };
+
+    struct ScheduledVoice {
+        Voice *voice = nullptr;
+        std::vector<VoiceSource> sources;
+        bool on_guest_thread = false;
+        bool finished = false;
+        uint32_t finished_module = 0;
+    };
+
+    uint64_t update_count = 0;
+    // indexed by queue position, kept between updates to reuse their memory
+    std::vector<ScheduledVoice> scheduled;
+    std::vector<std::vector<uint32_t>> levels;
+
+    // Returns true if a module finished
+    bool process_voice(KernelState &kern, const MemState &mem, const SceUID thread_id, Voice *voice, uint32_t &finished_module,
+        std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock);
+    void finish_voice(KernelState &kern, const MemState &mem, const SceUID thread_id, Voice *voice, const uint32_t finished_module,
+        std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock);
+    void update_levels(KernelState &kern, const MemState &mem, const SceUID thread_id, const std::vector<Voice *> &queue_copy,
+        std::unique_lock<std::recursive_mutex> &scheduler_lock);
+
     void deque_insert(const MemState &mem, Voice *voice);
 
     bool resort_to_respect_dependencies(const MemState &mem, Voice *source);
@@ -18,7 +18,9 @@
 #pragma once
 
 #include <mem/ptr.h>
+#include <threads/worker_pool.h>
 
+#include <memory>
 #include <vector>
 
 struct MemState;
@@ -30,8 +32,10 @@ struct System;
 struct State {
     Ptr<VoiceDefinition> definitions;
     std::vector<System *> systems;
+    // shared by all the systems, null if voices are processed one after the other
+    std::unique_ptr<WorkerPool> workers;
 };
 
-bool init(State &ngs, MemState &mem);
+bool init(State &ngs, MemState &mem, uint32_t worker_count = 0);
 void deinit(State &ngs, MemState &mem);
 } // namespace ngs
@@ -212,6 +212,9 @@ struct ModuleData {
     void invoke_callback(KernelState &kern, const MemState &mem, const SceUID thread_id, const uint32_t reason1,
         const uint32_t reason2, Address reason_ptr);
 
+    // Index of this module among the modules of the same type in the voice definition
+    uint32_t instance_index() const;
+
     SceNgsBufferInfo *lock_params(const MemState &mem);
     bool unlock_params(const MemState &mem);
 
@@ -268,9 +271,13 @@ struct VoiceInputManager {
     using PCMInputs = std::vector<PCMInput>;
 
     PCMInputs inputs;
+    // whether a patch was mixed into each input since the last reset, the others are silent
+    std::vector<bool> received;
 
     void init(const uint32_t granularity, const uint16_t total_input);
     void reset_inputs();
+    // Called once every source of the voice delivered its data, before it is processed
+    void finalize_inputs(const uint32_t granularity);
 
     PCMInput *get_input_buffer_queue(const int32_t index);
     int32_t receive(const MemState &mem, Patch *patch, const VoiceProduct &data);
@@ -298,6 +305,16 @@ struct Voice {
     Ptr<void> finished_callback;
     Ptr<void> finished_callback_user_data;
 
+    // set by the scheduler at the beginning of every update the voice is queued in
+    uint64_t scheduled_update = 0;
+    uint32_t schedule_position = 0;
+    uint32_t schedule_level = 0;
+
+    // true if this voice is processed after the source in the current update
+    bool is_scheduled_after(const Voice &source) const {
+        return scheduled_update == source.scheduled_update && schedule_position > source.schedule_position;
+    }
+
     void init(Rack *mama);
 
     ModuleData *module_storage(const uint32_t index);
@@ -345,8 +362,8 @@ struct System : public MempoolObject {
     static uint32_t get_required_memspace_size(SceNgsSystemInitParams *parameters);
 };
 
-bool deliver_data(const MemState &mem, const std::vector<Voice *> &voice_queue, Voice *source, const uint8_t output_port,
-    const VoiceProduct &data_to_deliver);
+// Mixes the products of the source into the inputs of the voices it is patched to and that are processed after it
+void deliver_data(const MemState &mem, Voice *source);
 
 bool init_system(State &ngs, const MemState &mem, SceNgsSystemInitParams *parameters, Ptr<void> memspace, const uint32_t memspace_size);
 void release_system(State &ngs, const MemState &mem, System *system);
@@ -0,0 +1,968 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+/*
+Block DSP kernels of the NGS effect modules
+The inner loops use 4 float lanes: NEON on aarch64, SSE2 (always available on x86-64) on x86, plain C++ otherwise.
+Recursive filters cannot be vectorized over time, they process both channels (or the 4 combs of a channel) in parallel instead,
+and fill the other lanes with the next filter of a cascade or the next frame.
+*/
+
+#include <ngs/dsp.h>
+
+#include <ngs/modules/filter.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NGS_DSP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ngs::dsp {
+
+#if defined(__aarch64__)
+using f32x4 = float32x4_t;
+
+static inline f32x4 load4(const float *ptr) { return vld1q_f32(ptr); }
+static inline void store4(float *ptr, const f32x4 value) { vst1q_f32(ptr, value); }
+static inline f32x4 load2(const float *ptr) { return vcombine_f32(vld1_f32(ptr), vdup_n_f32(0.0f)); }
+static inline void store2(float *ptr, const f32x4 value) { vst1_f32(ptr, vget_low_f32(value)); }
+static inline void store_high2(float *ptr, const f32x4 value) { vst1_f32(ptr, vget_high_f32(value)); }
+static inline f32x4 splat(const float value) { return vdupq_n_f32(value); }
+static inline f32x4 set4(const float a, const float b, const float c, const float d) {
+    const float values[4] = { a, b, c, d };
+    return vld1q_f32(values);
+}
+static inline f32x4 add(const f32x4 a, const f32x4 b) { return vaddq_f32(a, b); }
+static inline f32x4 sub(const f32x4 a, const f32x4 b) { return vsubq_f32(a, b); }
+static inline f32x4 mul(const f32x4 a, const f32x4 b) { return vmulq_f32(a, b); }
+static inline f32x4 abs4(const f32x4 a) { return vabsq_f32(a); }
+static inline f32x4 sqrt4(const f32x4 a) { return vsqrtq_f32(a); }
+static inline f32x4 min4(const f32x4 a, const f32x4 b) { return vminq_f32(a, b); }
+static inline f32x4 max4(const f32x4 a, const f32x4 b) { return vmaxq_f32(a, b); }
+// { a1, a0, a3, a2 }, swaps the channels of two stereo frames
+static inline f32x4 swap_pairs(const f32x4 a) { return vrev64q_f32(a); }
+// { a0, a1, b0, b1 }
+static inline f32x4 low_halves(const f32x4 a, const f32x4 b) { return vcombine_f32(vget_low_f32(a), vget_low_f32(b)); }
+// { a2, a3, b0, b1 }
+static inline f32x4 high_low_halves(const f32x4 a, const f32x4 b) { return vcombine_f32(vget_high_f32(a), vget_low_f32(b)); }
+// { a2, a3, b2, b3 }
+static inline f32x4 high_halves(const f32x4 a, const f32x4 b) { return vcombine_f32(vget_high_f32(a), vget_high_f32(b)); }
+// a > b ? x : y
+static inline f32x4 select_gt(const f32x4 a, const f32x4 b, const f32x4 x, const f32x4 y) { return vbslq_f32(vcgtq_f32(a, b), x, y); }
+static inline float hsum(const f32x4 a) { return vaddvq_f32(a); }
+#elif defined(NGS_DSP_SSE2)
+using f32x4 = __m128;
+
+static inline f32x4 load4(const float *ptr) { return _mm_loadu_ps(ptr); }
+static inline void store4(float *ptr, const f32x4 value) { _mm_storeu_ps(ptr, value); }
+static inline f32x4 load2(const float *ptr) { return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(ptr))); }
+static inline void store2(float *ptr, const f32x4 value) { _mm_store_sd(reinterpret_cast<double *>(ptr), _mm_castps_pd(value)); }
+static inline void store_high2(float *ptr, const f32x4 value) { _mm_storeh_pd(reinterpret_cast<double *>(ptr), _mm_castps_pd(value)); }
+static inline f32x4 splat(const float value) { return _mm_set1_ps(value); }
+static inline f32x4 set4(const float a, const float b, const float c, const float d) { return _mm_setr_ps(a, b, c, d); }
+static inline f32x4 add(const f32x4 a, const f32x4 b) { return _mm_add_ps(a, b); }
+static inline f32x4 sub(const f32x4 a, const f32x4 b) { return _mm_sub_ps(a, b); }
+static inline f32x4 mul(const f32x4 a, const f32x4 b) { return _mm_mul_ps(a, b); }
+static inline f32x4 abs4(const f32x4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline f32x4 sqrt4(const f32x4 a) { return _mm_sqrt_ps(a); }
+static inline f32x4 min4(const f32x4 a, const f32x4 b) { return _mm_min_ps(a, b); }
+static inline f32x4 max4(const f32x4 a, const f32x4 b) { return _mm_max_ps(a, b); }
+// { a1, a0, a3, a2 }, swaps the channels of two stereo frames
+static inline f32x4 swap_pairs(const f32x4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+// { a0, a1, b0, b1 }
+static inline f32x4 low_halves(const f32x4 a, const f32x4 b) { return _mm_movelh_ps(a, b); }
+// { a2, a3, b0, b1 }
+static inline f32x4 high_low_halves(const f32x4 a, const f32x4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 2)); }
+// { a2, a3, b2, b3 }
+static inline f32x4 high_halves(const f32x4 a, const f32x4 b) { return _mm_movehl_ps(b, a); }
+static inline f32x4 select_gt(const f32x4 a, const f32x4 b, const f32x4 x, const f32x4 y) {
+    const f32x4 mask = _mm_cmpgt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+static inline float hsum(const f32x4 a) {
+    const f32x4 pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+#else
+struct f32x4 {
+    float v[4];
+};
+
+template <typename F>
+static inline f32x4 lanes(F func) {
+    return { { func(0), func(1), func(2), func(3) } };
+}
+
+static inline f32x4 load4(const float *ptr) { return { { ptr[0], ptr[1], ptr[2], ptr[3] } }; }
+static inline void store4(float *ptr, const f32x4 value) { std::copy_n(value.v, 4, ptr); }
+static inline f32x4 load2(const float *ptr) { return { { ptr[0], ptr[1], 0.0f, 0.0f } }; }
+static inline void store2(float *ptr, const f32x4 value) { std::copy_n(value.v, 2, ptr); }
+static inline void store_high2(float *ptr, const f32x4 value) { std::copy_n(value.v + 2, 2, ptr); }
+static inline f32x4 splat(const float value) { return { { value, value, value, value } }; }
+static inline f32x4 set4(const float a, const float b, const float c, const float d) { return { { a, b, c, d } }; }
+static inline f32x4 add(const f32x4 a, const f32x4 b) { return lanes([&](int i) { return a.v[i] + b.v[i]; }); }
+static inline f32x4 sub(const f32x4 a, const f32x4 b) { return lanes([&](int i) { return a.v[i] - b.v[i]; }); }
+static inline f32x4 mul(const f32x4 a, const f32x4 b) { return lanes([&](int i) { return a.v[i] * b.v[i]; }); }
+static inline f32x4 abs4(const f32x4 a) { return lanes([&](int i) { return std::abs(a.v[i]); }); }
+static inline f32x4 sqrt4(const f32x4 a) { return lanes([&](int i) { return std::sqrt(a.v[i]); }); }
+static inline f32x4 min4(const f32x4 a, const f32x4 b) { return lanes([&](int i) { return std::min(a.v[i], b.v[i]); }); }
+static inline f32x4 max4(const f32x4 a, const f32x4 b) { return lanes([&](int i) { return std::max(a.v[i], b.v[i]); }); }
+// { a1, a0, a3, a2 }, swaps the channels of two stereo frames
+static inline f32x4 swap_pairs(const f32x4 a) { return { { a.v[1], a.v[0], a.v[3], a.v[2] } }; }
+// { a0, a1, b0, b1 }
+static inline f32x4 low_halves(const f32x4 a, const f32x4 b) { return { { a.v[0], a.v[1], b.v[0], b.v[1] } }; }
+// { a2, a3, b0, b1 }
+static inline f32x4 high_low_halves(const f32x4 a, const f32x4 b) { return { { a.v[2], a.v[3], b.v[0], b.v[1] } }; }
+// { a2, a3, b2, b3 }
+static inline f32x4 high_halves(const f32x4 a, const f32x4 b) { return { { a.v[2], a.v[3], b.v[2], b.v[3] } }; }
+static inline f32x4 select_gt(const f32x4 a, const f32x4 b, const f32x4 x, const f32x4 y) {
+    return lanes([&](int i) { return a.v[i] > b.v[i] ? x.v[i] : y.v[i]; });
+}
+static inline float hsum(const f32x4 a) { return a.v[0] + a.v[1] + a.v[2] + a.v[3]; }
+#endif
+
+// a + b * c
+static inline f32x4 madd(const f32x4 a, const f32x4 b, const f32x4 c) {
+    return add(a, mul(b, c));
+}
+
+// Feedback paths decay into denormals once their input goes silent, and those are very slow on x86.
+// The float environment is restored before returning to the guest.
+class DenormalGuard {
+public:
+#if defined(NGS_DSP_SSE2)
+    DenormalGuard()
+        : csr(_mm_getcsr()) {
+        // flush to zero and denormals are zero
+        _mm_setcsr(csr | 0x8040);
+    }
+    ~DenormalGuard() {
+        _mm_setcsr(csr);
+    }
+
+private:
+    unsigned int csr;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    DenormalGuard() {
+        asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+        // FZ bit
+        asm volatile("msr fpcr, %0" : : "r"(fpcr | (uint64_t(1) << 24)));
+    }
+    ~DenormalGuard() {
+        asm volatile("msr fpcr, %0" : : "r"(fpcr));
+    }
+
+private:
+    uint64_t fpcr;
+#endif
+};
+
+float millibels_to_gain(const float millibels) {
+    // the lowest level of the I3DL2 ranges means silence
+    if (millibels <= -10000.0f)
+        return 0.0f;
+
+    return std::pow(10.0f, millibels / 2000.0f);
+}
+
+void scale(const float *input, float *output, const float gain, const uint32_t frames) {
+    const uint32_t count = frames * 2;
+    const f32x4 gains = splat(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        store4(output + i, mul(load4(input + i), gains));
+    for (; i < count; i++)
+        output[i] = input[i] * gain;
+}
+
+void mix(float *output, const float *input, const float left_gain, const float right_gain, const uint32_t frames) {
+    const uint32_t count = frames * 2;
+    const f32x4 gains = set4(left_gain, right_gain, left_gain, right_gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        store4(output + i, madd(load4(output + i), load4(input + i), gains));
+    if (i < count) {
+        output[i] += input[i] * left_gain;
+        output[i + 1] += input[i + 1] * right_gain;
+    }
+}
+
+void mix_matrix(float *output, const float *input, const float (&matrix)[2][2], const uint32_t frames) {
+    // most patches do not move sound between the channels
+    if (matrix[1][0] == 0.0f && matrix[0][1] == 0.0f) {
+        mix(output, input, matrix[0][0], matrix[1][1], frames);
+        return;
+    }
+
+    // left += left * m00 + right * m10, right += left * m01 + right * m11
+    const f32x4 direct = set4(matrix[0][0], matrix[1][1], matrix[0][0], matrix[1][1]);
+    const f32x4 crossed = set4(matrix[1][0], matrix[0][1], matrix[1][0], matrix[0][1]);
+    const uint32_t count = frames * 2;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const f32x4 in = load4(input + i);
+        store4(output + i, madd(madd(load4(output + i), in, direct), swap_pairs(in), crossed));
+    }
+    if (i < count) {
+        const float left = input[i];
+        const float right = input[i + 1];
+        output[i] += left * matrix[0][0] + right * matrix[1][0];
+        output[i + 1] += left * matrix[0][1] + right * matrix[1][1];
+    }
+}
+
+void clamp(float *buffer, const uint32_t frames) {
+    const f32x4 low = splat(-1.0f);
+    const f32x4 high = splat(1.0f);
+    const uint32_t count = frames * 2;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        store4(buffer + i, min4(max4(load4(buffer + i), low), high));
+    for (; i < count; i++)
+        buffer[i] = std::clamp(buffer[i], -1.0f, 1.0f);
+}
+
+BiquadCoeffs make_biquad(const SceNgsParamFilter &filter, const float sample_rate) {
+    // Designs from the RBJ audio EQ cookbook, computed in double as the coefficients of low frequencies are sensitive
+    const double frequency = std::clamp<double>(filter.fFrequency, 10.0, sample_rate * 0.49);
+    const double q = std::max<double>(filter.fResonance, 0.01);
+    const double w0 = 2.0 * std::numbers::pi * frequency / sample_rate;
+    const double cos_w0 = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+    // NGS gains are linear amplitudes, the cookbook A is the square root of it
+    const double a = std::sqrt(std::max<double>(filter.fGain, 0.0001));
+    const double sqrt_a_alpha = 2.0 * std::sqrt(a) * alpha;
+
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+    switch (filter.eFilterMode) {
+    case SCE_NGS_FILTER_MODE_OFF:
+        return {};
+    case SCE_NGS_FILTER_LOWPASS_RESONANT:
+    case SCE_NGS_FILTER_LOWPASS_RESONANT_NORMALIZED:
+        b0 = b2 = (1.0 - cos_w0) / 2.0;
+        b1 = 1.0 - cos_w0;
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        // the resonance peak is about q, keep it under unity gain
+        if (filter.eFilterMode == SCE_NGS_FILTER_LOWPASS_RESONANT_NORMALIZED && q > 1.0)
+            a0 *= q;
+        break;
+    case SCE_NGS_FILTER_HIGHPASS_RESONANT:
+        b0 = b2 = (1.0 + cos_w0) / 2.0;
+        b1 = -(1.0 + cos_w0);
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        break;
+    case SCE_NGS_FILTER_BANDPASS_PEAK:
+        b0 = q * alpha;
+        b2 = -q * alpha;
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        break;
+    case SCE_NGS_FILTER_BANDPASS_ZERO:
+        b0 = alpha;
+        b2 = -alpha;
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        break;
+    case SCE_NGS_FILTER_NOTCH:
+        b0 = b2 = 1.0;
+        b1 = -2.0 * cos_w0;
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        break;
+    case SCE_NGS_FILTER_PEAK:
+        b0 = 1.0 + alpha * a;
+        b1 = -2.0 * cos_w0;
+        b2 = 1.0 - alpha * a;
+        a0 = 1.0 + alpha / a;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha / a;
+        break;
+    case SCE_NGS_FILTER_HIGHSHELF:
+        b0 = a * ((a + 1.0) + (a - 1.0) * cos_w0 + sqrt_a_alpha);
+        b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cos_w0);
+        b2 = a * ((a + 1.0) + (a - 1.0) * cos_w0 - sqrt_a_alpha);
+        a0 = (a + 1.0) - (a - 1.0) * cos_w0 + sqrt_a_alpha;
+        a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cos_w0);
+        a2 = (a + 1.0) - (a - 1.0) * cos_w0 - sqrt_a_alpha;
+        break;
+    case SCE_NGS_FILTER_LOWSHELF:
+        b0 = a * ((a + 1.0) - (a - 1.0) * cos_w0 + sqrt_a_alpha);
+        b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cos_w0);
+        b2 = a * ((a + 1.0) - (a - 1.0) * cos_w0 - sqrt_a_alpha);
+        a0 = (a + 1.0) + (a - 1.0) * cos_w0 + sqrt_a_alpha;
+        a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cos_w0);
+        a2 = (a + 1.0) + (a - 1.0) * cos_w0 - sqrt_a_alpha;
+        break;
+    case SCE_NGS_FILTER_LOWPASS_ONEPOLE: {
+        const double x = std::exp(-w0);
+        b0 = 1.0 - x;
+        a1 = -x;
+        break;
+    }
+    case SCE_NGS_FILTER_HIGHPASS_ONEPOLE: {
+        const double x = std::exp(-w0);
+        b0 = (1.0 + x) / 2.0;
+        b1 = -b0;
+        a1 = -x;
+        break;
+    }
+    case SCE_NGS_FILTER_ALLPASS:
+        b0 = 1.0 - alpha;
+        b1 = -2.0 * cos_w0;
+        b2 = 1.0 + alpha;
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * cos_w0;
+        a2 = 1.0 - alpha;
+        break;
+    default:
+        return {};
+    }
+
+    return {
+        static_cast<float>(b0 / a0),
+        static_cast<float>(b1 / a0),
+        static_cast<float>(b2 / a0),
+        static_cast<float>(a1 / a0),
+        static_cast<float>(a2 / a0),
+    };
+}
+
+BiquadCoeffs make_biquad(const SceNgsParamCoEff &coeffs) {
+    return { coeffs.fB0, coeffs.fB1, coeffs.fB2, coeffs.fA1, coeffs.fA2 };
+}
+
+// keep the state out of the denormal range once the input is silent
+static void flush_biquad_state(BiquadState &state) {
+    for (int channel = 0; channel < 2; channel++) {
+        if (std::abs(state.z1[channel]) < 1e-20f)
+            state.z1[channel] = 0.0f;
+        if (std::abs(state.z2[channel]) < 1e-20f)
+            state.z2[channel] = 0.0f;
+    }
+}
+
+// Transposed direct form II with y substituted in the state updates, so that the recursion from one frame
+// to the next is a multiply and an add instead of going through the output first:
+// y = b0 x + z1, z1' = (b1 - a1 b0) x + z2 - a1 z1, z2' = (b2 - a2 b0) x - a2 z1
+struct BiquadLanes {
+    f32x4 b0, k1, k2, a1, a2;
+
+    BiquadLanes() = default;
+    BiquadLanes(const BiquadCoeffs &low, const BiquadCoeffs &high)
+        : b0(set4(low.b0, low.b0, high.b0, high.b0))
+        , k1(set4(low.b1 - low.a1 * low.b0, low.b1 - low.a1 * low.b0, high.b1 - high.a1 * high.b0, high.b1 - high.a1 * high.b0))
+        , k2(set4(low.b2 - low.a2 * low.b0, low.b2 - low.a2 * low.b0, high.b2 - high.a2 * high.b0, high.b2 - high.a2 * high.b0))
+        , a1(set4(-low.a1, -low.a1, -high.a1, -high.a1))
+        , a2(set4(-low.a2, -low.a2, -high.a2, -high.a2)) {}
+
+    // returns y and advances the state
+    f32x4 process(const f32x4 x, f32x4 &z1, f32x4 &z2) const {
+        const f32x4 y = madd(z1, b0, x);
+        const f32x4 z = z1;
+        z1 = madd(madd(z2, k1, x), a1, z);
+        z2 = madd(mul(k2, x), a2, z);
+        return y;
+    }
+};
+
+void process_biquad(const BiquadCoeffs &coeffs, BiquadState &state, const float *input, float *output, const uint32_t frames) {
+    // A single filter has nothing to overlap its recursion with, so it steps two frames at a time instead:
+    // the state two frames ahead is computed from the current one directly, halving the recursions.
+    // s holds { z1 left, z1 right, z2 left, z2 right }, the input and output registers hold two stereo frames.
+    const float alpha = -coeffs.a1;
+    const float beta = -coeffs.a2;
+    const float k1 = coeffs.b1 + alpha * coeffs.b0;
+    const float k2 = coeffs.b2 + beta * coeffs.b0;
+    // y0 = z1 + b0 x0, y1 = alpha z1 + z2 + k1 x0 + b0 x1
+    const f32x4 out_z1 = set4(1.0f, 1.0f, alpha, alpha);
+    const f32x4 out_z2 = set4(0.0f, 0.0f, 1.0f, 1.0f);
+    const f32x4 out_x0 = set4(coeffs.b0, coeffs.b0, k1, k1);
+    const f32x4 out_x1 = set4(0.0f, 0.0f, coeffs.b0, coeffs.b0);
+    // z1'' = (alpha^2 + beta) z1 + alpha z2 + (alpha k1 + k2) x0 + k1 x1
+    // z2'' = alpha beta z1 + beta z2 + beta k1 x0 + k2 x1
+    const f32x4 next_s = set4(alpha * alpha + beta, alpha * alpha + beta, beta, beta);
+    const f32x4 next_swapped = set4(alpha, alpha, alpha * beta, alpha * beta);
+    const f32x4 next_x0 = set4(alpha * k1 + k2, alpha * k1 + k2, beta * k1, beta * k1);
+    const f32x4 next_x1 = set4(k1, k1, k2, k2);
+
+    f32x4 s = set4(state.z1[0], state.z1[1], state.z2[0], state.z2[1]);
+    uint32_t frame = 0;
+    for (; frame + 2 <= frames; frame += 2) {
+        const f32x4 x = load4(input + frame * 2);
+        const f32x4 x0 = low_halves(x, x);
+        const f32x4 x1 = high_halves(x, x);
+        store4(output + frame * 2, add(madd(mul(out_z1, low_halves(s, s)), out_z2, high_halves(s, s)), madd(mul(out_x0, x0), out_x1, x1)));
+        s = add(madd(madd(mul(next_x0, x0), next_x1, x1), next_s, s), mul(next_swapped, high_low_halves(s, s)));
+    }
+
+    float values[4];
+    store4(values, s);
+    std::copy_n(values, 2, state.z1);
+    std::copy_n(values + 2, 2, state.z2);
+    // the odd frame at the end
+    if (frame < frames) {
+        for (int channel = 0; channel < 2; channel++) {
+            const float x = input[frame * 2 + channel];
+            const float z1 = state.z1[channel];
+            output[frame * 2 + channel] = z1 + coeffs.b0 * x;
+            state.z1[channel] = alpha * z1 + state.z2[channel] + k1 * x;
+            state.z2[channel] = beta * z1 + k2 * x;
+        }
+    }
+
+    flush_biquad_state(state);
+}
+
+// Two consecutive filters of a cascade, the first one in the lower lanes
+struct BiquadPair {
+    BiquadLanes lanes;
+    f32x4 z1 = splat(0.0f);
+    f32x4 z2 = splat(0.0f);
+    // last output of both filters
+    f32x4 y = splat(0.0f);
+
+    BiquadPair() = default;
+    BiquadPair(const BiquadCoeffs *coeffs, const BiquadState *states)
+        : lanes(coeffs[0], coeffs[1])
+        , z1(set4(states[0].z1[0], states[0].z1[1], states[1].z1[0], states[1].z1[1]))
+        , z2(set4(states[0].z2[0], states[0].z2[1], states[1].z2[0], states[1].z2[1])) {}
+
+    void process(const f32x4 x) {
+        y = lanes.process(x, z1, z2);
+    }
+
+    // only the filters whose lanes are set in active advance
+    void process(const f32x4 x, const f32x4 active) {
+        f32x4 next_z1 = z1;
+        f32x4 next_z2 = z2;
+        y = lanes.process(x, next_z1, next_z2);
+        z1 = select_gt(active, splat(0.0f), next_z1, z1);
+        z2 = select_gt(active, splat(0.0f), next_z2, z2);
+    }
+
+    void save(BiquadState *states) const {
+        float values[4];
+        store4(values, z1);
+        std::copy_n(values, 2, states[0].z1);
+        std::copy_n(values + 2, 2, states[1].z1);
+        store4(values, z2);
+        std::copy_n(values, 2, states[0].z2);
+        std::copy_n(values + 2, 2, states[1].z2);
+        flush_biquad_state(states[0]);
+        flush_biquad_state(states[1]);
+    }
+};
+
+// Runs a cascade of pairs * 2 biquads with all the lanes busy: filter i of the cascade processes frame step - i,
+// so that its input is the output the filter before it produced in the previous step. The first and last steps
+// of the block only advance the filters that have a frame. The output is written behind the input, so both can
+// be the same buffer.
+template <uint32_t pairs>
+static void process_biquad_pairs(const BiquadCoeffs *coeffs, BiquadState *states, const float *input, float *output, const uint32_t frames) {
+    static_assert(pairs == 1 || pairs == 2);
+    static constexpr uint32_t count = pairs * 2;
+
+    BiquadPair first(coeffs, states);
+    BiquadPair second = pairs == 2 ? BiquadPair(coeffs + 2, states + 2) : BiquadPair();
+    const auto is_active = [&](const uint32_t filter, const uint32_t step) {
+        return filter <= step && step < frames + filter ? 1.0f : 0.0f;
+    };
+
+    for (uint32_t step = 0; step < frames + count - 1; step++) {
+        const f32x4 first_input = low_halves(step < frames ? load2(input + step * 2) : splat(0.0f), first.y);
+        const f32x4 second_input = high_low_halves(first.y, second.y);
+        if (step >= count - 1 && step < frames) {
+            first.process(first_input);
+            if constexpr (pairs == 2)
+                second.process(second_input);
+        } else {
+            first.process(first_input, set4(is_active(0, step), is_active(0, step), is_active(1, step), is_active(1, step)));
+            if constexpr (pairs == 2)
+                second.process(second_input, set4(is_active(2, step), is_active(2, step), is_active(3, step), is_active(3, step)));
+        }
+
+        if (step >= count - 1)
+            store_high2(output + (step - (count - 1)) * 2, pairs == 2 ? second.y : first.y);
+    }
+
+    first.save(states);
+    if constexpr (pairs == 2)
+        second.save(states + 2);
+}
+
+void process_biquad_cascade(const BiquadCoeffs *coeffs, BiquadState *states, uint32_t count, const float *input, float *output, const uint32_t frames) {
+    while (count > 0) {
+        const uint32_t filters = std::min(count, 4u);
+        switch (filters) {
+        case 1:
+            process_biquad(*coeffs, *states, input, output, frames);
+            break;
+        case 2:
+            process_biquad_pairs<1>(coeffs, states, input, output, frames);
+            break;
+        case 3: {
+            // padded with a filter that lets everything through
+            const BiquadCoeffs padded_coeffs[4] = { coeffs[0], coeffs[1], coeffs[2], {} };
+            BiquadState padded_states[4] = { states[0], states[1], states[2], {} };
+            process_biquad_pairs<2>(padded_coeffs, padded_states, input, output, frames);
+            std::copy_n(padded_states, 3, states);
+            break;
+        }
+        default:
+            process_biquad_pairs<2>(coeffs, states, input, output, frames);
+            break;
+        }
+
+        coeffs += filters;
+        states += filters;
+        count -= filters;
+        input = output;
+    }
+}
+
+// output = newer + (older - newer) * weight, over count floats
+static void lerp_run(const float *older, const float *newer, float *output, const uint32_t count, const float weight) {
+    const f32x4 weights = splat(weight);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const f32x4 b = load4(newer + i);
+        store4(output + i, madd(b, sub(load4(older + i), b), weights));
+    }
+    for (; i < count; i++)
+        output[i] = newer[i] + (older[i] - newer[i]) * weight;
+}
+
+void DelayLine::reserve(const uint32_t max_delay, const uint32_t max_block) {
+    const uint32_t size = std::bit_ceil(max_delay + max_block + 2);
+    if (size * 2 <= buffer.size())
+        return;
+
+    buffer.assign(size * 2, 0.0f);
+    mask = size - 1;
+    position = 0;
+}
+
+void DelayLine::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    position = 0;
+}
+
+void DelayLine::write(const float *input, const uint32_t frames) {
+    const uint32_t first = std::min(frames, mask + 1 - position);
+    std::copy_n(input, first * 2, &buffer[position * 2]);
+    std::copy_n(input + first * 2, (frames - first) * 2, buffer.data());
+    position = (position + frames) & mask;
+}
+
+void DelayLine::read(float *output, const uint32_t frames, const float delay) const {
+    const float whole = std::floor(delay);
+    // weight of the older of the two frames around the read position
+    const float weight = delay - whole;
+    const uint32_t newest = (position - static_cast<uint32_t>(whole)) & mask;
+
+    uint32_t i = 0;
+    while (i < frames) {
+        const uint32_t newer = (newest + i) & mask;
+        const uint32_t run = std::min(frames - i, mask + 1 - newer);
+        if (weight == 0.0f) {
+            std::copy_n(&buffer[newer * 2], run * 2, output + i * 2);
+            i += run;
+        } else if (newer == 0) {
+            // the older frame is at the other end of the buffer
+            const float *older = &buffer[mask * 2];
+            for (int channel = 0; channel < 2; channel++)
+                output[i * 2 + channel] = buffer[channel] + (older[channel] - buffer[channel]) * weight;
+            i++;
+        } else {
+            lerp_run(&buffer[(newer - 1) * 2], &buffer[newer * 2], output + i * 2, run * 2, weight);
+            i += run;
+        }
+    }
+}
+
+void DelayLine::read_modulated(float *output, const uint32_t frames, const float *delays) const {
+    for (uint32_t i = 0; i < frames; i++) {
+        const float whole = std::floor(delays[i]);
+        const f32x4 weight = splat(delays[i] - whole);
+        const uint32_t newer = (position + i - static_cast<uint32_t>(whole)) & mask;
+        const f32x4 newer_frame = load2(&buffer[newer * 2]);
+        const f32x4 older_frame = load2(&buffer[((newer - 1) & mask) * 2]);
+        store2(output + i * 2, madd(newer_frame, sub(older_frame, newer_frame), weight));
+    }
+}
+
+// Freeverb tunings, in frames at 44.1 kHz
+static constexpr float REVERB_TUNING_RATE = 44100.0f;
+static constexpr float COMB_TUNINGS[Reverb::COMB_COUNT] = { 1116.0f, 1188.0f, 1277.0f, 1356.0f };
+static constexpr float ALLPASS_TUNINGS[Reverb::ALLPASS_COUNT] = { 556.0f, 441.0f, 341.0f };
+static constexpr float STEREO_SPREAD = 23.0f;
+// the combs add up the input of many passes, scale it down to keep the tail around unity gain
+static constexpr float LATE_INPUT_GAIN = 0.05f;
+
+struct ReflectionPattern {
+    float delays[Reverb::REFLECTION_TAP_COUNT]; // in milliseconds
+    float gains[Reverb::REFLECTION_TAP_COUNT];
+};
+
+// The layouts used by the hardware are unknown, these approximate a small, a medium and a large room
+static constexpr ReflectionPattern REFLECTION_PATTERNS[] = {
+    { { 3.1f, 7.3f, 11.9f, 17.3f }, { 0.84f, 0.61f, 0.47f, 0.35f } }, // SCE_NGS_REVERB_ROOM1_LEFT
+    { { 4.3f, 8.9f, 13.1f, 19.7f }, { 0.80f, 0.58f, 0.44f, 0.33f } }, // SCE_NGS_REVERB_ROOM1_RIGHT
+    { { 6.2f, 13.9f, 22.6f, 32.9f }, { 0.78f, 0.56f, 0.41f, 0.30f } }, // SCE_NGS_REVERB_ROOM2_LEFT
+    { { 8.1f, 16.9f, 24.9f, 37.4f }, { 0.75f, 0.53f, 0.39f, 0.28f } }, // SCE_NGS_REVERB_ROOM2_RIGHT
+    { { 10.5f, 24.8f, 40.5f, 58.8f }, { 0.72f, 0.50f, 0.36f, 0.25f } }, // SCE_NGS_REVERB_ROOM3_LEFT
+    { { 14.6f, 30.3f, 44.5f, 67.0f }, { 0.70f, 0.48f, 0.34f, 0.24f } }, // SCE_NGS_REVERB_ROOM3_RIGHT
+};
+
+void Reverb::configure(const ReverbSettings &new_settings, const float sample_rate, const uint32_t max_block) {
+    settings = new_settings;
+
+    const float tuning_scale = sample_rate / REVERB_TUNING_RATE;
+    // a lower density means shorter combs, so fewer echoes per second in the tail
+    const float size = 0.6f + 0.4f * std::clamp(settings.density, 0.0f, 1.0f);
+    const float decay_time = std::clamp(settings.decay_time, 0.1f, 20.0f);
+    const float hf_ratio = std::clamp(settings.decay_hf_ratio, 0.1f, 2.0f);
+
+    const uint32_t comb_size = std::bit_ceil(static_cast<uint32_t>((COMB_TUNINGS[COMB_COUNT - 1] + STEREO_SPREAD) * tuning_scale) + 2);
+    if (comb_mask + 1 != comb_size) {
+        for (auto &line : comb_lines)
+            line.assign(comb_size * COMB_COUNT, 0.0f);
+        comb_mask = comb_size - 1;
+        comb_position = 0;
+    }
+
+    for (int channel = 0; channel < 2; channel++) {
+        for (uint32_t comb = 0; comb < COMB_COUNT; comb++) {
+            const float length = (COMB_TUNINGS[comb] * size + channel * STEREO_SPREAD) * tuning_scale;
+            comb_lengths[channel][comb] = static_cast<uint32_t>(length);
+
+            // gain of one pass to get a 60 dB decay after decay_time
+            const float pass_db = -60.0f * length / (decay_time * sample_rate);
+            comb_feedback[channel][comb] = std::pow(10.0f, pass_db / 20.0f);
+            // the high frequencies lose an additional ratio on each pass, approximated with a one-pole lowpass
+            const float hf_loss = std::pow(10.0f, pass_db * (1.0f / hf_ratio - 1.0f) / 20.0f);
+            comb_damping[channel][comb] = std::clamp((1.0f - hf_loss) / (1.0f + hf_loss), 0.0f, 0.95f);
+        }
+    }
+
+    const uint32_t allpass_size = std::bit_ceil(static_cast<uint32_t>((ALLPASS_TUNINGS[0] + STEREO_SPREAD) * tuning_scale) + 2);
+    if (allpass_mask + 1 != allpass_size) {
+        for (auto &line : allpass_lines)
+            line.assign(allpass_size * 2, 0.0f);
+        allpass_mask = allpass_size - 1;
+        allpass_position = 0;
+    }
+
+    for (uint32_t allpass = 0; allpass < ALLPASS_COUNT; allpass++) {
+        for (int channel = 0; channel < 2; channel++)
+            allpass_lengths[allpass][channel] = static_cast<uint32_t>((ALLPASS_TUNINGS[allpass] + channel * STEREO_SPREAD) * tuning_scale);
+    }
+    allpass_feedback = 0.3f + 0.4f * std::clamp(settings.diffusion, 0.0f, 1.0f);
+
+    float max_delay = settings.reflections_delay + settings.reverb_delay;
+    for (int channel = 0; channel < 2; channel++) {
+        const ReflectionPattern &pattern = REFLECTION_PATTERNS[std::min<uint32_t>(settings.reflection_patterns[channel], std::size(REFLECTION_PATTERNS) - 1)];
+        for (uint32_t tap = 0; tap < REFLECTION_TAP_COUNT; tap++) {
+            reflection_delays[channel][tap] = settings.reflections_delay + pattern.delays[tap] * 0.001f * sample_rate * settings.reflections_scalar;
+            reflection_gains[channel][tap] = pattern.gains[tap];
+            max_delay = std::max(max_delay, reflection_delays[channel][tap]);
+        }
+    }
+
+    pre_delay.reserve(static_cast<uint32_t>(max_delay) + 1, max_block);
+    wet.resize(max_block * 2);
+    tap.resize(max_block * 2);
+}
+
+void Reverb::process(const float *input, float *output, const uint32_t frames) {
+    const DenormalGuard guard;
+
+    process_biquad(settings.room_hf, room_hf_state, input, wet.data(), frames);
+    process_biquad(settings.room_lf, room_lf_state, wet.data(), wet.data(), frames);
+    pre_delay.write(wet.data(), frames);
+
+    scale(input, output, settings.dry_gain, frames);
+
+    // the delays are relative to the block that was just written
+    const float reflections_gain = settings.room_gain * settings.reflections_gain;
+    if (reflections_gain != 0.0f) {
+        for (uint32_t i = 0; i < REFLECTION_TAP_COUNT; i++) {
+            pre_delay.read(tap.data(), frames, reflection_delays[0][i] + frames);
+            mix(output, tap.data(), reflection_gains[0][i] * reflections_gain, 0.0f, frames);
+            pre_delay.read(tap.data(), frames, reflection_delays[1][i] + frames);
+            mix(output, tap.data(), 0.0f, reflection_gains[1][i] * reflections_gain, frames);
+        }
+    }
+
+    // late reverb: parallel combs then allpasses in series, for each channel
+    pre_delay.read(tap.data(), frames, settings.reflections_delay + settings.reverb_delay + frames);
+
+    f32x4 feedback[2], damping[2], filter[2];
+    for (int channel = 0; channel < 2; channel++) {
+        feedback[channel] = load4(comb_feedback[channel]);
+        damping[channel] = load4(comb_damping[channel]);
+        filter[channel] = load4(comb_filter[channel]);
+    }
+    const f32x4 allpass_gain = splat(allpass_feedback);
+
+    for (uint32_t i = 0; i < frames; i++) {
+        float comb_sum[2];
+        for (int channel = 0; channel < 2; channel++) {
+            float *line = comb_lines[channel].data();
+            const uint32_t *lengths = comb_lengths[channel];
+            const f32x4 delayed = set4(
+                line[((comb_position - lengths[0]) & comb_mask) * COMB_COUNT + 0],
+                line[((comb_position - lengths[1]) & comb_mask) * COMB_COUNT + 1],
+                line[((comb_position - lengths[2]) & comb_mask) * COMB_COUNT + 2],
+                line[((comb_position - lengths[3]) & comb_mask) * COMB_COUNT + 3]);
+
+            filter[channel] = madd(delayed, sub(filter[channel], delayed), damping[channel]);
+            store4(line + comb_position * COMB_COUNT, madd(splat(tap[i * 2 + channel] * LATE_INPUT_GAIN), filter[channel], feedback[channel]));
+            comb_sum[channel] = hsum(delayed);
+        }
+        comb_position = (comb_position + 1) & comb_mask;
+
+        f32x4 value = set4(comb_sum[0], comb_sum[1], 0.0f, 0.0f);
+        for (uint32_t allpass = 0; allpass < ALLPASS_COUNT; allpass++) {
+            float *line = allpass_lines[allpass].data();
+            const f32x4 buffered = set4(
+                line[((allpass_position - allpass_lengths[allpass][0]) & allpass_mask) * 2],
+                line[((allpass_position - allpass_lengths[allpass][1]) & allpass_mask) * 2 + 1],
+                0.0f, 0.0f);
+            store2(line + allpass_position * 2, madd(value, buffered, allpass_gain));
+            value = sub(buffered, value);
+        }
+        allpass_position = (allpass_position + 1) & allpass_mask;
+
+        store2(wet.data() + i * 2, value);
+    }
+
+    for (int channel = 0; channel < 2; channel++)
+        store4(comb_filter[channel], filter[channel]);
+
+    const float late_gain = settings.room_gain * settings.reverb_gain;
+    mix(output, wet.data(), late_gain, late_gain, frames);
+}
+
+// The gain is computed in dB once every this many frames and linearly interpolated in between
+static constexpr uint32_t COMPRESSOR_CONTROL_FRAMES = 16;
+
+void Compressor::configure(const CompressorSettings &new_settings, const float sample_rate) {
+    settings = new_settings;
+    settings.ratio = std::max(settings.ratio, 1.0f);
+    settings.knee = std::max(settings.knee, 0.0f);
+    threshold_db = 20.0f * std::log10(std::max(settings.threshold, 1e-6f));
+
+    const auto time_to_coeff = [&](const float milliseconds) {
+        return 1.0f - std::exp(-1000.0f / (std::max(milliseconds, 0.01f) * sample_rate));
+    };
+    attack_coeff = time_to_coeff(settings.attack);
+    release_coeff = time_to_coeff(settings.release);
+    rms_coeff = time_to_coeff(10.0f);
+}
+
+void Compressor::process(const float *input, float *output, const uint32_t frames, float *input_level, float *output_level) {
+    const DenormalGuard guard;
+
+    const f32x4 attack = splat(attack_coeff);
+    const f32x4 release = splat(release_coeff);
+    const f32x4 rms = splat(rms_coeff);
+    f32x4 squares = load2(mean_square);
+    f32x4 levels = load2(envelope);
+
+    const float slope = 1.0f / settings.ratio - 1.0f;
+    const auto gain_for_level = [&](const float level) {
+        const float over = 20.0f * std::log10(std::max(level, 1e-6f)) - threshold_db;
+        float gain_db = slope * over;
+        if (2.0f * over <= -settings.knee)
+            gain_db = 0.0f;
+        else if (2.0f * std::abs(over) <= settings.knee)
+            gain_db = slope * (over + settings.knee / 2.0f) * (over + settings.knee / 2.0f) / (2.0f * settings.knee);
+        return std::pow(10.0f, gain_db / 20.0f) * settings.makeup_gain;
+    };
+
+    for (uint32_t start = 0; start < frames; start += COMPRESSOR_CONTROL_FRAMES) {
+        const uint32_t count = std::min(COMPRESSOR_CONTROL_FRAMES, frames - start);
+
+        for (uint32_t i = start; i < start + count; i++) {
+            const f32x4 x = load2(input + i * 2);
+            f32x4 level;
+            if (settings.peak_mode) {
+                level = abs4(x);
+            } else {
+                squares = madd(squares, sub(mul(x, x), squares), rms);
+                level = sqrt4(squares);
+            }
+            levels = madd(levels, sub(level, levels), select_gt(level, levels, attack, release));
+        }
+
+        store2(envelope, levels);
+        float detected[2] = { envelope[0], envelope[1] };
+        if (settings.stereo_link)
+            detected[0] = detected[1] = std::max(detected[0], detected[1]);
+
+        const float target[2] = { gain_for_level(detected[0]), gain_for_level(detected[1]) };
+        const f32x4 step = set4((target[0] - gain[0]) / count, (target[1] - gain[1]) / count, 0.0f, 0.0f);
+        f32x4 current = add(set4(gain[0], gain[1], 0.0f, 0.0f), step);
+        for (uint32_t i = start; i < start + count; i++) {
+            store2(output + i * 2, mul(load2(input + i * 2), current));
+            current = add(current, step);
+        }
+        gain[0] = target[0];
+        gain[1] = target[1];
+    }
+
+    store2(mean_square, squares);
+    for (int channel = 0; channel < 2; channel++) {
+        input_level[channel] = envelope[channel];
+        output_level[channel] = envelope[channel] * gain[channel];
+    }
+}
+
+void Delay::configure(const DelaySettings &new_settings, const float sample_rate, const uint32_t max_block) {
+    settings = new_settings;
+
+    const float angle = 2.0f * std::numbers::pi_v<float> * settings.modulation_rate / sample_rate;
+    rotation[0] = std::cos(angle);
+    rotation[1] = std::sin(angle);
+
+    float max_delay = 1.0f;
+    min_delay = static_cast<float>(max_block);
+    for (uint32_t i = 0; i < DelaySettings::MAX_TAPS; i++) {
+        DelayTapSettings &tap_settings = settings.taps[i];
+        // a tap must not read the frames of the block being computed
+        tap_settings.delay = std::max(tap_settings.delay, tap_settings.modulation_width + 1.0f);
+        oscillators[i][0] = std::cos(tap_settings.modulation_phase);
+        oscillators[i][1] = std::sin(tap_settings.modulation_phase);
+
+        if (tap_settings.volume == 0.0f && tap_settings.feedback == 0.0f)
+            continue;
+
+        max_delay = std::max(max_delay, tap_settings.delay + tap_settings.modulation_width);
+        min_delay = std::min(min_delay, tap_settings.delay - tap_settings.modulation_width);
+    }
+
+    line.reserve(static_cast<uint32_t>(max_delay) + 1, max_block);
+    tap.resize(max_block * 2);
+    feedback.resize(max_block * 2);
+    delays.resize(max_block);
+}
+
+void Delay::process(const float *input, float *output, const uint32_t frames) {
+    const DenormalGuard guard;
+
+    // with feedback, a block can only be computed at once if all the frames it reads are already in the line,
+    // so blocks longer than the shortest delay are split
+    const uint32_t chunk = std::max(static_cast<uint32_t>(min_delay), 1u);
+    for (uint32_t start = 0; start < frames; start += chunk)
+        process_chunk(input + start * 2, output + start * 2, std::min(chunk, frames - start));
+}
+
+void Delay::process_chunk(const float *input, float *output, const uint32_t frames) {
+    scale(input, output, settings.dry_gain, frames);
+    std::copy_n(input, frames * 2, feedback.data());
+
+    for (uint32_t i = 0; i < DelaySettings::MAX_TAPS; i++) {
+        const DelayTapSettings &tap_settings = settings.taps[i];
+        if (tap_settings.volume == 0.0f && tap_settings.feedback == 0.0f)
+            continue;
+
+        if (tap_settings.modulation_width > 0.0f) {
+            float cos_value = oscillators[i][0];
+            float sin_value = oscillators[i][1];
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                delays[frame] = tap_settings.delay + tap_settings.modulation_width * sin_value;
+                const float next_cos = cos_value * rotation[0] - sin_value * rotation[1];
+                sin_value = cos_value * rotation[1] + sin_value * rotation[0];
+                cos_value = next_cos;
+            }
+            // the rotation slowly drifts away from the unit circle
+            const float norm = 1.0f / std::sqrt(cos_value * cos_value + sin_value * sin_value);
+            oscillators[i][0] = cos_value * norm;
+            oscillators[i][1] = sin_value * norm;
+
+            line.read_modulated(tap.data(), frames, delays.data());
+        } else {
+            line.read(tap.data(), frames, tap_settings.delay);
+        }
+
+        if (!tap_settings.filter.is_identity())
+            process_biquad(tap_settings.filter, tap_filters[i], tap.data(), tap.data(), frames);
+
+        mix(output, tap.data(), tap_settings.volume, tap_settings.volume, frames);
+        mix(feedback.data(), tap.data(), tap_settings.feedback, tap_settings.feedback, frames);
+    }
+
+    line.write(feedback.data(), frames);
+}
+
+// length of the delay range swept by the read heads
+static constexpr uint32_t PITCH_SHIFT_WINDOW = 2048;
+
+void PitchShifter::process(const float *input, float *output, const uint32_t frames, const float ratio) {
+    line.reserve(PITCH_SHIFT_WINDOW + frames + 1, frames);
+    line.write(input, frames);
+
+    // Two read heads sweep the delay at the rate that changes the pitch, half a window apart.
+    // Each one fades out before jumping back to the other end of the window.
+    const float step = (1.0f - ratio) / PITCH_SHIFT_WINDOW;
+    for (int head = 0; head < 2; head++) {
+        heads[head].resize(frames * 2);
+        delays[head].resize(frames);
+    }
+
+    float head_phase = phase;
+    for (uint32_t i = 0; i < frames; i++) {
+        const float other_phase = head_phase < 0.5f ? head_phase + 0.5f : head_phase - 0.5f;
+        // the delays are relative to the block that was just written
+        delays[0][i] = head_phase * PITCH_SHIFT_WINDOW + frames;
+        delays[1][i] = other_phase * PITCH_SHIFT_WINDOW + frames;
+
+        head_phase += step;
+        head_phase -= std::floor(head_phase);
+    }
+
+    line.read_modulated(heads[0].data(), frames, delays[0].data());
+    line.read_modulated(heads[1].data(), frames, delays[1].data());
+
+    for (uint32_t i = 0; i < frames; i++) {
+        // triangular crossfade, the weights of both heads add up to 1
+        const float head_weight = 1.0f - std::abs(2.0f * phase - 1.0f);
+        const f32x4 first = load2(&heads[0][i * 2]);
+        const f32x4 second = load2(&heads[1][i * 2]);
+        store2(output + i * 2, madd(second, sub(first, second), splat(head_weight)));
+
+        phase += step;
+        phase -= std::floor(phase);
+    }
+}
+
+} // namespace ngs::dsp
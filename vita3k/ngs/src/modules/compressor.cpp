@@ -16,18 +16,47 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <ngs/modules/compressor.h>
-#include <util/log.h>
 
 namespace ngs {
 
+void CompressorModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
 bool CompressorModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID || desc->id == SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID_V2) {
-            LOG_WARN_ONCE("Game is using unimplemented compressor audio module");
-        }
+    Voice *voice = data.parent;
+    VoiceProduct &product = voice->products[0];
+    if (data.is_bypassed || !product.data)
+        return false;
+
+    const auto *params = data.get_parameters<SceNgsCompressorParams>(mem);
+    if (params->desc.id != SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID && params->desc.id != SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID_V2)
+        return false;
+
+    CompressorLogicalState *logical = data.get_logical_state<CompressorLogicalState>();
+    if (dsp::update_params_cache(logical->params, params, sizeof(SceNgsCompressorParams))) {
+        // the threshold and the makeup gain are linear amplitudes like the other NGS volumes
+        dsp::CompressorSettings settings;
+        settings.ratio = params->fRatio;
+        settings.threshold = params->fThreshold;
+        settings.makeup_gain = params->fMakeupGain;
+        settings.attack = params->fAttack;
+        settings.release = params->fRelease;
+        settings.knee = params->fSoftKnee;
+        settings.peak_mode = params->nPeakMode == SCE_NGS_COMPRESSOR_PEAK_MODE;
+        settings.stereo_link = params->nStereoLink == SCE_NGS_COMPRESSOR_STEREO_LINK_ON;
+        logical->compressor.configure(settings, static_cast<float>(voice->rack->system->sample_rate));
     }
 
+    const int32_t granularity = voice->rack->system->granularity;
+    data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+
+    SceNgsCompressorStates *state = data.get_state<SceNgsCompressorStates>();
+    logical->compressor.process(reinterpret_cast<const float *>(product.data), reinterpret_cast<float *>(data.scratch_data.data()),
+        granularity, state->fInputLevel, state->fOutputLevel);
+    product.data = data.scratch_data.data();
+
     return false;
 }
 } // namespace ngs
@@ -16,18 +16,81 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <ngs/modules/delay.h>
-#include <util/log.h>
+#include <ngs/modules/filter.h>
+
+#include <algorithm>
+#include <numbers>
 
 namespace ngs {
 
-bool DelayModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_DELAY_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented delay audio module");
+// keeps the line of a voice under 2 MiB at 48 kHz
+static constexpr float MAX_DELAY_MILLISECS = 5000.0f;
+
+void DelayModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
+static dsp::DelaySettings get_delay_settings(const SceNgsDelayParams &params, const float sample_rate) {
+    dsp::DelaySettings settings;
+    settings.dry_gain = params.fDryVol;
+    settings.modulation_rate = std::max(params.fModRate, 0.0f);
+
+    const auto to_frames = [&](const float milliseconds) {
+        return std::clamp(milliseconds, 0.0f, MAX_DELAY_MILLISECS) * 0.001f * sample_rate;
+    };
+
+    for (int i = 0; i < SCE_NGS_DELAY_MAX_TAPS; i++) {
+        const SceNgsDelayTap &tap = params.taps[i];
+        dsp::DelayTapSettings &tap_settings = settings.taps[i];
+        tap_settings.delay = to_frames(tap.fDelayMillisecs);
+        tap_settings.modulation_width = to_frames(tap.fModWidthMillisecs);
+        tap_settings.modulation_phase = tap.fPhaseOffsetDeg * std::numbers::pi_v<float> / 180.0f;
+        tap_settings.volume = tap.fVolume;
+        // anything higher would never decay
+        tap_settings.feedback = std::clamp(tap.fFeedback, -0.99f, 0.99f);
+
+        SceNgsParamFilter filter = { SCE_NGS_FILTER_MODE_OFF, tap.fCutoff, 0.707f, 1.0f };
+        switch (tap.eFilterMode) {
+        case SCE_NGS_DELAY_FILTER_MODE_LOWPASS_ONEPOLE:
+            filter.eFilterMode = SCE_NGS_FILTER_LOWPASS_ONEPOLE;
+            break;
+        case SCE_NGS_DELAY_FILTER_MODE_HIGHPASS_ONEPOLE:
+            filter.eFilterMode = SCE_NGS_FILTER_HIGHPASS_ONEPOLE;
+            break;
+        case SCE_NGS_DELAY_FILTER_MODE_ALLPASS:
+            filter.eFilterMode = SCE_NGS_FILTER_ALLPASS;
+            break;
+        default:
+            break;
         }
+        tap_settings.filter = dsp::make_biquad(filter, sample_rate);
     }
 
+    return settings;
+}
+
+bool DelayModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
+    Voice *voice = data.parent;
+    VoiceProduct &product = voice->products[0];
+    if (data.is_bypassed || !product.data)
+        return false;
+
+    const auto *params = data.get_parameters<SceNgsDelayParams>(mem);
+    if (params->desc.id != SCE_NGS_DELAY_PARAMS_STRUCT_ID)
+        return false;
+
+    const int32_t granularity = voice->rack->system->granularity;
+    DelayLogicalState *logical = data.get_logical_state<DelayLogicalState>();
+    if (dsp::update_params_cache(logical->params, params, sizeof(SceNgsDelayParams))) {
+        const float sample_rate = static_cast<float>(voice->rack->system->sample_rate);
+        logical->delay.configure(get_delay_settings(*params, sample_rate), sample_rate, granularity);
+    }
+
+    data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+    logical->delay.process(reinterpret_cast<const float *>(product.data), reinterpret_cast<float *>(data.scratch_data.data()), granularity);
+    product.data = data.scratch_data.data();
+
     return false;
 }
 } // namespace ngs
@@ -16,22 +16,76 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <ngs/modules/equalizer.h>
-#include <util/log.h>
+
+#include <algorithm>
 
 namespace ngs {
 
+void EqualizerModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
+static void update_coeffs(EqualizerLogicalState &logical, const SceNgsParamsDescriptor *desc, const float sample_rate) {
+    if (desc->id == SCE_NGS_PARAM_EQ_STRUCT_ID) {
+        const auto *params = reinterpret_cast<const SceNgsParamEqParams *>(desc);
+        if (dsp::update_params_cache(logical.params, params, sizeof(SceNgsParamEqParams))) {
+            for (int i = 0; i < SCE_NGS_MAX_EQ_FILTERS; i++)
+                logical.coeffs[i] = dsp::make_biquad(params->filter[i], sample_rate);
+        }
+    } else if (desc->id == SCE_NGS_PARAM_EQ_COEFF_STRUCT_ID) {
+        const auto *params = reinterpret_cast<const SceNgsParamEqParamsCoEff *>(desc);
+        if (dsp::update_params_cache(logical.params, params, sizeof(SceNgsParamEqParamsCoEff))) {
+            for (int i = 0; i < SCE_NGS_MAX_EQ_FILTERS; i++)
+                logical.coeffs[i] = dsp::make_biquad(params->filterCoEff[i]);
+        }
+    } else {
+        logical.params.clear();
+        std::fill_n(logical.coeffs, SCE_NGS_MAX_EQ_FILTERS, dsp::BiquadCoeffs{});
+    }
+}
+
 bool EqualizerModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_PARAM_EQ_COEFF_STRUCT_ID || desc->id == SCE_NGS_PARAM_EQ_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented equalizer audio module");
+    Voice *voice = data.parent;
+    const uint32_t instance = data.instance_index();
+    // The first equalizer processes the whole voice, definitions with more have one for each of their (up to 4) outputs
+    VoiceProduct &product = voice->products[instance == 0 ? 0 : std::min(instance - 1, MAX_VOICE_OUTPUT - 1)];
+
+    if (!data.is_bypassed && product.data) {
+        EqualizerLogicalState *logical = data.get_logical_state<EqualizerLogicalState>();
+        update_coeffs(*logical, data.get_parameters<SceNgsParamsDescriptor>(mem), static_cast<float>(voice->rack->system->sample_rate));
+
+        // the bands left flat are skipped, the others run as one cascade
+        dsp::BiquadCoeffs coeffs[SCE_NGS_MAX_EQ_FILTERS];
+        dsp::BiquadState states[SCE_NGS_MAX_EQ_FILTERS];
+        int bands[SCE_NGS_MAX_EQ_FILTERS];
+        uint32_t count = 0;
+        for (int i = 0; i < SCE_NGS_MAX_EQ_FILTERS; i++) {
+            if (logical->coeffs[i].is_identity())
+                continue;
+
+            coeffs[count] = logical->coeffs[i];
+            states[count] = logical->states[i];
+            bands[count++] = i;
+        }
+
+        if (count > 0) {
+            const int32_t granularity = voice->rack->system->granularity;
+            data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+            float *output = reinterpret_cast<float *>(data.scratch_data.data());
+            dsp::process_biquad_cascade(coeffs, states, count, reinterpret_cast<const float *>(product.data), output, granularity);
+
+            for (uint32_t i = 0; i < count; i++)
+                logical->states[bands[i]] = states[i];
+            product.data = data.scratch_data.data();
         }
     }
 
-    // Definitions with equalizers can have up to 4 outputs
-    data.parent->products[1] = data.parent->products[0];
-    data.parent->products[2] = data.parent->products[0];
-    data.parent->products[3] = data.parent->products[0];
+    if (instance == 0) {
+        voice->products[1] = voice->products[0];
+        voice->products[2] = voice->products[0];
+        voice->products[3] = voice->products[0];
+    }
 
     return false;
 }
@@ -16,20 +16,51 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <ngs/modules/filter.h>
-#include <util/log.h>
+
+#include <algorithm>
 
 namespace ngs {
 
+void FilterModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    // a voice played again must not start with the tail of its previous sound
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
 bool FilterModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_FILTER_PARAMS_COEFF_STRUCT_ID || desc->id == SCE_NGS_FILTER_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented filter audio module");
-        }
+    Voice *voice = data.parent;
+    const uint32_t output = std::min(data.instance_index(), MAX_VOICE_OUTPUT - 1);
+
+    // Definitions with filters have 2 outputs, each one has its own filter fed with the same signal
+    if (output == 0)
+        voice->products[1] = voice->products[0];
+
+    VoiceProduct &product = voice->products[output];
+    if (data.is_bypassed || !product.data)
+        return false;
+
+    const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
+    FilterLogicalState *logical = data.get_logical_state<FilterLogicalState>();
+    if (desc->id == SCE_NGS_FILTER_PARAMS_STRUCT_ID) {
+        const auto *params = reinterpret_cast<const SceNgsFilterParams *>(desc);
+        if (dsp::update_params_cache(logical->params, params, sizeof(SceNgsFilterParams)))
+            logical->coeffs = dsp::make_biquad(params->params, static_cast<float>(voice->rack->system->sample_rate));
+    } else if (desc->id == SCE_NGS_FILTER_PARAMS_COEFF_STRUCT_ID) {
+        const auto *params = reinterpret_cast<const SceNgsFilterParamsCoEff *>(desc);
+        if (dsp::update_params_cache(logical->params, params, sizeof(SceNgsFilterParamsCoEff)))
+            logical->coeffs = dsp::make_biquad(params->params);
+    } else {
+        return false;
     }
 
-    // Definitions with filters have 2 outputs
-    data.parent->products[1] = data.parent->products[0];
+    if (logical->coeffs.is_identity())
+        return false;
+
+    const int32_t granularity = voice->rack->system->granularity;
+    data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+    dsp::process_biquad(logical->coeffs, logical->state, reinterpret_cast<const float *>(product.data),
+        reinterpret_cast<float *>(data.scratch_data.data()), granularity);
+    product.data = data.scratch_data.data();
 
     return false;
 }
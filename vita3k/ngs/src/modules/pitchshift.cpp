@@ -16,17 +16,35 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <ngs/modules/pitchshift.h>
-#include <util/log.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace ngs {
 
+void PitchShiftModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
 bool PitchShiftModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_PITCHSHIFT_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented pitchshift audio module");
-        }
-    }
+    Voice *voice = data.parent;
+    VoiceProduct &product = voice->products[0];
+    if (data.is_bypassed || !product.data)
+        return false;
+
+    const auto *params = data.get_parameters<SceNgsPitchShiftParams>(mem);
+    if (params->desc.id != SCE_NGS_PITCHSHIFT_PARAMS_STRUCT_ID || params->fPitchOffsetInCents == 0.0f)
+        return false;
+
+    // two octaves in both directions
+    const float ratio = std::exp2(std::clamp(params->fPitchOffsetInCents, -2400.0f, 2400.0f) / 1200.0f);
+
+    const int32_t granularity = voice->rack->system->granularity;
+    data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+    data.get_logical_state<PitchShiftLogicalState>()->shifter.process(reinterpret_cast<const float *>(product.data),
+        reinterpret_cast<float *>(data.scratch_data.data()), granularity, ratio);
+    product.data = data.scratch_data.data();
 
     return false;
 }
@@ -15,19 +15,63 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/modules/filter.h>
 #include <ngs/modules/reverb.h>
-#include <util/log.h>
+
+#include <algorithm>
+#include <cstddef>
 
 namespace ngs {
 
+void ReverbModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.logical_state.reset();
+}
+
+// The parameters follow the I3DL2 model: levels are in millibels, times in seconds and percentages for the diffusion and density
+static dsp::ReverbSettings get_reverb_settings(const SceNgsReverbParams &params, const float sample_rate) {
+    dsp::ReverbSettings settings;
+    // the first version of the structure has no dry level, the buss then only outputs the reverb
+    settings.dry_gain = params.desc.size >= offsetof(SceNgsReverbParams, fDryMB) + sizeof(SceFloat32) ? dsp::millibels_to_gain(params.fDryMB) : 0.0f;
+    settings.room_gain = dsp::millibels_to_gain(params.fRoom);
+    settings.reflections_gain = dsp::millibels_to_gain(params.fReflections);
+    settings.reverb_gain = dsp::millibels_to_gain(params.fReverb);
+    settings.reflections_delay = std::clamp(params.fReflectionsDelay, 0.0f, 0.3f) * sample_rate;
+    settings.reverb_delay = std::clamp(params.fReverbDelay, 0.0f, 0.1f) * sample_rate;
+    settings.decay_time = params.fDecayTime;
+    settings.decay_hf_ratio = params.fDecayHFRatio;
+    settings.diffusion = params.fDiffusion / 100.0f;
+    settings.density = params.fDensity / 100.0f;
+    settings.room_hf = dsp::make_biquad(SceNgsParamFilter{ SCE_NGS_FILTER_HIGHSHELF, params.fHFReference, 0.707f, dsp::millibels_to_gain(params.fRoomHF) }, sample_rate);
+    settings.room_lf = dsp::make_biquad(SceNgsParamFilter{ SCE_NGS_FILTER_LOWSHELF, params.fLFReference, 0.707f, dsp::millibels_to_gain(params.fRoomLF) }, sample_rate);
+    for (int channel = 0; channel < SCE_NGS_MAX_SYSTEM_CHANNELS; channel++)
+        settings.reflection_patterns[channel] = static_cast<uint32_t>(params.eEarlyReflectionPattern[channel]);
+    settings.reflections_scalar = std::clamp(params.fEarlyReflectionScalar, 0.0f, 2.0f);
+
+    return settings;
+}
+
 bool ReverbModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_REVERB_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented reverb audio module");
-        }
+    Voice *voice = data.parent;
+    VoiceProduct &product = voice->products[0];
+    if (data.is_bypassed || !product.data)
+        return false;
+
+    const auto *params = data.get_parameters<SceNgsReverbParams>(mem);
+    if (params->desc.id != SCE_NGS_REVERB_PARAMS_STRUCT_ID && params->desc.id != SCE_NGS_REVERB_PARAMS_STRUCT_ID_V2)
+        return false;
+
+    const int32_t granularity = voice->rack->system->granularity;
+    ReverbLogicalState *logical = data.get_logical_state<ReverbLogicalState>();
+    if (dsp::update_params_cache(logical->params, params, sizeof(SceNgsReverbParams))) {
+        const float sample_rate = static_cast<float>(voice->rack->system->sample_rate);
+        logical->reverb.configure(get_reverb_settings(*params, sample_rate), sample_rate, granularity);
     }
 
+    data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+    logical->reverb.process(reinterpret_cast<const float *>(product.data), reinterpret_cast<float *>(data.scratch_data.data()), granularity);
+    product.data = data.scratch_data.data();
+
     return false;
 }
 } // namespace ngs
@@ -18,6 +18,7 @@
 #include <cpu/functions.h>
 #include <kernel/state.h>
 
+#include <ngs/dsp.h>
 #include <ngs/modules/atrac9.h>
 #include <ngs/state.h>
 #include <ngs/system.h>
@@ -42,6 +43,7 @@ bool Patch::is_active() const {
 
 void VoiceInputManager::init(const uint32_t granularity, const uint16_t total_input) {
     inputs.resize(total_input);
+    received.resize(total_input);
 
     for (auto &input : inputs) {
         // FLTP and maximum channel count
@@ -55,6 +57,15 @@ void VoiceInputManager::reset_inputs() {
     for (auto &input : inputs) {
         std::fill(input.begin(), input.end(), 0);
     }
+
+    std::fill(received.begin(), received.end(), false);
+}
+
+void VoiceInputManager::finalize_inputs(const uint32_t granularity) {
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (received[i])
+            dsp::clamp(reinterpret_cast<float *>(inputs[i].data()), granularity);
+    }
 }
 
 VoiceInputManager::PCMInput *VoiceInputManager::get_input_buffer_queue(const int32_t index) {
@@ -95,14 +106,9 @@ int32_t VoiceInputManager::receive(const MemState &mem, ngs::Patch *patch, const
         volume_matrix[1][1] = 0.0f;
     }
 
-    // Try mixing, also with the use of this volume matrix
-    // Dest is our voice to receive this data.
-    for (int32_t k = 0; k < dest->rack->system->granularity; k++) {
-        dest_buffer[k * 2] = std::clamp(dest_buffer[k * 2] + data_to_mix_in[k * 2] * volume_matrix[0][0]
-                + data_to_mix_in[k * 2 + 1] * volume_matrix[1][0],
-            -1.0f, 1.0f);
-        dest_buffer[k * 2 + 1] = std::clamp(dest_buffer[k * 2 + 1] + data_to_mix_in[k * 2] * volume_matrix[0][1] + data_to_mix_in[k * 2 + 1] * volume_matrix[1][1], -1.0f, 1.0f);
-    }
+    // the sum is only clamped once all the sources were received, see finalize_inputs
+    dsp::mix_matrix(dest_buffer, data_to_mix_in, volume_matrix, dest->rack->system->granularity);
+    received[patch->dest_index] = true;
 
     return 0;
 }
@@ -114,6 +120,19 @@ ModuleData::ModuleData()
     , flags(0) {
 }
 
+uint32_t ModuleData::instance_index() const {
+    const auto &modules = parent->rack->modules;
+    const uint32_t id = modules[index]->module_id();
+
+    uint32_t instance = 0;
+    for (uint32_t i = 0; i < index; i++) {
+        if (modules[i] && modules[i]->module_id() == id)
+            instance++;
+    }
+
+    return instance;
+}
+
 SceNgsBufferInfo *ModuleData::lock_params(const MemState &mem) {
     const std::lock_guard<std::mutex> guard(*parent->voice_mutex);
 
@@ -351,9 +370,12 @@ uint32_t Rack::get_required_memspace_size(MemState &mem, SceNgsRackDescription *
     return sizeof(ngs::Rack) + description->voice_count * (sizeof(ngs::Voice) + buffer_size + description->patches_per_output * description->definition.get(mem)->output_count * sizeof(ngs::Patch));
 }
 
-bool init(State &ngs, MemState &mem) {
+bool init(State &ngs, MemState &mem, const uint32_t worker_count) {
     voice_definition_init(ngs, mem);
 
+    if (worker_count > 0)
+        ngs.workers = std::make_unique<WorkerPool>(worker_count);
+
     return true;
 }
 
@@ -364,6 +386,7 @@ void deinit(State &ngs, MemState &mem) {
 
     Atrac9Module::free_swr_contexts();
 
+    ngs.workers.reset();
     ngs.definitions = Ptr<VoiceDefinition>(0);
 }
 
@@ -377,6 +400,7 @@ bool init_system(State &ngs, const MemState &mem, SceNgsSystemInitParams *parame
     sys->max_voices = parameters->max_voices;
     sys->granularity = parameters->granularity;
     sys->sample_rate = parameters->sample_rate;
+    sys->voice_scheduler.workers = ngs.workers.get();
 
     // Alloc first block for System struct
     if (!sys->alloc_raw(sizeof(System))) {
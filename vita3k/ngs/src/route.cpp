@@ -17,29 +17,51 @@
 
 #include <ngs/system.h>
 
-#include <util/vector_utils.h>
-
 namespace ngs {
-bool deliver_data(const MemState &mem, const std::vector<Voice *> &voice_queue, Voice *source, const uint8_t output_port,
-    const VoiceProduct &data_to_deliver) {
-    if (!data_to_deliver.data) {
-        return false;
-    }
-
-    for (auto &patch_ptr : source->patches[output_port]) {
-        Patch *patch = patch_ptr.get(mem);
-
-        if (!patch || !patch->is_active())
+// Calls func(patch, dest, output_port) for every active patch of the source
+template <typename F>
+static void for_each_patch(const MemState &mem, Voice *source, F func) {
+    for (uint32_t port = 0; port < source->rack->vdef->output_count; port++) {
+        if (!source->products[port].data)
             continue;
 
-        Voice *dest = patch->dest.get(mem);
-        if (!dest || !std::ranges::contains(voice_queue, dest))
-            continue;
+        for (auto &patch_ptr : source->patches[port]) {
+            Patch *patch = patch_ptr.get(mem);
+            if (!patch || !patch->is_active())
+                continue;
 
-        const std::lock_guard<std::mutex> guard(*dest->voice_mutex);
-        dest->inputs.receive(mem, patch, data_to_deliver);
+            Voice *dest = patch->dest.get(mem);
+            if (dest && !func(patch, dest, port))
+                return;
+        }
     }
+}
+
+void deliver_data(const MemState &mem, Voice *source) {
+    // A voice usually has a few patches, often going to the same bus. They are grouped by
+    // destination so that each destination is locked only once, without allocating anything.
+    for_each_patch(mem, source, [&](Patch *first_patch, Voice *dest, uint32_t) {
+        bool already_delivered = false;
+        for_each_patch(mem, source, [&](Patch *patch, Voice *other_dest, uint32_t) {
+            if (patch == first_patch)
+                return false;
+            already_delivered |= other_dest == dest;
+            return !already_delivered;
+        });
 
-    return true;
+        // the inputs of a voice processed before this one were already used
+        if (already_delivered || !dest->is_scheduled_after(*source))
+            return true;
+
+        const std::lock_guard<std::mutex> guard(*dest->voice_mutex);
+        bool found_first = false;
+        for_each_patch(mem, source, [&](Patch *patch, Voice *other_dest, uint32_t port) {
+            found_first |= patch == first_patch;
+            if (found_first && other_dest == dest)
+                dest->inputs.receive(mem, patch, source->products[port]);
+            return true;
+        });
+        return true;
+    });
 }
 } // namespace ngs
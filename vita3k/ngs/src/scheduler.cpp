@@ -19,6 +19,7 @@
 #include <ngs/system.h>
 
 #include <kernel/state.h>
+#include <threads/worker_pool.h>
 
 #include <algorithm>
 #include <cstring>
@@ -120,55 +121,71 @@ bool VoiceScheduler::off(const MemState &mem, Voice *voice) {
     return true;
 }
 
+bool VoiceScheduler::process_voice(KernelState &kern, const MemState &mem, const SceUID thread_id, Voice *voice, uint32_t &finished_module,
+    std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
+    memset(voice->products, 0, sizeof(voice->products));
+    voice->inputs.finalize_inputs(voice->rack->system->granularity);
+
+    bool finished = false;
+    for (size_t i = 0; i < voice->rack->modules.size(); i++) {
+        if (voice->rack->modules[i]) {
+            if (voice->rack->modules[i]->process(kern, mem, thread_id, voice->datas[i], scheduler_lock, voice_lock)) {
+                finished = true;
+                finished_module = voice->rack->modules[i]->module_id();
+            }
+        }
+    }
+
+    return finished;
+}
+
+void VoiceScheduler::finish_voice(KernelState &kern, const MemState &mem, const SceUID thread_id, Voice *voice, const uint32_t finished_module,
+    std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
+    voice->is_keyed_off = true;
+    voice->transition(mem, VOICE_STATE_FINALIZING);
+    if (voice->finished_callback) {
+        voice_lock.unlock();
+        scheduler_lock.unlock();
+        voice->invoke_callback(kern, mem, thread_id, voice->finished_callback, voice->finished_callback_user_data, finished_module);
+        scheduler_lock.lock();
+        voice_lock.lock();
+    }
+    voice->is_keyed_off = false;
+
+    stop(mem, voice);
+}
+
 void VoiceScheduler::update(KernelState &kern, const MemState &mem, const SceUID thread_id) {
     std::unique_lock<std::recursive_mutex> scheduler_lock(mutex);
     is_updating = true;
 
     // make a copy of the queue, this way we have no issue if it is modified in a callback
     std::vector<ngs::Voice *> queue_copy = queue;
+    update_count++;
 
     // Do a first routine to clear inputs from previous update session
-    for (ngs::Voice *voice : queue_copy) {
+    for (size_t i = 0; i < queue_copy.size(); i++) {
+        ngs::Voice *voice = queue_copy[i];
         voice->inputs.reset_inputs();
+        voice->scheduled_update = update_count;
+        voice->schedule_position = static_cast<uint32_t>(i);
     }
 
-    for (ngs::Voice *voice : queue_copy) {
-        // Modify the state, in peace....
-        std::unique_lock<std::mutex> voice_lock(*voice->voice_mutex);
-        memset(voice->products, 0, sizeof(voice->products));
+    if (workers && workers->worker_count() > 0) {
+        update_levels(kern, mem, thread_id, queue_copy, scheduler_lock);
+    } else {
+        for (ngs::Voice *voice : queue_copy) {
+            // Modify the state, in peace....
+            std::unique_lock<std::mutex> voice_lock(*voice->voice_mutex);
 
-        bool finished = false;
-        uint32_t finished_module = 0;
+            uint32_t finished_module = 0;
+            if (process_voice(kern, mem, thread_id, voice, finished_module, scheduler_lock, voice_lock))
+                finish_voice(kern, mem, thread_id, voice, finished_module, scheduler_lock, voice_lock);
 
-        for (size_t i = 0; i < voice->rack->modules.size(); i++) {
-            if (voice->rack->modules[i]) {
-                if (voice->rack->modules[i]->process(kern, mem, thread_id, voice->datas[i], scheduler_lock, voice_lock)) {
-                    finished = true;
-                    finished_module = voice->rack->modules[i]->module_id();
-                }
-            }
-        }
-        if (finished) {
-            voice->is_keyed_off = true;
-            voice->transition(mem, VOICE_STATE_FINALIZING);
-            if (voice->finished_callback) {
-                voice_lock.unlock();
-                scheduler_lock.unlock();
-                voice->invoke_callback(kern, mem, thread_id, voice->finished_callback, voice->finished_callback_user_data, finished_module);
-                scheduler_lock.lock();
-                voice_lock.lock();
-            }
-            voice->is_keyed_off = false;
-
-            stop(mem, voice);
-        }
+            deliver_data(mem, voice);
 
-        for (size_t i = 0; i < voice->rack->vdef->output_count; i++) {
-            if (voice->products[i].data)
-                deliver_data(mem, queue_copy, voice, static_cast<uint8_t>(i), voice->products[i]);
+            voice->frame_count++;
         }
-
-        voice->frame_count++;
     }
 
     while (!operations_pending.empty()) {
@@ -189,6 +206,104 @@ void VoiceScheduler::update(KernelState &kern, const MemState &mem, const SceUID
     condvar.notify_all();
 }
 
+void VoiceScheduler::update_levels(KernelState &kern, const MemState &mem, const SceUID thread_id, const std::vector<Voice *> &queue_copy,
+    std::unique_lock<std::recursive_mutex> &scheduler_lock) {
+    // A voice depends on the voices patched to it, which come before it in the queue. Its level is one more
+    // than the highest level of these voices, so the voices of a level do not depend on each other.
+    // Each voice also records where its inputs come from, in queue order: it mixes them itself
+    // once its level is processed, which sums them in the same order as the serial update.
+    scheduled.resize(queue_copy.size());
+    for (auto &level : levels)
+        level.clear();
+
+    for (size_t i = 0; i < queue_copy.size(); i++) {
+        scheduled[i].voice = queue_copy[i];
+        scheduled[i].sources.clear();
+        queue_copy[i]->schedule_level = 0;
+    }
+
+    for (size_t i = 0; i < queue_copy.size(); i++) {
+        Voice *voice = queue_copy[i];
+        ScheduledVoice &current = scheduled[i];
+
+        // guest callbacks have to run on the thread updating the system
+        current.on_guest_thread = static_cast<bool>(voice->finished_callback);
+        for (const ModuleData &data : voice->datas)
+            current.on_guest_thread |= static_cast<bool>(data.callback);
+
+        for (uint32_t port = 0; port < voice->rack->vdef->output_count; port++) {
+            for (auto &patch_ptr : voice->patches[port]) {
+                Patch *patch = patch_ptr.get(mem);
+                if (!patch || !patch->is_active())
+                    continue;
+
+                Voice *dest = patch->dest.get(mem);
+                if (!dest || !dest->is_scheduled_after(*voice))
+                    continue;
+
+                dest->schedule_level = std::max(dest->schedule_level, voice->schedule_level + 1);
+                scheduled[dest->schedule_position].sources.push_back({ voice, patch, port });
+            }
+        }
+
+        if (levels.size() <= voice->schedule_level)
+            levels.resize(voice->schedule_level + 1);
+        levels[voice->schedule_level].push_back(static_cast<uint32_t>(i));
+    }
+
+    const auto process = [&](ScheduledVoice &current, std::unique_lock<std::recursive_mutex> &lock) {
+        std::unique_lock<std::mutex> voice_lock(*current.voice->voice_mutex);
+        for (const auto &source : current.sources) {
+            if (source.patch->is_active() && source.voice->products[source.port].data)
+                current.voice->inputs.receive(mem, source.patch, source.voice->products[source.port]);
+        }
+
+        current.finished = process_voice(kern, mem, thread_id, current.voice, current.finished_module, lock, voice_lock);
+    };
+
+    for (const auto &level : levels) {
+        if (level.empty())
+            continue;
+
+        uint32_t worker_voices = 0;
+        for (const uint32_t position : level) {
+            if (scheduled[position].on_guest_thread)
+                process(scheduled[position], scheduler_lock);
+            else
+                worker_voices++;
+        }
+
+        const auto process_on_worker = [&](const uint32_t index) {
+            ScheduledVoice &current = scheduled[level[index]];
+            if (current.on_guest_thread)
+                return;
+
+            // modules only give the scheduler lock up to run guest callbacks, which these voices do not have,
+            // the updating thread holds the real one until the whole level is done
+            std::recursive_mutex unused;
+            std::unique_lock<std::recursive_mutex> lock(unused);
+            process(current, lock);
+        };
+
+        // waking the workers costs more than processing a few voices
+        if (worker_voices >= MIN_VOICES_PER_JOB) {
+            workers->run(static_cast<uint32_t>(level.size()), process_on_worker);
+        } else {
+            for (uint32_t i = 0; i < level.size(); i++)
+                process_on_worker(i);
+        }
+
+        for (const uint32_t position : level) {
+            ScheduledVoice &current = scheduled[position];
+            if (current.finished) {
+                std::unique_lock<std::mutex> voice_lock(*current.voice->voice_mutex);
+                finish_voice(kern, mem, thread_id, current.voice, current.finished_module, scheduler_lock, voice_lock);
+            }
+            current.voice->frame_count++;
+        }
+    }
+}
+
 int32_t VoiceScheduler::get_position(Voice *v) {
     // we assume the scheduler lock is being held when calling this function
     return vector_utils::find_index(queue, v);
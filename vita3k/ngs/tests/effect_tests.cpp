@@ -0,0 +1,246 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "rack_renderer.h"
+
+#include <ngs/modules/compressor.h>
+#include <ngs/modules/delay.h>
+#include <ngs/modules/equalizer.h>
+#include <ngs/modules/filter.h>
+#include <ngs/modules/pitchshift.h>
+#include <ngs/modules/reverb.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static RackRenderer::Generator impulse(const float amplitude) {
+    return [=](float *output, const uint32_t frames, const uint64_t start_frame) {
+        std::fill_n(output, frames * 2, 0.0f);
+        if (start_frame == 0)
+            output[0] = output[1] = amplitude;
+    };
+}
+
+// RMS of the left channel from first_frame to last_frame, with samples in [-1, 1]
+static double rms(const std::vector<int16_t> &samples, const size_t first_frame, const size_t last_frame) {
+    double sum = 0.0;
+    for (size_t i = first_frame; i < last_frame; i++) {
+        const double value = samples[i * 2] / 32768.0;
+        sum += value * value;
+    }
+    return std::sqrt(sum / (last_frame - first_frame));
+}
+
+// Set NGS_TESTS_WAV_DIR to listen to what the tests render
+static void save_wav(const RackRenderer &renderer, const std::string &name) {
+    const char *dir = std::getenv("NGS_TESTS_WAV_DIR");
+    if (!dir)
+        return;
+
+    const std::vector<uint8_t> data = renderer.wav();
+    std::ofstream(std::string(dir) + "/" + name + ".wav", std::ios::binary).write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+TEST(ngs_effects, wav_header_matches_rendered_samples) {
+    RackRenderer renderer;
+    ngs::Voice *voice = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_MIXER, 1, sine(440, 0.5f)), 0);
+    renderer.patch(voice, 0, renderer.master);
+    renderer.play(voice);
+    renderer.render(48000);
+
+    const std::vector<uint8_t> wav = renderer.wav();
+    ASSERT_EQ(wav.size(), 44 + renderer.samples().size() * sizeof(int16_t));
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(wav.data()), 4), "RIFF");
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(wav.data() + 8), 4), "WAVE");
+    EXPECT_NEAR(rms(renderer.samples(), 0, 48000), 0.5 / std::sqrt(2.0), 0.01);
+}
+
+TEST(ngs_effects, lowpass_filter_removes_high_frequencies) {
+    RackRenderer renderer;
+    ngs::Voice *voice = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_SIMPLE, 1, sine(8000, 0.5f)), 0);
+    auto *params = renderer.set_params<SceNgsFilterParams>(voice, SIMPLE_SEND_1_FILTER, SCE_NGS_FILTER_PARAMS_STRUCT_ID);
+    params->params = { SCE_NGS_FILTER_LOWPASS_RESONANT, 500.0f, 0.707f, 1.0f };
+    renderer.patch(voice, 0, renderer.master);
+    renderer.play(voice);
+    renderer.render(48000);
+    save_wav(renderer, "lowpass_filter");
+
+    // 4 octaves above the cutoff of a 12 dB/octave filter
+    EXPECT_LT(rms(renderer.samples(), 4800, 48000), 0.5 / std::sqrt(2.0) * 0.01);
+}
+
+TEST(ngs_effects, equalizer_boosts_its_band) {
+    RackRenderer renderer;
+    ngs::Voice *voice = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_SIMPLE, 1, sine(1000, 0.25f)), 0);
+    auto *params = renderer.set_params<SceNgsParamEqParams>(voice, SIMPLE_EQUALIZER, SCE_NGS_PARAM_EQ_STRUCT_ID);
+    params->filter[0] = { SCE_NGS_FILTER_PEAK, 1000.0f, 1.0f, 2.0f };
+    renderer.patch(voice, 0, renderer.master);
+    renderer.play(voice);
+    renderer.render(48000);
+
+    EXPECT_NEAR(rms(renderer.samples(), 4800, 48000), 0.5 / std::sqrt(2.0), 0.01);
+}
+
+TEST(ngs_effects, delay_repeats_the_input) {
+    RackRenderer renderer;
+    ngs::Voice *source = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_MIXER, 1, impulse(0.5f)), 0);
+    ngs::Voice *delay = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_DELAY, 1), 0);
+    auto *params = renderer.set_params<SceNgsDelayParams>(delay, EFFECT_MODULE, SCE_NGS_DELAY_PARAMS_STRUCT_ID);
+    params->fDryVol = 1.0f;
+    params->taps[0].fDelayMillisecs = 100.0f;
+    params->taps[0].fVolume = 1.0f;
+    params->taps[0].fFeedback = 0.5f;
+    renderer.patch(source, 0, delay);
+    renderer.patch(delay, 0, renderer.master);
+    // a voice is scheduled before the voices it outputs to, so the busses have to be played first
+    renderer.play(delay);
+    renderer.play(source);
+    renderer.render(24000);
+    save_wav(renderer, "delay");
+
+    const std::vector<int16_t> &samples = renderer.samples();
+    EXPECT_EQ(samples[0], 16384);
+    // each repeat is half as loud as the previous one
+    EXPECT_EQ(samples[4800 * 2], 16384);
+    EXPECT_EQ(samples[9600 * 2], 8192);
+    EXPECT_EQ(samples[14400 * 2], 4096);
+    EXPECT_EQ(samples[4799 * 2], 0);
+    EXPECT_EQ(samples[4801 * 2], 0);
+}
+
+TEST(ngs_effects, reverb_adds_a_decaying_tail) {
+    RackRenderer renderer;
+    ngs::Voice *source = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_MIXER, 1, impulse(1.0f)), 0);
+    ngs::Voice *reverb = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_REVERB, 1), 0);
+    auto *params = renderer.set_params<SceNgsReverbParams>(reverb, EFFECT_MODULE, SCE_NGS_REVERB_PARAMS_STRUCT_ID_V2);
+    params->fRoom = 0.0f;
+    params->fDecayTime = 1.5f;
+    params->fDecayHFRatio = 0.8f;
+    params->fReflections = -1000.0f;
+    params->fReflectionsDelay = 0.01f;
+    params->fReverb = 0.0f;
+    params->fReverbDelay = 0.02f;
+    params->fDiffusion = 100.0f;
+    params->fDensity = 100.0f;
+    params->fHFReference = 5000.0f;
+    params->fLFReference = 250.0f;
+    params->eEarlyReflectionPattern[0] = SCE_NGS_REVERB_ROOM2_LEFT;
+    params->eEarlyReflectionPattern[1] = SCE_NGS_REVERB_ROOM2_RIGHT;
+    params->fEarlyReflectionScalar = 1.0f;
+    params->fDryMB = -10000.0f;
+    renderer.patch(source, 0, reverb);
+    renderer.patch(reverb, 0, renderer.master);
+    renderer.play(reverb);
+    renderer.play(source);
+    renderer.render(3 * 48000);
+    save_wav(renderer, "reverb");
+
+    const std::vector<int16_t> &samples = renderer.samples();
+    // no dry sound, nothing before the first reflection
+    EXPECT_EQ(samples[0], 0);
+    const double early = rms(samples, 0, 24000);
+    const double middle = rms(samples, 24000, 48000);
+    const double late = rms(samples, 48000 * 2, 48000 * 3);
+    EXPECT_GT(early, 0.0);
+    EXPECT_GT(middle, 0.0);
+    EXPECT_LT(middle, early);
+    // 60 dB in 1.5 s
+    EXPECT_LT(late, middle * 0.01);
+}
+
+TEST(ngs_effects, compressor_reduces_loud_input) {
+    RackRenderer renderer;
+    ngs::Voice *source = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_MIXER, 1, sine(200, 0.8f)), 0);
+    ngs::Voice *compressor = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_COMPRESSOR, 1), 0);
+    auto *params = renderer.set_params<SceNgsCompressorParams>(compressor, EFFECT_MODULE, SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID);
+    params->fRatio = 10.0f;
+    params->fThreshold = 0.1f;
+    params->fAttack = 1.0f;
+    params->fRelease = 100.0f;
+    params->fMakeupGain = 1.0f;
+    params->nPeakMode = SCE_NGS_COMPRESSOR_PEAK_MODE;
+    params->nStereoLink = SCE_NGS_COMPRESSOR_STEREO_LINK_ON;
+    renderer.patch(source, 0, compressor);
+    renderer.patch(compressor, 0, renderer.master);
+    renderer.play(compressor);
+    renderer.play(source);
+    renderer.render(48000);
+
+    // 18 dB over the threshold at a 10:1 ratio leaves about 1.8 dB
+    const double output = rms(renderer.samples(), 24000, 48000) * std::sqrt(2.0);
+    EXPECT_GT(output, 0.1);
+    EXPECT_LT(output, 0.2);
+
+    const auto *state = compressor->datas[EFFECT_MODULE].get_state<SceNgsCompressorStates>();
+    EXPECT_GT(state->fInputLevel[0], 0.5f);
+    EXPECT_LT(state->fOutputLevel[0], 0.2f);
+}
+
+TEST(ngs_effects, pitch_shift_raises_frequency_by_an_octave) {
+    RackRenderer renderer;
+    ngs::Voice *source = renderer.voice(renderer.create_source_rack(ngs::BussType::BUSS_MIXER, 1, sine(500, 0.5f)), 0);
+    ngs::Voice *shift = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_PITCH_SHIFT, 1), 0);
+    renderer.set_params<SceNgsPitchShiftParams>(shift, EFFECT_MODULE, SCE_NGS_PITCHSHIFT_PARAMS_STRUCT_ID)->fPitchOffsetInCents = 1200.0f;
+    renderer.patch(source, 0, shift);
+    renderer.patch(shift, 0, renderer.master);
+    renderer.play(shift);
+    renderer.play(source);
+    renderer.render(48000);
+    save_wav(renderer, "pitch_shift");
+
+    const std::vector<int16_t> &samples = renderer.samples();
+    uint32_t crossings = 0;
+    for (size_t i = 4800; i < 48000; i++)
+        crossings += (samples[(i - 1) * 2] < 0) != (samples[i * 2] < 0);
+
+    // 1 kHz over 0.9 s
+    EXPECT_NEAR(crossings, 1800, 180);
+}
+
+// voices with an equalizer and two send filters, each frequency gets a rack of voice_count voices,
+// all mixed into a reverb and a compressor buss
+// the time it takes is measured by BM_EffectRack in ngs-bench
+TEST(ngs_effects, rack_of_64_voices_with_effects_renders) {
+    RackRenderer renderer;
+    create_effect_mix(renderer, { 440 }, 64);
+
+    renderer.render(10 * 48000);
+    save_wav(renderer, "rack_64_voices");
+
+    EXPECT_GT(rms(renderer.samples(), 48000, 10 * 48000), 0.0);
+}
+
+TEST(ngs_scheduler, parallel_update_matches_serial_update) {
+    // the voices sound different so that mixing them in another order would change the result
+    const std::vector<int32_t> frequencies = { 110, 220, 330, 440, 550, 660, 770, 880 };
+    RackRenderer serial(512, 48000, 0);
+    RackRenderer parallel(512, 48000, 3);
+    create_effect_mix(serial, frequencies, 8);
+    create_effect_mix(parallel, frequencies, 8);
+
+    serial.render(2 * 48000);
+    parallel.render(2 * 48000);
+
+    ASSERT_GT(rms(serial.samples(), 0, 2 * 48000), 0.0);
+    EXPECT_EQ(serial.samples(), parallel.samples());
+}
@@ -0,0 +1,107 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "rack_renderer.h"
+
+#include <ngs/dsp.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+static constexpr uint32_t GRANULARITY = 512;
+
+// the mixing loop used before the kernels, clamping after every patch
+static void mix_clamp_scalar(float *output, const float *input, const float (&matrix)[2][2], const uint32_t frames) {
+    for (uint32_t k = 0; k < frames; k++) {
+        output[k * 2] = std::clamp(output[k * 2] + input[k * 2] * matrix[0][0] + input[k * 2 + 1] * matrix[1][0], -1.0f, 1.0f);
+        output[k * 2 + 1] = std::clamp(output[k * 2 + 1] + input[k * 2] * matrix[0][1] + input[k * 2 + 1] * matrix[1][1], -1.0f, 1.0f);
+    }
+}
+
+static void BM_MixScalar(benchmark::State &state) {
+    const float matrix[2][2] = { { 0.7f, 0.1f }, { 0.1f, 0.7f } };
+    const std::vector<float> input(GRANULARITY * 2, 0.01f);
+    std::vector<float> output(GRANULARITY * 2);
+    for (auto _ : state) {
+        mix_clamp_scalar(output.data(), input.data(), matrix, GRANULARITY);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * GRANULARITY);
+}
+
+static void BM_MixMatrix(benchmark::State &state) {
+    // the second matrix only has a gain per channel, which takes the fast path
+    const float matrix[2][2] = { { 0.7f, state.range(0) ? 0.1f : 0.0f }, { state.range(0) ? 0.1f : 0.0f, 0.7f } };
+    const std::vector<float> input(GRANULARITY * 2, 0.01f);
+    std::vector<float> output(GRANULARITY * 2);
+    for (auto _ : state) {
+        ngs::dsp::mix_matrix(output.data(), input.data(), matrix, GRANULARITY);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * GRANULARITY);
+}
+
+// Hundreds of voices, each patched to one of 4 busses and sending to the first one, as a game routing
+// its sounds into music, effects and voice busses with a shared send would
+static void BM_PatchMixing(benchmark::State &state) {
+    static constexpr int32_t BUSS_COUNT = 4;
+    const int32_t voice_count = static_cast<int32_t>(state.range(0));
+
+    RackRenderer renderer(GRANULARITY);
+    ngs::Rack *busses = renderer.create_rack(ngs::BussType::BUSS_MIXER, BUSS_COUNT);
+    for (int32_t i = 0; i < BUSS_COUNT; i++) {
+        renderer.play(renderer.voice(busses, i));
+        renderer.patch(renderer.voice(busses, i), 0, renderer.master, 0.25f);
+    }
+
+    ngs::Rack *sources = renderer.create_source_rack(ngs::BussType::BUSS_MIXER, voice_count, [](float *output, uint32_t frames, uint64_t) {
+        std::fill_n(output, frames * 2, 0.01f);
+    });
+    for (int32_t i = 0; i < voice_count; i++) {
+        ngs::Voice *voice = renderer.voice(sources, i);
+        // panned a little to the left
+        ngs::Patch *patch = renderer.patch(voice, 0, renderer.voice(busses, i % BUSS_COUNT), 0.8f);
+        patch->volume_matrix[1][0] = 0.2f;
+        renderer.patch(voice, 0, renderer.voice(busses, 0), 0.2f);
+        renderer.play(voice);
+    }
+
+    for (auto _ : state)
+        renderer.system->voice_scheduler.update(renderer.kernel, renderer.mem, 0);
+    state.SetItemsProcessed(state.iterations() * voice_count * GRANULARITY);
+}
+
+// 64 voices with an equalizer and two send filters each, mixed into a reverb and a compressor buss.
+// load is the share of one core the update takes to keep up with the audio, the goal is under 5%
+static void BM_EffectRack(benchmark::State &state) {
+    RackRenderer renderer(GRANULARITY);
+    create_effect_mix(renderer, { 440 }, 64);
+
+    for (auto _ : state)
+        renderer.system->voice_scheduler.update(renderer.kernel, renderer.mem, 0);
+    const double rendered_seconds = static_cast<double>(state.iterations()) * GRANULARITY / renderer.sample_rate;
+    state.counters["load"] = benchmark::Counter(rendered_seconds, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_MixScalar);
+BENCHMARK(BM_MixMatrix)->Arg(0)->Arg(1);
+BENCHMARK(BM_PatchMixing)->Arg(128)->Arg(256)->Arg(512);
+BENCHMARK(BM_EffectRack);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,238 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "rack_renderer.h"
+
+#include <mem/functions.h>
+#include <ngs/modules/compressor.h>
+#include <ngs/modules/equalizer.h>
+#include <ngs/modules/filter.h>
+#include <ngs/modules/output.h>
+#include <ngs/modules/reverb.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+
+class SignalModule : public ngs::Module {
+public:
+    explicit SignalModule(RackRenderer::Generator generator)
+        : generator(std::move(generator)) {}
+
+    bool process(KernelState &kern, const MemState &mem, const SceUID thread_id, ngs::ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) override {
+        const int32_t granularity = data.parent->rack->system->granularity;
+        data.ensure_scratch_size(static_cast<size_t>(granularity) * sizeof(float) * 2);
+        generator(reinterpret_cast<float *>(data.scratch_data.data()), granularity, static_cast<uint64_t>(data.parent->frame_count) * granularity);
+        data.parent->products[0].data = data.scratch_data.data();
+        return false;
+    }
+
+    uint32_t get_buffer_parameter_size() const override { return 0; }
+
+private:
+    RackRenderer::Generator generator;
+};
+
+} // namespace
+
+RackRenderer::RackRenderer(const int32_t granularity, const int32_t sample_rate, const uint32_t worker_count)
+    : granularity(granularity)
+    , sample_rate(sample_rate) {
+    if (!init(mem, false) || !ngs::init(ngs, mem, worker_count))
+        throw std::runtime_error("Failed to initialize the guest memory");
+
+    SceNgsSystemInitParams params = { 16, 1024, granularity, sample_rate, 0 };
+    const uint32_t size = ngs::System::get_required_memspace_size(&params);
+    const Ptr<void> memspace(alloc(mem, size, "ngs system"));
+    if (!ngs::init_system(ngs, mem, &params, memspace, size))
+        throw std::runtime_error("Failed to initialize the NGS system");
+    system = memspace.cast<ngs::System>().get(mem);
+
+    master = voice(create_rack(ngs::BussType::BUSS_MASTER, 1), 0);
+    play(master);
+}
+
+RackRenderer::~RackRenderer() {
+    ngs::deinit(ngs, mem);
+    deinit_mem(mem);
+}
+
+ngs::Rack *RackRenderer::create_rack(const ngs::BussType type, const int32_t voice_count) {
+    SceNgsRackDescription description = {};
+    description.definition = ngs::get_voice_definition(ngs, mem, type);
+    description.voice_count = voice_count;
+    description.channels_per_voice = 2;
+    description.max_patches_per_input = 64;
+    description.patches_per_output = 4;
+
+    SceNgsBufferInfo info;
+    info.size = ngs::Rack::get_required_memspace_size(mem, &description);
+    info.data = Ptr<void>(alloc(mem, info.size, "ngs rack"));
+    if (!info.data || !ngs::init_rack(ngs, mem, system, &info, &description))
+        throw std::runtime_error("Failed to initialize the NGS rack");
+
+    return info.data.cast<ngs::Rack>().get(mem);
+}
+
+ngs::Rack *RackRenderer::create_source_rack(const ngs::BussType type, const int32_t voice_count, const Generator &generator) {
+    ngs::Rack *rack = create_rack(type, voice_count);
+    rack->modules[0] = std::make_unique<SignalModule>(generator);
+    return rack;
+}
+
+ngs::Voice *RackRenderer::voice(ngs::Rack *rack, const int32_t index) {
+    return rack->voices[index].get(mem);
+}
+
+void RackRenderer::play(ngs::Voice *voice) {
+    system->voice_scheduler.play(mem, voice);
+}
+
+ngs::Patch *RackRenderer::patch(ngs::Voice *source, const int32_t output, ngs::Voice *dest, const float volume) {
+    SceNgsPatchSetupInfo info = {};
+    info.source = Ptr<ngs::Voice>(source, mem);
+    info.source_output_index = output;
+    info.source_output_subindex = -1;
+    info.dest = Ptr<ngs::Voice>(dest, mem);
+    info.dest_input_index = 0;
+
+    const Ptr<ngs::Patch> patch = system->voice_scheduler.patch(mem, &info);
+    if (!patch)
+        throw std::runtime_error("Failed to patch the voices");
+
+    ngs::Patch *patch_data = patch.get(mem);
+    patch_data->volume_matrix[0][0] = volume;
+    patch_data->volume_matrix[1][1] = volume;
+    return patch_data;
+}
+
+void RackRenderer::render(const uint32_t frames) {
+    // the output module of the master buss
+    const ngs::ModuleData &master_output = master->datas[1];
+
+    for (uint32_t rendered = 0; rendered < frames; rendered += granularity) {
+        system->voice_scheduler.update(kernel, mem, 0);
+
+        const auto *samples = reinterpret_cast<const int16_t *>(master_output.guest_state_data.data());
+        output.insert(output.end(), samples, samples + granularity * 2);
+    }
+}
+
+std::vector<uint8_t> RackRenderer::wav() const {
+    const uint32_t data_size = static_cast<uint32_t>(output.size() * sizeof(int16_t));
+    std::vector<uint8_t> file(44 + data_size);
+    uint8_t *ptr = file.data();
+
+    const auto write_tag = [&](const char *tag) {
+        std::memcpy(ptr, tag, 4);
+        ptr += 4;
+    };
+    const auto write_u32 = [&](const uint32_t value) {
+        for (int i = 0; i < 4; i++)
+            *ptr++ = static_cast<uint8_t>(value >> (i * 8));
+    };
+    const auto write_u16 = [&](const uint16_t value) {
+        *ptr++ = static_cast<uint8_t>(value);
+        *ptr++ = static_cast<uint8_t>(value >> 8);
+    };
+
+    write_tag("RIFF");
+    write_u32(36 + data_size);
+    write_tag("WAVE");
+    write_tag("fmt ");
+    write_u32(16);
+    write_u16(1); // PCM
+    write_u16(2);
+    write_u32(sample_rate);
+    write_u32(sample_rate * 2 * sizeof(int16_t));
+    write_u16(2 * sizeof(int16_t));
+    write_u16(16);
+    write_tag("data");
+    write_u32(data_size);
+    for (const int16_t sample : output)
+        write_u16(static_cast<uint16_t>(sample));
+
+    return file;
+}
+
+RackRenderer::Generator sine(const int32_t frequency, const float amplitude, const int32_t sample_rate) {
+    auto second = std::make_shared<std::vector<float>>(sample_rate);
+    for (int32_t i = 0; i < sample_rate; i++)
+        (*second)[i] = amplitude * static_cast<float>(std::sin(2.0 * std::numbers::pi * frequency * i / sample_rate));
+
+    return [=](float *output, const uint32_t frames, const uint64_t start_frame) {
+        uint32_t position = static_cast<uint32_t>(start_frame % sample_rate);
+        for (uint32_t i = 0; i < frames;) {
+            const uint32_t run = std::min(frames - i, static_cast<uint32_t>(sample_rate) - position);
+            const float *samples = second->data() + position;
+            for (uint32_t j = 0; j < run; j++)
+                output[(i + j) * 2] = output[(i + j) * 2 + 1] = samples[j];
+            i += run;
+            position = 0;
+        }
+    };
+}
+
+void create_effect_mix(RackRenderer &renderer, const std::vector<int32_t> &frequencies, const int32_t voice_count) {
+    ngs::Voice *reverb = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_REVERB, 1), 0);
+    ngs::Voice *compressor = renderer.voice(renderer.create_rack(ngs::BussType::BUSS_COMPRESSOR, 1), 0);
+
+    auto *reverb_params = renderer.set_params<SceNgsReverbParams>(reverb, EFFECT_MODULE, SCE_NGS_REVERB_PARAMS_STRUCT_ID_V2);
+    reverb_params->fDecayTime = 2.0f;
+    reverb_params->fDecayHFRatio = 0.5f;
+    reverb_params->fReflectionsDelay = 0.02f;
+    reverb_params->fReverbDelay = 0.04f;
+    reverb_params->fDiffusion = 100.0f;
+    reverb_params->fDensity = 100.0f;
+    reverb_params->fHFReference = 5000.0f;
+    reverb_params->fLFReference = 250.0f;
+    reverb_params->fEarlyReflectionScalar = 1.0f;
+    auto *compressor_params = renderer.set_params<SceNgsCompressorParams>(compressor, EFFECT_MODULE, SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID);
+    compressor_params->fRatio = 4.0f;
+    compressor_params->fThreshold = 0.5f;
+    compressor_params->fAttack = 5.0f;
+    compressor_params->fRelease = 100.0f;
+    compressor_params->fMakeupGain = 1.0f;
+
+    renderer.patch(reverb, 0, renderer.master);
+    renderer.patch(compressor, 0, renderer.master);
+    renderer.play(reverb);
+    renderer.play(compressor);
+
+    for (const int32_t frequency : frequencies) {
+        ngs::Rack *voices = renderer.create_source_rack(ngs::BussType::BUSS_SIMPLE, voice_count, sine(frequency, 0.01f));
+        for (int32_t i = 0; i < voice_count; i++) {
+            ngs::Voice *voice = renderer.voice(voices, i);
+            auto *eq = renderer.set_params<SceNgsParamEqParams>(voice, SIMPLE_EQUALIZER, SCE_NGS_PARAM_EQ_STRUCT_ID);
+            eq->filter[0] = { SCE_NGS_FILTER_LOWSHELF, 200.0f, 0.707f, 1.5f };
+            eq->filter[1] = { SCE_NGS_FILTER_PEAK, 1000.0f, 1.0f, 0.8f };
+            eq->filter[2] = { SCE_NGS_FILTER_PEAK, 4000.0f, 1.0f, 1.2f };
+            eq->filter[3] = { SCE_NGS_FILTER_HIGHSHELF, 8000.0f, 0.707f, 0.7f };
+            for (uint32_t send = 0; send < 2; send++) {
+                auto *filter = renderer.set_params<SceNgsFilterParams>(voice, SIMPLE_SEND_1_FILTER + send, SCE_NGS_FILTER_PARAMS_STRUCT_ID);
+                filter->params = { SCE_NGS_FILTER_LOWPASS_RESONANT, 6000.0f + send * 2000.0f, 0.707f, 1.0f };
+            }
+            renderer.patch(voice, 0, compressor);
+            renderer.patch(voice, 1, reverb, 0.5f);
+            renderer.play(voice);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <kernel/state.h>
+#include <mem/state.h>
+#include <ngs/state.h>
+#include <ngs/system.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Renders NGS racks offline, without a guest thread or an audio device
+ *
+ * The sound comes from source voices whose first module is replaced by a generator callback,
+ * and goes out of a master voice as signed 16-bit stereo, which can be saved as a WAV file.
+ */
+class RackRenderer {
+public:
+    // Fills frames interleaved stereo frames, start_frame is the position of the first one since the voice started
+    using Generator = std::function<void(float *output, uint32_t frames, uint64_t start_frame)>;
+
+    // worker_count is the size of the pool processing the voices in parallel, 0 for a serial update
+    explicit RackRenderer(int32_t granularity = 512, int32_t sample_rate = 48000, uint32_t worker_count = 0);
+    ~RackRenderer();
+
+    ngs::Rack *create_rack(ngs::BussType type, int32_t voice_count);
+    // The player (or input mixer) of the voices of this rack is replaced by the generator
+    ngs::Rack *create_source_rack(ngs::BussType type, int32_t voice_count, const Generator &generator);
+    ngs::Voice *voice(ngs::Rack *rack, int32_t index);
+
+    // Returns the zeroed parameters of a module of the voice, with their descriptor filled
+    template <typename T>
+    T *set_params(ngs::Voice *voice, uint32_t module, uint32_t id) {
+        T *params = voice->datas[module].info.data.template cast<T>().get(mem);
+        std::memset(params, 0, sizeof(T));
+        params->desc.id = id;
+        params->desc.size = sizeof(T);
+        return params;
+    }
+
+    void play(ngs::Voice *voice);
+    ngs::Patch *patch(ngs::Voice *source, int32_t output, ngs::Voice *dest, float volume = 1.0f);
+
+    // Updates the system until at least frames frames have been output by the master voice
+    void render(uint32_t frames);
+
+    const std::vector<int16_t> &samples() const { return output; }
+    std::vector<uint8_t> wav() const;
+
+    int32_t granularity;
+    int32_t sample_rate;
+
+    MemState mem;
+    KernelState kernel;
+    ngs::State ngs;
+    ngs::System *system = nullptr;
+    ngs::Voice *master = nullptr;
+
+private:
+    std::vector<int16_t> output;
+};
+
+// modules of the BUSS_SIMPLE voices
+static constexpr uint32_t SIMPLE_EQUALIZER = 1;
+static constexpr uint32_t SIMPLE_SEND_1_FILTER = 4;
+// the effect of the single effect busses
+static constexpr uint32_t EFFECT_MODULE = 1;
+
+// frequency must be a whole number of Hz, one second of the sine is computed ahead so that the generator costs next to nothing
+RackRenderer::Generator sine(int32_t frequency, float amplitude, int32_t sample_rate = 48000);
+
+// voice_count voices per frequency, each with an equalizer and both send filters set,
+// sending to a compressor buss and a reverb buss like the sounds of a game would
+void create_effect_mix(RackRenderer &renderer, const std::vector<int32_t> &frequencies, int32_t voice_count);
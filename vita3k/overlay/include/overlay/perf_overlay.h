@@ -40,8 +40,8 @@ enum class screen_quadrant : uint8_t {
 enum class perf_detail_level : uint8_t {
     minimum = 0, // FPS only
     low, // FPS + ms/frame
-    medium, // FPS + ms/frame + min/max/avg
-    maximum // FPS + ms/frame + min/max/avg + graph
+    medium, // FPS + ms/frame + min/max/avg + commands/frame + texture bytes/frame + vblank intervals
+    maximum // FPS + ms/frame + min/max/avg + commands/frame + texture bytes/frame + vblank intervals + graph
 };
 
 struct perf_overlay : public overlay {
@@ -54,6 +54,9 @@ struct perf_overlay : public overlay {
         uint32_t max_fps, uint32_t ms_per_frame,
         const float *fps_values, uint32_t fps_values_count,
         uint32_t fps_offset);
+    void set_command_data(uint32_t commands_per_frame, uint32_t command_bytes_per_frame);
+    void set_texture_data(uint32_t texture_bytes_hashed_per_frame, uint32_t texture_bytes_uploaded_per_frame);
+    void set_vblank_data(float interval_mean, float interval_variance, float interval_max, uint32_t dropped);
 
     compiled_resource get_compiled() override;
 
@@ -75,6 +78,14 @@ private:
     uint32_t m_min_fps = 0;
     uint32_t m_max_fps = 0;
     uint32_t m_ms_per_frame = 0;
+    uint32_t m_commands_per_frame = 0;
+    uint32_t m_command_bytes_per_frame = 0;
+    uint32_t m_texture_bytes_hashed_per_frame = 0;
+    uint32_t m_texture_bytes_uploaded_per_frame = 0;
+    float m_vblank_interval_mean = 0;
+    float m_vblank_interval_variance = 0;
+    float m_vblank_interval_max = 0;
+    uint32_t m_vblanks_dropped = 0;
 
     bool m_force_repaint = true;
 
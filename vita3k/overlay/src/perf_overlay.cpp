@@ -84,6 +84,48 @@ void perf_overlay::set_fps_data(uint32_t fps, uint32_t avg_fps, uint32_t min_fps
     }
 }
 
+void perf_overlay::set_command_data(uint32_t commands_per_frame, uint32_t command_bytes_per_frame) {
+    if (m_commands_per_frame == commands_per_frame && m_command_bytes_per_frame == command_bytes_per_frame)
+        return;
+
+    m_commands_per_frame = commands_per_frame;
+    m_command_bytes_per_frame = command_bytes_per_frame;
+
+    if (m_detail >= perf_detail_level::medium) {
+        update_text();
+        reset_transforms();
+    }
+}
+
+void perf_overlay::set_texture_data(uint32_t texture_bytes_hashed_per_frame, uint32_t texture_bytes_uploaded_per_frame) {
+    if (m_texture_bytes_hashed_per_frame == texture_bytes_hashed_per_frame && m_texture_bytes_uploaded_per_frame == texture_bytes_uploaded_per_frame)
+        return;
+
+    m_texture_bytes_hashed_per_frame = texture_bytes_hashed_per_frame;
+    m_texture_bytes_uploaded_per_frame = texture_bytes_uploaded_per_frame;
+
+    if (m_detail >= perf_detail_level::medium) {
+        update_text();
+        reset_transforms();
+    }
+}
+
+void perf_overlay::set_vblank_data(float interval_mean, float interval_variance, float interval_max, uint32_t dropped) {
+    if (m_vblank_interval_mean == interval_mean && m_vblank_interval_variance == interval_variance
+        && m_vblank_interval_max == interval_max && m_vblanks_dropped == dropped)
+        return;
+
+    m_vblank_interval_mean = interval_mean;
+    m_vblank_interval_variance = interval_variance;
+    m_vblank_interval_max = interval_max;
+    m_vblanks_dropped = dropped;
+
+    if (m_detail >= perf_detail_level::medium) {
+        update_text();
+        reset_transforms();
+    }
+}
+
 void perf_overlay::update_text() {
     std::string text;
 
@@ -97,9 +139,15 @@ void perf_overlay::update_text() {
     case perf_detail_level::medium:
     case perf_detail_level::maximum:
         text = fmt::format("FPS: {} ({} ms)\n"
-                           "Avg: {}  Min: {}  Max: {}",
+                           "Avg: {}  Min: {}  Max: {}\n"
+                           "Cmds: {}/frame ({:.1f} KiB)\n"
+                           "Tex: {:.1f} KiB hashed, {:.1f} KiB uploaded/frame\n"
+                           "VBlank: {:.2f} +- {:.2f} ms (max {:.2f}), {} dropped",
             m_fps, m_ms_per_frame,
-            m_avg_fps, m_min_fps, m_max_fps);
+            m_avg_fps, m_min_fps, m_max_fps,
+            m_commands_per_frame, m_command_bytes_per_frame / 1024.0f,
+            m_texture_bytes_hashed_per_frame / 1024.0f, m_texture_bytes_uploaded_per_frame / 1024.0f,
+            m_vblank_interval_mean, std::sqrt(m_vblank_interval_variance), m_vblank_interval_max, m_vblanks_dropped);
         break;
     }
 
@@ -18,8 +18,12 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace renderer {
@@ -27,9 +31,12 @@ namespace renderer {
 #define REPORT_STUBBED() LOG_INFO("Stubbed")
 
 struct Command;
+struct CommandArenaChunk;
 
-using CommandAllocFunc = std::function<Command *()>;
-using CommandFreeFunc = std::function<void(Command *)>;
+// Allocates a command able to hold payload_size bytes of arguments
+using CommandAllocFunc = std::function<Command *(std::size_t payload_size)>;
+// Frees the commands from first to last (included), following Command::next
+using CommandFreeFunc = std::function<void(Command *first, Command *last)>;
 
 struct Context;
 struct State;
@@ -93,24 +100,65 @@ enum CommandErrorCode {
     CommandErrorArgumentsTooLarge = -2
 };
 
-constexpr std::size_t MAX_COMMAND_DATA_SIZE = 0x20;
-
-struct Command {
+// The arguments of a command are stored right after it
+struct alignas(8) Command {
     enum {
-        FLAG_FROM_HOST = 1 << 0,
-        FLAG_NO_FREE = 1 << 1
+        FLAG_NO_FREE = 1 << 0
     };
 
     CommandOpcode opcode;
     std::uint8_t flags = 0;
+    std::uint16_t size = 0; ///< Size of the arguments.
 
-    std::uint8_t data[MAX_COMMAND_DATA_SIZE];
     int *status;
 
     Command *next = nullptr;
+    CommandArenaChunk *chunk = nullptr; ///< Set if allocated from a CommandArena.
+
+    std::uint8_t *data() {
+        return reinterpret_cast<std::uint8_t *>(this + 1);
+    }
+
+    // Size of the command and its arguments
+    std::size_t total_size() const {
+        return (sizeof(Command) + size + alignof(Command) - 1) & ~(alignof(Command) - 1);
+    }
 };
 
-using CommandPool = std::vector<Command>;
+constexpr std::size_t MAX_COMMAND_DATA_SIZE = 0x1000;
+
+/**
+ * @brief Bump allocator for the commands of a context
+ *
+ * Commands are allocated one after the other in big chunks by the thread recording them, a chunk
+ * goes back to the free list at once when the render thread has consumed all its commands.
+ */
+class CommandArena {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+    static_assert(CHUNK_SIZE >= sizeof(Command) + MAX_COMMAND_DATA_SIZE);
+
+    CommandArena();
+    ~CommandArena();
+    CommandArena(const CommandArena &) = delete;
+    CommandArena &operator=(const CommandArena &) = delete;
+
+    // Must only be called by the thread recording the commands
+    Command *allocate(std::size_t payload_size);
+    // Can be called from any thread, commands not allocated by an arena are skipped
+    static void release(Command *first, Command *last);
+
+    std::size_t chunk_count() const;
+
+private:
+    void recycle(CommandArenaChunk *chunk);
+
+    CommandArenaChunk *current = nullptr;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<CommandArenaChunk>> chunks;
+    std::vector<CommandArenaChunk *> free_chunks;
+};
 
 // It's to split a command list easier when ExecuteCommandList is used.
 struct CommandList {
@@ -131,11 +179,11 @@ struct CommandHelper {
 
     template <typename T>
     bool push(T &val) {
-        if (point + sizeof(T) > MAX_COMMAND_DATA_SIZE) {
+        if (point + sizeof(T) > cmd->size) {
             return false;
         }
 
-        *(T *)(cmd->data + point) = val;
+        memcpy(cmd->data() + point, &val, sizeof(T));
         point += sizeof(T);
 
         return true;
@@ -143,15 +191,16 @@ struct CommandHelper {
 
     template <typename T>
     T pop() {
-        if (point + sizeof(T) > MAX_COMMAND_DATA_SIZE) {
+        if (point + sizeof(T) > cmd->size) {
             // Shouldn't happen
             assert(false);
         }
 
-        T *data = (T *)(cmd->data + point);
+        T data;
+        memcpy(&data, cmd->data() + point, sizeof(T));
         point += sizeof(T);
 
-        return *data;
+        return data;
     }
 
     void complete(const int code) {
@@ -173,18 +222,25 @@ bool do_command_push_data(CommandHelper &helper, Head arg1, Args... args2) {
 }
 
 template <typename... Args>
-Command *make_command(CommandAllocFunc alloc_func, CommandFreeFunc free_func, const CommandOpcode opcode, int *status, Args... arguments) {
-    Command *new_command = alloc_func();
+Command *make_command(const CommandAllocFunc &alloc_func, const CommandFreeFunc &free_func, const CommandOpcode opcode, int *status, Args... arguments) {
+    constexpr std::size_t payload_size = (std::size_t{ 0 } + ... + sizeof(Args));
+    static_assert(payload_size <= MAX_COMMAND_DATA_SIZE, "Command arguments are too large");
+
+    Command *new_command = alloc_func(payload_size);
+    if (!new_command) {
+        return nullptr;
+    }
 
     new_command->opcode = opcode;
     new_command->status = status;
     new_command->next = nullptr;
+    new_command->size = static_cast<std::uint16_t>(payload_size);
 
     CommandHelper helper(new_command);
 
     if constexpr (sizeof...(arguments) > 0) {
         if (!do_command_push_data(helper, arguments...)) {
-            free_func(new_command);
+            free_func(new_command, new_command);
             return nullptr;
         }
     }
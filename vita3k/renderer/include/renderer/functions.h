@@ -27,6 +27,7 @@ struct FeatureState;
 struct Config;
 struct DisplayState;
 struct GxmState;
+class WorkerPool;
 
 namespace renderer {
 struct Context;
@@ -92,7 +93,7 @@ void set_uniform_buffer(State &state, Context *ctx, const bool is_vertex_uniform
 void set_visibility_buffer(State &state, Context *ctx, Ptr<uint32_t> visibility_address, uint32_t visibility_stride);
 void set_visibility_index(State &state, Context *ctx, bool enable, uint32_t index, bool is_increment);
 
-void set_context(State &state, Context *ctx, RenderTarget *target, SceGxmColorSurface *color_surface, SceGxmDepthStencilSurface *depth_stencil_surface);
+void set_context(State &state, Context *ctx, RenderTarget *target, const SceGxmColorSurface *color_surface, const SceGxmDepthStencilSurface *depth_stencil_surface);
 void set_vertex_stream(State &state, Context *ctx, const std::size_t index, const std::size_t data_len, const Ptr<const void> stream);
 void draw(State &state, Context *ctx, SceGxmPrimitiveType prim_type, SceGxmIndexFormat index_type, Ptr<const void> index_data, const std::uint32_t index_count, const std::uint32_t instance_count);
 void transfer_copy(State &state, uint32_t colorKeyValue, uint32_t colorKeyMask, SceGxmTransferColorKeyMode colorKeyMode, const SceGxmTransferImage *images, SceGxmTransferType srcType, SceGxmTransferType destType);
@@ -107,9 +108,8 @@ bool create_render_target(State &state, std::unique_ptr<RenderTarget> &rt, const
 void destroy_render_target(State &state, std::unique_ptr<RenderTarget> &rt);
 void destroy_render_target_during_shutdown(State &state, std::unique_ptr<RenderTarget> &rt);
 
-Command *generic_command_allocate();
-void generic_command_free(Command *cmd);
-void destroy_command_payload(Command &cmd);
+Command *generic_command_allocate(std::size_t payload_size);
+void generic_command_free(Command *first, Command *last);
 
 template <typename... Args>
 bool add_command(Context *ctx, const CommandOpcode opcode, int *status, Args... arguments) {
@@ -204,10 +204,11 @@ void resolve_z_order_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest,
  * \param data   Source data to decompress.
  * \param width  Texture width.
  * \param height Texture height.
+ * \param pool   If not null, large images are split in stripes of rows decompressed in parallel by its workers.
  *
  * \return Size of source taken.
  */
-uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height);
+uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height, WorkerPool *pool = nullptr);
 
 /**
  * \brief Decompresses all the blocks of a block compressed texture and stores the resulting pixels in 'image'.
@@ -256,14 +257,9 @@ void convert_x8u24_to_u24x8(void *dest, const void *data, const uint32_t width,
 void convert_f32m_to_f32(void *dest, const void *data, const uint32_t width, const uint32_t height);
 void convert_u2f10f10f10_to_f16f16f16f16(void *dest, const void *data, const uint32_t width, const uint32_t height, const SceGxmTextureFormat format);
 
-void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel);
-void tiled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel);
 
 uint16_t get_upload_mip(const uint16_t true_mip, const uint16_t width, const uint16_t height);
 
-uint32_t decode_morton2_x(uint32_t code);
-uint32_t decode_morton2_y(uint32_t code);
-uint32_t encode_morton(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 bool can_texture_be_unswizzled_without_decode(SceGxmTextureBaseFormat fmt, bool is_vulkan);
 uint32_t get_compressed_size(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height);
 uint64_t hash_texture_data(const SceGxmTexture &texture, uint32_t texture_size, const MemState &mem);
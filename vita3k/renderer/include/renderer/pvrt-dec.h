@@ -44,6 +44,19 @@ namespace pvr {
 /// <returns>Return the amount of data that was decompressed.</returns>
 uint32_t PVRTDecompressPVRTC(const void *compressedData, uint32_t do2bitMode, uint32_t xDim, uint32_t yDim, uint32_t doPvrtType, uint8_t *outResultImage);
 
+/// <summary>Decompresses the rows of 4 pixels [firstWordRow, firstWordRow + wordRowCount) of a PVRTC texture to RGBA 8888.
+/// Disjoint ranges of rows can be decompressed at the same time. The image must be at least 16x8 (PVRTC2) or 8x8 (PVRTC4).</summary>
+/// <param name="compressedData">The PVRTC texture data to decompress</param>
+/// <param name="do2bitMode">Signifies whether the data is PVRTC2 or PVRTC4</param>
+/// <param name="xDim">X dimension of the texture</param>
+/// <param name="yDim">Y dimension of the texture</param>
+/// <param name="doPvrtType">Signifies whether the data is PVRTC-I or PVRTC-II</param>
+/// <param name="outResultImage">The decompressed texture data</param>
+/// <param name="firstWordRow">First row of words to decompress</param>
+/// <param name="wordRowCount">Number of rows of words to decompress</param>
+/// <returns>Return the amount of data that was decompressed.</returns>
+uint32_t PVRTDecompressPVRTCRows(const void *compressedData, uint32_t do2bitMode, uint32_t xDim, uint32_t yDim, uint32_t doPvrtType, uint8_t *outResultImage, uint32_t firstWordRow, uint32_t wordRowCount);
+
 /// <summary>Decompresses ETC to RGBA 8888.</summary>
 /// <param name="srcData">The ETC texture data to decompress</param>
 /// <param name="xDim">X dimension of the texture</param>
@@ -0,0 +1,86 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace renderer {
+
+/**
+ * @brief Append-only archive holding every translated shader of a game
+ *
+ * The archive is memory-mapped and indexed once when it is opened, a lookup is then a hash map access
+ * instead of a file open. New shaders are appended at the end of the file, a record cut short by a crash
+ * is dropped at the next open. Entries are keyed by the name the loose cache file had, e.g. "v13-<hash>.frag".
+ */
+class ShaderArchive {
+public:
+    static constexpr const char *FILE_NAME = "shaders.pack";
+
+    ShaderArchive() = default;
+    ~ShaderArchive();
+    ShaderArchive(const ShaderArchive &) = delete;
+    ShaderArchive &operator=(const ShaderArchive &) = delete;
+
+    // Maps and indexes the archive at path, a missing archive is created by the first add
+    void open(const fs::path &path);
+    // Must not be called while another thread uses the archive
+    void close();
+
+    bool is_open() const { return !path.empty(); }
+    const fs::path &get_path() const { return path; }
+
+    // Data stored under key, empty if there is none. The view stays valid until close.
+    std::string_view find(const std::string &key);
+    // Adds or replaces the data stored under key, nothing is written if it already holds this data
+    void add(const std::string &key, const void *data, size_t size);
+
+    size_t size();
+    // Time open took to map and index the archive
+    double load_time_ms() const { return load_ms; }
+
+private:
+    bool map_file();
+    void unmap_file();
+    // Indexes the mapped file, returns false if it ends with an invalid record
+    bool index_file();
+
+    fs::path path;
+    // lookups only take it shared, precompilation runs them from several threads
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, std::string_view> entries;
+    // data added since the archive was mapped
+    std::deque<std::string> added;
+    // size of the valid part of the file, a truncated record after it is overwritten by the next add
+    uint64_t valid_size = 0;
+    FILE *append_file = nullptr;
+
+    const uint8_t *mapping = nullptr;
+    size_t mapping_size = 0;
+    double load_ms = 0.0;
+};
+
+} // namespace renderer
@@ -32,15 +32,17 @@ struct FeatureState;
 
 namespace renderer {
 
+class ShaderArchive;
 struct ShadersHash;
 struct State;
 
 // Shaders.
 bool get_shaders_cache_hashs(State &renderer);
 void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders_cache_hashs);
-std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
-std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
-std::string pre_load_shader_glsl(const fs::path &shader_path);
-std::vector<uint32_t> pre_load_shader_spirv(const fs::path &shader_path);
+std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderArchive &archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
+std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, ShaderArchive &archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
+// Shaders from the archive (or from a loose file of an older cache), empty if there is none
+std::string pre_load_shader_glsl(ShaderArchive &archive, const std::string &shader_name);
+std::vector<uint32_t> pre_load_shader_spirv(ShaderArchive &archive, const std::string &shader_name);
 
 } // namespace renderer
@@ -20,8 +20,9 @@
 #include <features/state.h>
 #include <renderer/commands.h>
 #include <renderer/frame_host.h>
+#include <renderer/shader_archive.h>
 #include <renderer/types.h>
-#include <threads/queue.h>
+#include <threads/ring_queue.h>
 
 #include <array>
 #include <atomic>
@@ -66,6 +67,15 @@ struct PerformanceOverlayState {
     std::array<float, 20> fps_values = {};
     uint32_t fps_values_count = 0;
     uint32_t current_fps_offset = 0;
+    uint32_t commands_per_frame = 0;
+    uint32_t command_bytes_per_frame = 0;
+    uint32_t texture_bytes_hashed_per_frame = 0;
+    uint32_t texture_bytes_uploaded_per_frame = 0;
+    // intervals between vblanks, in ms
+    float vblank_interval_mean = 0;
+    float vblank_interval_variance = 0;
+    float vblank_interval_max = 0;
+    uint32_t vblanks_dropped = 0;
 };
 
 class TextureCache;
@@ -100,7 +110,11 @@ struct State {
     Context *context;
 
     GXPPtrMap gxp_ptr_map;
-    Queue<CommandList> command_buffer_queue;
+    // Command lists submitted by the guest GXM threads, consumed by the render thread
+    RingQueue<CommandList, 32> command_buffer_queue;
+    // Commands executed by the render thread since the performance metrics were last updated
+    std::atomic<uint64_t> command_count{ 0 };
+    std::atomic<uint64_t> command_bytes{ 0 };
     std::condition_variable command_finish_one;
     std::mutex command_finish_one_mutex;
 
@@ -109,12 +123,13 @@ struct State {
 
     std::vector<ShadersHash> shaders_cache_hashs;
     std::string shader_version;
+    ShaderArchive shader_archive;
 
     int last_scene_id = 0;
 
     // on Vulkan, this is actually the number of pipelines compiled
     uint32_t shaders_count_compiled = 0;
-    uint32_t programs_count_pre_compiled = 0;
+    std::atomic<uint32_t> programs_count_pre_compiled{ 0 };
 
     bool should_display;
 
@@ -214,6 +229,8 @@ struct State {
     virtual std::string_view get_gpu_name() = 0;
 
     virtual void precompile_shader(const ShadersHash &hash) = 0;
+    // Whether precompile_shader can be called from several threads at once
+    virtual bool can_precompile_in_parallel() { return false; }
     virtual void preclose_action() = 0;
 
     virtual ~State() = default;
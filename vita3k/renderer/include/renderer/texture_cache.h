@@ -18,13 +18,16 @@
 #pragma once
 
 #include <gxm/types.h>
+#include <renderer/texture_decode.h>
 #include <util/containers.h>
 #include <util/fs.h>
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace ddspp {
 struct Descriptor;
@@ -61,6 +64,13 @@ struct TextureCacheInfo {
     uint16_t height = 0;
     uint16_t mip_count = 0;
     SceGxmTextureBaseFormat format;
+    // texels being decompressed in the background, a blank image is bound until they are uploaded
+    std::shared_ptr<texture::DecodeJob> pending_decode;
+    // large hashed textures: hash of each 4 KiB page of the first mip, with use_protect only the pages written
+    // since write_generation (see watch_pages) are hashed again, pages_hash is the hash of all of them
+    std::vector<uint64_t> page_hashes;
+    uint64_t pages_hash = 0;
+    uint32_t write_generation = 0;
 };
 
 struct SamplerCacheInfo {
@@ -102,6 +112,13 @@ protected:
     bool save_as_png = true;
     bool export_textures = false;
 
+    // decompression of the textures the GPU cannot sample
+    texture::DecodeQueue decoder;
+
+    // set while only part of the current texture is uploaded, the backend must keep the rest of its content:
+    // when the mips decompressed in the background replace the blank ones, or when only the changed rows are uploaded
+    bool keep_texture_content = false;
+
 public:
     Backend backend;
     bool use_protect = false;
@@ -141,18 +158,27 @@ public:
     bool support_x8d24 = false;
     bool support_e5rgb9 = false;
     bool support_a2rgb10 = false;
+    // decompress the large textures the GPU cannot sample in the background instead of stalling the render thread
+    bool async_decoding = true;
+
+    // texture bytes hashed and uploaded since the performance metrics were last updated
+    std::atomic<uint64_t> bytes_hashed{ 0 };
+    std::atomic<uint64_t> bytes_uploaded{ 0 };
 
     bool init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id, const size_t sampler_cache_size = 0);
     void set_replacement_state(bool import_textures, bool export_textures, bool export_as_png);
 
     virtual void select(size_t index, const SceGxmTexture &texture) = 0;
     virtual void configure_texture(const SceGxmTexture &texture) = 0;
-    virtual void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) = 0;
+    // upload width x height texels starting at the row first_row of the mip
+    virtual void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride, uint32_t first_row) = 0;
     virtual void upload_done() {}
 
     virtual void configure_sampler(size_t index, const SceGxmTexture &texture, bool no_linear) {}
 
-    void upload_texture(const SceGxmTexture &gxm_texture, MemState &mem);
+    // if changed_end is not 0, only the rows of the first mip covering the bytes [changed_begin, changed_end) are uploaded,
+    // the texture must then be linear with a single mip
+    void upload_texture(const SceGxmTexture &gxm_texture, MemState &mem, uint32_t changed_begin = 0, uint32_t changed_end = 0);
     void cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemState &mem);
 
     // is called by cache_and_bind_texture if use_sampler_cache is set to true
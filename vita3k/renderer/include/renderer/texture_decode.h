@@ -0,0 +1,85 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <gxm/types.h>
+#include <threads/worker_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace renderer::texture {
+
+// One mip of one face of a texture decompressed in the background
+struct MipDecode {
+    SceGxmTextureBaseFormat base_format;
+    SceGxmTextureBaseFormat upload_format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_index;
+    int face;
+    // dimensions of the decompressed image
+    uint32_t pixels_per_stride;
+    uint32_t memory_height;
+    // compressed blocks, replaced by the decompressed texels once the job is done
+    std::vector<uint8_t> data;
+};
+
+struct DecodeJob {
+    std::vector<MipDecode> mips;
+    // set by the decode thread once all the mips are decompressed
+    std::atomic<bool> done{ false };
+    // set by the render thread if the texture changed in the meantime
+    std::atomic<bool> canceled{ false };
+};
+
+/**
+ * @brief Decompresses the block compressed textures the GPU cannot sample (BCn and PVRTC)
+ *
+ * Images are split in stripes of rows decompressed in parallel by a worker pool. Large textures can be
+ * submitted as jobs to a background thread, so that the render thread uploads a blank image and
+ * swaps in the decompressed one once it is done. The threads are only created the first time they are needed.
+ */
+class DecodeQueue {
+public:
+    ~DecodeQueue();
+
+    // Pool to give to decompress_compressed_texture
+    WorkerPool &get_pool();
+    void submit(const std::shared_ptr<DecodeJob> &job);
+
+private:
+    void decode_loop();
+
+    std::once_flag pool_created;
+    std::unique_ptr<WorkerPool> pool;
+
+    std::thread decode_thread;
+    std::mutex mutex;
+    std::condition_variable job_cond;
+    std::deque<std::shared_ptr<DecodeJob>> jobs;
+    bool stop = false;
+};
+
+} // namespace renderer::texture
@@ -161,6 +161,7 @@ struct Context {
     CommandList command_list;
     CommandAllocFunc alloc_func;
     CommandFreeFunc free_func;
+    CommandArena command_arena;
 
     int render_finish_status = 0;
     int notification_finish_status = 0;
@@ -25,6 +25,7 @@
 #include <renderer/vulkan/screen_renderer.h>
 #include <renderer/vulkan/surface_cache.h>
 #include <renderer/vulkan/types.h>
+#include <threads/queue.h>
 
 #include <chrono>
 
@@ -159,6 +160,7 @@ struct VKState : public renderer::State {
     uint32_t get_gpu_version() override;
 
     void precompile_shader(const ShadersHash &hash) override;
+    bool can_precompile_in_parallel() override;
     void preclose_action() override;
 
     inline FrameObject &frame() {
@@ -189,6 +189,9 @@ private:
     void destroy_surface(ColorSurfaceCacheInfo &info);
     void destroy_surface(DepthStencilSurfaceCacheInfo &info);
 
+    // copy the surface back to the guest memory with a separate command buffer, clear it first if clear_color is not null
+    void sync_surface(ColorSurfaceCacheInfo &surface, const vk::ClearColorValue *clear_color);
+
 public:
     // when creating a mutable image, can we pass as an argument
     // the possible format used for an image view to improve performance ?
@@ -218,6 +221,10 @@ public:
     // so that subsequent calls to check_for_surface with the target destination also get delayed
     bool check_for_surface(MemState &mem, Address source_address, CallbackRequestFunction &callback, Address target_address);
 
+    // Fill a whole color surface on the GPU, the result is then synced back to the RAM
+    // Returns false if dest is not a surface or the fill cannot be done with a clear
+    bool fill_surface(const SceGxmTransferImage &dest, uint32_t fill_color);
+
     // If non-null, the return value must be sent as a PostSurfaceSyncRequest
     ColorSurfaceCacheInfo *perform_surface_sync();
 
@@ -70,7 +70,7 @@ struct VKTextureCache : public TextureCache {
     bool init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id);
     void select(size_t index, const SceGxmTexture &texture) override;
     void configure_texture(const SceGxmTexture &texture) override;
-    void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) override;
+    void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride, uint32_t first_row) override;
     void upload_done() override;
 
     void configure_sampler(size_t index, const SceGxmTexture &texture, bool no_linear) override;
@@ -140,11 +140,15 @@ struct TrappedBuffer {
     uint32_t size;
     // used by the index buffer to keep the max index
     uint32_t extra;
-    // no need for it to be atomic
-    bool dirty = false;
+    // watched range and the write generation it was copied at
+    Address watched_addr = 0;
+    uint32_t watched_size = 0;
+    uint32_t write_generation = 0;
     uint8_t *mapped_location;
 
     TrappedBuffer() {}
+
+    bool is_dirty(const MemState &mem) const;
 };
 
 // structure to track which buffer were trapped and if they have been modified
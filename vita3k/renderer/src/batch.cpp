@@ -28,9 +28,13 @@
 #include <functional>
 #include <overlay/display_manager.h>
 #include <overlay/shader_precompile_progress.h>
+#include <threads/worker_pool.h>
 #include <util/log.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <new>
 #include <thread>
 
 #ifdef TRACY_ENABLE
@@ -40,12 +44,18 @@
 struct FeatureState;
 
 namespace renderer {
-Command *generic_command_allocate() {
-    return new Command;
+Command *generic_command_allocate(std::size_t payload_size) {
+    return new (::operator new(sizeof(Command) + payload_size)) Command;
 }
 
-void generic_command_free(Command *cmd) {
-    delete cmd;
+void generic_command_free(Command *first, Command *last) {
+    Command *cmd = first;
+    while (cmd) {
+        Command *next = (cmd == last) ? nullptr : cmd->next;
+        cmd->~Command();
+        ::operator delete(cmd);
+        cmd = next;
+    }
 }
 
 void complete_command(State &state, CommandHelper &helper, const int code) {
@@ -59,8 +69,8 @@ bool is_cmd_ready(MemState &mem, CommandList &command_list) {
     if (!command_list.first || command_list.first->opcode != CommandOpcode::WaitSyncObject)
         return true;
 
-    SceGxmSyncObject *sync = reinterpret_cast<Ptr<SceGxmSyncObject> *>(&command_list.first->data[0])->get(mem);
-    const uint32_t timestamp = *reinterpret_cast<uint32_t *>(&command_list.first->data[sizeof(uint32_t)]);
+    SceGxmSyncObject *sync = reinterpret_cast<Ptr<SceGxmSyncObject> *>(command_list.first->data())->get(mem);
+    const uint32_t timestamp = *reinterpret_cast<uint32_t *>(command_list.first->data() + sizeof(uint32_t));
 
     return sync->timestamp_current >= timestamp;
 }
@@ -68,8 +78,8 @@ bool is_cmd_ready(MemState &mem, CommandList &command_list) {
 static renderer::SyncWaitResult wait_cmd(MemState &mem, CommandList &command_list) {
     // we assume here that the cmd starts with a WaitSyncObject
 
-    SceGxmSyncObject *sync = reinterpret_cast<Ptr<SceGxmSyncObject> *>(&command_list.first->data[0])->get(mem);
-    const uint32_t timestamp = *reinterpret_cast<uint32_t *>(&command_list.first->data[sizeof(uint32_t)]);
+    SceGxmSyncObject *sync = reinterpret_cast<Ptr<SceGxmSyncObject> *>(command_list.first->data())->get(mem);
+    const uint32_t timestamp = *reinterpret_cast<uint32_t *>(command_list.first->data() + sizeof(uint32_t));
 
     // wait 500 micro seconds and then return in case should_display is set to true
     return renderer::wishlist(sync, timestamp, 500);
@@ -101,14 +111,12 @@ static void process_batch(renderer::State &state, const FeatureState &features,
         { CommandOpcode::DestroyContext, cmd_handle_destroy_context }
     };
 
-    Command *cmd = command_list.first;
+    uint64_t command_count = 0;
+    uint64_t command_bytes = 0;
 
     // Take a batch, and execute it. Hope it's not too large
-    do {
-        if (cmd == nullptr) {
-            break;
-        }
-
+    Command *cmd = command_list.first;
+    while (cmd) {
         auto handler = handlers.find(cmd->opcode);
         if (handler == handlers.end()) {
             LOG_ERROR("Unimplemented command opcode {}", static_cast<int>(cmd->opcode));
@@ -117,15 +125,22 @@ static void process_batch(renderer::State &state, const FeatureState &features,
             handler->second(state, mem, config, helper, features, command_list.context);
         }
 
-        Command *last_cmd = cmd;
-        cmd = cmd->next;
+        command_count++;
+        command_bytes += cmd->total_size();
+        cmd = (cmd == command_list.last) ? nullptr : cmd->next;
+    }
 
+    // the whole list is given back at once, the arena recycles each chunk in one go
+    if (command_list.first) {
         if (command_list.context) {
-            command_list.context->free_func(last_cmd);
+            command_list.context->free_func(command_list.first, command_list.last);
         } else {
-            generic_command_free(last_cmd);
+            generic_command_free(command_list.first, command_list.last);
         }
-    } while (true);
+    }
+
+    state.command_count.fetch_add(command_count, std::memory_order_relaxed);
+    state.command_bytes.fetch_add(command_bytes, std::memory_order_relaxed);
 }
 
 void process_batches(renderer::State &state, const FeatureState &features, MemState &mem, Config &config, int64_t max_wait_ms) {
@@ -195,21 +210,51 @@ static void render_loop(renderer::State &state, DisplayState &display, GxmState
 
         const int total = static_cast<int>(state.precompile_queue.size());
         state.precompile_total = total;
+        const auto start = std::chrono::steady_clock::now();
+
+        if (state.can_precompile_in_parallel()) {
+            // the overlay is only refreshed between chunks, the shaders of a chunk are spread over the pool
+            constexpr int CHUNK_SIZE = 64;
+            WorkerPool pool(std::max(std::thread::hardware_concurrency(), 2U) - 1);
+
+            for (int i = 0; i < total && !state.render_abort.load(std::memory_order_relaxed);) {
+                if (!state.set_current())
+                    break;
+
+                const int chunk = std::min(CHUNK_SIZE, total - i);
+                pool.run(chunk, [&](const uint32_t j) {
+                    state.precompile_shader(state.precompile_queue[i + j]);
+                });
+                i += chunk;
+                state.precompile_progress = i;
+
+                if (progress_overlay) {
+                    progress_overlay->set_progress(i, total);
+                    state.render_frame(display, gxm, mem);
+                    state.swap_window();
+                }
+            }
+        } else {
+            for (int i = 0; i < total && !state.render_abort.load(std::memory_order_relaxed); ++i) {
+                if (!state.set_current())
+                    break;
 
-        for (int i = 0; i < total && !state.render_abort.load(std::memory_order_relaxed); ++i) {
-            if (!state.set_current())
-                break;
-
-            state.precompile_shader(state.precompile_queue[i]);
-            state.precompile_progress = i + 1;
+                state.precompile_shader(state.precompile_queue[i]);
+                state.precompile_progress = i + 1;
 
-            if (progress_overlay) {
-                progress_overlay->set_progress(i + 1, total);
-                state.render_frame(display, gxm, mem);
-                state.swap_window();
+                if (progress_overlay) {
+                    progress_overlay->set_progress(i + 1, total);
+                    state.render_frame(display, gxm, mem);
+                    state.swap_window();
+                }
             }
         }
 
+        if (total > 0) {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("Precompiled {} programs in {:.2f} s ({:.0f}/s)", state.precompile_progress, seconds, state.precompile_progress / std::max(seconds, 1e-3));
+        }
+
         state.precompile_queue.clear();
 
         if (progress_overlay) {
@@ -271,6 +316,8 @@ static void render_loop(renderer::State &state, DisplayState &display, GxmState
         state.render_frame(display, gxm, mem);
         state.swap_window();
         state.async_flip_requested.store(false, std::memory_order_relaxed);
+        // in unlocked mode, the next vblank happens now
+        display.vblank_pacer.notify();
 
 #ifdef TRACY_ENABLE
         FrameMark;
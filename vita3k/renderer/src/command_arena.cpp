@@ -0,0 +1,111 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/commands.h>
+
+#include <atomic>
+#include <new>
+
+namespace renderer {
+
+struct CommandArenaChunk {
+    // the live command count is in the low bits, RETIRED is set once no more commands are allocated in the chunk
+    static constexpr uint32_t RETIRED = 1u << 31;
+
+    CommandArena *arena;
+    std::atomic<uint32_t> state{ 0 };
+    std::size_t used = 0;
+    std::unique_ptr<uint8_t[]> memory;
+
+    explicit CommandArenaChunk(CommandArena *arena)
+        : arena(arena)
+        , memory(std::make_unique<uint8_t[]>(CommandArena::CHUNK_SIZE)) {
+    }
+};
+
+CommandArena::CommandArena() = default;
+CommandArena::~CommandArena() = default;
+
+Command *CommandArena::allocate(std::size_t payload_size) {
+    const std::size_t size = (sizeof(Command) + payload_size + alignof(Command) - 1) & ~(alignof(Command) - 1);
+    assert(size <= CHUNK_SIZE);
+
+    if (!current || current->used + size > CHUNK_SIZE) {
+        if (current) {
+            // the render thread may have consumed everything already, then nobody else will recycle it
+            if ((current->state.fetch_or(CommandArenaChunk::RETIRED, std::memory_order_acq_rel) & ~CommandArenaChunk::RETIRED) == 0)
+                recycle(current);
+        }
+
+        const std::lock_guard<std::mutex> guard(mutex);
+        if (free_chunks.empty()) {
+            chunks.push_back(std::make_unique<CommandArenaChunk>(this));
+            current = chunks.back().get();
+        } else {
+            current = free_chunks.back();
+            free_chunks.pop_back();
+        }
+    }
+
+    Command *cmd = new (current->memory.get() + current->used) Command;
+    cmd->chunk = current;
+    current->used += size;
+    current->state.fetch_add(1, std::memory_order_relaxed);
+
+    return cmd;
+}
+
+void CommandArena::release(Command *first, Command *last) {
+    CommandArenaChunk *chunk = nullptr;
+    uint32_t count = 0;
+
+    const auto drop = [&]() {
+        if (!chunk)
+            return;
+        if (chunk->state.fetch_sub(count, std::memory_order_acq_rel) == (CommandArenaChunk::RETIRED | count))
+            chunk->arena->recycle(chunk);
+    };
+
+    // commands come in allocation order, so this is one atomic operation per chunk and not per command
+    // the next pointer of the last command can be changed by another thread, do not go past it
+    for (Command *cmd = first; cmd; cmd = (cmd == last) ? nullptr : cmd->next) {
+        if (!cmd->chunk || (cmd->flags & Command::FLAG_NO_FREE))
+            continue;
+
+        if (cmd->chunk != chunk) {
+            drop();
+            chunk = cmd->chunk;
+            count = 0;
+        }
+        count++;
+    }
+    drop();
+}
+
+std::size_t CommandArena::chunk_count() const {
+    const std::lock_guard<std::mutex> guard(mutex);
+    return chunks.size();
+}
+
+void CommandArena::recycle(CommandArenaChunk *chunk) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    chunk->used = 0;
+    chunk->state.store(0, std::memory_order_relaxed);
+    free_chunks.push_back(chunk);
+}
+
+} // namespace renderer
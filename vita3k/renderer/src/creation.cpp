@@ -278,9 +278,6 @@ bool init(FrameHost &frame, std::unique_ptr<State> &state, Backend backend, cons
 
     state->current_backend = backend;
 
-    // Can change this
-    state->command_buffer_queue.maxPendingCount_ = 30;
-
     return true;
 }
 } // namespace renderer
@@ -153,13 +153,13 @@ static SharedGLObject compile_program(ProgramCache &program_cache, const SharedG
     return program;
 }
 
-static SharedGLObject compile_shader(const fs::path &shader_cache_path, const std::string &shader_version, const std::string &hash_hex,
+static SharedGLObject compile_shader(ShaderArchive &archive, const std::string &shader_version, const std::string &hash_hex,
     const char *type_str, const GLenum type, ShaderCache &cache, const Sha256Hash &hash) {
     // Set Shader version with hash
 
     // Load Shader
-    const auto shader_name = shader_cache_path / fmt::format("{}-{}.{}", shader_version, hash_hex, type_str);
-    const std::string shader = pre_load_shader_glsl(shader_name);
+    const auto shader_name = fmt::format("{}-{}.{}", shader_version, hash_hex, type_str);
+    const std::string shader = pre_load_shader_glsl(archive, shader_name);
     if (shader.empty()) {
         LOG_WARN("{} shader is empty or not found:\n{}", type_str, hash_hex);
         return SharedGLObject();
@@ -188,10 +188,10 @@ static std::vector<ShadersHash>::iterator get_shaders_hash_index(std::vector<Sha
 }
 
 void pre_compile_program(GLState &renderer, const ShadersHash &hash) {
-    if (fs::exists(renderer.shaders_path) && !fs::is_empty(renderer.shaders_path)) {
+    if (renderer.shader_archive.is_open()) {
         // Compile Fragment Shader
         const auto frag_hash_hex = convert_hash_to_hex(hash.frag);
-        const SharedGLObject frag_shader = compile_shader(renderer.shaders_path, renderer.shader_version,
+        const SharedGLObject frag_shader = compile_shader(renderer.shader_archive, renderer.shader_version,
             frag_hash_hex, "frag", GL_FRAGMENT_SHADER, renderer.fragment_shader_cache, hash.frag);
         if (!frag_shader) {
             return;
@@ -199,7 +199,7 @@ void pre_compile_program(GLState &renderer, const ShadersHash &hash) {
 
         // Compile Vertex Shader
         const auto vert_hash_hex = convert_hash_to_hex(hash.vert);
-        const SharedGLObject vert_shader = compile_shader(renderer.shaders_path, renderer.shader_version,
+        const SharedGLObject vert_shader = compile_shader(renderer.shader_archive, renderer.shader_version,
             vert_hash_hex, "vert", GL_VERTEX_SHADER, renderer.vertex_shader_cache, hash.vert);
         if (!vert_shader) {
             return;
@@ -208,22 +208,22 @@ void pre_compile_program(GLState &renderer, const ShadersHash &hash) {
         // Compile Program
         const ProgramHashes hashes(hash.frag, hash.vert);
         compile_program(renderer.program_cache, frag_shader, vert_shader, hashes);
-        renderer.programs_count_pre_compiled++;
-        LOG_INFO("Program Compiled {}/{}", renderer.programs_count_pre_compiled, renderer.shaders_cache_hashs.size());
+        const uint32_t compiled = ++renderer.programs_count_pre_compiled;
+        LOG_INFO("Program Compiled {}/{}", compiled, renderer.shaders_cache_hashs.size());
     }
 }
 
 static SharedGLObject get_or_compile_shader(const SceGxmProgram *program, const FeatureState &features, const Sha256Hash &hash,
-    ShaderCache &cache, const GLenum type, const shader::Hints &hints, bool shader_cache, bool spirv, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, uint32_t &shaders_count_compiled) {
+    ShaderCache &cache, const GLenum type, const shader::Hints &hints, bool shader_cache, bool spirv, bool maskupdate, ShaderArchive &archive, const fs::path &shader_log_path, const std::string &shader_version, uint32_t &shaders_count_compiled) {
     const auto cached = cache.find(hash);
     if (cached == cache.end()) {
         SharedGLObject obj = nullptr;
 
         // Need to compile new one and add it to cache
         if (features.spirv_shader && spirv) {
-            obj = compile_spirv(type, load_spirv_shader(*program, features, false, hints, maskupdate, shader_cache_path, shader_log_path, shader_version + "spv", shader_cache));
+            obj = compile_spirv(type, load_spirv_shader(*program, features, false, hints, maskupdate, archive, shader_log_path, shader_version + "spv", shader_cache));
         } else {
-            obj = compile_glsl(type, load_glsl_shader(*program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_version, shader_cache));
+            obj = compile_glsl(type, load_glsl_shader(*program, features, hints, maskupdate, archive, shader_log_path, shader_version, shader_cache));
         }
 
         cache.emplace(hash, obj);
@@ -268,7 +268,7 @@ SharedGLObject compile_program(GLState &renderer, GLContext &context, const GxmR
     context.shader_hints.attributes = &vertex_program_gxm.attributes;
 
     const SharedGLObject fragment_shader = get_or_compile_shader(fragment_program_gxm.program.get(mem), features, fragment_program.hash, renderer.fragment_shader_cache,
-        GL_FRAGMENT_SHADER, context.shader_hints, shader_cache, spirv, maskupdate, renderer.shaders_path, renderer.shaders_log_path, renderer.shader_version, renderer.shaders_count_compiled);
+        GL_FRAGMENT_SHADER, context.shader_hints, shader_cache, spirv, maskupdate, renderer.shader_archive, renderer.shaders_log_path, renderer.shader_version, renderer.shaders_count_compiled);
 
     if (!fragment_shader) {
         LOG_CRITICAL("Error in get/compile fragment vertex shader:\n{}", hex_string(fragment_program.hash));
@@ -276,7 +276,7 @@ SharedGLObject compile_program(GLState &renderer, GLContext &context, const GxmR
     }
 
     const SharedGLObject vertex_shader = get_or_compile_shader(vertex_program_gxm.program.get(mem), features, vertex_program.hash, renderer.vertex_shader_cache,
-        GL_VERTEX_SHADER, context.shader_hints, shader_cache, spirv, maskupdate, renderer.shaders_path, renderer.shaders_log_path, renderer.shader_version, renderer.shaders_count_compiled);
+        GL_VERTEX_SHADER, context.shader_hints, shader_cache, spirv, maskupdate, renderer.shader_archive, renderer.shaders_log_path, renderer.shader_version, renderer.shaders_count_compiled);
 
     if (!vertex_shader) {
         LOG_CRITICAL("Error in get/compiled vertex shader:\n{}", hex_string(vertex_program.hash));
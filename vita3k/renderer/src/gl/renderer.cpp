@@ -851,6 +851,7 @@ void GLState::cleanup() {
 
     gxp_ptr_map.clear();
     shaders_cache_hashs.clear();
+    shader_archive.close();
     command_buffer_queue.reset();
     last_scene_id = 0;
     shaders_count_compiled = 0;
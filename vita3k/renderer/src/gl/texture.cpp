@@ -195,7 +195,7 @@ void GLTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
     }
 }
 
-void GLTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) {
+void GLTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride, uint32_t first_row) {
     R_PROFILE(__func__);
 
     GLenum upload_type = GL_TEXTURE_2D;
@@ -224,7 +224,7 @@ void GLTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
 
         const GLenum format = translate_format(base_format);
         size_t compressed_size = renderer::texture::get_compressed_size(base_format, width, height);
-        glCompressedTexSubImage2D(upload_type, mip_index, 0, 0, width, height, format, static_cast<GLsizei>(compressed_size), pixels);
+        glCompressedTexSubImage2D(upload_type, mip_index, 0, static_cast<GLint>(first_row), width, height, format, static_cast<GLsizei>(compressed_size), pixels);
 
         glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_SIZE, 0);
         glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_WIDTH, 0);
@@ -235,7 +235,7 @@ void GLTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
 
         const GLenum format = translate_format(base_format);
         const GLenum type = translate_type(base_format);
-        glTexSubImage2D(upload_type, mip_index, 0, 0, width, height, format, type, pixels);
+        glTexSubImage2D(upload_type, mip_index, 0, static_cast<GLint>(first_row), width, height, format, type, pixels);
 
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     }
@@ -83,6 +83,9 @@ void State::update_overlays() {
             perf_overlay.max_fps, perf_overlay.ms_per_frame,
             perf_overlay.fps_values.data(), perf_overlay.fps_values_count,
             perf_overlay.current_fps_offset);
+        perf->set_command_data(perf_overlay.commands_per_frame, perf_overlay.command_bytes_per_frame);
+        perf->set_texture_data(perf_overlay.texture_bytes_hashed_per_frame, perf_overlay.texture_bytes_uploaded_per_frame);
+        perf->set_vblank_data(perf_overlay.vblank_interval_mean, perf_overlay.vblank_interval_variance, perf_overlay.vblank_interval_max, perf_overlay.vblanks_dropped);
     } else {
         auto perf = overlay_manager->get<overlay::perf_overlay>();
         if (perf)
@@ -203,8 +206,20 @@ void set_side_fragment_program_enable(State &state, Context *ctx, const bool is_
     renderer::add_state_set_command(ctx, renderer::GXMState::FragmentProgramEnable, is_front, mode);
 }
 
-void set_context(State &state, Context *ctx, RenderTarget *target, SceGxmColorSurface *color_surface, SceGxmDepthStencilSurface *depth_stencil_surface) {
-    renderer::add_command(ctx, renderer::CommandOpcode::SetContext, nullptr, target, color_surface, depth_stencil_surface);
+void set_context(State &state, Context *ctx, RenderTarget *target, const SceGxmColorSurface *color_surface, const SceGxmDepthStencilSurface *depth_stencil_surface) {
+    // the surfaces are copied in the command itself, a missing surface is sent as a disabled one
+    SceGxmColorSurface color_surface_copy{};
+    SceGxmDepthStencilSurface depth_stencil_surface_copy{};
+
+    if (color_surface)
+        color_surface_copy = *color_surface;
+    else
+        color_surface_copy.disabled = 1;
+
+    if (depth_stencil_surface)
+        depth_stencil_surface_copy = *depth_stencil_surface;
+
+    renderer::add_command(ctx, renderer::CommandOpcode::SetContext, nullptr, target, color_surface_copy, depth_stencil_surface_copy);
 }
 
 void set_vertex_stream(State &state, Context *ctx, const std::size_t index, const std::size_t data_len, const Ptr<const void> stream) {
@@ -39,45 +39,28 @@
 #endif
 
 namespace renderer {
-void destroy_command_payload(Command &cmd) {
-    switch (cmd.opcode) {
-    case CommandOpcode::SetContext: {
-        auto *color_surface = reinterpret_cast<SceGxmColorSurface **>(&cmd.data[sizeof(RenderTarget *)]);
-        auto *depth_stencil_surface = reinterpret_cast<SceGxmDepthStencilSurface **>(&cmd.data[sizeof(RenderTarget *) + sizeof(SceGxmColorSurface *)]);
-        delete *color_surface;
-        delete *depth_stencil_surface;
-        break;
-    }
-
-    default:
-        break;
-    }
-}
-
 COMMAND(handle_set_context) {
     TRACY_FUNC_COMMANDS(handle_set_context);
     RenderTarget *rt = helper.pop<RenderTarget *>();
-    const SceGxmColorSurface *color_surface = helper.pop<SceGxmColorSurface *>();
-    const SceGxmDepthStencilSurface *depth_stencil_surface = helper.pop<SceGxmDepthStencilSurface *>();
+    const SceGxmColorSurface color_surface = helper.pop<SceGxmColorSurface>();
+    const SceGxmDepthStencilSurface depth_stencil_surface = helper.pop<SceGxmDepthStencilSurface>();
 
     render_context->current_render_target = rt;
 
-    if (color_surface && !color_surface->disabled) {
-        render_context->record.color_surface = *color_surface;
+    if (!color_surface.disabled) {
+        render_context->record.color_surface = color_surface;
     } else {
         render_context->record.color_surface.data = nullptr;
         render_context->record.color_surface.downscale = false;
     }
 
-    if (depth_stencil_surface && !depth_stencil_surface->disabled()) {
-        render_context->record.depth_stencil_surface = *depth_stencil_surface;
+    if (!depth_stencil_surface.disabled()) {
+        render_context->record.depth_stencil_surface = depth_stencil_surface;
     } else {
         render_context->record.depth_stencil_surface.depth_data.reset();
         render_context->record.depth_stencil_surface.stencil_data.reset();
     }
 
-    destroy_command_payload(*helper.cmd);
-
     switch (renderer.current_backend) {
     case Backend::OpenGL:
         gl::set_context(dynamic_cast<gl::GLState &>(renderer), *reinterpret_cast<gl::GLContext *>(render_context), mem, reinterpret_cast<const gl::GLRenderTarget *>(rt), features);
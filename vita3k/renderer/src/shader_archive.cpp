@@ -0,0 +1,238 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/shader_archive.h>
+
+#include <util/log.h>
+
+#include <xxhash.h>
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace renderer {
+
+static constexpr char ARCHIVE_MAGIC[4] = { 'V', '3', 'S', 'P' };
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+
+struct ArchiveHeader {
+    char magic[4];
+    uint32_t version;
+};
+
+// Followed by the key and the data
+struct RecordHeader {
+    uint32_t key_size;
+    uint32_t data_size;
+    uint64_t checksum;
+};
+
+static uint64_t record_checksum(std::string_view key, const void *data, size_t size) {
+    return XXH3_64bits(key.data(), key.size()) ^ XXH3_64bits(data, size);
+}
+
+ShaderArchive::~ShaderArchive() {
+    close();
+}
+
+bool ShaderArchive::map_file() {
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // the view keeps the mapping alive once both handles are closed
+    const HANDLE mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping_handle)
+        return false;
+    mapping = static_cast<const uint8_t *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping_handle);
+    if (!mapping)
+        return false;
+    mapping_size = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *const data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    mapping = static_cast<const uint8_t *>(data);
+    mapping_size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void ShaderArchive::unmap_file() {
+    if (!mapping)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#else
+    munmap(const_cast<uint8_t *>(mapping), mapping_size);
+#endif
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+bool ShaderArchive::index_file() {
+    ArchiveHeader header;
+    if (mapping_size >= sizeof(header))
+        memcpy(&header, mapping, sizeof(header));
+    if (mapping_size < sizeof(header) || memcmp(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || header.version != ARCHIVE_VERSION) {
+        LOG_WARN("Shader archive {} is invalid or outdated, recreating it", fs_utils::path_to_utf8(path));
+        unmap_file();
+        fs::remove(path);
+        valid_size = 0;
+        return true;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset + sizeof(RecordHeader) <= mapping_size) {
+        RecordHeader record;
+        memcpy(&record, mapping + offset, sizeof(record));
+        const size_t record_end = offset + sizeof(record) + record.key_size + record.data_size;
+        if (record_end > mapping_size)
+            break;
+
+        const std::string_view key(reinterpret_cast<const char *>(mapping + offset + sizeof(record)), record.key_size);
+        const uint8_t *data = mapping + offset + sizeof(record) + record.key_size;
+        if (record_checksum(key, data, record.data_size) != record.checksum)
+            break;
+
+        // a key added twice keeps the last data
+        entries.insert_or_assign(std::string(key), std::string_view(reinterpret_cast<const char *>(data), record.data_size));
+        offset = record_end;
+    }
+    valid_size = offset;
+
+    return valid_size == mapping_size;
+}
+
+void ShaderArchive::open(const fs::path &archive_path) {
+    close();
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::lock_guard<std::shared_mutex> lock(mutex);
+    path = archive_path;
+    if (map_file() && !index_file()) {
+        // the last record was cut short by a crash, drop it so that the next add does not append after it
+        LOG_WARN("Shader archive {} ends with {} invalid bytes, dropping them", fs_utils::path_to_utf8(path), mapping_size - valid_size);
+        unmap_file();
+        entries.clear();
+        fs::resize_file(path, valid_size);
+        if (map_file())
+            index_file();
+    }
+
+    load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ShaderArchive::close() {
+    const std::lock_guard<std::shared_mutex> lock(mutex);
+    if (append_file) {
+        fclose(append_file);
+        append_file = nullptr;
+    }
+    unmap_file();
+    entries.clear();
+    added.clear();
+    path.clear();
+    valid_size = 0;
+    load_ms = 0.0;
+}
+
+std::string_view ShaderArchive::find(const std::string &key) {
+    const std::shared_lock<std::shared_mutex> lock(mutex);
+    const auto it = entries.find(key);
+    return it == entries.end() ? std::string_view() : it->second;
+}
+
+void ShaderArchive::add(const std::string &key, const void *data, size_t size) {
+    const std::lock_guard<std::shared_mutex> lock(mutex);
+    if (path.empty())
+        return;
+
+    // the shaders are added again on every launch when the shader cache is not used
+    const auto it = entries.find(key);
+    if (it != entries.end() && it->second == std::string_view(static_cast<const char *>(data), size))
+        return;
+
+    if (!append_file) {
+        fs::create_directories(path.parent_path());
+        append_file = FOPEN(path.c_str(), "ab");
+        if (!append_file) {
+            LOG_ERROR("Could not open shader archive {}", fs_utils::path_to_utf8(path));
+            return;
+        }
+
+        if (valid_size == 0) {
+            ArchiveHeader header;
+            memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+            header.version = ARCHIVE_VERSION;
+            fwrite(&header, sizeof(header), 1, append_file);
+            valid_size = sizeof(header);
+        }
+    }
+
+    const RecordHeader record{
+        .key_size = static_cast<uint32_t>(key.size()),
+        .data_size = static_cast<uint32_t>(size),
+        .checksum = record_checksum(key, data, size)
+    };
+    fwrite(&record, sizeof(record), 1, append_file);
+    fwrite(key.data(), 1, key.size(), append_file);
+    fwrite(data, 1, size, append_file);
+    // a crash must not lose the shaders already added
+    fflush(append_file);
+    valid_size += sizeof(record) + key.size() + size;
+
+    const std::string &stored = added.emplace_back(static_cast<const char *>(data), size);
+    entries.insert_or_assign(key, std::string_view(stored));
+}
+
+size_t ShaderArchive::size() {
+    const std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+} // namespace renderer
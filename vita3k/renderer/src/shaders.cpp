@@ -17,6 +17,7 @@
 
 #include <renderer/shaders.h>
 
+#include <renderer/shader_archive.h>
 #include <renderer/vulkan/state.h>
 
 #include <gxm/types.h>
@@ -26,12 +27,13 @@
 #include <util/fs.h>
 #include <util/log.h>
 
+#include <cstring>
 #include <string>
 #include <vector>
 
 namespace renderer {
 
-bool get_shaders_cache_hashs(State &renderer) {
+static bool read_shaders_cache_hashs(State &renderer) {
     const std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
 
     fs::ifstream shaders_hashs(renderer.shaders_path / hash_file_name, std::ios::in | std::ios::binary);
@@ -86,6 +88,18 @@ bool get_shaders_cache_hashs(State &renderer) {
     return !renderer.shaders_cache_hashs.empty();
 }
 
+bool get_shaders_cache_hashs(State &renderer) {
+    // an outdated cache is deleted, the archive must not be mapped by then
+    renderer.shader_archive.close();
+    const bool has_hashs = read_shaders_cache_hashs(renderer);
+
+    renderer.shader_archive.open(renderer.shaders_path / ShaderArchive::FILE_NAME);
+    if (renderer.shader_archive.size() > 0)
+        LOG_INFO("Loaded {} shaders from the shader archive in {:.2f} ms", renderer.shader_archive.size(), renderer.shader_archive.load_time_ms());
+
+    return has_hashs;
+}
+
 void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders_cache_hashs) {
     fs::create_directories(renderer.shaders_path);
     std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
@@ -115,26 +129,21 @@ void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders
     }
 }
 
-static bool load_shader(const fs::path &shader_name, char **destination, std::size_t &size_read) {
-    fs::ifstream is(shader_name, fs::ifstream::binary);
-    if (!is) {
-        return false;
-    }
-
-    is.seekg(0, fs::ifstream::end);
-    size_read = is.tellg();
-    is.seekg(0);
-
-    if (size_read == 0) {
-        return false;
-    }
-
-    if (destination == nullptr) {
-        return true;
-    }
-
-    is.read(*destination, size_read);
-    return true;
+// Looks name up in the archive, a loose file left by an older cache is moved into the archive
+static std::string_view find_shader(ShaderArchive &archive, const std::string &name) {
+    const std::string_view data = archive.find(name);
+    if (!data.empty() || !archive.is_open())
+        return data;
+
+    const fs::path loose_path = archive.get_path().parent_path() / name;
+    std::vector<uint8_t> loose_data;
+    if (!fs::exists(loose_path) || !fs_utils::read_data(loose_path, loose_data) || loose_data.empty())
+        // another thread may have just moved it
+        return archive.find(name);
+
+    archive.add(name, loose_data.data(), loose_data.size());
+    fs::remove(loose_path);
+    return archive.find(name);
 }
 
 static Sha256Hash get_shader_hash(const SceGxmProgram &program) {
@@ -143,41 +152,36 @@ static Sha256Hash get_shader_hash(const SceGxmProgram &program) {
 }
 
 template <typename R>
-static R load_shader_generic(const fs::path &shader_path) {
-    std::size_t read_size = 0;
+static R load_shader_generic(ShaderArchive &archive, const std::string &name) {
+    const std::string_view data = find_shader(archive, name);
     R source;
-
-    if (load_shader(shader_path, nullptr, read_size)) {
-        source.resize((read_size + sizeof(typename R::value_type) - 1) / sizeof(typename R::value_type));
-
-        char *dest_pointer = reinterpret_cast<char *>(source.data());
-        load_shader(shader_path, &dest_pointer, read_size);
-    }
+    source.resize((data.size() + sizeof(typename R::value_type) - 1) / sizeof(typename R::value_type));
+    memcpy(source.data(), data.data(), data.size());
 
     return source;
 }
 
-static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache) {
+static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderArchive &archive, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache) {
     // TODO: no need to recompute the hash here
     const std::string hash_text = hex_string(get_shader_hash(program));
     // Set Shader Hash with Version
     const std::string hash_hex_ver = fmt::format("{}-{}", shader_version, hash_text);
-    const auto get_shader_path = [&](const char *ext) {
-        return shader_cache_path / fmt::format("{}.{}", hash_hex_ver, ext);
+    const auto get_shader_name = [&](const char *ext) {
+        return fmt::format("{}.{}", hash_hex_ver, ext);
     };
     const auto get_shaderlog_path = [&](const char *ext) {
         return shaderlog_path / fmt::format("{}.{}", hash_hex_ver, ext);
     };
 
-    const auto shader_path = get_shader_path(shader_type_str);
+    const auto shader_name = get_shader_name(shader_type_str);
     if (shader_cache) {
         if (target == shader::Target::GLSLOpenGL) {
-            std::string source = load_shader_generic<std::string>(shader_path);
+            std::string source = load_shader_generic<std::string>(archive, shader_name);
             if (!source.empty()) {
                 return { source, std::vector<uint32_t>() };
             }
         } else {
-            std::vector<uint32_t> source = load_shader_generic<std::vector<uint32_t>>(get_shader_path("spv"));
+            std::vector<uint32_t> source = load_shader_generic<std::vector<uint32_t>>(archive, get_shader_name("spv"));
             if (!source.empty())
                 return { "", source };
         }
@@ -192,32 +196,27 @@ static shader::GeneratedShader load_shader_generic(shader::Target target, const
     // Dump gxp binary
     fs_utils::dump_data(shader_log_path, &program, program.size);
     const auto write_data_with_ext = [&](const std::string &ext, const std::string &data) {
-        fs::path out_path;
-        if (ext == shader_type_str) {
-            out_path = shader_path;
+        // only the glsl source is read back, the spir-v disassembly goes with the logs
+        if (ext == shader_type_str && target == shader::Target::GLSLOpenGL) {
+            archive.add(shader_name, data.c_str(), data.size());
         } else {
-            out_path = shader_log_path;
+            fs::path out_path = shader_log_path;
             out_path.replace_extension(ext);
+            fs_utils::dump_data(out_path, data.c_str(), data.size());
         }
-        fs_utils::dump_data(out_path, data.c_str(), data.size());
         return true;
     };
 
     shader::GeneratedShader source = shader::convert_gxp(program, hash_text, features, target, hints, maskupdate, false, write_data_with_ext);
 
     // Copy shader generate to shaders cache
-    const auto shaders_cache_path = fs::path(shader_cache_path);
-    fs::create_directories(shaders_cache_path);
-
-    if (target != shader::Target::GLSLOpenGL) {
-        const auto shader_dst_path = get_shader_path("spv");
-        fs_utils::dump_data(shader_dst_path, source.spirv.data(), sizeof(uint32_t) * source.spirv.size());
-    }
+    if (target != shader::Target::GLSLOpenGL)
+        archive.add(get_shader_name("spv"), source.spirv.data(), sizeof(uint32_t) * source.spirv.size());
 
     return source;
 }
 
-std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderArchive &archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     SceGxmProgramType program_type = program.get_type();
 
     auto shader_type_to_str = [](SceGxmProgramType type) {
@@ -226,25 +225,25 @@ std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &f
 
     const char *shader_type_str = shader_type_to_str(program_type);
 
-    return load_shader_generic(shader::Target::GLSLOpenGL, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
+    return load_shader_generic(shader::Target::GLSLOpenGL, program, features, hints, maskupdate, archive, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
 }
 
-std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, ShaderArchive &archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     const shader::Target target = is_vulkan ? shader::Target::SpirVVulkan : shader::Target::SpirVOpenGL;
     auto shader_type_to_str = [](SceGxmProgramType type) {
         return (type == SceGxmProgramType::Vertex) ? "vert.spv.txt" : ((type == SceGxmProgramType::Fragment) ? "frag.spv.txt" : "unknown.spv.txt");
     };
     const char *shader_type_str = shader_type_to_str(program.get_type());
 
-    return load_shader_generic(target, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
+    return load_shader_generic(target, program, features, hints, maskupdate, archive, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
 }
 
-std::string pre_load_shader_glsl(const fs::path &shader_path) {
-    return load_shader_generic<std::string>(shader_path);
+std::string pre_load_shader_glsl(ShaderArchive &archive, const std::string &shader_name) {
+    return load_shader_generic<std::string>(archive, shader_name);
 }
 
-std::vector<uint32_t> pre_load_shader_spirv(const fs::path &shader_path) {
-    return load_shader_generic<std::vector<uint32_t>>(shader_path);
+std::vector<uint32_t> pre_load_shader_spirv(ShaderArchive &archive, const std::string &shader_name) {
+    return load_shader_generic<std::vector<uint32_t>>(archive, shader_name);
 }
 
 } // namespace renderer
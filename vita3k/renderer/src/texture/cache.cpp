@@ -21,13 +21,17 @@
 #include <renderer/texture_cache.h>
 
 #include <gxm/functions.h>
+#include <mem/functions.h>
 #include <mem/ptr.h>
+#include <mem/util.h>
 #include <util/align.h>
 #include <util/log.h>
 
 #include <algorithm>
 #include <cstring>
 #include <numeric>
+#include <tuple>
+#include <utility>
 #if defined(__x86_64__) && !defined(__APPLE__)
 #include <xxh_x86dispatch.h>
 #else
@@ -38,6 +42,15 @@
 namespace renderer {
 namespace texture {
 
+// mips with fewer texels are decompressed right away even if async decoding is enabled
+static constexpr uint32_t ASYNC_DECODE_MIN_TEXELS = 256 * 256;
+
+// granularity of the write tracking
+static constexpr uint32_t TRACKED_PAGE_SIZE = KiB(4);
+// hashed textures whose first mip is at least this large are hashed page by page,
+// the first write to a watched page faults so it is not worth it for smaller textures
+static constexpr uint32_t INCREMENTAL_HASH_MIN_SIZE = 4 * TRACKED_PAGE_SIZE;
+
 static uint64_t hash_data(const void *data, size_t size) {
     return XXH3_64bits(data, size);
 }
@@ -47,6 +60,18 @@ static uint64_t hash_palette_data(const SceGxmTexture &texture, size_t count, co
     return hash_data(palette_bytes, count * sizeof(uint32_t));
 }
 
+// number of colors in the palette of the texture, 0 if it has none
+static uint32_t get_palette_count(const SceGxmTexture &texture) {
+    switch (gxm::get_base_format(gxm::get_format(texture))) {
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
+        return 16;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
+        return 256;
+    default:
+        return 0;
+    }
+}
+
 uint64_t hash_texture_data(const SceGxmTexture &texture, uint32_t texture_size, const MemState &mem) {
     const SceGxmTextureFormat format = gxm::get_format(texture);
     const SceGxmTextureBaseFormat base_format = gxm::get_base_format(format);
@@ -279,6 +304,55 @@ uint64_t hash_texture_nostride(const SceGxmTexture &texture, const MemState &mem
     return hash;
 }
 
+// Hash again the pages of the first mip written since the last call and watch them again, all of them the first time.
+// Watching write-protects the pages, which makes the host writes to them (file reads for example) fail, so without
+// watch every page is hashed again on each call.
+// Returns the range of bytes [begin, end) of the first mip covering the pages whose content changed, { 0, 0 } if none did.
+static std::pair<uint32_t, uint32_t> hash_written_pages(TextureCacheInfo &info, const SceGxmTexture &texture, MemState &mem, bool watch, uint64_t &bytes_hashed) {
+    const Address addr = texture.data_addr << 2;
+    const uint32_t size = info.texture_size;
+    if (addr == 0)
+        return { 0, 0 };
+
+    const uint32_t first_page = addr / TRACKED_PAGE_SIZE;
+    const uint32_t page_count = (addr + size - 1) / TRACKED_PAGE_SIZE - first_page + 1;
+
+    const bool first_hash = info.page_hashes.size() != page_count;
+    const bool hash_all = first_hash || !watch;
+    if (!hash_all && !pages_written_since(mem, addr, size, info.write_generation))
+        return { 0, 0 };
+
+    // watch the pages before reading them, a write made while hashing is then seen by the next call
+    const uint32_t last_generation = info.write_generation;
+    if (watch)
+        info.write_generation = watch_pages(mem, addr, size);
+    info.page_hashes.resize(page_count);
+
+    const uint8_t *data = Ptr<const uint8_t>(addr).get(mem);
+    uint32_t changed_begin = size;
+    uint32_t changed_end = 0;
+    for (uint32_t page = 0; page < page_count; page++) {
+        const uint32_t begin = std::max(addr, (first_page + page) * TRACKED_PAGE_SIZE) - addr;
+        const uint32_t end = std::min(addr + size, (first_page + page + 1) * TRACKED_PAGE_SIZE) - addr;
+        if (!hash_all && !pages_written_since(mem, addr + begin, end - begin, last_generation))
+            continue;
+
+        const uint64_t page_hash = hash_data(data + begin, end - begin);
+        bytes_hashed += end - begin;
+        if (first_hash || page_hash != info.page_hashes[page]) {
+            info.page_hashes[page] = page_hash;
+            changed_begin = std::min(changed_begin, begin);
+            changed_end = end;
+        }
+    }
+
+    if (changed_end == 0)
+        return { 0, 0 };
+
+    info.pages_hash = hash_data(info.page_hashes.data(), info.page_hashes.size() * sizeof(uint64_t));
+    return { changed_begin, changed_end };
+}
+
 uint16_t get_upload_mip(const uint16_t true_mip, const uint16_t width, const uint16_t height) {
     uint16_t max_mip_text = std::bit_width(std::min(width, height));
     return std::min(true_mip, max_mip_text);
@@ -317,7 +391,7 @@ bool TextureCache::init(const bool hashless_texture_cache, const fs::path &textu
     return true;
 }
 
-void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &mem) {
+void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &mem, const uint32_t changed_begin, const uint32_t changed_end) {
     R_PROFILE(__func__);
 
     bool is_vulkan = (backend == renderer::Backend::Vulkan);
@@ -411,6 +485,34 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
     const uint32_t org_layout_width = layout_width;
     const uint32_t org_layout_height = layout_height;
 
+    const bool decompress_on_cpu = (gxm::is_bcn_format(base_format) && !support_dxt) || (gxm::is_pvrt_format(base_format) && !support_pvrt);
+    // the large mips are decompressed in the background and swapped in by cache_and_bind_texture,
+    // textures bound without the cache are decompressed right away
+    std::shared_ptr<DecodeJob> decode_job;
+    if (decompress_on_cpu && async_decoding && !export_textures && current_info)
+        decode_job = std::make_shared<DecodeJob>();
+    // using the pool while the decode thread has it would wait for the job to be done
+    WorkerPool *decode_pool = (decompress_on_cpu && !async_decoding) ? &decoder.get_pool() : nullptr;
+
+    // decompress the texels at pixels or queue them to be decompressed, returns the texels to upload
+    auto decompress_texels = [&](const uint32_t memory_height, const uint32_t bytes_per_texel, const SceGxmTextureBaseFormat upload_format) -> const void * {
+        const size_t decompressed_size = pixels_per_stride * memory_height * bytes_per_texel;
+        if (decode_job && pixels_per_stride * memory_height >= ASYNC_DECODE_MIN_TEXELS) {
+            const uint8_t *compressed = static_cast<const uint8_t *>(pixels);
+            const size_t compressed_size = (pixels_per_stride * memory_height * gxm::bits_per_pixel(base_format)) / 8;
+            decode_job->mips.push_back({ base_format, upload_format, width, height, mip_index, upload_type, pixels_per_stride, memory_height,
+                std::vector<uint8_t>(compressed, compressed + compressed_size) });
+
+            // blank until the decompressed texels are uploaded
+            texture_data_decompressed.assign(decompressed_size, 0);
+            return texture_data_decompressed.data();
+        }
+
+        texture_data_decompressed.resize(decompressed_size);
+        decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, decode_pool);
+        return texture_data_decompressed.data();
+    };
+
     while (face_uploaded_count < face_total_count && org_width > 0 && org_height > 0) {
         pixels = texture_data;
 
@@ -436,6 +538,17 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
         pixels_per_stride = align(pixels_per_stride, align_width);
         memory_height = align(memory_height, align_height);
 
+        // only upload the rows which changed
+        uint32_t first_row = 0;
+        if (changed_end != 0) {
+            const uint32_t block_row_size = (pixels_per_stride * block_height * bpp) / 8;
+            first_row = (changed_begin / block_row_size) * block_height;
+            const uint32_t end_row = std::min(height, (changed_end + block_row_size - 1) / block_row_size * block_height);
+            pixels = texture_data + (first_row / block_height) * block_row_size;
+            height = end_row - first_row;
+            memory_height = align(height, align_height);
+        }
+
         // perform all needed conversions (formats not supported by modern GPUs)
         switch (base_format) {
         case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
@@ -464,13 +577,11 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
             if (!is_swizzled)
                 LOG_ERROR_ONCE("Unhandled non-swizzled PVRT format, please report it to the developers");
 
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
             // this actually also unswizzles the texture
-            decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
+            pixels = decompress_texels(memory_height, 4, upload_format);
             bytes_per_pixel = 4;
             bpp = 32;
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            pixels = texture_data_decompressed.data();
             break;
         case SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2:
             // Convert U8U3U3U2 to U8U8U8U8
@@ -547,11 +658,9 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
                 // just unswizzle the blocks
                 resolve_z_order_compressed_texture(base_format, texture_pixels_lineared.data(), pixels, pixels_per_stride, memory_height);
             else if (is_swizzled)
-                swizzled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
-                    static_cast<std::uint8_t>(bpp));
+                gxm::swizzled_to_linear(texture_pixels_lineared.data(), pixels, pixels_per_stride, memory_height, bpp / 8);
             else
-                tiled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
-                    static_cast<std::uint8_t>(bpp));
+                gxm::tiled_to_linear(texture_pixels_lineared.data(), pixels, pixels_per_stride, memory_height, bpp / 8);
 
             pixels = texture_pixels_lineared.data();
         }
@@ -559,14 +668,13 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
         if (!support_dxt && gxm::is_bcn_format(base_format)) {
             // decompress the texture
             const int num_comp = gxm::get_num_components(base_format);
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * num_comp);
-            decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
-            pixels = texture_data_decompressed.data();
-            bpp = num_comp * 8;
             upload_format = get_matching_decompressed_format(base_format);
+            pixels = decompress_texels(memory_height, num_comp, upload_format);
+            bpp = num_comp * 8;
         }
 
-        upload_texture_impl(upload_format, width, height, mip_index, pixels, upload_type, pixels_per_stride);
+        upload_texture_impl(upload_format, width, height, mip_index, pixels, upload_type, pixels_per_stride, first_row);
+        bytes_uploaded.fetch_add((static_cast<uint64_t>(pixels_per_stride) * height * gxm::bits_per_pixel(upload_format)) / 8, std::memory_order_relaxed);
         if (export_textures)
             export_texture_impl(upload_format, width, height, mip_index, pixels, upload_type, pixels_per_stride);
 
@@ -610,6 +718,11 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
             texture_data += total_source_so_far - source_unaligned_size;
         }
     }
+
+    if (decode_job && !decode_job->mips.empty()) {
+        current_info->pending_decode = decode_job;
+        decoder.submit(decode_job);
+    }
 }
 
 // remove everything related to the sampler state
@@ -651,6 +764,29 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
     Address range_protect_end = 0;
 
     TextureCacheInfo *info;
+    uint64_t hashed = 0;
+    // bytes of the first mip which changed if the texture was hashed page by page
+    uint32_t changed_begin = 0;
+    uint32_t changed_end = 0;
+    const auto update_hash = [&] {
+        if (import_textures || export_textures) {
+            info->hash = hash_texture_nostride(gxm_texture, mem);
+            hashed += info->texture_size;
+            return;
+        }
+
+        const uint32_t palette_count = get_palette_count(gxm_texture);
+        hashed += palette_count * sizeof(uint32_t);
+        if (info->texture_size >= INCREMENTAL_HASH_MIN_SIZE) {
+            std::tie(changed_begin, changed_end) = hash_written_pages(*info, gxm_texture, mem, use_protect, hashed);
+            const uint64_t palette_hash = (palette_count > 0) ? hash_palette_data(gxm_texture, palette_count, mem) : 0;
+            // the xor 1 is to make sure it won't be the same as hash_texture_nostride
+            info->hash = info->pages_hash ^ palette_hash ^ 1;
+        } else {
+            info->hash = hash_texture_data(gxm_texture, info->texture_size, mem) ^ 1;
+            hashed += info->texture_size;
+        }
+    };
     if (cached_gxm_texture_index == -1) {
         // Texture not found in cache.
         // get the least recently used texture, which info_list_head points to
@@ -686,13 +822,10 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         }
 
         info->use_hash = should_use_hash;
-        if (info->use_hash) {
-            if (import_textures || export_textures)
-                info->hash = hash_texture_nostride(gxm_texture, mem);
-            else
-                // the xor 1 is to make sure it won't be the same as hash_texture_nostride
-                info->hash = hash_texture_data(gxm_texture, info->texture_size, mem) ^ 1;
-        }
+        info->page_hashes.clear();
+        info->pages_hash = 0;
+        if (info->use_hash)
+            update_hash();
     } else {
         // Texture is cached.
         index = cached_gxm_texture_index;
@@ -700,11 +833,7 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         configure = false;
         if (info->use_hash) {
             const uint64_t previous_hash = info->hash;
-            if (import_textures || export_textures)
-                info->hash = hash_texture_nostride(gxm_texture, mem);
-            else
-                info->hash = hash_texture_data(gxm_texture, info->texture_size, mem) ^ 1;
-
+            update_hash();
             upload = previous_hash != info->hash;
         } else {
             range_protect_begin = align(gxm_texture.data_addr << 2, mem.host_page_size);
@@ -721,7 +850,10 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
     if (upload && !info->use_hash && (import_textures || export_textures)) {
         // we still need to get a hash of the texture
         info->hash = hash_texture_nostride(gxm_texture, mem);
+        hashed += info->texture_size;
     }
+    if (hashed > 0)
+        bytes_hashed.fetch_add(hashed, std::memory_order_relaxed);
 
     importing_texture = false;
     if (upload && import_textures) {
@@ -739,6 +871,24 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
     if (upload && !importing_texture && info->is_imported)
         configure = true;
 
+    // when only some pages of a linear texture changed, upload the rows they cover over the current content
+    bool upload_rows = false;
+    if (upload && changed_end != 0 && !configure && !info->pending_decode) {
+        const SceGxmTextureBaseFormat base_format = gxm::get_base_format(gxm::get_format(gxm_texture));
+        const auto texture_type = gxm_texture.texture_type();
+        // the other formats are converted or decompressed as a whole
+        upload_rows = (texture_type == SCE_GXM_TEXTURE_LINEAR || texture_type == SCE_GXM_TEXTURE_LINEAR_STRIDED)
+            && get_upload_mip(gxm_texture.true_mip_count(), gxm::get_width(gxm_texture), gxm::get_height(gxm_texture)) == 1
+            && !gxm::is_paletted_format(base_format) && !gxm::is_yuv_format(base_format) && !gxm::is_pvrt_format(base_format)
+            && (support_dxt || !gxm::is_bcn_format(base_format));
+    }
+
+    if (info->pending_decode && (configure || upload)) {
+        // the texels being decompressed are outdated
+        info->pending_decode->canceled = true;
+        info->pending_decode.reset();
+    }
+
     select(index, gxm_texture);
 
     if (configure) {
@@ -757,8 +907,11 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         if (export_textures && !importing_texture)
             export_select(gxm_texture);
 
+        keep_texture_content = upload_rows;
         if (importing_texture)
             import_upload_texture();
+        else if (upload_rows)
+            upload_texture(gxm_texture, mem, changed_begin, changed_end);
         else
             upload_texture(gxm_texture, mem);
 
@@ -774,10 +927,21 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         }
 
         upload_done();
+        keep_texture_content = false;
         if (export_textures && !importing_texture)
             export_done();
         if (importing_texture)
             import_done();
+    } else if (info->pending_decode && info->pending_decode->done.load(std::memory_order_acquire)) {
+        // replace the blank image with the texels decompressed in the background, the small mips were already uploaded
+        keep_texture_content = true;
+        for (const MipDecode &mip : info->pending_decode->mips) {
+            upload_texture_impl(mip.upload_format, mip.width, mip.height, mip.mip_index, mip.data.data(), mip.face, mip.pixels_per_stride, 0);
+            bytes_uploaded.fetch_add(mip.data.size(), std::memory_order_relaxed);
+        }
+        upload_done();
+        keep_texture_content = false;
+        info->pending_decode.reset();
     }
     importing_texture = false;
 
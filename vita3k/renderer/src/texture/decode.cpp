@@ -0,0 +1,88 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_decode.h>
+
+#include <renderer/functions.h>
+
+#include <gxm/functions.h>
+#include <util/log.h>
+
+#include <algorithm>
+
+namespace renderer::texture {
+
+DecodeQueue::~DecodeQueue() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        jobs.clear();
+    }
+    job_cond.notify_one();
+    if (decode_thread.joinable())
+        decode_thread.join();
+}
+
+WorkerPool &DecodeQueue::get_pool() {
+    std::call_once(pool_created, [this] {
+        // the thread calling run() also takes stripes
+        const uint32_t worker_count = std::clamp(std::thread::hardware_concurrency() / 2, 1U, 4U);
+        LOG_INFO("Decompressing textures on the CPU with {} worker threads", worker_count);
+        pool = std::make_unique<WorkerPool>(worker_count);
+    });
+    return *pool;
+}
+
+void DecodeQueue::submit(const std::shared_ptr<DecodeJob> &job) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (!decode_thread.joinable())
+            decode_thread = std::thread(&DecodeQueue::decode_loop, this);
+        jobs.push_back(job);
+    }
+    job_cond.notify_one();
+}
+
+void DecodeQueue::decode_loop() {
+    WorkerPool &workers = get_pool();
+
+    while (true) {
+        std::shared_ptr<DecodeJob> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_cond.wait(lock, [this] { return stop || !jobs.empty(); });
+            if (stop)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        for (auto &mip : job->mips) {
+            if (job->canceled.load(std::memory_order_relaxed))
+                break;
+
+            const uint32_t bytes_per_texel = gxm::is_pvrt_format(mip.base_format) ? 4 : gxm::get_num_components(mip.base_format);
+            std::vector<uint8_t> decompressed(mip.pixels_per_stride * mip.memory_height * bytes_per_texel);
+            decompress_compressed_texture(mip.base_format, decompressed.data(), mip.data.data(), mip.pixels_per_stride, mip.memory_height, &workers);
+            mip.data = std::move(decompressed);
+        }
+
+        job->done.store(true, std::memory_order_release);
+    }
+}
+
+} // namespace renderer::texture
@@ -16,15 +16,34 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <type_traits>
 
+#include <gxm/functions.h>
 #include <gxm/types.h>
 #include <renderer/functions.h>
 #include <renderer/pvrt-dec.h>
+#include <threads/worker_pool.h>
+#include <util/instrset_detect.h>
 #include <util/log.h>
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSSE3 __attribute__((__target__("ssse3")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define TARGET_SSSE3
+#include <intrin.h>
+#else
+#error "Compiler is not supported"
+#endif
+
 namespace renderer::texture {
 
 bool convert_base_texture_format_to_base_color_format(SceGxmTextureBaseFormat format, SceGxmColorBaseFormat &color_format) {
@@ -114,7 +133,26 @@ void resolve_z_order_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest,
             static_cast<std::uint8_t *>(dest), block_size);
 }
 
-uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height) {
+static void decompress_bc_block_rows(uint32_t block_count_x, const uint8_t *block_storage, uint8_t *image, uint8_t format_id,
+    uint32_t first_block_row, uint32_t block_row_count);
+
+// images are split in stripes of this many rows of blocks (or of PVRTC words) to be decompressed in parallel
+static constexpr uint32_t STRIPE_BLOCK_ROWS = 16;
+
+static void decompress_in_stripes(WorkerPool *pool, const uint32_t block_rows, const std::function<void(uint32_t, uint32_t)> &decompress_rows) {
+    const uint32_t stripe_count = (block_rows + STRIPE_BLOCK_ROWS - 1) / STRIPE_BLOCK_ROWS;
+    if (!pool || stripe_count <= 1) {
+        decompress_rows(0, block_rows);
+        return;
+    }
+
+    pool->run(stripe_count, [&](const uint32_t stripe) {
+        const uint32_t first_row = stripe * STRIPE_BLOCK_ROWS;
+        decompress_rows(first_row, std::min(STRIPE_BLOCK_ROWS, block_rows - first_row));
+    });
+}
+
+uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height, WorkerPool *pool) {
     uint8_t format_id = 0;
 
     switch (fmt) {
@@ -151,14 +189,23 @@ uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest,
     }
 
     if (format_id) {
-        decompress_bc_image(width, height, static_cast<const uint8_t *>(data),
-            static_cast<uint32_t *>(dest), format_id);
+        const uint32_t block_count_x = (width + 3) / 4;
+        decompress_in_stripes(pool, (height + 3) / 4, [&](const uint32_t first_row, const uint32_t row_count) {
+            decompress_bc_block_rows(block_count_x, static_cast<const uint8_t *>(data), static_cast<uint8_t *>(dest), format_id, first_row, row_count);
+        });
         return (((width + 3) / 4) * ((height + 3) / 4) * ((format_id != 1 && format_id != 4 && format_id != 5) ? 16 : 8));
     } else if ((fmt >= SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP) && (fmt <= SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP)) {
-        pvr::PVRTDecompressPVRTC(data, (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP) || (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP), width, height,
-            (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP) || (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP), static_cast<uint8_t *>(dest));
-
         const bool is_2bpp = (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP) || (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP);
+        const bool is_pvrtii = (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP) || (fmt == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP);
+
+        if (width >= (is_2bpp ? 16 : 8) && height >= 8) {
+            decompress_in_stripes(pool, height / 4, [&](const uint32_t first_row, const uint32_t row_count) {
+                pvr::PVRTDecompressPVRTCRows(data, is_2bpp, width, height, is_pvrtii, static_cast<uint8_t *>(dest), first_row, row_count);
+            });
+        } else {
+            // too small to be split, the decoder needs a temporary image
+            pvr::PVRTDecompressPVRTC(data, is_2bpp, width, height, is_pvrtii, static_cast<uint8_t *>(dest));
+        }
 
         const uint32_t num_xword = (width + (is_2bpp ? 7 : 3)) / (is_2bpp ? 8 : 4);
         const uint32_t num_yword = (height + 3) / 4;
@@ -294,103 +341,6 @@ void convert_u2f10f10f10_to_f16f16f16f16(void *dest, const void *data, const uin
     }
 }
 
-// Based on this: http://xen.firefly.nu/up/rearrange.c.html
-// https://fgiesen.wordpress.com/2009/12/13/decoding-morton-codes/
-// Thanks daniel from GXTConvert finding this out first
-
-// Inverse of Part1By1 - "delete" all odd-indexed bits
-static uint32_t compact_one_by_one(uint32_t x) {
-    x &= 0x55555555; // x = -f-e -d-c -b-a -9-8 -7-6 -5-4 -3-2 -1-0
-    x = (x ^ (x >> 1)) & 0x33333333; // x = --fe --dc --ba --98 --76 --54 --32 --10
-    x = (x ^ (x >> 2)) & 0x0f0f0f0f; // x = ---- fedc ---- ba98 ---- 7654 ---- 3210
-    x = (x ^ (x >> 4)) & 0x00ff00ff; // x = ---- ---- fedc ba98 ---- ---- 7654 3210
-    x = (x ^ (x >> 8)) & 0x0000ffff; // x = ---- ---- ---- ---- fedc ba98 7654 3210
-    return x;
-}
-
-uint32_t decode_morton2_y(uint32_t code) {
-    return compact_one_by_one(code >> 0);
-}
-
-uint32_t decode_morton2_x(uint32_t code) {
-    return compact_one_by_one(code >> 1);
-}
-
-static uint32_t Part1By1(uint32_t x) {
-    x &= 0x0000ffff; // x = ---- ---- ---- ---- fedc ba98 7654 3210
-    x = (x ^ (x << 8)) & 0x00ff00ff; // x = ---- ---- fedc ba98 ---- ---- 7654 3210
-    x = (x ^ (x << 4)) & 0x0f0f0f0f; // x = ---- fedc ---- ba98 ---- 7654 ---- 3210
-    x = (x ^ (x << 2)) & 0x33333333; // x = --fe --dc --ba --98 --76 --54 --32 --10
-    x = (x ^ (x << 1)) & 0x55555555; // x = -f-e -d-c -b-a -9-8 -7-6 -5-4 -3-2 -1-0
-    return x;
-}
-
-uint32_t encode_morton(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
-    assert((width & (width - 1)) == 0);
-    assert((height & (height - 1)) == 0);
-
-    // assuming width < height:
-    // xxxxxxx yyyy
-    uint16_t min = std::min(width, height);
-    uint32_t k = std::bit_width(min) - 1;
-    // upper unswizzled bits
-    // xxx--------
-    uint32_t result = static_cast<uint32_t>((x >> k) | (y >> k)) << 2 * k;
-    // xxxx-x-x-x-
-    result |= (Part1By1(x & (min - 1)) << 1);
-    // xxxxyxyxyxy
-    result |= Part1By1(y & (min - 1));
-    return result;
-}
-
-void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
-    if (bits_per_pixel % 8 != 0) {
-        // Don't support yet
-        return;
-    }
-
-    uint8_t bytes_per_pixel = (bits_per_pixel + 7) >> 3;
-    uint32_t min = std::min(width, height);
-    uint32_t k = std::bit_width(min) - 1;
-
-    for (uint32_t i = 0; i < width * static_cast<uint32_t>(height); i++) {
-        uint32_t x = decode_morton2_x(i) & (min - 1);
-        uint32_t y = decode_morton2_y(i) & (min - 1);
-        uint32_t upper_bits = (i >> (2 * k)) << k;
-        if (width >= height) {
-            x |= upper_bits;
-        } else {
-            y |= upper_bits;
-        }
-
-        memcpy(dest + (y * width + x) * bytes_per_pixel, src + i * bytes_per_pixel, bytes_per_pixel);
-    }
-}
-
-void tiled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
-    // 32x32 block is assembled to tiled.
-    if (bits_per_pixel % 8 != 0) {
-        // Don't support yet
-        return;
-    }
-
-    const uint32_t bpp = bits_per_pixel >> 3;
-    const uint32_t width_in_tiles = (width + 31) >> 5;
-
-    for (uint16_t y = 0; y < height; y++) {
-        for (uint16_t x = 0; x < width; x++) {
-            // Calculate texel address in tile
-            const uint32_t texel_offset_in_tile = (x & 0b11111) | ((y & 0b11111) << 5);
-            const uint32_t tile_address = (x >> 5) + width_in_tiles * (y >> 5);
-
-            const uint32_t offset = ((tile_address << 10) | (texel_offset_in_tile)) * bpp;
-
-            // Make scanline
-            memcpy(dest + ((y * width) + x) * bpp, src + offset, bpp);
-        }
-    }
-}
-
 uint32_t get_compressed_size(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height) {
     switch (base_format) {
     case SCE_GXM_TEXTURE_BASE_FORMAT_UBC1:
@@ -426,19 +376,24 @@ uint32_t get_compressed_size(SceGxmTextureBaseFormat base_format, uint32_t width
 // and unswizzled on the CPU.
 
 // This BC decompression code is based on code from AMD GPUOpen's Compressonator
+// Each block is written directly to the 4 rows of the image it covers: the palette of the block is computed once,
+// then the texels are looked up in it from their indices, a whole row at a time with SSSE3 or NEON.
+
+// writes the 4 rows of a color block, pitch is in texels, alpha (if not null) replaces the alpha of the 16 texels
+using ColorRowsFunc = void (*)(uint32_t *dest, size_t pitch, const uint32_t palette[4], uint32_t indices, const uint8_t *alpha);
+// dest[i] = palette[indices[i]] for the 16 texels of a block
+using LookupAlphaFunc = void (*)(uint8_t *dest, const uint8_t palette[8], const uint8_t indices[16]);
 
 /**
- * \brief Decompresses one block of a BC1 texture and stores the resulting pixels at the appropriate offset in 'image'.
+ * \brief Computes the 4 colors of the color part of a BC1, BC2 or BC3 block.
  *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
+ * \param block_storage     pointer to the color part of the block.
+ * \param palette           colors indexed by the 2-bit indices of the block.
  **/
-static void decompress_block_bc1(const uint8_t *block_storage, uint32_t *image) {
+static void get_color_palette(const uint8_t *block_storage, uint32_t palette[4]) {
     std::uint16_t n0 = static_cast<std::uint16_t>((block_storage[1] << 8) | block_storage[0]);
     std::uint16_t n1 = static_cast<std::uint16_t>((block_storage[3] << 8) | block_storage[2]);
 
-    block_storage += 4;
-
     std::uint8_t r0 = (n0 & 0xF800) >> 8;
     std::uint8_t g0 = (n0 & 0x07E0) >> 3;
     std::uint8_t b0 = (n0 & 0x001F) << 3;
@@ -454,8 +409,8 @@ static void decompress_block_bc1(const uint8_t *block_storage, uint32_t *image)
     b0 |= b0 >> 5;
     b1 |= b1 >> 5;
 
-    std::uint32_t c0 = 0xFF000000 | (b0 << 16) | (g0 << 8) | r0;
-    std::uint32_t c1 = 0xFF000000 | (b1 << 16) | (g1 << 8) | r1;
+    palette[0] = 0xFF000000 | (b0 << 16) | (g0 << 8) | r0;
+    palette[1] = 0xFF000000 | (b1 << 16) | (g1 << 8) | r1;
 
     if (n0 > n1) {
         std::uint8_t r2 = static_cast<uint8_t>((2 * r0 + r1 + 1) / 3);
@@ -465,293 +420,308 @@ static void decompress_block_bc1(const uint8_t *block_storage, uint32_t *image)
         std::uint8_t b2 = static_cast<uint8_t>((2 * b0 + b1 + 1) / 3);
         std::uint8_t b3 = static_cast<uint8_t>((2 * b1 + b0 + 1) / 3);
 
-        std::uint32_t c2 = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
-        std::uint32_t c3 = 0xFF000000 | (b3 << 16) | (g3 << 8) | r3;
-
-        for (int i = 0; i < 16; ++i) {
-            int index = (block_storage[i / 4] >> (i % 4 * 2)) & 0x03;
-            switch (index) {
-            case 0:
-                image[i] = c0;
-                break;
-            case 1:
-                image[i] = c1;
-                break;
-            case 2:
-                image[i] = c2;
-                break;
-            case 3:
-                image[i] = c3;
-                break;
-            }
-        }
+        palette[2] = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
+        palette[3] = 0xFF000000 | (b3 << 16) | (g3 << 8) | r3;
     } else {
         // Transparent decode
         std::uint8_t r2 = static_cast<uint8_t>((r0 + r1) / 2);
         std::uint8_t g2 = static_cast<uint8_t>((g0 + g1) / 2);
         std::uint8_t b2 = static_cast<uint8_t>((b0 + b1) / 2);
 
-        std::uint32_t c2 = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
-
-        for (int i = 0; i < 16; ++i) {
-            int index = (block_storage[i / 4] >> (i % 4 * 2)) & 0x03;
-            switch (index) {
-            case 0:
-                image[i] = c0;
-                break;
-            case 1:
-                image[i] = c1;
-                break;
-            case 2:
-                image[i] = c2;
-                break;
-            case 3:
-                image[i] = 0x00000000;
-                break;
-            }
-        }
+        palette[2] = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
+        palette[3] = 0x00000000;
     }
 }
 
 /**
- * \brief Decompresses one block of a alpha texture and stores the resulting pixels at the appropriate offset in 'image'.
+ * \brief Computes the 8 values of an alpha block (BC3 alpha, BC4 and BC5 channels).
  *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- * \param offset            offset to where data should be written.
- * \param stride            stride between bytes to where data should be written.
+ * \param block_storage     pointer to the alpha block.
+ * \param palette           values indexed by the 3-bit indices of the block, as signed bytes if is_signed is set.
  **/
-static void decompress_block_alpha(const uint8_t *block_storage, uint8_t *image, const uint32_t offset, const uint32_t stride) {
-    uint8_t alpha[8];
+template <bool is_signed>
+static void get_alpha_palette(const uint8_t *block_storage, uint8_t palette[8]) {
+    using T = std::conditional_t<is_signed, int8_t, uint8_t>;
+    T alpha[8];
 
-    alpha[0] = block_storage[0];
-    alpha[1] = block_storage[1];
+    alpha[0] = static_cast<T>(block_storage[0]);
+    alpha[1] = static_cast<T>(block_storage[1]);
 
     if (alpha[0] > alpha[1]) {
         // 8-alpha block:  derive the other six alphas.
         // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-        alpha[2] = static_cast<uint8_t>((6 * alpha[0] + 1 * alpha[1] + 3) / 7); // bit code 010
-        alpha[3] = static_cast<uint8_t>((5 * alpha[0] + 2 * alpha[1] + 3) / 7); // bit code 011
-        alpha[4] = static_cast<uint8_t>((4 * alpha[0] + 3 * alpha[1] + 3) / 7); // bit code 100
-        alpha[5] = static_cast<uint8_t>((3 * alpha[0] + 4 * alpha[1] + 3) / 7); // bit code 101
-        alpha[6] = static_cast<uint8_t>((2 * alpha[0] + 5 * alpha[1] + 3) / 7); // bit code 110
-        alpha[7] = static_cast<uint8_t>((1 * alpha[0] + 6 * alpha[1] + 3) / 7); // bit code 111
+        alpha[2] = static_cast<T>((6 * alpha[0] + 1 * alpha[1] + 3) / 7); // bit code 010
+        alpha[3] = static_cast<T>((5 * alpha[0] + 2 * alpha[1] + 3) / 7); // bit code 011
+        alpha[4] = static_cast<T>((4 * alpha[0] + 3 * alpha[1] + 3) / 7); // bit code 100
+        alpha[5] = static_cast<T>((3 * alpha[0] + 4 * alpha[1] + 3) / 7); // bit code 101
+        alpha[6] = static_cast<T>((2 * alpha[0] + 5 * alpha[1] + 3) / 7); // bit code 110
+        alpha[7] = static_cast<T>((1 * alpha[0] + 6 * alpha[1] + 3) / 7); // bit code 111
     } else {
         // 6-alpha block.
         // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-        alpha[2] = static_cast<uint8_t>((4 * alpha[0] + 1 * alpha[1] + 2) / 5); // Bit code 010
-        alpha[3] = static_cast<uint8_t>((3 * alpha[0] + 2 * alpha[1] + 2) / 5); // Bit code 011
-        alpha[4] = static_cast<uint8_t>((2 * alpha[0] + 3 * alpha[1] + 2) / 5); // Bit code 100
-        alpha[5] = static_cast<uint8_t>((1 * alpha[0] + 4 * alpha[1] + 2) / 5); // Bit code 101
-        alpha[6] = 0; // Bit code 110
-        alpha[7] = 255; // Bit code 111
+        alpha[2] = static_cast<T>((4 * alpha[0] + 1 * alpha[1] + 2) / 5); // Bit code 010
+        alpha[3] = static_cast<T>((3 * alpha[0] + 2 * alpha[1] + 2) / 5); // Bit code 011
+        alpha[4] = static_cast<T>((2 * alpha[0] + 3 * alpha[1] + 2) / 5); // Bit code 100
+        alpha[5] = static_cast<T>((1 * alpha[0] + 4 * alpha[1] + 2) / 5); // Bit code 101
+        alpha[6] = is_signed ? -128 : 0; // Bit code 110
+        alpha[7] = is_signed ? 127 : 255; // Bit code 111
     }
 
-    image += offset;
-
-    image[stride * 0] = alpha[block_storage[2] & 0x07];
-    image[stride * 1] = alpha[(block_storage[2] >> 3) & 0x07];
-    image[stride * 2] = alpha[((block_storage[3] << 2) & 0x04) | ((block_storage[2] >> 6) & 0x03)];
-    image[stride * 3] = alpha[(block_storage[3] >> 1) & 0x07];
-    image[stride * 4] = alpha[(block_storage[3] >> 4) & 0x07];
-    image[stride * 5] = alpha[((block_storage[4] << 1) & 0x06) | ((block_storage[3] >> 7) & 0x01)];
-    image[stride * 6] = alpha[(block_storage[4] >> 2) & 0x07];
-    image[stride * 7] = alpha[(block_storage[4] >> 5) & 0x07];
-    image[stride * 8] = alpha[block_storage[5] & 0x07];
-    image[stride * 9] = alpha[(block_storage[5] >> 3) & 0x07];
-    image[stride * 10] = alpha[((block_storage[6] << 2) & 0x04) | ((block_storage[5] >> 6) & 0x03)];
-    image[stride * 11] = alpha[(block_storage[6] >> 1) & 0x07];
-    image[stride * 12] = alpha[(block_storage[6] >> 4) & 0x07];
-    image[stride * 13] = alpha[((block_storage[7] << 1) & 0x06) | ((block_storage[6] >> 7) & 0x01)];
-    image[stride * 14] = alpha[(block_storage[7] >> 2) & 0x07];
-    image[stride * 15] = alpha[(block_storage[7] >> 5) & 0x07];
+    memcpy(palette, alpha, sizeof(alpha));
 }
 
-/**
- * \brief Decompresses one block of a signed alpha texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- * \param offset            offset to where data should be written.
- * \param stride            stride between bytes to where data should be written.
- **/
-static void decompress_block_alpha_signed(const uint8_t *block_storage, uint8_t *image, const uint32_t offset, const uint32_t stride) {
-    int8_t alpha[8];
-
-    alpha[0] = static_cast<int8_t>(block_storage[0]);
-    alpha[1] = static_cast<int8_t>(block_storage[1]);
+// the 16 3-bit indices of an alpha block are stored in its last 6 bytes
+static void get_alpha_indices(const uint8_t *block_storage, uint8_t indices[16]) {
+    uint64_t bits = 0;
+    memcpy(&bits, block_storage + 2, 6);
+    for (int i = 0; i < 16; i++)
+        indices[i] = (bits >> (3 * i)) & 0x07;
+}
 
-    if (alpha[0] > alpha[1]) {
-        // 8-alpha block:  derive the other six alphas.
-        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-        alpha[2] = static_cast<int8_t>((6 * alpha[0] + 1 * alpha[1] + 3) / 7); // bit code 010
-        alpha[3] = static_cast<int8_t>((5 * alpha[0] + 2 * alpha[1] + 3) / 7); // bit code 011
-        alpha[4] = static_cast<int8_t>((4 * alpha[0] + 3 * alpha[1] + 3) / 7); // bit code 100
-        alpha[5] = static_cast<int8_t>((3 * alpha[0] + 4 * alpha[1] + 3) / 7); // bit code 101
-        alpha[6] = static_cast<int8_t>((2 * alpha[0] + 5 * alpha[1] + 3) / 7); // bit code 110
-        alpha[7] = static_cast<int8_t>((1 * alpha[0] + 6 * alpha[1] + 3) / 7); // bit code 111
-    } else {
-        // 6-alpha block.
-        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-        alpha[2] = static_cast<int8_t>((4 * alpha[0] + 1 * alpha[1] + 2) / 5); // Bit code 010
-        alpha[3] = static_cast<int8_t>((3 * alpha[0] + 2 * alpha[1] + 2) / 5); // Bit code 011
-        alpha[4] = static_cast<int8_t>((2 * alpha[0] + 3 * alpha[1] + 2) / 5); // Bit code 100
-        alpha[5] = static_cast<int8_t>((1 * alpha[0] + 4 * alpha[1] + 2) / 5); // Bit code 101
-        alpha[6] = -128; // Bit code 110
-        alpha[7] = 127; // Bit code 111
+template <bool has_alpha>
+static void color_rows_basic(uint32_t *dest, size_t pitch, const uint32_t palette[4], uint32_t indices, const uint8_t *alpha) {
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int i = y * 4 + x;
+            uint32_t color = palette[(indices >> (2 * i)) & 0x03];
+            if constexpr (has_alpha)
+                color = (color & 0x00FFFFFF) | (alpha[i] << 24);
+            dest[y * pitch + x] = color;
+        }
     }
-
-    image += offset;
-
-    image[stride * 0] = static_cast<uint8_t>(alpha[block_storage[2] & 0x07]);
-    image[stride * 1] = static_cast<uint8_t>(alpha[(block_storage[2] >> 3) & 0x07]);
-    image[stride * 2] = static_cast<uint8_t>(alpha[((block_storage[3] << 2) & 0x04) | ((block_storage[2] >> 6) & 0x03)]);
-    image[stride * 3] = static_cast<uint8_t>(alpha[(block_storage[3] >> 1) & 0x07]);
-    image[stride * 4] = static_cast<uint8_t>(alpha[(block_storage[3] >> 4) & 0x07]);
-    image[stride * 5] = static_cast<uint8_t>(alpha[((block_storage[4] << 1) & 0x06) | ((block_storage[3] >> 7) & 0x01)]);
-    image[stride * 6] = static_cast<uint8_t>(alpha[(block_storage[4] >> 2) & 0x07]);
-    image[stride * 7] = static_cast<uint8_t>(alpha[(block_storage[4] >> 5) & 0x07]);
-    image[stride * 8] = static_cast<uint8_t>(alpha[block_storage[5] & 0x07]);
-    image[stride * 9] = static_cast<uint8_t>(alpha[(block_storage[5] >> 3) & 0x07]);
-    image[stride * 10] = static_cast<uint8_t>(alpha[((block_storage[6] << 2) & 0x04) | ((block_storage[5] >> 6) & 0x03)]);
-    image[stride * 11] = static_cast<uint8_t>(alpha[(block_storage[6] >> 1) & 0x07]);
-    image[stride * 12] = static_cast<uint8_t>(alpha[(block_storage[6] >> 4) & 0x07]);
-    image[stride * 13] = static_cast<uint8_t>(alpha[((block_storage[7] << 1) & 0x06) | ((block_storage[6] >> 7) & 0x01)]);
-    image[stride * 14] = static_cast<uint8_t>(alpha[(block_storage[7] >> 2) & 0x07]);
-    image[stride * 15] = static_cast<uint8_t>(alpha[(block_storage[7] >> 5) & 0x07]);
 }
 
-/**
- * \brief Decompresses one block of a BC2 texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- **/
-static void decompress_block_bc2(const uint8_t *block_storage, uint32_t *image) {
-    decompress_block_bc1(block_storage + 8, image);
+static void lookup_alpha_basic(uint8_t *dest, const uint8_t palette[8], const uint8_t indices[16]) {
+    for (int i = 0; i < 16; i++)
+        dest[i] = palette[indices[i]];
+}
 
-    for (int i = 0; i < 8; i++) {
-        image[2 * i] = (((block_storage[i] & 0x0F) | ((block_storage[i] & 0x0F) << 4)) << 24) | (image[2 * i] & 0x00FFFFFF);
-        image[2 * i + 1] = (((block_storage[i] & 0xF0) | ((block_storage[i] & 0xF0) >> 4)) << 24) | (image[2 * i + 1] & 0x00FFFFFF);
+// byte shuffle gathering the 4 colors (4 bytes each) selected by the 2-bit indices of one row
+static constexpr auto COLOR_ROW_SHUFFLES = [] {
+    std::array<std::array<uint8_t, 16>, 256> shuffles{};
+    for (uint32_t row = 0; row < 256; row++) {
+        for (uint32_t x = 0; x < 4; x++) {
+            for (uint32_t byte = 0; byte < 4; byte++)
+                shuffles[row][x * 4 + byte] = static_cast<uint8_t>(((row >> (2 * x)) & 0x03) * 4 + byte);
+        }
+    }
+    return shuffles;
+}();
+
+// byte shuffle moving the 4 alphas of row y to the top byte of each texel, the other bytes are zeroed
+static constexpr auto ALPHA_ROW_SHUFFLES = [] {
+    std::array<std::array<uint8_t, 16>, 4> shuffles{};
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++) {
+            shuffles[y][x * 4 + 0] = 0x80;
+            shuffles[y][x * 4 + 1] = 0x80;
+            shuffles[y][x * 4 + 2] = 0x80;
+            shuffles[y][x * 4 + 3] = static_cast<uint8_t>(y * 4 + x);
+        }
+    }
+    return shuffles;
+}();
+
+#if defined(__aarch64__)
+template <bool has_alpha>
+static void color_rows_neon(uint32_t *dest, size_t pitch, const uint32_t palette[4], uint32_t indices, const uint8_t *alpha) {
+    const uint8x16_t colors = vld1q_u8(reinterpret_cast<const uint8_t *>(palette));
+    uint8x16_t alphas;
+    if constexpr (has_alpha)
+        alphas = vld1q_u8(alpha);
+
+    for (int y = 0; y < 4; y++) {
+        uint8x16_t row = vqtbl1q_u8(colors, vld1q_u8(COLOR_ROW_SHUFFLES[(indices >> (8 * y)) & 0xFF].data()));
+        if constexpr (has_alpha) {
+            // out of range indices give 0 with tbl
+            const uint8x16_t row_alpha = vqtbl1q_u8(alphas, vld1q_u8(ALPHA_ROW_SHUFFLES[y].data()));
+            row = vorrq_u8(vreinterpretq_u8_u32(vandq_u32(vreinterpretq_u32_u8(row), vdupq_n_u32(0x00FFFFFF))), row_alpha);
+        }
+        vst1q_u8(reinterpret_cast<uint8_t *>(dest + y * pitch), row);
     }
 }
 
-/**
- * \brief Decompresses one block of a BC3 texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- **/
-static void decompress_block_bc3(const uint8_t *block_storage, uint32_t *image) {
-    decompress_block_bc1(block_storage + 8, image);
-    decompress_block_alpha(block_storage, reinterpret_cast<std::uint8_t *>(image), 3, 4);
+static void lookup_alpha_neon(uint8_t *dest, const uint8_t palette[8], const uint8_t indices[16]) {
+    const uint8x16_t values = vcombine_u8(vld1_u8(palette), vdup_n_u8(0));
+    vst1q_u8(dest, vqtbl1q_u8(values, vld1q_u8(indices)));
 }
-
-/**
- * \brief Decompresses one block of a BC4U texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- **/
-static void decompress_block_bc4u(const uint8_t *block_storage, uint8_t *image) {
-    for (int i = 0; i < 16; i++)
-        image[i] = 0x00;
-    decompress_block_alpha(block_storage, image, 0, 1);
+#else
+template <bool has_alpha>
+TARGET_SSSE3 static void color_rows_ssse3(uint32_t *dest, size_t pitch, const uint32_t palette[4], uint32_t indices, const uint8_t *alpha) {
+    const __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i *>(palette));
+    __m128i alphas;
+    if constexpr (has_alpha)
+        alphas = _mm_loadu_si128(reinterpret_cast<const __m128i *>(alpha));
+
+    for (int y = 0; y < 4; y++) {
+        __m128i row = _mm_shuffle_epi8(colors, _mm_loadu_si128(reinterpret_cast<const __m128i *>(COLOR_ROW_SHUFFLES[(indices >> (8 * y)) & 0xFF].data())));
+        if constexpr (has_alpha) {
+            // indices with the top bit set give 0 with pshufb
+            const __m128i row_alpha = _mm_shuffle_epi8(alphas, _mm_loadu_si128(reinterpret_cast<const __m128i *>(ALPHA_ROW_SHUFFLES[y].data())));
+            row = _mm_or_si128(_mm_and_si128(row, _mm_set1_epi32(0x00FFFFFF)), row_alpha);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + y * pitch), row);
+    }
 }
 
-/**
- * \brief Decompresses one block of a BC4S texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- **/
-static void decompress_block_bc4s(const uint8_t *block_storage, uint8_t *image) {
-    for (int i = 0; i < 16; i++)
-        image[i] = 0x00;
-    decompress_block_alpha_signed(block_storage, image, 0, 1);
+TARGET_SSSE3 static void lookup_alpha_ssse3(uint8_t *dest, const uint8_t palette[8], const uint8_t indices[16]) {
+    const __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(palette));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), _mm_shuffle_epi8(values, _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices))));
 }
+#endif
+
+struct BCKernels {
+    ColorRowsFunc color_rows;
+    ColorRowsFunc color_alpha_rows;
+    LookupAlphaFunc lookup_alpha;
+};
+
+static BCKernels select_bc_kernels() {
+#if defined(__aarch64__)
+    return { color_rows_neon<false>, color_rows_neon<true>, lookup_alpha_neon };
+#else
+    if (util::instrset::instrset_detect() >= util::instrset::instrset_SSSE3) {
+        LOG_INFO("SSSE3 instruction set is supported. Using SSSE3 BCn texture decompression");
+        return { color_rows_ssse3<false>, color_rows_ssse3<true>, lookup_alpha_ssse3 };
+    }
 
-/**
- * \brief Decompresses one block of a BC5U texture and stores the resulting pixels at the appropriate offset in 'image'.
- *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
- **/
-static void decompress_block_bc5u(const uint8_t *block_storage, uint16_t *image) {
-    for (int i = 0; i < 16; i++)
-        image[i] = 0x0000;
-    decompress_block_alpha(block_storage, reinterpret_cast<uint8_t *>(image), 0, 2);
-    decompress_block_alpha(block_storage + 8, reinterpret_cast<uint8_t *>(image), 1, 2);
+    LOG_INFO("SSSE3 instruction set is not supported. Using basic BCn texture decompression");
+    return { color_rows_basic<false>, color_rows_basic<true>, lookup_alpha_basic };
+#endif
 }
 
 /**
- * \brief Decompresses one block of a BC5S texture and stores the resulting pixels at the appropriate offset in 'image'.
+ * \brief Decompresses the block rows [first_block_row, first_block_row + block_row_count) of a BCn image.
  *
- * \param block_storage     pointer to the block to decompress.
- * \param image             pointer to image where the decompressed pixel data should be stored.
+ * \param block_count_x     number of blocks in a row, the image has a pitch of block_count_x * 4 texels.
+ * \param block_storage     pointer to the first block of the image.
+ * \param image             pointer to the first texel of the image.
+ * \param format_id         same as decompress_bc_image.
  **/
-static void decompress_block_bc5s(const uint8_t *block_storage, uint16_t *image) {
-    for (int i = 0; i < 16; i++)
-        image[i] = 0x0000;
-    decompress_block_alpha_signed(block_storage, reinterpret_cast<uint8_t *>(image), 0, 2);
-    decompress_block_alpha_signed(block_storage + 8, reinterpret_cast<uint8_t *>(image), 1, 2);
-}
+static void decompress_bc_block_rows(const uint32_t block_count_x, const uint8_t *block_storage, uint8_t *image, const uint8_t format_id,
+    const uint32_t first_block_row, const uint32_t block_row_count) {
+    static const BCKernels kernels = select_bc_kernels();
 
-void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id) {
-    const uint32_t block_count_x = (width + 3) / 4;
-    const uint32_t block_count_y = (height + 3) / 4;
     const uint32_t block_size = (format_id != 1 && format_id != 4 && format_id != 5) ? 16 : 8;
-    const uint32_t line_size = block_count_x * 4;
+    const size_t pitch = block_count_x * 4;
 
-    auto decompress_bcn = [=, &block_storage]<typename T, typename F>(T _, F decompress_func) {
-        T temp_block_result[16] = {};
-        T *img = reinterpret_cast<T *>(image);
-
-        for (uint32_t j = 0; j < block_count_y; j++) {
+    auto for_each_block = [&]<typename T, typename F>(T _, F decompress_block) {
+        for (uint32_t j = first_block_row; j < first_block_row + block_row_count; j++) {
+            const uint8_t *block = block_storage + static_cast<size_t>(j) * block_count_x * block_size;
+            T *row = reinterpret_cast<T *>(image) + j * 4 * pitch;
             for (uint32_t i = 0; i < block_count_x; i++) {
-                decompress_func(block_storage, temp_block_result);
+                decompress_block(block, row + i * 4);
+                block += block_size;
+            }
+        }
+    };
 
-                const uint32_t offset = j * 4 * line_size + i * 4;
-                for (uint32_t delta = 0; delta < 16; delta++) {
-                    img[offset + (delta % 4) + ((delta / 4) * line_size)] = temp_block_result[delta];
-                }
+    auto color_indices = [](const uint8_t *block) {
+        uint32_t indices;
+        memcpy(&indices, block + 4, sizeof(indices));
+        return indices;
+    };
 
-                block_storage += block_size;
+    // 4 rows of 4 bytes (BC4) or 4 rows of 8 bytes (BC5) from the 16 values of the channels
+    auto write_channels = []<typename T>(T *dest, const size_t pitch, const uint8_t *first, const uint8_t *second) {
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                if constexpr (sizeof(T) == 1)
+                    dest[y * pitch + x] = first[y * 4 + x];
+                else
+                    dest[y * pitch + x] = first[y * 4 + x] | (second[y * 4 + x] << 8);
             }
         }
     };
 
+    auto decompress_bc4 = [&]<bool is_signed>(const uint8_t *block, uint8_t *dest) {
+        uint8_t palette[8];
+        uint8_t indices[16];
+        uint8_t values[16];
+        get_alpha_palette<is_signed>(block, palette);
+        get_alpha_indices(block, indices);
+        kernels.lookup_alpha(values, palette, indices);
+        write_channels(dest, pitch, values, nullptr);
+    };
+
+    auto decompress_bc5 = [&]<bool is_signed>(const uint8_t *block, uint16_t *dest) {
+        uint8_t palette[8];
+        uint8_t indices[16];
+        uint8_t red[16];
+        uint8_t green[16];
+        get_alpha_palette<is_signed>(block, palette);
+        get_alpha_indices(block, indices);
+        kernels.lookup_alpha(red, palette, indices);
+        get_alpha_palette<is_signed>(block + 8, palette);
+        get_alpha_indices(block + 8, indices);
+        kernels.lookup_alpha(green, palette, indices);
+        write_channels(dest, pitch, red, green);
+    };
+
     switch (format_id) {
     case 1:
-        decompress_bcn(uint32_t(), decompress_block_bc1);
+        for_each_block(uint32_t(), [&](const uint8_t *block, uint32_t *dest) {
+            uint32_t palette[4];
+            get_color_palette(block, palette);
+            kernels.color_rows(dest, pitch, palette, color_indices(block), nullptr);
+        });
         break;
 
     case 2:
-        decompress_bcn(uint32_t(), decompress_block_bc2);
+        for_each_block(uint32_t(), [&](const uint8_t *block, uint32_t *dest) {
+            // explicit 4-bit alphas
+            uint8_t alpha[16];
+            for (int i = 0; i < 8; i++) {
+                alpha[2 * i] = (block[i] & 0x0F) | ((block[i] & 0x0F) << 4);
+                alpha[2 * i + 1] = (block[i] & 0xF0) | ((block[i] & 0xF0) >> 4);
+            }
+
+            uint32_t palette[4];
+            get_color_palette(block + 8, palette);
+            kernels.color_alpha_rows(dest, pitch, palette, color_indices(block + 8), alpha);
+        });
         break;
 
     case 3:
-        decompress_bcn(uint32_t(), decompress_block_bc3);
+        for_each_block(uint32_t(), [&](const uint8_t *block, uint32_t *dest) {
+            uint8_t alpha_palette[8];
+            uint8_t alpha_indices[16];
+            uint8_t alpha[16];
+            get_alpha_palette<false>(block, alpha_palette);
+            get_alpha_indices(block, alpha_indices);
+            kernels.lookup_alpha(alpha, alpha_palette, alpha_indices);
+
+            uint32_t palette[4];
+            get_color_palette(block + 8, palette);
+            kernels.color_alpha_rows(dest, pitch, palette, color_indices(block + 8), alpha);
+        });
         break;
 
     case 4:
-        decompress_bcn(uint8_t(), decompress_block_bc4u);
+        for_each_block(uint8_t(), [&](const uint8_t *block, uint8_t *dest) { decompress_bc4.template operator()<false>(block, dest); });
         break;
 
     case 5:
-        decompress_bcn(uint8_t(), decompress_block_bc4s);
+        for_each_block(uint8_t(), [&](const uint8_t *block, uint8_t *dest) { decompress_bc4.template operator()<true>(block, dest); });
         break;
 
     case 6:
-        decompress_bcn(uint16_t(), decompress_block_bc5u);
+        for_each_block(uint16_t(), [&](const uint8_t *block, uint16_t *dest) { decompress_bc5.template operator()<false>(block, dest); });
         break;
 
     case 7:
-        decompress_bcn(uint16_t(), decompress_block_bc5s);
+        for_each_block(uint16_t(), [&](const uint8_t *block, uint16_t *dest) { decompress_bc5.template operator()<true>(block, dest); });
         break;
     }
 }
 
+void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id) {
+    const uint32_t block_count_x = (width + 3) / 4;
+    const uint32_t block_count_y = (height + 3) / 4;
+
+    decompress_bc_block_rows(block_count_x, block_storage, reinterpret_cast<uint8_t *>(image), format_id, 0, block_count_y);
+}
+
 /**
  * \brief Solves Z-order on all the blocks of a block compressed texture and stores the resulting pixels in 'dest'.
  *
@@ -763,25 +733,8 @@ void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_s
  * \param dest      Pointer to the image where the decompressed pixels will be stored.
  */
 void resolve_z_order_compressed_image(uint32_t width, uint32_t height, const uint8_t *src, uint8_t *dest, const uint32_t block_size) {
-    uint32_t block_count_x = (width + 3) / 4;
-    uint32_t block_count_y = (height + 3) / 4;
-
-    uint32_t min = std::min(block_count_x, block_count_y);
-    uint32_t k = std::bit_width(min) - 1;
-
-    uint32_t block_count = block_count_x * block_count_y;
-    for (uint32_t i = 0; i < block_count; i++) {
-        uint32_t x = decode_morton2_x(i) & (min - 1);
-        uint32_t y = decode_morton2_y(i) & (min - 1);
-        uint32_t upper_bits = (i >> (2 * k)) << k;
-        if (block_count_x >= block_count_y) {
-            x |= upper_bits;
-        } else {
-            y |= upper_bits;
-        }
-
-        std::memcpy(dest + (y * block_count_x + x) * block_size, src + i * block_size, block_size);
-    }
+    // the blocks are swizzled like the texels of an uncompressed texture
+    gxm::swizzled_to_linear(dest, src, (width + 3) / 4, (height + 3) / 4, block_size);
 }
 
 } // namespace renderer::texture
@@ -727,7 +727,9 @@ static void mapDecompressedData(Pixel32 *pOutput, int width, const Pixel32 *pWor
         }
     }
 }
-static int pvrtcDecompress(uint8_t *pCompressedData, Pixel32 *pDecompressedData, uint32_t ui32Width, uint32_t ui32Height, uint8_t ui8Bpp, uint32_t uiII) {
+// Each iteration of the word rows loop writes the bottom half of the previous row of words and the top half of the current one,
+// so ranges of word rows [firstWordRow, lastWordRow) write disjoint pixels and can be decompressed in parallel.
+static int pvrtcDecompress(uint8_t *pCompressedData, Pixel32 *pDecompressedData, uint32_t ui32Width, uint32_t ui32Height, uint8_t ui8Bpp, uint32_t uiII, int firstWordRow, int lastWordRow) {
     uint32_t ui32WordWidth = 4;
     uint32_t ui32WordHeight = 4;
     if (ui8Bpp == 2) {
@@ -746,7 +748,7 @@ static int pvrtcDecompress(uint8_t *pCompressedData, Pixel32 *pDecompressedData,
     std::vector<Pixel32> pPixels(ui32WordWidth * ui32WordHeight);
 
     // For each row of words
-    for (int wordY = -1; wordY < i32NumYWords - 1; wordY++) {
+    for (int wordY = firstWordRow - 1; wordY < std::min(lastWordRow, i32NumYWords) - 1; wordY++) {
         // for each column of words
         for (int wordX = -1; wordX < i32NumXWords - 1; wordX++) {
             indices.P[0] = wrapWordIndex(i32NumXWords, wordX);
@@ -804,7 +806,7 @@ uint32_t PVRTDecompressPVRTC(const void *pCompressedData, uint32_t Do2bitMode, u
     }
 
     // Decompress the surface.
-    int retval = pvrtcDecompress((uint8_t *)pCompressedData, pDecompressedData, XTrueDim, YTrueDim, (Do2bitMode == 1 ? 2 : 4), DoPvrtType);
+    int retval = pvrtcDecompress((uint8_t *)pCompressedData, pDecompressedData, XTrueDim, YTrueDim, (Do2bitMode == 1 ? 2 : 4), DoPvrtType, 0, INT32_MAX);
 
     // If the dimensions were too small, then copy the new buffer back into the output buffer.
     if ((XTrueDim != XDim) || (YTrueDim != YDim)) {
@@ -821,6 +823,15 @@ uint32_t PVRTDecompressPVRTC(const void *pCompressedData, uint32_t Do2bitMode, u
     return retval;
 }
 
+uint32_t PVRTDecompressPVRTCRows(const void *pCompressedData, uint32_t Do2bitMode, uint32_t XDim, uint32_t YDim, uint32_t DoPvrtType, uint8_t *pResultImage, uint32_t FirstWordRow, uint32_t WordRowCount) {
+    // the image must be at least one 2x2 group of words, no temporary buffer is used here
+    assert(XDim >= ((Do2bitMode == 1u) ? 16u : 8u));
+    assert(YDim >= 8u);
+
+    return pvrtcDecompress((uint8_t *)pCompressedData, (Pixel32 *)pResultImage, XDim, YDim, (Do2bitMode == 1 ? 2 : 4), DoPvrtType,
+        static_cast<int>(FirstWordRow), static_cast<int>(FirstWordRow + WordRowCount));
+}
+
 ////////////////////////////////////// ETC Compression //////////////////////////////////////
 
 #define _CLAMP_(X, Xmin, Xmax) ((X) < (Xmax) ? ((X) < (Xmin) ? (Xmin) : (X)) : (Xmax))
@@ -579,7 +579,7 @@ void TextureCache::import_upload_texture() {
             for (uint32_t mip = 0; mip < mipcount; mip++) {
                 const uint8_t *mip_data = imported_texture_decoded + ddspp::get_offset(*dds_descriptor, mip, face);
                 // dds textures are tightly packed (up to the block size)
-                upload_texture_impl(current_info->format, width, height, mip, mip_data, is_cube + face, align(width, block_width));
+                upload_texture_impl(current_info->format, width, height, mip, mip_data, is_cube + face, align(width, block_width), 0);
 
                 // on to the next mip
                 width /= 2;
@@ -588,7 +588,7 @@ void TextureCache::import_upload_texture() {
         }
     } else {
         // just upload the first mip and we are done (png does not support multiple mips / cubemaps)
-        upload_texture_impl(current_info->format, current_info->width, current_info->height, 0, imported_texture_decoded, 0, current_info->width);
+        upload_texture_impl(current_info->format, current_info->width, current_info->height, 0, imported_texture_decoded, 0, current_info->width, 0);
     }
 }
 
@@ -22,6 +22,7 @@
 #include <renderer/functions.h>
 #include <renderer/state.h>
 #include <renderer/types.h>
+#include <util/align.h>
 #include <util/log.h>
 #include <util/tracy.h>
 
@@ -30,9 +31,9 @@
 // keywords.h must be after tracy.h for msvc compiler
 #include <util/keywords.h>
 
-extern "C" {
-#include <libswscale/swscale.h>
-}
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace renderer {
 
@@ -41,38 +42,53 @@ static void perform_transfer_copy_impl(MemState &mem, const SceGxmTransferImage
     T *__restrict__ src_ptr = src.address.cast<T>().get(mem);
     T *__restrict__ dst_ptr = dst.address.cast<T>().get(mem);
 
-    auto compute_offset = [&](uint32_t dx, uint32_t dy, const SceGxmTransferImage &img, SceGxmTransferType type) -> int32_t {
-        const int32_t stride_pixel = img.stride / sizeof(T);
-        if (type == SCE_GXM_TRANSFER_LINEAR) {
-            return dy * stride_pixel + dx;
-        } else if (type == SCE_GXM_TRANSFER_TILED) {
-            // tiles are 32x32, you have the offset within the tile then the offset of the tile
-            const uint32_t texel_offset_in_tile = ((dy % 32) * 32) + (dx % 32);
-            const int32_t tile_address = (stride_pixel / 32) * (dy / 32) + (dx / 32);
-
-            return tile_address * 1024 + texel_offset_in_tile;
+    if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_NONE && src_type != SCE_GXM_TRANSFER_LINEAR && dst_type == SCE_GXM_TRANSFER_LINEAR) {
+        // a whole tiled or swizzled image to a packed linear image is what the texture upload does
+        const bool whole_image = src.x == 0 && src.y == 0 && dst.x == 0 && dst.y == 0 && dst.stride == static_cast<int32_t>(src.width * sizeof(T));
+        if constexpr (src_type == SCE_GXM_TRANSFER_SWIZZLED) {
+            if (whole_image && gxm::swizzled_to_linear(dst_ptr, src_ptr, src.width, src.height, sizeof(T)))
+                return;
         } else {
-            return texture::encode_morton(dx, dy, img.width, img.height);
+            if (whole_image && src.stride == static_cast<int32_t>(align(src.width, 32) * sizeof(T)) && gxm::tiled_to_linear(dst_ptr, src_ptr, src.width, src.height, sizeof(T)))
+                return;
         }
-    };
+    }
 
+    const gxm::TransferLayout<src_type> src_layout(src.width, src.height, src.stride / sizeof(T));
+    const gxm::TransferLayout<dst_type> dst_layout(dst.width, dst.height, dst.stride / sizeof(T));
+
+    // the offsets of the columns are the same for every row
+    std::vector<uint32_t> src_columns(src.width);
+    std::vector<uint32_t> dst_columns(src.width);
     for (uint32_t dx = 0; dx < src.width; dx++) {
-        for (uint32_t dy = 0; dy < src.height; dy++) {
-            // compute offset depending on the texture type used
-            // the function compute_offset gets inlined
-            uint32_t src_offset = compute_offset(src.x + dx, src.y + dy, src, src_type);
-            uint32_t dst_offset = compute_offset(dst.x + dx, dst.y + dy, dst, dst_type);
-
-            T value = src_ptr[src_offset];
-            if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS) {
-                if ((value & key_mask) != key_value)
-                    continue;
-            } else if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_REJECT) {
-                if ((value & key_mask) == key_value)
-                    continue;
+        src_columns[dx] = src_layout.column_offset(src.x + dx);
+        dst_columns[dx] = dst_layout.column_offset(dst.x + dx);
+    }
+
+    for (uint32_t dy = 0; dy < src.height; dy++) {
+        const T *src_row = src_ptr + src_layout.row_offset(src.y + dy);
+        T *dst_row = dst_ptr + dst_layout.row_offset(dst.y + dy);
+
+        if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_NONE && src_type != SCE_GXM_TRANSFER_SWIZZLED && dst_type != SCE_GXM_TRANSFER_SWIZZLED) {
+            // copy the texels which follow each other in both images at once, up to a tile row
+            for (uint32_t dx = 0; dx < src.width;) {
+                const uint32_t count = std::min({ src.width - dx, src_layout.contiguous_texels(src.x + dx), dst_layout.contiguous_texels(dst.x + dx) });
+                memcpy(dst_row + dst_columns[dx], src_row + src_columns[dx], count * sizeof(T));
+                dx += count;
             }
+        } else {
+            for (uint32_t dx = 0; dx < src.width; dx++) {
+                T value = src_row[src_columns[dx]];
+                if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS) {
+                    if ((value & key_mask) != key_value)
+                        continue;
+                } else if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_REJECT) {
+                    if ((value & key_mask) == key_value)
+                        continue;
+                }
 
-            dst_ptr[dst_offset] = value;
+                dst_row[dst_columns[dx]] = value;
+            }
         }
     }
 }
@@ -210,38 +226,11 @@ COMMAND(handle_transfer_downscale) {
 
     // only rgb formats are supported by the PS Vita for downscaling
     vulkan::CallbackRequestFunction downscale_operation = [&mem, src, dst]() {
-        AVPixelFormat pixel_fmt = AV_PIX_FMT_NONE;
-        switch (src->format) {
-        case SCE_GXM_TRANSFER_FORMAT_U5U6U5_BGR:
-            pixel_fmt = AV_PIX_FMT_RGB565LE;
-            break;
-        case SCE_GXM_TRANSFER_FORMAT_U8U8U8_BGR:
-            pixel_fmt = AV_PIX_FMT_RGB24;
-            break;
-        case SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR:
-            pixel_fmt = AV_PIX_FMT_RGBA;
-            break;
-        default:
-            break;
-        }
-
         uint8_t *src_ptr = src->address.cast<uint8_t>().get(mem);
         uint8_t *dst_ptr = dst->address.cast<uint8_t>().get(mem);
 
-        if (pixel_fmt != AV_PIX_FMT_NONE && src->stride > 0 && dst->stride > 0) {
-            // use ffmpeg with the avg filter
-            SwsContext *ctx = sws_getContext(src->width, src->height, pixel_fmt, dst->width, dst->height, pixel_fmt, SWS_AREA, nullptr, nullptr, nullptr);
-            if (ctx == nullptr) {
-                LOG_ERROR("Failed to get ffmpeg context for format 0x{:0X}", fmt::underlying(src->format));
-            } else {
-                sws_scale(ctx, &src_ptr, &src->stride, 0, src->height, &dst_ptr, &dst->stride);
-                sws_freeContext(ctx);
-            }
-
-        } else {
-            // fallback, not (entirely) supported by ffmpeg
-            // slow and not entirely accurate (nearest instead of average) fallback
-
+        if (!gxm::downscale_image(dst_ptr, src_ptr, dst->width, dst->height, dst->stride, src->stride, src->format)) {
+            // raw and yuv formats, there are no channels to average so use the nearest texel
             auto perform_downscale = [&]<typename T>(T type) {
                 for (size_t y = 0; y < dst->height; y++) {
                     // stride is in bytes
@@ -290,25 +279,29 @@ COMMAND(handle_transfer_fill) {
     const uint32_t fill_color = helper.pop<uint32_t>();
     const SceGxmTransferImage *dest = helper.pop<SceGxmTransferImage *>();
 
-    const auto bpp = gxm::get_bits_per_pixel(dest->format);
+    if (renderer.current_backend == Backend::Vulkan) {
+        // the fill of a cached surface is done by the GPU, which also writes the result back to memory
+        if (dynamic_cast<vulkan::VKState &>(renderer).surface_cache.fill_surface(*dest, fill_color)) {
+            delete dest;
+            return;
+        }
+    }
 
-    const uint32_t bytes_per_pixel = (bpp + 7) >> 3;
-    for (uint32_t y = 0; y < dest->height; y++) {
-        for (uint32_t x = 0; x < dest->width; x++) {
-            // Set offset of destination
-            const auto dest_offset = ((x + dest->x) * bytes_per_pixel) + ((y + dest->y) * dest->stride);
+    vulkan::CallbackRequestFunction fill_operation = [&mem, fill_color, dest]() {
+        const uint32_t bytes_per_pixel = (gxm::get_bits_per_pixel(dest->format) + 7) >> 3;
+        uint8_t *dest_ptr = dest->address.cast<uint8_t>().get(mem) + dest->y * dest->stride + dest->x * bytes_per_pixel;
+        gxm::fill_image(dest_ptr, dest->width, dest->height, dest->stride, bytes_per_pixel, fill_color);
 
-            // Set pointer of destination
-            auto dest_ptr = (uint8_t *)dest->address.get(mem) + dest_offset;
+        delete dest;
+    };
 
-            // Fill color in destination
-            memcpy(dest_ptr, &fill_color, bytes_per_pixel);
-        }
+    if (renderer.current_backend == Backend::Vulkan && renderer.features.enable_memory_mapping && !renderer.disable_surface_sync) {
+        // a surface which could not be cleared on the GPU is synced back to memory before being filled
+        if (dynamic_cast<vulkan::VKState &>(renderer).surface_cache.check_for_surface(mem, dest->address.address(), fill_operation, dest->address.address()))
+            return;
     }
 
-    // TODO: handle case where dest is a cached surface
-
-    delete dest;
+    fill_operation();
 }
 
 } // namespace renderer
@@ -506,7 +506,7 @@ vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmPro
     LOG_INFO("Generating vulkan spv shader {}", hash_text);
     const std::string shader_version = fmt::format("vk{}", shader::CURRENT_VERSION);
 
-    shader::usse::SpirvCode source = load_spirv_shader(*program, state.features, true, hints, maskupdate, state.shaders_path, state.shaders_log_path, shader_version, true);
+    shader::usse::SpirvCode source = load_spirv_shader(*program, state.features, true, hints, maskupdate, state.shader_archive, state.shaders_log_path, shader_version, true);
 
     vk::ShaderModuleCreateInfo shader_info{
         .codeSize = sizeof(uint32_t) * source.size(),
@@ -1016,19 +1016,20 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
 
 vk::ShaderModule PipelineCache::precompile_shader(const Sha256Hash &hash, bool search_first) {
     if (search_first) {
-        // happens while loading the thread, no parallel access so no need for a mutex
+        // programs are precompiled from several threads and often share a vertex shader
+        std::lock_guard<std::mutex> guard(shaders_mutex);
         auto it = shaders.find(hash);
         if (it != shaders.end())
             return it->second;
     }
 
-    if (!fs::exists(state.shaders_path) || fs::is_empty(state.shaders_path))
+    if (!state.shader_archive.is_open())
         return nullptr;
 
     Sha256Hash shader_hash;
     memcpy(shader_hash.data(), hash.data(), sizeof(Sha256Hash));
     const std::string shader_file_name = fmt::format("vk{}-{}.spv", shader::CURRENT_VERSION, hex_string(shader_hash));
-    const std::vector<uint32_t> source = renderer::pre_load_shader_spirv(state.shaders_path / shader_file_name);
+    const std::vector<uint32_t> source = renderer::pre_load_shader_spirv(state.shader_archive, shader_file_name);
 
     if (source.empty())
         return nullptr;
@@ -1041,7 +1042,14 @@ vk::ShaderModule PipelineCache::precompile_shader(const Sha256Hash &hash, bool s
     vk::ShaderModule shader = state.device.createShaderModule(shader_info);
     {
         std::lock_guard<std::mutex> guard(shaders_mutex);
-        shaders[hash] = shader;
+        const auto [it, inserted] = shaders.emplace(hash, shader);
+        if (!inserted && search_first) {
+            // another thread created the same shader in the meantime
+            state.device.destroyShaderModule(shader);
+            return it->second;
+        }
+        // otherwise the entry is the placeholder of the caller compiling it
+        it->second = shader;
     }
 
     return shader;
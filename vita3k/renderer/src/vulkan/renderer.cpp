@@ -1078,6 +1078,7 @@ void VKState::cleanup() {
 
     gxp_ptr_map.clear();
     shaders_cache_hashs.clear();
+    shader_archive.close();
     request_queue.reset();
     current_frame_idx = 1;
     last_scene_id = 0;
@@ -1756,8 +1757,13 @@ void VKState::precompile_shader(const ShadersHash &hash) {
         pipeline_cache.precompile_shader(hash.frag);
     }
 
-    programs_count_pre_compiled++;
-    LOG_INFO("Program Compiled {}/{}", programs_count_pre_compiled, shaders_cache_hashs.size());
+    const uint32_t compiled = ++programs_count_pre_compiled;
+    LOG_INFO("Program Compiled {}/{}", compiled, shaders_cache_hashs.size());
+}
+
+bool VKState::can_precompile_in_parallel() {
+    // the pipeline cache guards its shader map, creating shader modules is thread safe
+    return true;
 }
 
 void VKState::preclose_action() {
@@ -1788,6 +1794,10 @@ void VKState::set_turbo_mode(bool set) {
 }
 #endif
 
+bool TrappedBuffer::is_dirty(const MemState &mem) const {
+    return pages_written_since(mem, watched_addr, watched_size, write_generation);
+}
+
 BufferTrapping::BufferTrapping(VKState &state)
     : state(state) {}
 
@@ -1819,7 +1829,7 @@ TrappedBuffer *BufferTrapping::access_buffer(Address addr, uint32_t size, MemSta
     if (it != trapped_buffers.end()) {
         // must check if everything match
         TrappedBuffer &buffer = it->second;
-        if (!buffer.dirty && buffer.size >= size)
+        if (!buffer.is_dirty(mem) && buffer.size >= size)
             // nothing to change
             return &it->second;
     } else {
@@ -1832,14 +1842,13 @@ TrappedBuffer *BufferTrapping::access_buffer(Address addr, uint32_t size, MemSta
         auto next_it = it;
         next_it++;
         while (next_it != trapped_buffers.end() && next_it->first < addr + size) {
-            if (next_it->second.dirty)
+            if (next_it->second.is_dirty(mem))
                 next_it = trapped_buffers.erase(next_it);
             else
                 next_it++;
         }
     }
     it->second.size = size;
-    it->second.dirty = false;
     it->second.extra = ~0;
 
     if (is_new) {
@@ -1863,10 +1872,10 @@ TrappedBuffer *BufferTrapping::access_buffer(Address addr, uint32_t size, MemSta
         aligned_addr = align(addr, KiB(4));
         aligned_size = align_down(addr + size - aligned_addr, KiB(4));
     }
-    add_protect(mem, aligned_addr, aligned_size, MemPerm::ReadOnly, [it](Address addr, bool write) {
-        it->second.dirty = true;
-        return true;
-    });
+    // writes are only recorded, checking them when the buffer is accessed again is enough
+    it->second.watched_addr = aligned_addr;
+    it->second.watched_size = aligned_size;
+    it->second.write_generation = watch_pages(mem, aligned_addr, aligned_size);
 
     // copy back the data as it was non-existent or dirty
     memcpy(it->second.mapped_location, Ptr<void>(addr).get(mem), size);
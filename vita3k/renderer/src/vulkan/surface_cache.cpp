@@ -1111,6 +1111,74 @@ Framebuffer &VKSurfaceCache::retrieve_framebuffer_handle(MemState &mem, SceGxmCo
     return (framebuffer_array[key] = { fb_standard, fb_interlock, color_result.base_image });
 }
 
+void VKSurfaceCache::sync_surface(ColorSurfaceCacheInfo &surface, const vk::ClearColorValue *clear_color) {
+    *surface.need_surface_sync = true;
+
+    VKContext &context = *static_cast<VKContext *>(state.context);
+    // we shouldn't have a command buffer being used, but just in case
+    vk::CommandBuffer prev_cmd = context.render_cmd;
+
+    // for the time being, just create a temp command buffer / fence
+    // That's not the best approach but I guess it works
+    vk::CommandBuffer surface_cmd = nullptr;
+    vk::Fence fence = state.device.createFence({});
+    ColorSurfaceCacheInfo *returned_info = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state.multithread_pool_mutex);
+        surface_cmd = vkutil::create_single_time_command(state.device, state.multithread_command_pool);
+
+        if (clear_color) {
+            // the whole surface is overwritten
+            surface.texture.transition_to_discard(surface_cmd, vkutil::ImageLayout::TransferDst);
+            surface_cmd.clearColorImage(surface.texture.image, vk::ImageLayout::eTransferDstOptimal, *clear_color, vkutil::color_subresource_range);
+
+            // the surface sync copies from the general layout, make the clear visible to it and to the next scenes
+            const vk::ImageMemoryBarrier barrier{
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+                .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                .newLayout = vk::ImageLayout::eGeneral,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = surface.texture.image,
+                .subresourceRange = vkutil::color_subresource_range
+            };
+            surface_cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                vk::DependencyFlags(), {}, {}, barrier);
+            surface.texture.layout = vkutil::ImageLayout::ColorAttachmentReadWrite;
+        }
+
+        context.render_cmd = surface_cmd;
+        last_written_surface = &surface;
+        returned_info = perform_surface_sync();
+        context.render_cmd = prev_cmd;
+
+        surface_cmd.end();
+    }
+    // submit this command
+    vk::SubmitInfo submit_info{};
+    submit_info.setCommandBuffers(surface_cmd);
+    state.general_queue.submit(submit_info, fence);
+
+    // now we need to wait for the fence, then destroy it along with the command buffer
+    // to prevent memory leaks
+    CallbackRequestFunction vk_callback = [&state = this->state, fence, surface_cmd]() {
+        auto result = state.device.waitForFences(fence, vk::True, std::numeric_limits<uint64_t>::max());
+        if (result != vk::Result::eSuccess)
+            LOG_ERROR("Could not wait for fences.");
+
+        // destroy the objects
+        state.device.destroyFence(fence);
+
+        std::lock_guard<std::mutex> lock(state.multithread_pool_mutex);
+        state.device.freeCommandBuffers(state.multithread_command_pool, surface_cmd);
+    };
+    state.request_queue.push(CallbackRequest{ new CallbackRequestFunction(std::move(vk_callback)) });
+
+    if (returned_info)
+        state.request_queue.push(PostSurfaceSyncRequest{ returned_info });
+}
+
 bool VKSurfaceCache::check_for_surface(MemState &mem, Address source_address, CallbackRequestFunction &callback, Address target_address) {
     if (!state.features.enable_memory_mapping || state.disable_surface_sync)
         return false;
@@ -1138,52 +1206,9 @@ bool VKSurfaceCache::check_for_surface(MemState &mem, Address source_address, Ca
         return false;
 
     // we found something
-    if (!*surface.need_surface_sync) {
+    if (!*surface.need_surface_sync)
         // first send the command to sync the surface with the GPU
-        *surface.need_surface_sync = true;
-
-        // we shouldn't have a command buffer being used, but just in case
-        vk::CommandBuffer prev_cmd = context.render_cmd;
-
-        // for the time being, just create a temp command buffer / fence
-        // That's not the best approach but I guess it works
-        vk::CommandBuffer surface_cmd = nullptr;
-        vk::Fence fence = state.device.createFence({});
-        ColorSurfaceCacheInfo *returned_info = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(state.multithread_pool_mutex);
-            surface_cmd = vkutil::create_single_time_command(state.device, state.multithread_command_pool);
-
-            context.render_cmd = surface_cmd;
-            last_written_surface = &surface;
-            returned_info = perform_surface_sync();
-            context.render_cmd = prev_cmd;
-
-            surface_cmd.end();
-        }
-        // submit this command
-        vk::SubmitInfo submit_info{};
-        submit_info.setCommandBuffers(surface_cmd);
-        state.general_queue.submit(submit_info, fence);
-
-        // now we need to wait for the fence, then destroy it along with the command buffer
-        // to prevent memory leaks
-        CallbackRequestFunction vk_callback = [&state = this->state, fence, surface_cmd]() {
-            auto result = state.device.waitForFences(fence, vk::True, std::numeric_limits<uint64_t>::max());
-            if (result != vk::Result::eSuccess)
-                LOG_ERROR("Could not wait for fences.");
-
-            // destroy the objects
-            state.device.destroyFence(fence);
-
-            std::lock_guard<std::mutex> lock(state.multithread_pool_mutex);
-            state.device.freeCommandBuffers(state.multithread_command_pool, surface_cmd);
-        };
-        state.request_queue.push(CallbackRequest{ new CallbackRequestFunction(std::move(vk_callback)) });
-
-        if (returned_info)
-            state.request_queue.push(PostSurfaceSyncRequest{ returned_info });
-    }
+        sync_surface(surface, nullptr);
 
     // now push the callback
     state.request_queue.push(CallbackRequest{ new CallbackRequestFunction(std::move(callback)) });
@@ -1194,6 +1219,45 @@ bool VKSurfaceCache::check_for_surface(MemState &mem, Address source_address, Ca
     return true;
 }
 
+bool VKSurfaceCache::fill_surface(const SceGxmTransferImage &dest, uint32_t fill_color) {
+    if (!state.features.enable_memory_mapping || state.disable_surface_sync)
+        return false;
+
+    // a pending transfer writes to this surface on the CPU, the fill must happen after it
+    if (vector_utils::find_index(cpu_surfaces_changed, dest.address.address()) != -1)
+        return false;
+
+    auto it = color_address_lookup.find(dest.address.address());
+    if (it == color_address_lookup.end())
+        return false;
+
+    auto &surface = *it->second;
+    const VKContext &context = *static_cast<VKContext *>(state.context);
+    if (surface.last_frame_rendered + MAX_FRAMES_RENDERING <= context.frame_timestamp || *surface.dirty)
+        return false;
+
+    // only a fill of a whole rgba8 surface is done with a single clear
+    if (dest.format != SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR || surface.format != SCE_GXM_COLOR_BASE_FORMAT_U8U8U8U8
+        || surface.texture.format != vk::Format::eR8G8B8A8Unorm || surface.swizzle.r != vk::ComponentSwizzle::eR
+        || surface.tiling != SurfaceTiling::Linear)
+        return false;
+
+    if (dest.x != 0 || dest.y != 0 || dest.width != surface.original_width || dest.height != surface.original_height
+        || dest.stride != static_cast<int32_t>(surface.stride_bytes))
+        return false;
+
+    const vk::ClearColorValue clear_color{ std::array<float, 4>({
+        static_cast<float>(fill_color & 0xFF) / 255.0f,
+        static_cast<float>((fill_color >> 8) & 0xFF) / 255.0f,
+        static_cast<float>((fill_color >> 16) & 0xFF) / 255.0f,
+        static_cast<float>(fill_color >> 24) / 255.0f,
+    }) };
+    // the surface sync then writes the cleared surface back to the guest memory
+    sync_surface(surface, &clear_color);
+
+    return true;
+}
+
 ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
     // surface sync is supported only if memory mapping is enabled
     if (!state.features.enable_memory_mapping)
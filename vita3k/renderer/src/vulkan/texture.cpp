@@ -261,8 +261,12 @@ void VKTextureCache::prepare_staging_buffer(bool is_configure) {
     };
 
     // if this is done during configure, layout is undefined, otherwise it is shader read only
+    // and its content is discarded unless only part of it is uploaded (see keep_texture_content),
+    // discarding it would lose the small mips already uploaded when the decompressed ones are swapped in
     if (is_configure)
         vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::Undefined, vkutil::ImageLayout::TransferDst, range);
+    else if (keep_texture_content)
+        vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::SampledImage, vkutil::ImageLayout::TransferDst, range);
     else
         vkutil::transition_image_layout_discard(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::SampledImage, vkutil::ImageLayout::TransferDst, range);
 
@@ -476,7 +480,7 @@ static void *add_alpha_channel(const void *pixels, const uint32_t width, const u
 }
 
 void VKTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height,
-    uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) {
+    uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride, uint32_t first_row) {
     if (!is_texture_transfer_ready)
         prepare_staging_buffer();
 
@@ -531,7 +535,7 @@ void VKTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
         .bufferRowLength = pixels_per_stride,
         .bufferImageHeight = buffer_height,
         .imageSubresource = layer,
-        .imageOffset = { 0, 0, 0 },
+        .imageOffset = { 0, static_cast<int32_t>(first_row), 0 },
         .imageExtent = { width, height, 1 }
     };
     cmd_buffer.copyBufferToImage(staging_buffer.buffer.buffer, image.image, vk::ImageLayout::eTransferDstOptimal, region);
@@ -0,0 +1,59 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/functions.h>
+
+#include <gxm/functions.h>
+#include <threads/worker_pool.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// size of a large texture
+static constexpr uint32_t SIZE = 1024;
+
+// the throughput is given in bytes of decompressed texels
+template <SceGxmTextureBaseFormat format>
+static void BM_Decompress(benchmark::State &state) {
+    const uint32_t bytes_per_texel = gxm::is_pvrt_format(format) ? 4 : gxm::get_num_components(format);
+    std::vector<uint8_t> src((SIZE * SIZE * gxm::bits_per_pixel(format)) / 8);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = static_cast<uint8_t>(i * 251 + (i >> 7));
+    std::vector<uint8_t> dest(SIZE * SIZE * bytes_per_texel);
+
+    // state.range(0) is the number of workers helping the calling thread
+    WorkerPool pool(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        renderer::texture::decompress_compressed_texture(format, dest.data(), src.data(), SIZE, SIZE, state.range(0) > 0 ? &pool : nullptr);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * dest.size());
+}
+
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_UBC1>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_UBC2>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_UBC3>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_UBC4>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_SBC4>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_UBC5>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_SBC5>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP>)->Arg(0)->Arg(3);
+BENCHMARK(BM_Decompress<SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP>)->Arg(0)->Arg(3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/shader_archive.h>
+
+#include <threads/worker_pool.h>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// roughly the shader cache of a large game
+static constexpr uint32_t SHADER_COUNT = 8000;
+static constexpr uint32_t SHADER_SIZE = 4096;
+
+static std::string shader_name(const uint32_t i) {
+    return fmt::format("vk13-{:064x}.spv", static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Writes every shader both as a loose file and in an archive, once for all the benchmarks
+static const fs::path &get_cache_path() {
+    static const fs::path path = [] {
+        const fs::path dir = fs::temp_directory_path() / "vita3k-shader-archive-bench";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "loose");
+
+        std::vector<char> data(SHADER_SIZE);
+        renderer::ShaderArchive archive;
+        archive.open(dir / renderer::ShaderArchive::FILE_NAME);
+        for (uint32_t i = 0; i < SHADER_COUNT; i++) {
+            for (uint32_t j = 0; j < SHADER_SIZE; j++)
+                data[j] = static_cast<char>(i * 31 + j);
+
+            const std::string name = shader_name(i);
+            std::ofstream(dir / "loose" / name, std::ios::binary).write(data.data(), data.size());
+            archive.add(name, data.data(), data.size());
+        }
+        archive.close();
+        return dir;
+    }();
+    return path;
+}
+
+// what the shader loading did before the archive: one file open per shader
+static std::vector<uint32_t> read_loose_file(const fs::path &path) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is)
+        return {};
+    is.seekg(0, std::ios::end);
+    std::vector<uint32_t> shader(static_cast<size_t>(is.tellg()) / sizeof(uint32_t));
+    is.seekg(0);
+    is.read(reinterpret_cast<char *>(shader.data()), shader.size() * sizeof(uint32_t));
+    return shader;
+}
+
+static std::vector<uint32_t> read_archive_entry(renderer::ShaderArchive &archive, const std::string &name) {
+    const std::string_view data = archive.find(name);
+    std::vector<uint32_t> shader(data.size() / sizeof(uint32_t));
+    memcpy(shader.data(), data.data(), shader.size() * sizeof(uint32_t));
+    return shader;
+}
+
+static std::vector<std::string> get_shader_names() {
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < SHADER_COUNT; i++)
+        names.push_back(shader_name(i));
+    return names;
+}
+
+static void BM_ArchiveOpen(benchmark::State &state) {
+    const fs::path path = get_cache_path() / renderer::ShaderArchive::FILE_NAME;
+    for (auto _ : state) {
+        renderer::ShaderArchive archive;
+        archive.open(path);
+        benchmark::DoNotOptimize(archive.size());
+    }
+    state.SetItemsProcessed(state.iterations() * SHADER_COUNT);
+}
+
+// the throughput is given in shaders loaded per second
+static void BM_LoadLooseFiles(benchmark::State &state) {
+    const fs::path dir = get_cache_path() / "loose";
+    const std::vector<std::string> names = get_shader_names();
+    for (auto _ : state) {
+        for (const auto &name : names)
+            benchmark::DoNotOptimize(read_loose_file(dir / name));
+    }
+    state.SetItemsProcessed(state.iterations() * SHADER_COUNT);
+}
+
+// state.range(0) is the number of workers helping the calling thread
+static void BM_LoadArchive(benchmark::State &state) {
+    const std::vector<std::string> names = get_shader_names();
+    WorkerPool pool(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        renderer::ShaderArchive archive;
+        archive.open(get_cache_path() / renderer::ShaderArchive::FILE_NAME);
+        pool.run(SHADER_COUNT, [&](const uint32_t i) {
+            benchmark::DoNotOptimize(read_archive_entry(archive, names[i]));
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * SHADER_COUNT);
+}
+
+BENCHMARK(BM_ArchiveOpen);
+BENCHMARK(BM_LoadLooseFiles);
+BENCHMARK(BM_LoadArchive)->Arg(0)->Arg(3);
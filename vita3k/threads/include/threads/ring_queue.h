@@ -0,0 +1,210 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Bounded multi-producer single-consumer queue
+ *
+ * Items are stored by value in a fixed ring, pushing and popping never allocate and only take
+ * the mutex to park when the queue is full (producers) or empty (consumer), or to wake a parked thread.
+ * Every function not marked otherwise must only be called from the consumer thread.
+ */
+template <typename T, std::size_t Capacity>
+class RingQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    RingQueue() {
+        for (std::size_t i = 0; i < Capacity; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    RingQueue(const RingQueue &) = delete;
+    RingQueue &operator=(const RingQueue &) = delete;
+
+    // Can be called from any thread. Blocks while the queue is full.
+    void push(const T &item) {
+        if (aborted)
+            return;
+
+        while (!try_push(item)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            producers_waiting.fetch_add(1);
+            // the consumer may have made room before it could see us waiting
+            cond_not_full.wait(lock, [&] { return aborted || size() < Capacity; });
+            producers_waiting.fetch_sub(1);
+
+            if (aborted)
+                return;
+        }
+
+        // pairs with the fence in wait_not_empty
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting.load(std::memory_order_relaxed)) {
+            const std::lock_guard<std::mutex> lock(mutex);
+            cond_not_empty.notify_one();
+        }
+    }
+
+    // Can be called from any thread. Returns false if the queue is full.
+    bool try_push(const T &item) {
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & (Capacity - 1)];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                // the consumer has not freed this cell yet
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        Cell &cell = cells[pos & (Capacity - 1)];
+        cell.item = item;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns a copy of the oldest item without removing it, waits at most ms microseconds (forever if 0)
+    std::optional<T> top(const int ms = 0) {
+        if (!wait_not_empty(ms))
+            return {};
+        return cells[dequeue_pos.load(std::memory_order_relaxed) & (Capacity - 1)].item;
+    }
+
+    // Removes and returns the oldest item, waits at most ms microseconds (forever if 0)
+    std::optional<T> pop(const int ms = 0) {
+        if (!wait_not_empty(ms))
+            return {};
+
+        const std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell &cell = cells[pos & (Capacity - 1)];
+        std::optional<T> item = cell.item;
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeue_pos.store(pos + 1);
+
+        // waking the producers for every item would make them bounce between full and waiting,
+        // let them fill half of the queue at once instead
+        if (producers_waiting.load() > 0 && size() <= Capacity / 2) {
+            const std::lock_guard<std::mutex> lock(mutex);
+            cond_not_full.notify_all();
+        }
+        return item;
+    }
+
+    // Can be called from any thread, the result is only a snapshot
+    std::size_t size() const {
+        return enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos.load();
+    }
+
+    bool empty() const {
+        return !ready();
+    }
+
+    // Can be called from any thread. Makes the pending top()/pop() return early.
+    void wake() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            woken = true;
+        }
+        cond_not_empty.notify_all();
+    }
+
+    // Can be called from any thread
+    void abort() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+        }
+        cond_not_empty.notify_all();
+        cond_not_full.notify_all();
+    }
+
+    bool is_aborted() const {
+        return aborted.load(std::memory_order_relaxed);
+    }
+
+    // Drops all the items, there must be no producer running
+    void reset() {
+        aborted = false;
+        while (ready()) {
+            const std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            cells[pos & (Capacity - 1)].sequence.store(pos + Capacity, std::memory_order_relaxed);
+            dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T item{};
+    };
+
+    bool ready() const {
+        const std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        return cells[pos & (Capacity - 1)].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    bool wait_not_empty(const int ms) {
+        if (aborted.load(std::memory_order_relaxed))
+            return false;
+        if (ready())
+            return true;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        consumer_waiting.store(true, std::memory_order_relaxed);
+        // pairs with the fence in push, either the producer sees us waiting or we see its item
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto predicate = [&] { return aborted || woken || ready(); };
+        if (ms == 0)
+            cond_not_empty.wait(lock, predicate);
+        else
+            cond_not_empty.wait_for(lock, std::chrono::microseconds(ms), predicate);
+        consumer_waiting.store(false, std::memory_order_relaxed);
+        woken = false;
+
+        return !aborted && ready();
+    }
+
+    // producers and the consumer touch different counters, keep them on different cache lines
+    alignas(64) std::atomic<std::size_t> enqueue_pos{ 0 };
+    alignas(64) std::atomic<std::size_t> dequeue_pos{ 0 };
+    alignas(64) std::array<Cell, Capacity> cells;
+
+    std::mutex mutex;
+    std::condition_variable cond_not_empty;
+    std::condition_variable cond_not_full;
+    std::atomic<uint32_t> producers_waiting{ 0 };
+    std::atomic<bool> consumer_waiting{ false };
+    bool woken = false;
+
+    std::atomic<bool> aborted{ false };
+};
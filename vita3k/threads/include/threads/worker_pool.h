@@ -0,0 +1,132 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Small fork-join pool used to split a job in independent parts (ngs voices, texture stripes)
+ *
+ * run() hands out the indices of a job to the workers and the calling thread,
+ * and only returns once all of them have been processed. One job runs at a time.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(const uint32_t worker_count) {
+        for (uint32_t i = 0; i < worker_count; i++)
+            workers.emplace_back(&WorkerPool::worker_loop, this);
+    }
+
+    ~WorkerPool() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        job_cond.notify_all();
+
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    uint32_t worker_count() const { return static_cast<uint32_t>(workers.size()); }
+
+    // Calls func(i) once for every i in [0, count), from any of the workers or the calling thread
+    void run(const uint32_t count, const std::function<void(uint32_t)> &func) {
+        if (count == 0)
+            return;
+
+        // several systems can be updated from different threads
+        const std::lock_guard<std::mutex> run_lock(run_mutex);
+
+        if (workers.empty() || count == 1) {
+            for (uint32_t i = 0; i < count; i++)
+                func(i);
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            job = &func;
+            job_size = count;
+            next_index = 0;
+            busy_workers = static_cast<uint32_t>(workers.size());
+            job_generation++;
+        }
+        job_cond.notify_all();
+
+        work();
+
+        // the job must outlive the workers still running the indices they took
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cond.wait(lock, [this] { return busy_workers == 0; });
+        job = nullptr;
+    }
+
+private:
+    void work() {
+        while (true) {
+            const uint32_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+            if (index >= job_size)
+                return;
+            (*job)(index);
+        }
+    }
+
+    void worker_loop() {
+        uint64_t generation = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_cond.wait(lock, [&] { return stop || job_generation != generation; });
+                if (stop)
+                    return;
+                generation = job_generation;
+            }
+
+            work();
+
+            const std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0)
+                done_cond.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex run_mutex;
+
+    std::mutex mutex;
+    std::condition_variable job_cond;
+    std::condition_variable done_cond;
+    uint64_t job_generation = 0;
+    uint32_t busy_workers = 0;
+    bool stop = false;
+
+    const std::function<void(uint32_t)> *job = nullptr;
+    uint32_t job_size = 0;
+    std::atomic<uint32_t> next_index{ 0 };
+};
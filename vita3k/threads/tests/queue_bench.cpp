@@ -0,0 +1,69 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <threads/queue.h>
+#include <threads/ring_queue.h>
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+// Same size as a renderer CommandList
+struct Item {
+    void *first = nullptr;
+    void *last = nullptr;
+    void *context = nullptr;
+};
+
+template <typename Push, typename Pop>
+static void run_producers_consumer(benchmark::State &state, Push &&push, Pop &&pop) {
+    const int producer_count = static_cast<int>(state.range(0));
+    constexpr int items_per_producer = 1 << 16;
+
+    for (auto _ : state) {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producer_count; ++p) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < items_per_producer; ++i)
+                    push(Item{});
+            });
+        }
+        for (int i = 0; i < producer_count * items_per_producer; ++i)
+            benchmark::DoNotOptimize(pop());
+        for (auto &producer : producers)
+            producer.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * producer_count * items_per_producer);
+}
+
+static void BM_Queue(benchmark::State &state) {
+    Queue<Item> queue;
+    queue.maxPendingCount_ = 32;
+    run_producers_consumer(state, [&](const Item &item) { queue.push(item); }, [&] { return queue.pop(); });
+}
+
+static void BM_RingQueue(benchmark::State &state) {
+    RingQueue<Item, 32> queue;
+    run_producers_consumer(state, [&](const Item &item) { queue.push(item); }, [&] { return queue.pop(); });
+}
+
+BENCHMARK(BM_Queue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK(BM_RingQueue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,98 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <threads/ring_queue.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(ring_queue, fifo_order) {
+    RingQueue<int, 8> queue;
+
+    for (int i = 0; i < 8; ++i)
+        ASSERT_TRUE(queue.try_push(i));
+    ASSERT_FALSE(queue.try_push(8));
+    ASSERT_EQ(queue.size(), 8);
+
+    ASSERT_EQ(queue.top(), 0);
+    for (int i = 0; i < 8; ++i)
+        ASSERT_EQ(queue.pop(), i);
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(ring_queue, wraps_around) {
+    RingQueue<int, 4> queue;
+
+    for (int i = 0; i < 100; ++i) {
+        queue.push(i);
+        queue.push(i + 1000);
+        ASSERT_EQ(queue.pop(), i);
+        ASSERT_EQ(queue.pop(), i + 1000);
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(ring_queue, timed_wait_on_empty) {
+    RingQueue<int, 4> queue;
+
+    ASSERT_FALSE(queue.top(100).has_value());
+    ASSERT_FALSE(queue.pop(100).has_value());
+}
+
+TEST(ring_queue, abort_wakes_consumer) {
+    RingQueue<int, 4> queue;
+
+    std::thread consumer([&] { ASSERT_FALSE(queue.pop().has_value()); });
+    queue.abort();
+    consumer.join();
+    ASSERT_TRUE(queue.is_aborted());
+
+    queue.reset();
+    ASSERT_FALSE(queue.is_aborted());
+    queue.push(1);
+    ASSERT_EQ(queue.pop(), 1);
+}
+
+TEST(ring_queue, multiple_producers) {
+    constexpr int producer_count = 4;
+    constexpr int items_per_producer = 100000;
+    RingQueue<int, 32> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < items_per_producer; ++i)
+                queue.push(p * items_per_producer + i);
+        });
+    }
+
+    // items of a given producer must come out in the order it pushed them
+    std::vector<int> last(producer_count, -1);
+    for (int i = 0; i < producer_count * items_per_producer; ++i) {
+        const auto item = queue.pop();
+        ASSERT_TRUE(item.has_value());
+        const int producer = *item / items_per_producer;
+        ASSERT_GT(*item % items_per_producer, last[producer]);
+        last[producer] = *item % items_per_producer;
+    }
+
+    for (auto &producer : producers)
+        producer.join();
+    ASSERT_TRUE(queue.empty());
+}
@@ -0,0 +1,209 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/types.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rcu {
+
+// Each reader thread counts its critical sections in one of the stripes, in the counter of the current epoch parity
+struct alignas(64) ReaderStripe {
+    std::array<std::atomic<uint32_t>, 2> counters{};
+};
+
+extern std::atomic<uint32_t> epoch;
+ReaderStripe &assign_reader_stripe();
+
+inline thread_local ReaderStripe *reader_stripe = nullptr;
+
+// Marks a read-side critical section: the objects removed from an object table
+// are not released while a thread which could still see them is inside one
+class ReadGuard {
+public:
+    ReadGuard()
+        : counter((reader_stripe ? *reader_stripe : assign_reader_stripe()).counters[epoch.load(std::memory_order_relaxed) & 1]) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in synchronize(): either it sees this reader or the reader sees the removal
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    ~ReadGuard() {
+        counter.fetch_sub(1, std::memory_order_release);
+    }
+
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard &operator=(const ReadGuard &) = delete;
+
+private:
+    std::atomic<uint32_t> &counter;
+};
+
+// Waits until every read-side critical section which started before the call has ended
+void synchronize();
+
+} // namespace rcu
+
+/**
+ * @brief Kernel objects indexed by their UID
+ *
+ * Lookups with get() never lock: the objects are stored in a radix tree indexed by the UID, published with
+ * atomics and released once no reader can still see them (the erased ones in batches). As UIDs are never reused,
+ * a stale UID can't match a newer object. The ordered map kept next to the tree is only used for iteration:
+ * modifying the table and iterating it must be done under the same lock (the kernel mutex), as with a plain map.
+ */
+template <typename T>
+class ObjectTable {
+public:
+    typedef std::shared_ptr<T> ObjectPtr;
+    typedef std::map<SceUID, ObjectPtr> Map;
+    typedef typename Map::const_iterator const_iterator;
+
+    ObjectTable() = default;
+    ~ObjectTable() {
+        clear();
+        for (auto &inner : *root)
+            delete inner.load(std::memory_order_relaxed);
+    }
+
+    ObjectTable(const ObjectTable &) = delete;
+    ObjectTable &operator=(const ObjectTable &) = delete;
+
+    ObjectPtr get(SceUID uid) const {
+        if (uid < 0)
+            return {};
+
+        const rcu::ReadGuard guard;
+        const Inner *inner = (*root)[static_cast<uint32_t>(uid) >> (LEAF_BITS + INNER_BITS)].load(std::memory_order_acquire);
+        if (!inner)
+            return {};
+        const Leaf *leaf = inner->leaves[(uid >> LEAF_BITS) & INNER_MASK].load(std::memory_order_acquire);
+        if (!leaf)
+            return {};
+        const ObjectPtr *object = leaf->objects[uid & LEAF_MASK].load(std::memory_order_acquire);
+        return object ? *object : ObjectPtr();
+    }
+
+    std::pair<const_iterator, bool> emplace(SceUID uid, const ObjectPtr &object) {
+        const auto [it, inserted] = map.emplace(uid, object);
+        if (inserted)
+            get_slot(uid).store(new ObjectPtr(object), std::memory_order_release);
+        return { it, inserted };
+    }
+
+    size_t erase(SceUID uid) {
+        if (!map.erase(uid))
+            return 0;
+
+        // waiting for the readers on every erase would stall the kernel mutex, they are waited for once per batch
+        retired.push_back(get_slot(uid).exchange(nullptr));
+        if (retired.size() >= RETIRE_BATCH)
+            reclaim();
+        return 1;
+    }
+
+    void clear() {
+        for (const auto &[uid, _] : map)
+            retired.push_back(get_slot(uid).exchange(nullptr));
+        map.clear();
+        reclaim();
+    }
+
+    // Null if there is no object with this UID
+    const ObjectPtr &operator[](SceUID uid) const {
+        static const ObjectPtr none;
+        const auto it = map.find(uid);
+        return it != map.end() ? it->second : none;
+    }
+
+    const_iterator find(SceUID uid) const { return map.find(uid); }
+    bool contains(SceUID uid) const { return map.contains(uid); }
+    const_iterator begin() const { return map.begin(); }
+    const_iterator end() const { return map.end(); }
+    size_t size() const { return map.size(); }
+    bool empty() const { return map.empty(); }
+
+private:
+    static constexpr size_t RETIRE_BATCH = 64;
+
+    // 3 levels covering all the positive UIDs, the nodes are only freed with the table
+    static constexpr uint32_t LEAF_BITS = 10;
+    static constexpr uint32_t INNER_BITS = 10;
+    static constexpr uint32_t ROOT_BITS = 31 - LEAF_BITS - INNER_BITS;
+    static constexpr uint32_t LEAF_MASK = (1 << LEAF_BITS) - 1;
+    static constexpr uint32_t INNER_MASK = (1 << INNER_BITS) - 1;
+
+    struct Leaf {
+        std::array<std::atomic<const ObjectPtr *>, 1 << LEAF_BITS> objects{};
+    };
+
+    struct Inner {
+        std::array<std::atomic<Leaf *>, 1 << INNER_BITS> leaves{};
+
+        ~Inner() {
+            for (auto &leaf : leaves)
+                delete leaf.load(std::memory_order_relaxed);
+        }
+    };
+
+    // on the heap, the tables are members of the kernel state
+    const std::unique_ptr<std::array<std::atomic<Inner *>, 1 << ROOT_BITS>> root = std::make_unique<std::array<std::atomic<Inner *>, 1 << ROOT_BITS>>();
+    Map map;
+    // removed from the tree but maybe still seen by a reader
+    std::vector<const ObjectPtr *> retired;
+
+    void reclaim() {
+        if (retired.empty())
+            return;
+
+        rcu::synchronize();
+        for (const ObjectPtr *object : retired)
+            delete object;
+        retired.clear();
+    }
+
+    std::atomic<const ObjectPtr *> &get_slot(SceUID uid) {
+        std::atomic<Inner *> &inner_slot = (*root)[static_cast<uint32_t>(uid) >> (LEAF_BITS + INNER_BITS)];
+        Inner *inner = inner_slot.load(std::memory_order_relaxed);
+        if (!inner) {
+            inner = new Inner();
+            inner_slot.store(inner, std::memory_order_release);
+        }
+
+        std::atomic<Leaf *> &leaf_slot = inner->leaves[(uid >> LEAF_BITS) & INNER_MASK];
+        Leaf *leaf = leaf_slot.load(std::memory_order_relaxed);
+        if (!leaf) {
+            leaf = new Leaf();
+            leaf_slot.store(leaf, std::memory_order_release);
+        }
+
+        return leaf->objects[uid & LEAF_MASK];
+    }
+};
+
+// Lookups in an object table don't need the lock
+template <typename T>
+std::shared_ptr<T> lock_and_find(SceUID key, const ObjectTable<T> &table, std::mutex &) {
+    return table.get(key);
+}
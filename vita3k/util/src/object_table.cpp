@@ -0,0 +1,51 @@
+// Vita3K emulator project
+// Copyright (C) 2026 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <util/object_table.h>
+
+#include <thread>
+
+namespace rcu {
+
+// synchronize() flips the epoch parity and waits for the counters of the previous one to drain, twice, so that
+// the readers which read the parity just before the flip are waited for as well
+static constexpr size_t READER_STRIPES = 64;
+
+static std::array<ReaderStripe, READER_STRIPES> stripes;
+std::atomic<uint32_t> epoch{ 0 };
+static std::mutex synchronize_mutex;
+
+ReaderStripe &assign_reader_stripe() {
+    static std::atomic<uint32_t> next_stripe{ 0 };
+    reader_stripe = &stripes[next_stripe++ % READER_STRIPES];
+    return *reader_stripe;
+}
+
+void synchronize() {
+    // pairs with the fence in ReadGuard: the slots were cleared before, so a reader we miss can't see them
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::lock_guard<std::mutex> lock(synchronize_mutex);
+    for (int phase = 0; phase < 2; phase++) {
+        const uint32_t parity = epoch.fetch_add(1) & 1;
+        for (const auto &stripe : stripes) {
+            while (stripe.counters[parity].load() != 0)
+                std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace rcu